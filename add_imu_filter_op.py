@@ -0,0 +1,105 @@
+"""
+Prepend the GAINS_IMU_FILTER custom op to a quantized pushup model.
+
+The op (src/imu_filter_op.cpp) runs the firmware preprocessing chain (median,
+Butterworth filters, gravity removal) and the normalization inside the model,
+so the model input becomes the raw int16 IMU window:
+
+    imu_raw      int16 [1, 50, 6]  per-channel scale = ICM-20600 LSB size
+    new_samples  int32 [1]         samples that are new since the last invoke
+                                   (-1 = start of a recording)
+
+and the original int8 input tensor becomes an intermediate tensor. Used
+after the INT8 conversion in pushup_model_colab.ipynb:
+
+    python add_imu_filter_op.py pushup_model_quantized.tflite \
+        --metadata pushup_model_metadata.json -o pushup_model_filtered.tflite
+
+Requires tensorflow (for the flatbuffer schema) and flatbuffers.
+"""
+
+import argparse
+import json
+
+from flatbuffers import flexbuffers
+from tensorflow.lite.python import schema_py_generated as schema_fb
+from tensorflow.lite.tools import flatbuffer_utils
+
+OP_NAME = "GAINS_IMU_FILTER"
+
+# ICM-20600 as configured in imu_provider.cpp: +-2 g and +-250 deg/s full scale
+ACCEL_LSB = 2.0 / 32768.0
+GYRO_LSB = 250.0 / 32768.0
+
+
+def add_filter_op(model, mean, std):
+    subgraph = model.subgraphs[0]
+    if len(subgraph.inputs) != 1:
+        raise ValueError("expected a single-input model")
+    model_input = subgraph.tensors[subgraph.inputs[0]]
+    if model_input.type != schema_fb.TensorType.INT8:
+        raise ValueError("model input must be int8 (run the INT8 conversion first)")
+    shape = list(model_input.shape)
+    if len(shape) != 3 or shape[2] != 6:
+        raise ValueError(f"expected input shape [1, window, 6], got {shape}")
+
+    def add_tensor(name, tensor_type, tensor_shape, quantization=None):
+        buffer = schema_fb.BufferT()
+        model.buffers.append(buffer)
+        tensor = schema_fb.TensorT()
+        tensor.name = name
+        tensor.type = tensor_type
+        tensor.shape = tensor_shape
+        tensor.buffer = len(model.buffers) - 1
+        tensor.quantization = quantization
+        subgraph.tensors.append(tensor)
+        return len(subgraph.tensors) - 1
+
+    raw_quant = schema_fb.QuantizationParametersT()
+    raw_quant.scale = [ACCEL_LSB] * 3 + [GYRO_LSB] * 3
+    raw_quant.zeroPoint = [0] * 6
+    raw_quant.quantizedDimension = 2
+    raw_index = add_tensor("imu_raw", schema_fb.TensorType.INT16, shape, raw_quant)
+    count_index = add_tensor("new_samples", schema_fb.TensorType.INT32, [1])
+
+    op_code = schema_fb.OperatorCodeT()
+    op_code.builtinCode = schema_fb.BuiltinOperator.CUSTOM
+    op_code.deprecatedBuiltinCode = schema_fb.BuiltinOperator.CUSTOM
+    op_code.customCode = OP_NAME
+    op_code.version = 1
+    model.operatorCodes.append(op_code)
+
+    op = schema_fb.OperatorT()
+    op.opcodeIndex = len(model.operatorCodes) - 1
+    op.inputs = [raw_index, count_index]
+    op.outputs = [subgraph.inputs[0]]
+    op.customOptions = list(flexbuffers.Dumps({"mean": [float(v) for v in mean],
+                                               "std": [float(v) for v in std]}))
+    op.customOptionsFormat = schema_fb.CustomOptionsFormat.FLEXBUFFERS
+    subgraph.operators.insert(0, op)
+    subgraph.inputs = [raw_index, count_index]
+
+    # Signature defs still point at the old input; TFLM does not use them
+    model.signatureDefs = []
+    return model
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Add the GAINS_IMU_FILTER op to a pushup model")
+    parser.add_argument("model", help="quantized .tflite from the training notebook")
+    parser.add_argument("--metadata", required=True,
+                        help="pushup_model_metadata.json with the normalization mean/std")
+    parser.add_argument("-o", "--output", required=True, help="output .tflite")
+    args = parser.parse_args()
+
+    with open(args.metadata, "r") as f:
+        metadata = json.load(f)
+    model = flatbuffer_utils.read_model(args.model)
+    add_filter_op(model, metadata["mean"], metadata["std"])
+    flatbuffer_utils.write_model(model, args.output)
+    print(f"Wrote {args.output} with {OP_NAME} (input: raw int16 window + new sample count)")
+    print("Convert with: xxd -i", args.output)
+
+
+if __name__ == "__main__":
+    main()
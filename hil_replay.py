@@ -0,0 +1,236 @@
+"""
+Hardware-in-the-loop replay for the GAINS pushup firmware.
+
+Streams recorded raw IMU sessions to the device over test_over_serial (the
+firmware's "imu-accel-gyro-f32" data type) in place of the live IMU, collects
+one "!RESULT" line per window and reports on-device accuracy and latency.
+
+Input is either session JSON with raw samples (dataset_raw/*.json) or a
+.gimu file exported from them (host/dataset/export_imu_dataset.py).
+
+Usage:
+    python hil_replay.py --port /dev/ttyACM0 dataset_raw/*.json --csv hil_results.csv
+    python hil_replay.py --port /dev/ttyACM0 raw.gimu --line-mode   # base64 !DATA path
+"""
+
+import argparse
+import base64
+import csv
+import json
+import struct
+import sys
+import time
+from array import array
+
+try:
+    import serial
+except ImportError:
+    print("ERROR: pyserial not found. Install with: pip install pyserial")
+    sys.exit(1)
+
+POSTURE_LABELS = ["good-form", "hips-high", "hips-sagging", "partial-rom"]
+DATA_TYPE = "imu-accel-gyro-f32"
+CHANNELS = ("ax", "ay", "az", "gx", "gy", "gz")
+SAMPLE_BYTES = 6 * 4
+
+
+# ============================================================================
+# SESSION LOADING
+# ============================================================================
+
+def load_json_sessions(path):
+    with open(path, "r") as f:
+        raw = json.load(f)
+    for session in raw["sessions"]:
+        data = session.get("data", [])
+        if data:
+            label = session.get("posture_label", "")
+            yield label, [[float(d[c]) for c in CHANNELS] for d in data]
+
+
+def load_gimu_sessions(path):
+    with open(path, "rb") as f:
+        blob = f.read()
+    (magic, _version, _rate, channels, num_sessions, num_labels, _num_participants,
+     _flags, index_offset, _total) = struct.unpack_from("<4sIIIIIIIQQ", blob, 0)
+    if magic != b"GIMU" or channels != 6:
+        sys.exit(f"ERROR: {path} is not a 6-channel .gimu file")
+    names_offset = index_offset + num_sessions * 32
+    labels = [blob[names_offset + i * 32:names_offset + (i + 1) * 32].split(b"\0")[0].decode()
+              for i in range(num_labels)]
+    for i in range(num_sessions):
+        data_offset, count, label, _p, _src, _fl, _r = struct.unpack_from(
+            "<QIHHIIQ", blob, index_offset + i * 32)
+        columns = array("f")
+        columns.frombytes(blob[data_offset:data_offset + count * SAMPLE_BYTES])
+        yield labels[label], [[columns[ch * count + t] for ch in range(6)] for t in range(count)]
+
+
+def load_sessions(paths):
+    for path in paths:
+        loader = load_gimu_sessions if path.endswith(".gimu") else load_json_sessions
+        for label, samples in loader(path):
+            yield path, label, samples
+
+
+# ============================================================================
+# SERIAL PROTOCOL
+# ============================================================================
+
+class HilDevice:
+    def __init__(self, port, baud, verbose=False):
+        self.ser = serial.Serial(port, baud, timeout=0.1)
+        self.verbose = verbose
+
+    def send_line(self, line):
+        self.ser.write((line + "\n").encode("ascii"))
+
+    def read_line(self, timeout):
+        deadline = time.time() + timeout
+        buf = b""
+        while time.time() < deadline:
+            chunk = self.ser.readline()
+            if not chunk:
+                continue
+            buf += chunk
+            if buf.endswith(b"\n"):
+                line = buf.decode("utf-8", errors="replace").strip()
+                if self.verbose:
+                    print("  <", line)
+                return line
+        return None
+
+    def wait_for(self, prefix, timeout, results=None):
+        """Read lines until one starts with prefix; collect !RESULT lines on the way."""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            line = self.read_line(deadline - time.time())
+            if line is None:
+                break
+            if line.startswith("!RESULT") and results is not None:
+                results.append(parse_result(line))
+            elif line.startswith("!FAIL"):
+                raise RuntimeError(f"device reported {line}")
+            elif line.startswith(prefix):
+                return line
+        raise TimeoutError(f"timed out waiting for {prefix}")
+
+    def enter_test_mode(self):
+        self.ser.reset_input_buffer()
+        for _ in range(5):
+            self.send_line("!TEST")
+            try:
+                return int(self.wait_for("!OK TEST", 2.0).split()[-1])
+            except TimeoutError:
+                continue
+        raise TimeoutError("device did not answer !TEST")
+
+    def send_bulk(self, payload, timeout):
+        results = []
+        self.send_line(f"!BULK {DATA_TYPE} {len(payload)}")
+        self.wait_for("!OK BULK", 2.0)
+        self.ser.write(payload)
+        self.wait_for("!OK BULK", timeout, results)
+        return results
+
+    def send_lines(self, payload, max_line_bytes, timeout):
+        # Legacy path: base64 lines, one !DATA_ACK per line
+        results = []
+        self.send_line(f"!DATA {DATA_TYPE} {len(payload)}")
+        step = max_line_bytes - (max_line_bytes % SAMPLE_BYTES) or max_line_bytes
+        for offset in range(0, len(payload), step):
+            chunk = payload[offset:offset + step]
+            self.send_line(base64.b64encode(chunk).decode("ascii"))
+            if offset + step < len(payload):
+                self.wait_for("!DATA_ACK", 2.0, results)
+        self.wait_for("!OK DATA", timeout, results)
+        return results
+
+
+def parse_result(line):
+    fields = line.split()
+    return {
+        "sample": int(fields[1]),
+        "predicted": int(fields[2]),
+        "invoke_us": int(fields[3]),
+        "probs": [float(v) for v in fields[4:8]],
+    }
+
+
+def percentile(values, pct):
+    if not values:
+        return 0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+# ============================================================================
+# MAIN
+# ============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay recorded IMU sessions through the device")
+    parser.add_argument("inputs", nargs="+", help="raw session JSON files or .gimu files")
+    parser.add_argument("--port", required=True, help="serial port of the device")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--line-mode", action="store_true",
+                        help="use base64 !DATA lines with per-line acks instead of !BULK")
+    parser.add_argument("--limit", type=int, default=0, help="stop after N sessions")
+    parser.add_argument("--csv", default=None, help="write per-window results to this file")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    device = HilDevice(args.port, args.baud, args.verbose)
+    max_line_bytes = device.enter_test_mode()
+    print(f"Device in test mode (max {max_line_bytes} bytes per base64 line)")
+
+    rows = []
+    start = time.time()
+    sample_total = 0
+    for session_index, (path, label, samples) in enumerate(load_sessions(args.inputs)):
+        if args.limit and session_index >= args.limit:
+            break
+        payload = b"".join(struct.pack("<6f", *s) for s in samples)
+        timeout = 5.0 + len(samples) * 0.05
+        if args.line_mode:
+            results = device.send_lines(payload, max_line_bytes, timeout)
+        else:
+            results = device.send_bulk(payload, timeout)
+        sample_total += len(samples)
+
+        expected = POSTURE_LABELS.index(label) if label in POSTURE_LABELS else -1
+        for r in results:
+            rows.append({"file": path, "session": session_index, "label": label,
+                         "expected": expected, **r})
+        correct = sum(1 for r in results if r["predicted"] == expected)
+        print(f"[{session_index:4d}] {label:12s} {len(samples):4d} samples "
+              f"{len(results):3d} windows {correct:3d} correct")
+
+    elapsed = time.time() - start
+    latencies = [r["invoke_us"] for r in rows]
+    labelled = [r for r in rows if r["expected"] >= 0]
+    correct = sum(1 for r in labelled if r["predicted"] == r["expected"])
+
+    print("\n========== HIL SUMMARY ==========")
+    print(f"Windows:   {len(rows)} ({sample_total} samples in {elapsed:.1f} s, "
+          f"{sample_total / max(elapsed, 1e-9):.0f} samples/s)")
+    if labelled:
+        print(f"Accuracy:  {100.0 * correct / len(labelled):.1f}% ({correct}/{len(labelled)})")
+    print(f"Invoke us: p50={percentile(latencies, 50)} p95={percentile(latencies, 95)} "
+          f"max={max(latencies) if latencies else 0}")
+    print("=================================")
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["file", "session", "label", "sample", "predicted", "invoke_us",
+                             *POSTURE_LABELS])
+            for r in rows:
+                writer.writerow([r["file"], r["session"], r["label"], r["sample"],
+                                 r["predicted"], r["invoke_us"], *r["probs"]])
+        print(f"Per-window results written to {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
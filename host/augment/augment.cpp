@@ -0,0 +1,466 @@
+#include "augment.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+// How many source sessions workers may run ahead of the writer. Bounds the
+// memory held by finished-but-unwritten sessions.
+constexpr int kReorderWindowPerThread = 4;
+
+uint64_t SplitMix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline uint32_t Rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// Rotate accel and gyro triplets by the same 3x3 matrix
+void ApplyRotation(ImuSeries* series, const float r[3][3]) {
+    const int n = series->length();
+    for (int group = 0; group < 2; group++) {
+        float* x = series->columns[group * 3 + 0].data();
+        float* y = series->columns[group * 3 + 1].data();
+        float* z = series->columns[group * 3 + 2].data();
+        for (int t = 0; t < n; t++) {
+            const float vx = x[t], vy = y[t], vz = z[t];
+            x[t] = r[0][0] * vx + r[0][1] * vy + r[0][2] * vz;
+            y[t] = r[1][0] * vx + r[1][1] * vy + r[1][2] * vz;
+            z[t] = r[2][0] * vx + r[2][1] * vy + r[2][2] * vz;
+        }
+    }
+}
+
+void QuaternionToMatrix(float qw, float qx, float qy, float qz, float r[3][3]) {
+    r[0][0] = 1 - 2 * (qy * qy + qz * qz);
+    r[0][1] = 2 * (qx * qy - qz * qw);
+    r[0][2] = 2 * (qx * qz + qy * qw);
+    r[1][0] = 2 * (qx * qy + qz * qw);
+    r[1][1] = 1 - 2 * (qx * qx + qz * qz);
+    r[1][2] = 2 * (qy * qz - qx * qw);
+    r[2][0] = 2 * (qx * qz - qy * qw);
+    r[2][1] = 2 * (qy * qz + qx * qw);
+    r[2][2] = 1 - 2 * (qx * qx + qy * qy);
+}
+
+// Catmull-Rom interpolation through evenly spaced knots
+float InterpolateKnots(const float* knots, int count, float pos) {
+    if (count == 1) return knots[0];
+    int i = static_cast<int>(pos);
+    if (i >= count - 1) i = count - 2;
+    const float u = pos - i;
+    const float p0 = knots[i > 0 ? i - 1 : 0];
+    const float p1 = knots[i];
+    const float p2 = knots[i + 1];
+    const float p3 = knots[i + 2 < count ? i + 2 : count - 1];
+    return 0.5f * ((2 * p1) + (-p0 + p2) * u + (2 * p0 - 5 * p1 + 4 * p2 - p3) * u * u +
+                   (-p0 + 3 * p1 - 3 * p2 + p3) * u * u * u);
+}
+
+int CountWindows(int length, int window, int stride) {
+    if (length < window || stride <= 0) return 0;
+    return (length - window) / stride + 1;
+}
+
+}  // namespace
+
+// ============================================================================
+// RANDOM NUMBERS
+// ============================================================================
+
+AugmentRng::AugmentRng(uint64_t seed) : has_spare_(false), spare_(0.0f) {
+    uint64_t state = seed;
+    const uint64_t a = SplitMix64(&state);
+    const uint64_t b = SplitMix64(&state);
+    s_[0] = static_cast<uint32_t>(a);
+    s_[1] = static_cast<uint32_t>(a >> 32);
+    s_[2] = static_cast<uint32_t>(b);
+    s_[3] = static_cast<uint32_t>(b >> 32);
+}
+
+uint32_t AugmentRng::NextU32() {
+    // xoshiro128+
+    const uint32_t result = s_[0] + s_[3];
+    const uint32_t t = s_[1] << 9;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 11);
+    return result;
+}
+
+float AugmentRng::Uniform() {
+    return (NextU32() >> 8) * (1.0f / 16777216.0f);
+}
+
+float AugmentRng::Uniform(float lo, float hi) {
+    return lo + (hi - lo) * Uniform();
+}
+
+int AugmentRng::UniformInt(int n) {
+    if (n <= 1) return 0;
+    return static_cast<int>((static_cast<uint64_t>(NextU32()) * static_cast<uint64_t>(n)) >> 32);
+}
+
+float AugmentRng::Normal(float mean, float sigma) {
+    // Box-Muller, caching the second value
+    if (has_spare_) {
+        has_spare_ = false;
+        return mean + sigma * spare_;
+    }
+    float u1 = Uniform();
+    if (u1 < 1e-7f) u1 = 1e-7f;
+    const float u2 = Uniform();
+    const float radius = sqrtf(-2.0f * logf(u1));
+    spare_ = radius * sinf(2.0f * kPi * u2);
+    has_spare_ = true;
+    return mean + sigma * radius * cosf(2.0f * kPi * u2);
+}
+
+uint64_t AugmentSeed(uint64_t seed, uint32_t session, uint32_t copy) {
+    uint64_t state = seed ^ (static_cast<uint64_t>(session) << 32 | copy);
+    SplitMix64(&state);
+    return SplitMix64(&state);
+}
+
+// ============================================================================
+// OPERATIONS
+// ============================================================================
+
+const char* AugmentOpName(int op) {
+    switch (op) {
+        case kAugmentJitter: return "jitter";
+        case kAugmentScaling: return "scaling";
+        case kAugmentRotate: return "rotate";
+        case kAugmentMagnitudeWarp: return "magnitude-warp";
+        case kAugmentTimeMask: return "time-mask";
+        case kAugmentTimeWarp: return "time-warp";
+        case kAugmentMix: return "mix";
+        default: return "unknown";
+    }
+}
+
+void AugmentJitter(ImuSeries* series, AugmentRng* rng, float sigma) {
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        for (float& v : series->columns[ch]) {
+            v += rng->Normal(0.0f, sigma);
+        }
+    }
+}
+
+void AugmentScaling(ImuSeries* series, AugmentRng* rng, float sigma) {
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        const float factor = rng->Normal(1.0f, sigma);
+        for (float& v : series->columns[ch]) {
+            v *= factor;
+        }
+    }
+}
+
+void AugmentRotate(ImuSeries* series, AugmentRng* rng, float max_deg) {
+    float r[3][3];
+    if (max_deg >= 180.0f) {
+        // Uniformly random orientation (Shoemake), as in the notebook
+        const float theta = rng->Uniform(0.0f, 2.0f * kPi);
+        const float phi = rng->Uniform(0.0f, 2.0f * kPi);
+        const float z = rng->Uniform();
+        QuaternionToMatrix(sqrtf(1 - z) * sinf(theta), sqrtf(1 - z) * cosf(theta),
+                           sqrtf(z) * sinf(phi), sqrtf(z) * cosf(phi), r);
+    } else {
+        // Random axis, bounded angle: models small sensor placement changes
+        const float uz = rng->Uniform(-1.0f, 1.0f);
+        const float az = rng->Uniform(0.0f, 2.0f * kPi);
+        const float s = sqrtf(1.0f - uz * uz);
+        const float angle = rng->Uniform(-max_deg, max_deg) * kPi / 180.0f;
+        const float h = sinf(angle * 0.5f);
+        QuaternionToMatrix(cosf(angle * 0.5f), s * cosf(az) * h, s * sinf(az) * h, uz * h, r);
+    }
+    ApplyRotation(series, r);
+}
+
+void AugmentMagnitudeWarp(ImuSeries* series, AugmentRng* rng, float sigma, int knots) {
+    if (knots < 2) knots = 2;
+    if (knots > 16) knots = 16;
+    float knot_values[16];
+    for (int k = 0; k < knots; k++) {
+        knot_values[k] = rng->Normal(1.0f, sigma);
+    }
+
+    const int n = series->length();
+    const float step = (n > 1) ? static_cast<float>(knots - 1) / (n - 1) : 0.0f;
+    std::vector<float> curve(n);
+    for (int t = 0; t < n; t++) {
+        curve[t] = InterpolateKnots(knot_values, knots, t * step);
+    }
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        float* col = series->columns[ch].data();
+        for (int t = 0; t < n; t++) {
+            col[t] *= curve[t];
+        }
+    }
+}
+
+void AugmentTimeMask(ImuSeries* series, AugmentRng* rng, float ratio) {
+    const int n = series->length();
+    const int mask_len = static_cast<int>(n * ratio);
+    if (mask_len <= 0 || mask_len >= n) return;
+    const int start = rng->UniformInt(n - mask_len);
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        std::fill(series->columns[ch].begin() + start,
+                  series->columns[ch].begin() + start + mask_len, 0.0f);
+    }
+}
+
+void AugmentTimeWarp(ImuSeries* series, AugmentRng* rng, float sigma) {
+    const int n = series->length();
+    const float factor = rng->Uniform(1.0f - sigma, 1.0f + sigma);
+    const int new_len = static_cast<int>(n * factor);
+    if (n < 2 || new_len < 2) return;
+
+    // Linear resample of [0, n-1] onto new_len points (np.linspace + interp1d)
+    const float step = static_cast<float>(n - 1) / (new_len - 1);
+    ImuSeries warped;
+    warped.Resize(new_len);
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        const float* src = series->columns[ch].data();
+        float* dst = warped.columns[ch].data();
+        for (int t = 0; t < new_len; t++) {
+            const float pos = t * step;
+            int i = static_cast<int>(pos);
+            if (i >= n - 1) i = n - 2;
+            const float u = pos - i;
+            dst[t] = src[i] + (src[i + 1] - src[i]) * u;
+        }
+    }
+    *series = std::move(warped);
+}
+
+void AugmentMix(ImuSeries* series, const float* const other[kImuChannels], int other_length,
+                AugmentRng* rng, float max_weight) {
+    const int n = series->length();
+    if (other_length <= 0 || n <= 0) return;
+
+    const float weight = rng->Uniform(0.0f, max_weight);
+    const int overlap = std::min(n, other_length);
+    const int src_start = rng->UniformInt(other_length - overlap + 1);
+    const int dst_start = rng->UniformInt(n - overlap + 1);
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        float* dst = series->columns[ch].data() + dst_start;
+        const float* src = other[ch] + src_start;
+        for (int t = 0; t < overlap; t++) {
+            dst[t] = (1.0f - weight) * dst[t] + weight * src[t];
+        }
+    }
+}
+
+// ============================================================================
+// PARALLEL DRIVER
+// ============================================================================
+
+namespace {
+
+struct SessionResult {
+    std::vector<ImuSeries> copies;
+    uint64_t op_counts[kNumAugmentOps] = {};
+    bool ready = false;
+};
+
+void AugmentCopy(const ImuDataset& input, const AugmentConfig& config,
+                 const std::vector<std::vector<int>>& by_label, int session, int copy,
+                 const int* enabled_ops, int num_enabled, ImuSeries* out,
+                 uint64_t* op_counts) {
+    AugmentRng rng(AugmentSeed(config.seed, static_cast<uint32_t>(session),
+                               static_cast<uint32_t>(copy)));
+    input.ReadSeries(session, out);
+
+    for (int k = 0; k < config.ops_per_copy; k++) {
+        const int op = enabled_ops[rng.UniformInt(num_enabled)];
+        op_counts[op]++;
+        switch (op) {
+            case kAugmentJitter:
+                AugmentJitter(out, &rng, config.jitter_sigma);
+                break;
+            case kAugmentScaling:
+                AugmentScaling(out, &rng, config.scaling_sigma);
+                break;
+            case kAugmentRotate:
+                AugmentRotate(out, &rng, config.rotation_max_deg);
+                break;
+            case kAugmentMagnitudeWarp:
+                AugmentMagnitudeWarp(out, &rng, config.magnitude_warp_sigma,
+                                     config.magnitude_warp_knots);
+                break;
+            case kAugmentTimeMask:
+                AugmentTimeMask(out, &rng, config.time_mask_ratio);
+                break;
+            case kAugmentTimeWarp:
+                AugmentTimeWarp(out, &rng, config.time_warp_sigma);
+                break;
+            case kAugmentMix: {
+                const std::vector<int>& peers = by_label[input.session(session).label];
+                const int other = peers[rng.UniformInt(static_cast<int>(peers.size()))];
+                const float* columns[kImuChannels];
+                for (int ch = 0; ch < kImuChannels; ch++) {
+                    columns[ch] = input.Column(other, ch);
+                }
+                AugmentMix(out, columns, static_cast<int>(input.session(other).sample_count),
+                           &rng, config.mix_max_weight);
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+bool RunAugmentation(const ImuDataset& input, const AugmentConfig& config,
+                     ImuDatasetWriter* writer, AugmentStats* stats) {
+    const auto start_time = std::chrono::steady_clock::now();
+    const int num_sessions = input.num_sessions();
+    *stats = AugmentStats();
+    stats->sessions_in = num_sessions;
+
+    int enabled_ops[kNumAugmentOps];
+    int num_enabled = 0;
+    for (int op = 0; op < kNumAugmentOps; op++) {
+        if (config.op_mask & (1u << op)) enabled_ops[num_enabled++] = op;
+    }
+    if (num_enabled == 0 || config.ops_per_copy <= 0) {
+        fprintf(stderr, "[AUGMENT] ERROR: no augmentation ops enabled\n");
+        return false;
+    }
+
+    // Group sessions by label (mixing partners and class balancing)
+    std::vector<std::vector<int>> by_label(input.num_labels());
+    for (int i = 0; i < num_sessions; i++) {
+        by_label[input.session(i).label].push_back(i);
+    }
+
+    // Copies per source session. With a class target the remainder goes to
+    // the first sessions of each class so totals hit the target exactly.
+    std::vector<int> copies(num_sessions, config.copies_per_session);
+    if (config.copies_per_session <= 0) {
+        for (const std::vector<int>& members : by_label) {
+            const int count = static_cast<int>(members.size());
+            if (count == 0) continue;
+            const int originals = config.keep_originals ? count : 0;
+            const int needed = std::max(0, config.target_per_class - originals);
+            for (int j = 0; j < count; j++) {
+                copies[members[j]] = needed / count + (j < needed % count ? 1 : 0);
+            }
+        }
+    }
+
+    // Map labels and participants into the output tables
+    std::vector<int> label_map(input.num_labels());
+    for (int i = 0; i < input.num_labels(); i++) {
+        label_map[i] = writer->InternLabel(input.LabelName(i));
+    }
+    std::vector<int> participant_map(input.num_participants());
+    for (int i = 0; i < input.num_participants(); i++) {
+        participant_map[i] = writer->InternParticipant(input.ParticipantName(i));
+    }
+
+    int num_threads = config.threads > 0 ? config.threads
+                                         : static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads < 1) num_threads = 1;
+    const int reorder_window = num_threads * kReorderWindowPerThread;
+
+    std::vector<SessionResult> results(num_sessions);
+    std::atomic<int> next_job(0);
+    int written = 0;  // guarded by mutex
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    auto worker = [&]() {
+        while (true) {
+            const int session = next_job.fetch_add(1);
+            if (session >= num_sessions) return;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return session < written + reorder_window; });
+            }
+
+            SessionResult local;
+            local.copies.resize(copies[session]);
+            for (int c = 0; c < copies[session]; c++) {
+                AugmentCopy(input, config, by_label, session, c, enabled_ops, num_enabled,
+                            &local.copies[c], local.op_counts);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results[session] = std::move(local);
+            results[session].ready = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < num_threads; t++) {
+        pool.emplace_back(worker);
+    }
+
+    // Writer: drain results strictly in source order
+    bool ok = true;
+    ImuSeries original;
+    for (int session = 0; session < num_sessions; session++) {
+        SessionResult result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return results[session].ready; });
+            result = std::move(results[session]);
+        }
+
+        const ImuSessionRecord& rec = input.session(session);
+        const int label = label_map[rec.label];
+        const int participant = participant_map[rec.participant];
+
+        if (config.keep_originals) {
+            input.ReadSeries(session, &original);
+            ok = ok && writer->WriteSession(original, label, participant, rec.source_session,
+                                            rec.flags);
+            stats->sessions_out++;
+            stats->samples_out += original.length();
+            stats->windows_out += CountWindows(original.length(), config.window_size,
+                                               config.window_stride);
+        }
+        for (const ImuSeries& copy : result.copies) {
+            ok = ok && writer->WriteSession(copy, label, participant, rec.source_session,
+                                            rec.flags | kImuSessionAugmented);
+            stats->sessions_out++;
+            stats->samples_out += copy.length();
+            stats->windows_out += CountWindows(copy.length(), config.window_size,
+                                               config.window_stride);
+        }
+        for (int op = 0; op < kNumAugmentOps; op++) {
+            stats->op_counts[op] += result.op_counts[op];
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        written = session + 1;
+        cv.notify_all();
+    }
+
+    for (std::thread& t : pool) {
+        t.join();
+    }
+
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return ok;
+}
@@ -0,0 +1,95 @@
+#ifndef AUGMENT_H_
+#define AUGMENT_H_
+
+#include <cstdint>
+
+#include "dataset/imu_dataset.h"
+
+// Augmentation operations, same set as the data_analysis.ipynb sampler plus
+// same-label mixing across sessions.
+enum AugmentOp {
+    kAugmentJitter = 0,      // additive gaussian noise
+    kAugmentScaling,         // per-channel gain
+    kAugmentRotate,          // random 3D rotation of accel and gyro
+    kAugmentMagnitudeWarp,   // smooth gain curve over time
+    kAugmentTimeMask,        // zero a random span
+    kAugmentTimeWarp,        // resample to a random length
+    kAugmentMix,             // blend with a crop of another same-label session
+    kNumAugmentOps
+};
+
+const char* AugmentOpName(int op);
+
+struct AugmentConfig {
+    uint64_t seed = 1;
+    int threads = 0;                 // 0 = hardware concurrency
+    int copies_per_session = 0;      // fixed number of copies per source session
+    int target_per_class = 300;      // used when copies_per_session == 0
+    int ops_per_copy = 1;            // how many ops are chained per copy
+    uint32_t op_mask = (1u << kNumAugmentOps) - 1;
+    bool keep_originals = true;
+
+    // Parameters (defaults follow the notebook)
+    float jitter_sigma = 0.01f;
+    float scaling_sigma = 0.1f;
+    float rotation_max_deg = 180.0f;  // 180 = uniformly random orientation
+    float magnitude_warp_sigma = 0.2f;
+    int magnitude_warp_knots = 4;
+    float time_mask_ratio = 0.15f;
+    float time_warp_sigma = 0.2f;
+    float mix_max_weight = 0.3f;
+
+    // Window geometry used only for throughput reporting
+    int window_size = 50;
+    int window_stride = 10;
+};
+
+struct AugmentStats {
+    int sessions_in = 0;
+    int sessions_out = 0;
+    uint64_t samples_out = 0;
+    uint64_t windows_out = 0;
+    uint64_t op_counts[kNumAugmentOps] = {};
+    double seconds = 0.0;
+};
+
+// Small deterministic generator (splitmix64 seeded xoshiro128+), identical on
+// every platform so a seed always reproduces the same dataset.
+class AugmentRng {
+public:
+    explicit AugmentRng(uint64_t seed);
+
+    uint32_t NextU32();
+    float Uniform();                     // [0, 1)
+    float Uniform(float lo, float hi);
+    int UniformInt(int n);               // [0, n)
+    float Normal(float mean, float sigma);
+
+private:
+    uint32_t s_[4];
+    bool has_spare_;
+    float spare_;
+};
+
+// Derive the generator seed for one augmented copy. Depends only on the
+// run seed and the (session, copy) position, never on thread scheduling.
+uint64_t AugmentSeed(uint64_t seed, uint32_t session, uint32_t copy);
+
+// Single-session operations. Each reads and writes *series in place
+// (time warp changes its length).
+void AugmentJitter(ImuSeries* series, AugmentRng* rng, float sigma);
+void AugmentScaling(ImuSeries* series, AugmentRng* rng, float sigma);
+void AugmentRotate(ImuSeries* series, AugmentRng* rng, float max_deg);
+void AugmentMagnitudeWarp(ImuSeries* series, AugmentRng* rng, float sigma, int knots);
+void AugmentTimeMask(ImuSeries* series, AugmentRng* rng, float ratio);
+void AugmentTimeWarp(ImuSeries* series, AugmentRng* rng, float sigma);
+void AugmentMix(ImuSeries* series, const float* const other[kImuChannels], int other_length,
+                AugmentRng* rng, float max_weight);
+
+// Parallel, deterministic augmentation of a whole dataset. Source sessions
+// are processed by a worker pool and written to `writer` in source order, so
+// output is byte-identical for a given seed regardless of the thread count.
+bool RunAugmentation(const ImuDataset& input, const AugmentConfig& config,
+                     ImuDatasetWriter* writer, AugmentStats* stats);
+
+#endif  // AUGMENT_H_
@@ -0,0 +1,127 @@
+/* GAINS host data augmentation
+ * Reads a .gimu dataset (see host/dataset/export_imu_dataset.py), generates
+ * augmented sessions in parallel and streams them into a new .gimu file.
+ *
+ *   host_augment --in merged.gimu --out augmented.gimu --seed 7 --target-per-class 3000
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "augment.h"
+#include "dataset/imu_dataset.h"
+
+namespace {
+
+void PrintUsage() {
+    printf("Usage: host_augment --in FILE.gimu --out FILE.gimu [options]\n");
+    printf("  --seed N              run seed (default 1)\n");
+    printf("  --threads N           worker threads (default: all cores)\n");
+    printf("  --copies N            augmented copies per source session\n");
+    printf("  --target-per-class N  balance every class to N sessions (default 300)\n");
+    printf("  --ops LIST            comma separated subset of:\n");
+    printf("                        jitter,scaling,rotate,magnitude-warp,time-mask,time-warp,mix\n");
+    printf("  --ops-per-copy N      ops chained per copy (default 1)\n");
+    printf("  --rotation-deg F      max rotation angle, 180 = any orientation (default 180)\n");
+    printf("  --mix-weight F        max blend weight for mix (default 0.3)\n");
+    printf("  --no-originals        do not copy source sessions to the output\n");
+}
+
+bool ParseOps(const char* list, uint32_t* mask) {
+    *mask = 0;
+    std::string s(list);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t end = s.find(',', pos);
+        if (end == std::string::npos) end = s.size();
+        const std::string name = s.substr(pos, end - pos);
+        bool found = false;
+        for (int op = 0; op < kNumAugmentOps; op++) {
+            if (name == AugmentOpName(op)) {
+                *mask |= 1u << op;
+                found = true;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown op '%s'\n", name.c_str());
+            return false;
+        }
+        pos = end + 1;
+    }
+    return *mask != 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* in_path = nullptr;
+    const char* out_path = nullptr;
+    AugmentConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--in") == 0 && value) {
+            in_path = argv[++i];
+        } else if (strcmp(arg, "--out") == 0 && value) {
+            out_path = argv[++i];
+        } else if (strcmp(arg, "--seed") == 0 && value) {
+            config.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--threads") == 0 && value) {
+            config.threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--copies") == 0 && value) {
+            config.copies_per_session = atoi(argv[++i]);
+        } else if (strcmp(arg, "--target-per-class") == 0 && value) {
+            config.target_per_class = atoi(argv[++i]);
+        } else if (strcmp(arg, "--ops") == 0 && value) {
+            if (!ParseOps(argv[++i], &config.op_mask)) return 1;
+        } else if (strcmp(arg, "--ops-per-copy") == 0 && value) {
+            config.ops_per_copy = atoi(argv[++i]);
+        } else if (strcmp(arg, "--rotation-deg") == 0 && value) {
+            config.rotation_max_deg = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--mix-weight") == 0 && value) {
+            config.mix_max_weight = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--no-originals") == 0) {
+            config.keep_originals = false;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (in_path == nullptr || out_path == nullptr) {
+        PrintUsage();
+        return 1;
+    }
+
+    ImuDataset input;
+    if (!input.Open(in_path)) return 1;
+    printf("[AUGMENT] %s: %d sessions, %d labels, %llu samples\n", in_path,
+           input.num_sessions(), input.num_labels(),
+           static_cast<unsigned long long>(input.header().total_samples));
+
+    ImuDatasetWriter writer;
+    if (!writer.Open(out_path, input.header().sample_rate_hz, input.header().flags)) return 1;
+
+    AugmentStats stats;
+    bool ok = RunAugmentation(input, config, &writer, &stats);
+    ok = writer.Close() && ok;
+    if (!ok) {
+        fprintf(stderr, "[AUGMENT] ERROR: augmentation failed\n");
+        return 1;
+    }
+
+    printf("[AUGMENT] Wrote %s: %d sessions, %llu samples, %llu windows (%d/%d)\n", out_path,
+           stats.sessions_out, static_cast<unsigned long long>(stats.samples_out),
+           static_cast<unsigned long long>(stats.windows_out), config.window_size,
+           config.window_stride);
+    for (int op = 0; op < kNumAugmentOps; op++) {
+        if (stats.op_counts[op] > 0) {
+            printf("  %-15s %llu\n", AugmentOpName(op),
+                   static_cast<unsigned long long>(stats.op_counts[op]));
+        }
+    }
+    printf("[AUGMENT] %.3f s, %.0f windows/s, %.0f sessions/s\n", stats.seconds,
+           stats.windows_out / stats.seconds, stats.sessions_out / stats.seconds);
+    return 0;
+}
@@ -0,0 +1,197 @@
+/* GAINS kernel autotuner
+ * Times every CONV_2D, DEPTHWISE_CONV_2D and FULLY_CONNECTED node of the
+ * pushup model (after graph fusion, as the firmware runs it) and of the magic
+ * wand model with each kernel variant (include/kernel_autotune.h), keeps the
+ * fastest variant whose outputs are bit-identical to the reference kernels
+ * and prints the per-node timings. --out writes the pushup table as the
+ * header the firmware includes (include/kernel_variants.h).
+ *
+ * Timings are host timings; for a table that reflects the ESP32, set
+ * ENABLE_KERNEL_AUTOTUNE in src/main.cpp and paste the header it prints.
+ *
+ *   host_autotune --repeat 16 --out include/kernel_variants.h
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "fused_ops.h"
+#include "graph_fusion.h"
+#include "kernel_autotune.h"
+#include "magic_wand_model_data.h"
+#include "pushup_model_data.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 128 * 1024;
+
+void PrintUsage() {
+    printf("Usage: host_autotune [options]\n");
+    printf("  --repeat N       inputs timed per variant (1-%d, default 8)\n",
+           KERNEL_AUTOTUNE_MAX_REPEAT);
+    printf("  --out FILE       write the pushup table as a C++ header\n");
+    printf("  --no-fusion      tune the pushup model as flashed (27 ops)\n");
+}
+
+void PrintReport(const char* name, const KernelTuneReport& report) {
+    printf("[TUNE] %s: %d tuned nodes, %d inputs per variant (ticks = us)\n", name,
+           report.node_count, report.repeat);
+    printf("%5s %-18s", "node", "op");
+    for (int v = 1; v < tflite::kKernelVariantCount; v++) {
+        printf(" %14s", tflite::KernelVariantName(static_cast<tflite::KernelVariant>(v)));
+    }
+    printf("  %-14s %s\n", "default", "best");
+    for (int i = 0; i < report.node_count; i++) {
+        const KernelTuneNode& node = report.nodes[i];
+        printf("%5d %-18s", node.node_index,
+               tflite::EnumNameBuiltinOperator(
+                   static_cast<tflite::BuiltinOperator>(node.builtin_code)));
+        for (int v = 1; v < tflite::kKernelVariantCount; v++) {
+            if (node.ticks[v] == 0) {
+                printf(" %14s", "-");
+            } else {
+                printf(" %13u%c", static_cast<unsigned>(node.ticks[v]), node.exact[v] ? ' ' : '!');
+            }
+        }
+        printf("  %-14s %s\n",
+               tflite::KernelVariantName(static_cast<tflite::KernelVariant>(node.default_variant)),
+               tflite::KernelVariantName(static_cast<tflite::KernelVariant>(node.best_variant)));
+    }
+    const uint32_t saved = report.default_ticks - report.best_ticks;
+    printf("[TUNE] %s: tuned nodes %u -> %u us (%.1f%% faster), ! = output differs\n\n", name,
+           static_cast<unsigned>(report.default_ticks), static_cast<unsigned>(report.best_ticks),
+           report.default_ticks ? 100.0 * saved / report.default_ticks : 0.0);
+}
+
+// Allocates the model with and without the table and compares the outputs
+// on fresh random inputs, the check the tuner did per node
+bool TableKeepsOutputs(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+                       const KernelTuneReport& report) {
+    tflite::KernelVariantEntry entries[KERNEL_AUTOTUNE_MAX_NODES];
+    const tflite::KernelVariantTable table = {
+        entries, KernelVariantTableFromReport(report, entries, KERNEL_AUTOTUNE_MAX_NODES),
+        nullptr, 0};
+    std::vector<uint8_t> arena_a(kArenaSize), arena_b(kArenaSize);
+    tflite::MicroInterpreter plain(model, resolver, arena_a.data(), arena_a.size());
+    tflite::MicroInterpreter tuned(model, resolver, arena_b.data(), arena_b.size());
+    if (plain.AllocateTensors() != kTfLiteOk) return false;
+    tflite::SetKernelVariantTable(&table);
+    const TfLiteStatus status = tuned.AllocateTensors();
+    tflite::SetKernelVariantTable(nullptr);
+    if (status != kTfLiteOk) return false;
+
+    uint32_t state = 777;
+    for (int n = 0; n < 32; n++) {
+        for (size_t i = 0; i < plain.inputs_size(); i++) {
+            TfLiteTensor* input = plain.input(i);
+            for (size_t k = 0; k < input->bytes; k++) {
+                state = state * 1664525u + 1013904223u;
+                input->data.uint8[k] = static_cast<uint8_t>(state >> 24);
+            }
+            if (input->type == kTfLiteFloat32) {
+                for (size_t k = 0; k < input->bytes / sizeof(float); k++) {
+                    state = state * 1664525u + 1013904223u;
+                    input->data.f[k] = (state >> 8) / 8388608.0f - 1.0f;
+                }
+            }
+            memcpy(tuned.input(i)->data.raw, input->data.raw, input->bytes);
+        }
+        if (plain.Invoke() != kTfLiteOk || tuned.Invoke() != kTfLiteOk) return false;
+        for (size_t i = 0; i < plain.outputs_size(); i++) {
+            if (memcmp(plain.output(i)->data.raw, tuned.output(i)->data.raw,
+                       plain.output(i)->bytes) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Tune(const char* name, const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+          int repeat, KernelTuneReport* report) {
+    std::vector<uint8_t> arena(kArenaSize);
+    if (!TuneKernelVariants(model, resolver, arena.data(), arena.size(), repeat, report)) {
+        fprintf(stderr, "[TUNE] ERROR: %s: tuning failed\n", name);
+        return false;
+    }
+    PrintReport(name, *report);
+    if (!TableKeepsOutputs(model, resolver, *report)) {
+        fprintf(stderr, "[TUNE] ERROR: %s: the table changes the model outputs\n", name);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int repeat = 8;
+    const char* out_path = nullptr;
+    bool fusion = true;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--repeat") == 0 && value) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(arg, "--out") == 0 && value) {
+            out_path = argv[++i];
+        } else if (strcmp(arg, "--no-fusion") == 0) {
+            fusion = false;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    tflite::AllOpsResolver resolver;
+    AddFusedOps(resolver);
+
+    const tflite::Model* pushup = tflite::GetModel(g_pushup_model_data);
+    std::vector<uint8_t> fused_data;
+    GraphFusionReport fusion_report;
+    if (fusion && FuseModel(g_pushup_model_data, &fused_data, &fusion_report)) {
+        pushup = tflite::GetModel(fused_data.data());
+    }
+    const int pushup_ops = static_cast<int>(pushup->subgraphs()->Get(0)->operators()->size());
+
+    static KernelTuneReport pushup_report;
+    static KernelTuneReport wand_report;
+    if (!Tune(fused_data.empty() ? "pushup" : "pushup (fused)", pushup, resolver, repeat,
+              &pushup_report) ||
+        !Tune("magic_wand", tflite::GetModel(g_magic_wand_model_data), resolver, repeat,
+              &wand_report)) {
+        return 1;
+    }
+
+    if (out_path) {
+        static char header[8192];
+        const size_t length = FormatKernelVariantHeader(pushup_report, pushup_ops,
+                                                        "kPushupKernelVariants", "the host",
+                                                        header, sizeof(header));
+        if (length >= sizeof(header)) {
+            fprintf(stderr, "[TUNE] ERROR: header too long\n");
+            return 1;
+        }
+        FILE* f = fopen(out_path, "w");
+        if (!f) {
+            fprintf(stderr, "[TUNE] ERROR: cannot write %s\n", out_path);
+            return 1;
+        }
+        fprintf(f,
+                "#ifndef KERNEL_VARIANTS_H_\n#define KERNEL_VARIANTS_H_\n\n"
+                "#include \"tensorflow/lite/micro/kernels/kernel_variant.h\"\n\n"
+                "// Kernel variant per node of the %s pushup model, applied in setup()\n"
+                "// when the operator count matches. Regenerate after retraining:\n"
+                "//   host_autotune --out include/kernel_variants.h\n"
+                "// or, for device timings, from the ENABLE_KERNEL_AUTOTUNE boot log.\n",
+                fused_data.empty() ? "flashed" : "fused");
+        fputs(header, f);
+        fprintf(f, "\n#endif  // KERNEL_VARIANTS_H_\n");
+        fclose(f);
+        printf("[TUNE] Wrote %s (%d entries)\n", out_path, pushup_report.node_count);
+    }
+    return 0;
+}
@@ -0,0 +1,348 @@
+#include "bench/bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// ALLOCATION COUNTER
+// ============================================================================
+
+namespace {
+std::atomic<uint64_t> g_alloc_count(0);
+std::atomic<uint64_t> g_alloc_bytes(0);
+}  // namespace
+
+#if defined(__GLIBC__)
+#define BENCH_HAVE_ALLOC_COUNTER 1
+// operator new ends up here as well
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(count * size, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    __libc_free(ptr);
+}
+}  // extern "C"
+#else
+#define BENCH_HAVE_ALLOC_COUNTER 0
+#endif
+
+// ============================================================================
+// CACHE MISS COUNTER
+// ============================================================================
+
+namespace {
+
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+
+    bool available() const { return fd_ >= 0; }
+
+    void Start() {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t Stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+double ElapsedNs(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+double Median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+}  // namespace
+
+// ============================================================================
+// RUNNER
+// ============================================================================
+
+std::vector<BenchResult> RunBenchmarks(const std::vector<Benchmark>& benchmarks,
+                                       const BenchConfig& config) {
+    std::vector<BenchResult> results;
+    CacheMissCounter cache_misses;
+    const double min_time_ns = config.min_time_ms * 1e6;
+
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!config.filter.empty() && benchmark.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        benchmark.run(1);  // Warm up caches and lazy state
+
+        // Grow the iteration count until one run takes about min_time_ms
+        uint64_t iterations = 1;
+        while (true) {
+            const auto start = std::chrono::steady_clock::now();
+            benchmark.run(iterations);
+            const double ns = ElapsedNs(start);
+            if (ns >= min_time_ns) break;
+            if (ns * 100.0 >= min_time_ns) {
+                iterations = static_cast<uint64_t>(std::ceil(iterations * min_time_ns / ns));
+                break;
+            }
+            iterations *= 10;
+        }
+
+        std::vector<double> ns_per_op;
+        std::vector<double> misses_per_op;
+        uint64_t allocs = 0;
+        uint64_t bytes = 0;
+        for (int r = 0; r < config.repetitions; r++) {
+            const uint64_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+            const uint64_t bytes_before = g_alloc_bytes.load(std::memory_order_relaxed);
+            cache_misses.Start();
+            const auto start = std::chrono::steady_clock::now();
+            benchmark.run(iterations);
+            const double ns = ElapsedNs(start);
+            const uint64_t misses = cache_misses.Stop();
+            allocs += g_alloc_count.load(std::memory_order_relaxed) - allocs_before;
+            bytes += g_alloc_bytes.load(std::memory_order_relaxed) - bytes_before;
+            ns_per_op.push_back(ns / iterations);
+            misses_per_op.push_back(static_cast<double>(misses) / iterations);
+        }
+
+        BenchResult result;
+        result.name = benchmark.name;
+        result.iterations = iterations;
+        result.repetitions = config.repetitions;
+        result.ns_per_op = Median(ns_per_op);
+        result.ns_per_op_min = *std::min_element(ns_per_op.begin(), ns_per_op.end());
+        const double total_ops = static_cast<double>(iterations) * config.repetitions;
+        if (BENCH_HAVE_ALLOC_COUNTER) {
+            result.allocs_per_op = allocs / total_ops;
+            result.bytes_per_op = bytes / total_ops;
+        }
+        if (cache_misses.available()) result.cache_misses_per_op = Median(misses_per_op);
+        results.push_back(result);
+        fprintf(stderr, "[BENCH] %-32s %12.1f ns/op\n", result.name.c_str(), result.ns_per_op);
+    }
+    return results;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+namespace {
+
+void FormatMetric(double value, const char* format, char* out, size_t size) {
+    if (value < 0) {
+        snprintf(out, size, "n/a");
+    } else {
+        snprintf(out, size, format, value);
+    }
+}
+
+void JsonMetric(FILE* f, const char* key, double value, bool last = false) {
+    if (value < 0) {
+        fprintf(f, "      \"%s\": null%s\n", key, last ? "" : ",");
+    } else {
+        fprintf(f, "      \"%s\": %.4f%s\n", key, value, last ? "" : ",");
+    }
+}
+
+// Number after "key": in text, -1 for null or a missing key
+double ParseJsonNumber(const std::string& text, const char* key) {
+    const std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = text.find(pattern);
+    if (pos == std::string::npos) return -1.0;
+    pos += pattern.size();
+    while (pos < text.size() && text[pos] == ' ') pos++;
+    if (text.compare(pos, 4, "null") == 0) return -1.0;
+    return strtod(text.c_str() + pos, nullptr);
+}
+
+}  // namespace
+
+void PrintResults(const std::vector<BenchResult>& results) {
+    printf("%-32s %12s %12s %10s %12s %12s\n", "benchmark", "ns/op", "min ns/op", "allocs/op",
+           "bytes/op", "misses/op");
+    for (const BenchResult& r : results) {
+        char allocs[32];
+        char bytes[32];
+        char misses[32];
+        FormatMetric(r.allocs_per_op, "%.2f", allocs, sizeof(allocs));
+        FormatMetric(r.bytes_per_op, "%.0f", bytes, sizeof(bytes));
+        FormatMetric(r.cache_misses_per_op, "%.2f", misses, sizeof(misses));
+        printf("%-32s %12.1f %12.1f %10s %12s %12s\n", r.name.c_str(), r.ns_per_op,
+               r.ns_per_op_min, allocs, bytes, misses);
+    }
+}
+
+bool WriteResultsJson(const std::vector<BenchResult>& results, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) {
+        fprintf(stderr, "[BENCH] ERROR: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"suite\": \"gains-host-bench\",\n  \"format\": 1,\n");
+    fprintf(f, "  \"compiler\": \"%s\",\n  \"benchmarks\": [\n", __VERSION__);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "    {\n      \"name\": \"%s\",\n", r.name.c_str());
+        fprintf(f, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(r.iterations));
+        fprintf(f, "      \"repetitions\": %d,\n", r.repetitions);
+        JsonMetric(f, "ns_per_op", r.ns_per_op);
+        JsonMetric(f, "ns_per_op_min", r.ns_per_op_min);
+        JsonMetric(f, "allocs_per_op", r.allocs_per_op);
+        JsonMetric(f, "bytes_per_op", r.bytes_per_op);
+        JsonMetric(f, "cache_misses_per_op", r.cache_misses_per_op, true);
+        fprintf(f, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+bool ReadResultsJson(const char* path, std::vector<BenchResult>* results) {
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "[BENCH] ERROR: cannot read %s\n", path);
+        return false;
+    }
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) text.append(chunk, n);
+    fclose(f);
+
+    // Only reads the layout WriteResultsJson() produces: one object per benchmark
+    results->clear();
+    size_t pos = 0;
+    const std::string name_key = "\"name\": \"";
+    while ((pos = text.find(name_key, pos)) != std::string::npos) {
+        const size_t name_start = pos + name_key.size();
+        const size_t name_end = text.find('"', name_start);
+        const size_t object_end = text.find('}', name_start);
+        if (name_end == std::string::npos || object_end == std::string::npos) break;
+        const std::string object = text.substr(name_start, object_end - name_start);
+
+        BenchResult r;
+        r.name = text.substr(name_start, name_end - name_start);
+        r.iterations = static_cast<uint64_t>(std::max(0.0, ParseJsonNumber(object, "iterations")));
+        r.repetitions = static_cast<int>(ParseJsonNumber(object, "repetitions"));
+        r.ns_per_op = ParseJsonNumber(object, "ns_per_op");
+        r.ns_per_op_min = ParseJsonNumber(object, "ns_per_op_min");
+        r.allocs_per_op = ParseJsonNumber(object, "allocs_per_op");
+        r.bytes_per_op = ParseJsonNumber(object, "bytes_per_op");
+        r.cache_misses_per_op = ParseJsonNumber(object, "cache_misses_per_op");
+        results->push_back(r);
+        pos = object_end;
+    }
+    if (results->empty()) {
+        fprintf(stderr, "[BENCH] ERROR: no benchmarks in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+int CompareResults(const std::vector<BenchResult>& baseline,
+                   const std::vector<BenchResult>& current, double threshold_pct) {
+    int regressions = 0;
+    printf("\n%-32s %12s %12s %9s %14s  %s\n", "benchmark", "base ns/op", "ns/op", "delta",
+           "allocs/op", "status");
+    for (const BenchResult& r : current) {
+        const BenchResult* base = nullptr;
+        for (const BenchResult& b : baseline) {
+            if (b.name == r.name) base = &b;
+        }
+        if (base == nullptr) {
+            printf("%-32s %12s %12.1f %9s %14s  new\n", r.name.c_str(), "-", r.ns_per_op, "-", "-");
+            continue;
+        }
+        const double delta_pct = 100.0 * (r.ns_per_op - base->ns_per_op) / base->ns_per_op;
+        const bool slower = delta_pct > threshold_pct;
+        const bool more_allocs = base->allocs_per_op >= 0 && r.allocs_per_op >= 0 &&
+                                 r.allocs_per_op > base->allocs_per_op + 1e-6;
+        char allocs[32] = "n/a";
+        if (base->allocs_per_op >= 0 && r.allocs_per_op >= 0) {
+            snprintf(allocs, sizeof(allocs), "%.2f -> %.2f", base->allocs_per_op, r.allocs_per_op);
+        }
+        const char* status = "ok";
+        if (slower || more_allocs) {
+            status = "REGRESSION";
+            regressions++;
+        } else if (delta_pct < -threshold_pct) {
+            status = "faster";
+        }
+        printf("%-32s %12.1f %12.1f %+8.1f%% %14s  %s\n", r.name.c_str(), base->ns_per_op,
+               r.ns_per_op, delta_pct, allocs, status);
+    }
+    for (const BenchResult& b : baseline) {
+        bool found = false;
+        for (const BenchResult& r : current) found = found || r.name == b.name;
+        if (!found) printf("%-32s %12.1f %12s %9s %14s  missing\n", b.name.c_str(), b.ns_per_op,
+                           "-", "-", "-");
+    }
+    return regressions;
+}
@@ -0,0 +1,66 @@
+/* Minimal benchmark runner for the GAINS host benchmark suite.
+ *
+ * Every benchmark is a function that runs its operation `iterations` times.
+ * The runner calibrates the iteration count to a minimum run time, repeats
+ * the run and reports the median ns/op. Heap allocations are counted by
+ * interposing malloc (glibc only) and cache misses come from perf_event_open
+ * (Linux, needs perf_event_paranoid <= 2); both are reported as unavailable
+ * otherwise.
+ */
+#ifndef HOST_BENCH_BENCH_H_
+#define HOST_BENCH_BENCH_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct Benchmark {
+    std::string name;
+    std::function<void(uint64_t iterations)> run;
+};
+
+struct BenchConfig {
+    double min_time_ms = 200.0;  // Per repetition
+    int repetitions = 5;
+    std::string filter;          // Substring of the benchmark name, empty = all
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;     // Per repetition
+    int repetitions = 0;
+    double ns_per_op = 0.0;      // Median over repetitions
+    double ns_per_op_min = 0.0;
+    double allocs_per_op = -1.0; // -1 = not available
+    double bytes_per_op = -1.0;
+    double cache_misses_per_op = -1.0;
+};
+
+// Keep the compiler from optimizing away a result or a store
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+std::vector<BenchResult> RunBenchmarks(const std::vector<Benchmark>& benchmarks,
+                                       const BenchConfig& config);
+
+void PrintResults(const std::vector<BenchResult>& results);
+
+bool WriteResultsJson(const std::vector<BenchResult>& results, const char* path);
+
+// Results of an earlier WriteResultsJson() run (name and metrics only)
+bool ReadResultsJson(const char* path, std::vector<BenchResult>* results);
+
+// Prints current vs baseline. A benchmark regresses when its ns/op grew by
+// more than threshold_pct or it allocates more per op than before. Returns
+// the number of regressions.
+int CompareResults(const std::vector<BenchResult>& baseline,
+                   const std::vector<BenchResult>& current, double threshold_pct);
+
+#endif  // HOST_BENCH_BENCH_H_
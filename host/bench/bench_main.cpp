@@ -0,0 +1,876 @@
+/* GAINS host benchmark suite
+ * Hot paths of the pushup firmware and the magic wand, built from the
+ * firmware sources. Results go to stdout and optionally to JSON; with
+ * --baseline the run is compared against a saved JSON and the exit code is 2
+ * if anything regressed.
+ *
+ *   host_bench --json bench.json
+ *   host_bench --baseline bench.json --threshold 10
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "batch_model.h"
+#include "bench/bench.h"
+#include "driver/i2c.h"
+#include "fused_ops.h"
+#include "graph_fusion.h"
+#include "layer_pipeline.h"
+#include "magic_wand_model_data.h"
+#include "metrics.h"
+#include "model_config.h"
+#include "font8x8_basic.h"
+#include "oled_display.h"
+#include "oled_screens.h"
+#include "preprocessing.h"
+#include "pushup_inference.h"
+#include "pushup_model_data.h"
+#include "rasterize_stroke.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "window_ring.h"
+
+namespace {
+
+constexpr int kSampleCount = 4096;      // Synthetic IMU stream, 102 s at 40 Hz
+constexpr int kStrokePoints = 160;      // Magic wand stroke (int8 x/y pairs)
+constexpr int kRasterSize = 32;         // Magic wand raster, 32x32x3
+constexpr int kPushupArenaSize = 120 * 1024;
+constexpr int kMagicWandArenaSize = 80 * 1024;
+constexpr int kPipelineWindows = 32;    // Distinct inputs streamed through the pipelines
+constexpr int kPipelineSlotBytes = 64 * 1024;
+constexpr int kBatchSizes[] = {1, 8, 32};  // Batched Invoke() throughput
+
+// Deterministic pushup-like motion: 1 Hz reps on gravity plus noise
+void GenerateSamples(float samples[][NUM_CHANNELS], int count) {
+    uint32_t state = 12345;
+    for (int t = 0; t < count; t++) {
+        const float phase = 2.0f * 3.14159265f * t / 40.0f;
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            state = state * 1664525u + 1013904223u;
+            const float noise = ((state >> 8) / 16777216.0f - 0.5f) * 0.02f;
+            if (ch < 3) {
+                samples[t][ch] = (ch == 2 ? 1.0f : 0.0f) + 0.3f * sinf(phase + ch) + noise;
+            } else {
+                samples[t][ch] = 40.0f * cosf(phase + ch) + noise * 100.0f;
+            }
+        }
+    }
+}
+
+// Figure eight in the int8 [-128, 127] stroke encoding of the magic wand
+void GenerateStroke(int8_t* points, int count) {
+    for (int i = 0; i < count; i++) {
+        const float a = 2.0f * 3.14159265f * i / count;
+        points[i * 2] = static_cast<int8_t>(lroundf(100.0f * sinf(a)));
+        points[i * 2 + 1] = static_cast<int8_t>(lroundf(60.0f * sinf(2.0f * a)));
+    }
+}
+
+tflite::MicroInterpreter* CreateInterpreter(const unsigned char* model_data, uint8_t* arena,
+                                            int arena_size) {
+    static tflite::AllOpsResolver resolver;
+    static bool fused_ops_added = false;
+    if (!fused_ops_added) {
+        AddFusedOps(resolver);
+        fused_ops_added = true;
+    }
+    tflite::MicroInterpreter* interpreter =
+        new tflite::MicroInterpreter(tflite::GetModel(model_data), resolver, arena, arena_size);
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+        fprintf(stderr, "[BENCH] ERROR: tensor allocation failed\n");
+        exit(1);
+    }
+    return interpreter;
+}
+
+// Run the model once with Invoke() and once one operator per InvokeStep()
+// call; the sliced run has to reproduce the output bit for bit. The input is
+// restored in between, the arena planner may reuse its buffer.
+void CheckInvokeStep(tflite::MicroInterpreter* interpreter, const char* name) {
+    const TfLiteTensor* input = interpreter->input(0);
+    std::vector<uint8_t> input_data(input->data.uint8, input->data.uint8 + input->bytes);
+    if (interpreter->Invoke() != kTfLiteOk) exit(1);
+    const TfLiteTensor* output = interpreter->output(0);
+    std::vector<uint8_t> expected(output->data.uint8, output->data.uint8 + output->bytes);
+    memset(output->data.uint8, 0, output->bytes);
+    memcpy(input->data.uint8, input_data.data(), input->bytes);
+    int slices = 0;
+    bool done = false;
+    while (!done) {
+        if (interpreter->InvokeStep(0, &done) != kTfLiteOk) exit(1);
+        slices++;
+    }
+    if (memcmp(expected.data(), output->data.uint8, output->bytes) != 0) {
+        fprintf(stderr, "[BENCH] ERROR: %s: InvokeStep() output differs from Invoke()\n", name);
+        exit(1);
+    }
+    printf("[BENCH] %s: InvokeStep() matches Invoke() over %d slices\n", name, slices);
+}
+
+// Deterministic model inputs for the pipeline check
+std::vector<std::vector<uint8_t>> GenerateInputs(const TfLiteTensor* input, int count) {
+    std::vector<std::vector<uint8_t>> inputs(count, std::vector<uint8_t>(input->bytes));
+    uint32_t state = 777;
+    for (std::vector<uint8_t>& bytes : inputs) {
+        for (uint8_t& byte : bytes) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(state >> 24);
+        }
+    }
+    return inputs;
+}
+
+// Fuse the model and run both graphs on the same inputs; the fused graph has
+// to reproduce every output bit for bit. Returns the fused interpreter.
+tflite::MicroInterpreter* CheckFusion(const char* name, const unsigned char* model_data,
+                                      std::vector<uint8_t>* fused_model,
+                                      tflite::MicroInterpreter* unfused, uint8_t* arena,
+                                      int arena_size,
+                                      const std::vector<std::vector<uint8_t>>& inputs) {
+    GraphFusionReport report;
+    if (!FuseModel(model_data, fused_model, &report)) {
+        fprintf(stderr, "[BENCH] ERROR: %s: graph fusion failed\n", name);
+        exit(1);
+    }
+    tflite::MicroInterpreter* fused = CreateInterpreter(fused_model->data(), arena, arena_size);
+    const size_t output_bytes = unfused->output(0)->bytes;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        memcpy(unfused->input(0)->data.uint8, inputs[i].data(), inputs[i].size());
+        memcpy(fused->input(0)->data.uint8, inputs[i].data(), inputs[i].size());
+        if (unfused->Invoke() != kTfLiteOk || fused->Invoke() != kTfLiteOk) exit(1);
+        if (memcmp(unfused->output(0)->data.uint8, fused->output(0)->data.uint8,
+                   output_bytes) != 0) {
+            fprintf(stderr, "[BENCH] ERROR: %s: fused output %zu differs from the unfused graph\n",
+                    name, i);
+            exit(1);
+        }
+    }
+    printf("[BENCH] %s: fusion %d -> %d ops (%d identity ops removed, %d channel affine, "
+           "%d conv+pool), %d -> %d tensors, arena %zu -> %zu bytes, matches the unfused graph "
+           "over %zu windows\n", name, report.ops_before, report.ops_after, report.identity_ops,
+           report.channel_affine, report.conv_pool, report.tensors_before, report.tensors_after,
+           unfused->arena_used_bytes(), fused->arena_used_bytes(), inputs.size());
+    return fused;
+}
+
+// Interpreter over the model rewritten for batch windows per Invoke()
+// (batch_model.h), checked against single-window invokes of the same model:
+// every window of every batch has to give the same output bytes
+struct BatchedModel {
+    int batch;
+    std::vector<uint8_t> model;
+    std::vector<uint8_t> arena;
+    tflite::MicroInterpreter* interpreter;
+    std::vector<uint8_t> inputs;  // batch windows, back to back
+};
+
+void CheckBatch(const char* name, const unsigned char* model_data,
+                tflite::MicroInterpreter* single, int arena_size, int batch,
+                const std::vector<std::vector<uint8_t>>& inputs, BatchedModel* batched) {
+    BatchModelReport report;
+    if (!BatchModel(model_data, batch, &batched->model, &report)) {
+        fprintf(stderr, "[BENCH] ERROR: %s: batch %d not supported\n", name, batch);
+        exit(1);
+    }
+    batched->batch = batch;
+    batched->arena.assign(static_cast<size_t>(arena_size) * batch, 0);
+    batched->interpreter =
+        CreateInterpreter(batched->model.data(), batched->arena.data(), arena_size * batch);
+    tflite::MicroInterpreter* interpreter = batched->interpreter;
+    const size_t input_bytes = single->input(0)->bytes;
+    const size_t output_bytes = single->output(0)->bytes;
+    if (interpreter->input(0)->bytes != input_bytes * batch ||
+        interpreter->output(0)->bytes != output_bytes * batch) {
+        fprintf(stderr, "[BENCH] ERROR: %s: batch %d tensors have the wrong size\n", name, batch);
+        exit(1);
+    }
+    for (size_t first = 0; first < inputs.size(); first += batch) {
+        for (int b = 0; b < batch; b++) {
+            const std::vector<uint8_t>& input = inputs[(first + b) % inputs.size()];
+            memcpy(interpreter->input(0)->data.uint8 + b * input_bytes, input.data(), input_bytes);
+        }
+        if (interpreter->Invoke() != kTfLiteOk) exit(1);
+        for (int b = 0; b < batch; b++) {
+            const std::vector<uint8_t>& input = inputs[(first + b) % inputs.size()];
+            memcpy(single->input(0)->data.uint8, input.data(), input_bytes);
+            if (single->Invoke() != kTfLiteOk) exit(1);
+            if (memcmp(single->output(0)->data.uint8,
+                       interpreter->output(0)->data.uint8 + b * output_bytes, output_bytes) != 0) {
+                fprintf(stderr, "[BENCH] ERROR: %s: batch %d window %zu differs from a single "
+                        "invoke\n", name, batch, first + b);
+                exit(1);
+            }
+        }
+    }
+    batched->inputs.assign(interpreter->input(0)->data.uint8,
+                           interpreter->input(0)->data.uint8 + input_bytes * batch);
+    printf("[BENCH] %s: batch %d, %d tensors resized, %d shape constants, arena %zu bytes, "
+           "matches single invokes over %zu windows\n", name, batch, report.tensors_resized,
+           report.constants_changed, interpreter->arena_used_bytes(),
+           ((inputs.size() + batch - 1) / batch) * batch);
+}
+
+// One batched Invoke() per iteration, the input copied in each time
+void StreamBatches(BatchedModel* batched, uint64_t iterations) {
+    TfLiteTensor* input = batched->interpreter->input(0);
+    for (uint64_t i = 0; i < iterations; i++) {
+        memcpy(input->data.uint8, batched->inputs.data(), batched->inputs.size());
+        if (batched->interpreter->Invoke() != kTfLiteOk) exit(1);
+    }
+}
+
+// Balance the two stages, start the pipeline and stream the inputs through
+// it; every output has to match a sequential Invoke() bit for bit
+void CheckLayerPipeline(const char* name, const unsigned char* model_data,
+                        tflite::MicroInterpreter* sequential, tflite::MicroInterpreter* front,
+                        tflite::MicroInterpreter* back, LayerPipeline* pipeline,
+                        uint8_t* slots, const std::vector<std::vector<uint8_t>>& inputs) {
+    const tflite::Model* model = tflite::GetModel(model_data);
+    uint32_t stage_us[2];
+    const size_t split = LayerPipeline::BalancedSplit(front, 10, stage_us);
+    if (!pipeline->Begin(model, front, back, split, slots, kPipelineSlotBytes)) {
+        fprintf(stderr, "[BENCH] ERROR: %s: pipeline split %zu not supported\n", name, split);
+        exit(1);
+    }
+
+    const size_t output_bytes = sequential->output(0)->bytes;
+    std::vector<std::vector<uint8_t>> expected;
+    for (const std::vector<uint8_t>& input : inputs) {
+        memcpy(sequential->input(0)->data.uint8, input.data(), input.size());
+        if (sequential->Invoke() != kTfLiteOk) exit(1);
+        const uint8_t* output = sequential->output(0)->data.uint8;
+        expected.emplace_back(output, output + output_bytes);
+    }
+    std::vector<uint8_t> actual(output_bytes);
+    uint8_t* outputs[LAYER_PIPELINE_MAX_OUTPUTS] = {actual.data()};
+    size_t popped = 0;
+    for (size_t i = 0; i <= inputs.size(); i++) {
+        if (i < inputs.size()) {
+            memcpy(front->input(0)->data.uint8, inputs[i].data(), inputs[i].size());
+            if (!pipeline->Push()) exit(1);
+        }
+        if (pipeline->Pending() == LAYER_PIPELINE_SLOTS || i == inputs.size()) {
+            while (pipeline->Pending() > (i < inputs.size() ? 1 : 0)) {
+                if (!pipeline->Pop(outputs)) exit(1);
+                if (actual != expected[popped]) {
+                    fprintf(stderr, "[BENCH] ERROR: %s: pipeline output %zu differs from Invoke()\n",
+                            name, popped);
+                    exit(1);
+                }
+                popped++;
+            }
+        }
+    }
+    printf("[BENCH] %s: pipeline split at op %zu/%zu (stage A %u us, B %u us, ideal %.2fx), "
+           "%d cut tensors, %zu slot bytes, matches Invoke() over %zu windows\n", name, split,
+           front->operators_size(), stage_us[0], stage_us[1],
+           static_cast<double>(stage_us[0] + stage_us[1]) /
+               (stage_us[0] > stage_us[1] ? stage_us[0] : stage_us[1]),
+           pipeline->CutTensorCount(), pipeline->SlotBytes(), popped);
+    if (std::thread::hardware_concurrency() < 2) {
+        printf("[BENCH] %s: one CPU, the pipelined benchmark cannot overlap the stages\n", name);
+    }
+}
+
+// One window per iteration through the pipeline; keeps both stages busy
+void StreamPipeline(LayerPipeline* pipeline, tflite::MicroInterpreter* front,
+                    const std::vector<std::vector<uint8_t>>& inputs, uint64_t iterations) {
+    uint8_t* outputs[LAYER_PIPELINE_MAX_OUTPUTS] = {};
+    for (uint64_t i = 0; i < iterations; i++) {
+        const std::vector<uint8_t>& input = inputs[i % inputs.size()];
+        memcpy(front->input(0)->data.uint8, input.data(), input.size());
+        if (!pipeline->Push()) exit(1);
+        if (pipeline->Pending() == LAYER_PIPELINE_SLOTS && !pipeline->Pop(outputs)) exit(1);
+    }
+    while (pipeline->Pending() > 0) {
+        if (!pipeline->Pop(outputs)) exit(1);
+    }
+}
+
+// Firmware screens drawn as main.cpp used to (oled_display_clear() and a
+// text call per line) and from their prerendered frames (oled_screens.h)
+struct OledScreenCase {
+    const char* name;
+    void (*text)();
+    void (*prerendered)();
+};
+
+const OledScreenCase kOledScreens[] = {
+    {"boot",
+     [] {
+         oled_display_clear();
+         oled_display_text(0, 10, "GAINS");
+     },
+     [] { RenderStaticScreen(OLED_SCREEN_BOOT); }},
+    {"idle",
+     [] {
+         oled_display_clear();
+         oled_display_text(0, 10, "GAINS");
+         oled_display_text(0, 30, "Press to start");
+     },
+     [] { RenderStaticScreen(OLED_SCREEN_IDLE); }},
+    {"imu_error",
+     [] {
+         oled_display_clear();
+         oled_display_text(0, 10, "ERROR");
+         oled_display_text(0, 30, "IMU Failed!");
+     },
+     [] { RenderStaticScreen(OLED_SCREEN_IMU_ERROR); }},
+    {"model_error",
+     [] {
+         oled_display_clear();
+         oled_display_text(0, 10, "ERROR");
+         oled_display_text(0, 30, "Model Version!");
+     },
+     [] { RenderStaticScreen(OLED_SCREEN_MODEL_ERROR); }},
+    {"arena_error",
+     [] {
+         oled_display_clear();
+         oled_display_text(0, 10, "ERROR");
+         oled_display_text(0, 30, "Tensor Alloc!");
+     },
+     [] { RenderStaticScreen(OLED_SCREEN_ARENA_ERROR); }},
+    {"recording",
+     [] {
+         char line[32];
+         oled_display_clear();
+         oled_display_text(0, 0, "GAINS");
+         oled_display_text(0, 16, "Recording...");
+         snprintf(line, sizeof(line), "%d samples", 123);
+         oled_display_text(0, 32, line);
+         snprintf(line, sizeof(line), "%d reps", 7);
+         oled_display_text(0, 48, line);
+     },
+     [] { RenderRecordingScreen(123, 7); }},
+    {"result",
+     [] {
+         char line[32];
+         oled_display_clear();
+         oled_display_text(0, 0, "GAINS");
+         oled_display_text(0, 12, "Result:");
+         oled_display_text(0, 24, posture_labels[2]);
+         snprintf(line, sizeof(line), "%.0f%% confident", 0.87f * 100);
+         oled_display_text(0, 36, line);
+         snprintf(line, sizeof(line), "(%d samples)", 14);
+         oled_display_text(0, 48, line);
+         snprintf(line, sizeof(line), "%d reps %lus TUT", 12, 21UL);
+         oled_display_text(0, 56, line);
+     },
+     [] { RenderResultScreen(posture_labels[2], 0.87f, 14, 12, 20600); }},
+    {"insufficient",
+     [] {
+         char line[32];
+         oled_display_clear();
+         oled_display_text(0, 0, "GAINS");
+         oled_display_text(0, 16, "ERROR");
+         oled_display_text(0, 32, "Need 2+ samples");
+         snprintf(line, sizeof(line), "Got: %d", 1);
+         oled_display_text(0, 48, line);
+     },
+     [] { RenderInsufficientSamplesScreen(1); }},
+};
+
+// The per-pixel draw_text() the driver had before glyphs were drawn a
+// column byte at a time
+void ReferenceDrawText(uint8_t* frame, int x, int y, const char* text) {
+    int cx = x;
+    for (const char* p = text; *p; ++p) {
+        if (*p == '\n') {
+            y += 8; cx = x; continue;
+        }
+        const unsigned char c = static_cast<unsigned char>(*p) > 127 ? '?' : *p;
+        for (int dy = 0; dy < 8; ++dy) {
+            for (int dx = 0; dx < 8; ++dx) {
+                const int px = cx + dx;
+                const int py = y + dy;
+                if (px < 0 || px >= OLED_WIDTH || py < 0 || py >= OLED_HEIGHT) continue;
+                uint8_t* cell = &frame[(py / 8) * OLED_WIDTH + px];
+                if ((font8x8_basic[c][dy] >> dx) & 0x01) {
+                    *cell |= 1u << (py % 8);
+                } else {
+                    *cell &= ~(1u << (py % 8));
+                }
+            }
+        }
+        cx += 8;
+        if (cx + 8 >= OLED_WIDTH) { y += 8; cx = x; }
+        if (y >= OLED_HEIGHT) break;
+    }
+}
+
+// Text drawing against the per-pixel reference at every row offset and
+// clipped at the edges, then every screen against its prerendered frame.
+// Both start from a dirty framebuffer, so they have to overwrite all of it.
+void CheckOledScreens() {
+    static uint8_t dirty[OLED_FRAMEBUFFER_SIZE];
+    static uint8_t expected[OLED_FRAMEBUFFER_SIZE];
+    uint32_t state = 777;
+    for (uint8_t& byte : dirty) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+
+    char charset[97];
+    for (int c = 0; c < 96; c++) charset[c] = static_cast<char>(32 + c);
+    charset[96] = '\0';
+    const int positions[][2] = {{0, 0}, {3, 5}, {0, 10}, {17, 27}, {120, 36}, {124, 60}, {5, 63}};
+    for (const auto& pos : positions) {
+        memcpy(expected, dirty, sizeof(expected));
+        ReferenceDrawText(expected, pos[0], pos[1], charset);
+        oled_display_bitmap(dirty);
+        oled_display_text(static_cast<uint8_t>(pos[0]), static_cast<uint8_t>(pos[1]), charset);
+        if (memcmp(oled_display_framebuffer(), expected, sizeof(expected)) != 0) {
+            fprintf(stderr, "[BENCH] ERROR: OLED text at (%d, %d) differs from per-pixel drawing\n",
+                    pos[0], pos[1]);
+            exit(1);
+        }
+    }
+
+    for (const OledScreenCase& screen : kOledScreens) {
+        oled_display_bitmap(dirty);
+        screen.text();
+        memcpy(expected, oled_display_framebuffer(), sizeof(expected));
+        oled_display_bitmap(dirty);
+        screen.prerendered();
+        if (memcmp(oled_display_framebuffer(), expected, sizeof(expected)) != 0) {
+            fprintf(stderr, "[BENCH] ERROR: prerendered OLED screen '%s' differs from text drawing\n",
+                    screen.name);
+            exit(1);
+        }
+    }
+    printf("[BENCH] OLED: glyph columns match per-pixel drawing, %zu prerendered screens match "
+           "text drawing\n",
+           sizeof(kOledScreens) / sizeof(kOledScreens[0]));
+}
+
+void PrintUsage() {
+    printf("Usage: host_bench [options]\n");
+    printf("  --filter TEXT       only benchmarks whose name contains TEXT\n");
+    printf("  --min-time-ms F     minimum time per repetition (default 200)\n");
+    printf("  --repetitions N     repetitions per benchmark, median is reported (default 5)\n");
+    printf("  --json FILE         write results as JSON\n");
+    printf("  --baseline FILE     compare against a JSON from an earlier run\n");
+    printf("  --threshold PCT     ns/op increase that counts as a regression (default 10)\n");
+    printf("  --list              list benchmark names\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    const char* json_path = nullptr;
+    const char* baseline_path = nullptr;
+    double threshold_pct = 10.0;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--filter") == 0 && value) {
+            config.filter = argv[++i];
+        } else if (strcmp(arg, "--min-time-ms") == 0 && value) {
+            config.min_time_ms = atof(argv[++i]);
+        } else if (strcmp(arg, "--repetitions") == 0 && value) {
+            config.repetitions = atoi(argv[++i]);
+        } else if (strcmp(arg, "--json") == 0 && value) {
+            json_path = argv[++i];
+        } else if (strcmp(arg, "--baseline") == 0 && value) {
+            baseline_path = argv[++i];
+        } else if (strcmp(arg, "--threshold") == 0 && value) {
+            threshold_pct = atof(argv[++i]);
+        } else if (strcmp(arg, "--list") == 0) {
+            list = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (config.repetitions < 1) config.repetitions = 1;
+
+    // ===== FIXTURES =====
+    static float samples[kSampleCount][NUM_CHANNELS];
+    GenerateSamples(samples, kSampleCount);
+
+    static float window[WINDOW_SIZE][NUM_CHANNELS];
+    static WindowRing<float, WINDOW_SIZE, NUM_CHANNELS> ring;
+    static WindowRing<float, WINDOW_SIZE, NUM_CHANNELS, RING_SOA> ring_soa;
+    Preprocessor preprocessor;
+    for (int t = 0; t < WINDOW_SIZE; t++) {
+        preprocessor.ProcessSample(&samples[t][0], &samples[t][3], window[t]);
+        ring.Push(window[t]);
+        ring_soa.Push(window[t]);
+    }
+
+    alignas(16) static uint8_t pushup_arena[kPushupArenaSize];
+    alignas(16) static uint8_t magic_wand_arena[kMagicWandArenaSize];
+    tflite::MicroInterpreter* pushup =
+        CreateInterpreter(g_pushup_model_data, pushup_arena, kPushupArenaSize);
+    tflite::MicroInterpreter* magic_wand =
+        CreateInterpreter(g_magic_wand_model_data, magic_wand_arena, kMagicWandArenaSize);
+    float normalized[WINDOW_SIZE][NUM_CHANNELS];
+    NormalizeWindow(window, WINDOW_SIZE, 0, normalized);
+    QuantizeWindow(normalized, pushup->input(0));
+
+    static int8_t stroke[kStrokePoints * 2];
+    static int8_t raster[kRasterSize * kRasterSize * 3];
+    GenerateStroke(stroke, kStrokePoints);
+    RasterizeStroke(stroke, kStrokePoints, 1.0f, 1.0f, kRasterSize, kRasterSize, raster);
+    memcpy(magic_wand->input(0)->data.int8, raster, sizeof(raster));
+    if (!list) {
+        CheckInvokeStep(pushup, "pushup");
+        CheckInvokeStep(magic_wand, "magic_wand");
+    }
+
+    // Two-stage layer pipelines, one interpreter (and arena) per stage
+    alignas(16) static uint8_t pushup_front_arena[kPushupArenaSize];
+    alignas(16) static uint8_t pushup_back_arena[kPushupArenaSize];
+    alignas(16) static uint8_t magic_wand_front_arena[kMagicWandArenaSize];
+    alignas(16) static uint8_t magic_wand_back_arena[kMagicWandArenaSize];
+    alignas(16) static uint8_t pushup_slots[kPipelineSlotBytes];
+    alignas(16) static uint8_t magic_wand_slots[kPipelineSlotBytes];
+    tflite::MicroInterpreter* pushup_front =
+        CreateInterpreter(g_pushup_model_data, pushup_front_arena, kPushupArenaSize);
+    tflite::MicroInterpreter* pushup_back =
+        CreateInterpreter(g_pushup_model_data, pushup_back_arena, kPushupArenaSize);
+    tflite::MicroInterpreter* magic_wand_front =
+        CreateInterpreter(g_magic_wand_model_data, magic_wand_front_arena, kMagicWandArenaSize);
+    tflite::MicroInterpreter* magic_wand_back =
+        CreateInterpreter(g_magic_wand_model_data, magic_wand_back_arena, kMagicWandArenaSize);
+    const std::vector<std::vector<uint8_t>> pushup_inputs =
+        GenerateInputs(pushup->input(0), kPipelineWindows);
+    const std::vector<std::vector<uint8_t>> magic_wand_inputs =
+        GenerateInputs(magic_wand->input(0), kPipelineWindows);
+    LayerPipeline pushup_pipeline;
+    LayerPipeline magic_wand_pipeline;
+    if (!list) {
+        CheckLayerPipeline("pushup", g_pushup_model_data, pushup, pushup_front, pushup_back,
+                           &pushup_pipeline, pushup_slots, pushup_inputs);
+        CheckLayerPipeline("magic_wand", g_magic_wand_model_data, magic_wand, magic_wand_front,
+                           magic_wand_back, &magic_wand_pipeline, magic_wand_slots,
+                           magic_wand_inputs);
+    }
+
+    // Load-time graph fusion against the unfused interpreters
+    alignas(16) static uint8_t pushup_fused_arena[kPushupArenaSize];
+    alignas(16) static uint8_t magic_wand_fused_arena[kMagicWandArenaSize];
+    static std::vector<uint8_t> pushup_fused_model;
+    static std::vector<uint8_t> magic_wand_fused_model;
+    tflite::MicroInterpreter* pushup_fused = nullptr;
+    tflite::MicroInterpreter* magic_wand_fused = nullptr;
+    if (!list) {
+        pushup_fused = CheckFusion("pushup", g_pushup_model_data, &pushup_fused_model, pushup,
+                                   pushup_fused_arena, kPushupArenaSize, pushup_inputs);
+        magic_wand_fused = CheckFusion("magic_wand", g_magic_wand_model_data,
+                                       &magic_wand_fused_model, magic_wand, magic_wand_fused_arena,
+                                       kMagicWandArenaSize, magic_wand_inputs);
+    }
+
+    // Batched models on top of the fused ones, against their single invokes
+    constexpr int kBatchCount = sizeof(kBatchSizes) / sizeof(kBatchSizes[0]);
+    static BatchedModel pushup_batched[kBatchCount];
+    static BatchedModel magic_wand_batched[kBatchCount];
+    if (!list) {
+        for (int i = 0; i < kBatchCount; i++) {
+            CheckBatch("pushup", pushup_fused_model.data(), pushup_fused, kPushupArenaSize,
+                       kBatchSizes[i], pushup_inputs, &pushup_batched[i]);
+            CheckBatch("magic_wand", magic_wand_fused_model.data(), magic_wand_fused,
+                       kMagicWandArenaSize, kBatchSizes[i], magic_wand_inputs,
+                       &magic_wand_batched[i]);
+        }
+    }
+
+    InferenceResult results[15];
+    for (int i = 0; i < 15; i++) {
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+            results[i].probabilities[c] = (c == i % NUM_POSTURE_CLASSES) ? 0.7f : 0.1f;
+        }
+        results[i].max_confidence = 0.7f;
+        results[i].best_class = i % NUM_POSTURE_CLASSES;
+        results[i].timestamp = i * 200;
+    }
+
+    oled_display_init();
+    if (!list) CheckOledScreens();
+
+    // ===== BENCHMARKS =====
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"preprocess/process_sample", [&](uint64_t iterations) {
+        float out[NUM_CHANNELS];
+        for (uint64_t i = 0; i < iterations; i++) {
+            const float* s = samples[i % kSampleCount];
+            preprocessor.ProcessSample(&s[0], &s[3], out);
+            DoNotOptimize(out);
+        }
+    }});
+    // With ENABLE_IMU_DLPF the median and accel lowpass run in the IMU
+    benchmarks.push_back({"preprocess/process_sample_hw_dlpf", [&](uint64_t iterations) {
+        Preprocessor hw_preprocessor;
+        hw_preprocessor.SetHardwareLowpass(true);
+        float out[NUM_CHANNELS];
+        for (uint64_t i = 0; i < iterations; i++) {
+            const float* s = samples[i % kSampleCount];
+            hw_preprocessor.ProcessSample(&s[0], &s[3], out);
+            DoNotOptimize(out);
+        }
+    }});
+    benchmarks.push_back({"inference/normalize_quantize", [&](uint64_t iterations) {
+        float out[WINDOW_SIZE][NUM_CHANNELS];
+        for (uint64_t i = 0; i < iterations; i++) {
+            NormalizeWindow(ring.Window(WINDOW_SIZE), out);
+            QuantizeWindow(out, pushup->input(0));
+            ClobberMemory();
+        }
+    }});
+    // Sliding window storage: the old modulo-indexed [N][C] buffer against the
+    // double-mapped WindowRing in both layouts
+    benchmarks.push_back({"ring/push_modulo", [&](uint64_t iterations) {
+        static float buffer[WINDOW_SIZE][NUM_CHANNELS];
+        static int head = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            memcpy(buffer[head], samples[i % kSampleCount], sizeof(buffer[0]));
+            head = (head + 1) % WINDOW_SIZE;
+            ClobberMemory();
+        }
+    }});
+    benchmarks.push_back({"ring/push_aos", [&](uint64_t iterations) {
+        static WindowRing<float, WINDOW_SIZE, NUM_CHANNELS> target;
+        for (uint64_t i = 0; i < iterations; i++) {
+            target.Push(samples[i % kSampleCount]);
+            ClobberMemory();
+        }
+    }});
+    benchmarks.push_back({"ring/push_soa", [&](uint64_t iterations) {
+        static WindowRing<float, WINDOW_SIZE, NUM_CHANNELS, RING_SOA> target;
+        for (uint64_t i = 0; i < iterations; i++) {
+            target.Push(samples[i % kSampleCount]);
+            ClobberMemory();
+        }
+    }});
+    benchmarks.push_back({"ring/normalize_modulo", [&](uint64_t iterations) {
+        float out[WINDOW_SIZE][NUM_CHANNELS];
+        for (uint64_t i = 0; i < iterations; i++) {
+            NormalizeWindow(window, WINDOW_SIZE, static_cast<int>(i % WINDOW_SIZE), out);
+            DoNotOptimize(out);
+        }
+    }});
+    benchmarks.push_back({"ring/normalize_aos", [&](uint64_t iterations) {
+        float out[WINDOW_SIZE][NUM_CHANNELS];
+        for (uint64_t i = 0; i < iterations; i++) {
+            NormalizeWindow(ring.Window(WINDOW_SIZE), out);
+            DoNotOptimize(out);
+        }
+    }});
+    // Per-channel mean of the window, the access pattern of the magic wand's
+    // EstimateGravityDirection()
+    benchmarks.push_back({"ring/channel_mean_modulo", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            const int head = static_cast<int>(i % WINDOW_SIZE);
+            float mean[NUM_CHANNELS] = {};
+            for (int t = 0; t < WINDOW_SIZE; t++) {
+                const float* entry = window[(head + t) % WINDOW_SIZE];
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) mean[ch] += entry[ch];
+            }
+            DoNotOptimize(mean);
+        }
+    }});
+    benchmarks.push_back({"ring/channel_mean_aos", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            const float* entry = ring.Window(WINDOW_SIZE);
+            float mean[NUM_CHANNELS] = {};
+            for (int t = 0; t < WINDOW_SIZE; t++, entry += NUM_CHANNELS) {
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) mean[ch] += entry[ch];
+            }
+            DoNotOptimize(mean);
+        }
+    }});
+    benchmarks.push_back({"ring/channel_mean_soa", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            float mean[NUM_CHANNELS] = {};
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                const float* values = ring_soa.Channel(ch, WINDOW_SIZE);
+                for (int t = 0; t < WINDOW_SIZE; t++) mean[ch] += values[t];
+            }
+            DoNotOptimize(mean);
+        }
+    }});
+    benchmarks.push_back({"inference/pushup_invoke", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (pushup->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    // Same invoke yielding after every operator, the cost of slicing it
+    benchmarks.push_back({"inference/pushup_invoke_step", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            bool done = false;
+            while (!done) {
+                if (pushup->InvokeStep(0, &done) != kTfLiteOk) exit(1);
+            }
+        }
+    }});
+    benchmarks.push_back({"inference/magic_wand_invoke", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (magic_wand->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    benchmarks.push_back({"inference/magic_wand_invoke_step", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            bool done = false;
+            while (!done) {
+                if (magic_wand->InvokeStep(0, &done) != kTfLiteOk) exit(1);
+            }
+        }
+    }});
+    // Same models after load-time graph fusion
+    benchmarks.push_back({"inference/pushup_invoke_fused", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (pushup_fused->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    benchmarks.push_back({"inference/magic_wand_invoke_fused", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (magic_wand_fused->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    // Windows per second through one interpreter vs the two-stage pipeline
+    benchmarks.push_back({"pipeline/pushup_sequential", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            const std::vector<uint8_t>& input = pushup_inputs[i % kPipelineWindows];
+            memcpy(pushup->input(0)->data.uint8, input.data(), input.size());
+            if (pushup->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    benchmarks.push_back({"pipeline/pushup_pipelined", [&](uint64_t iterations) {
+        StreamPipeline(&pushup_pipeline, pushup_front, pushup_inputs, iterations);
+    }});
+    benchmarks.push_back({"pipeline/magic_wand_sequential", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            const std::vector<uint8_t>& input = magic_wand_inputs[i % kPipelineWindows];
+            memcpy(magic_wand->input(0)->data.uint8, input.data(), input.size());
+            if (magic_wand->Invoke() != kTfLiteOk) exit(1);
+        }
+    }});
+    benchmarks.push_back({"pipeline/magic_wand_pipelined", [&](uint64_t iterations) {
+        StreamPipeline(&magic_wand_pipeline, magic_wand_front, magic_wand_inputs, iterations);
+    }});
+    // One op = one Invoke() of batch windows through the fused model
+    for (int i = 0; i < kBatchCount; i++) {
+        const std::string suffix = "_b" + std::to_string(kBatchSizes[i]);
+        benchmarks.push_back({"batch/pushup" + suffix, [i](uint64_t iterations) {
+            StreamBatches(&pushup_batched[i], iterations);
+        }});
+        benchmarks.push_back({"batch/magic_wand" + suffix, [i](uint64_t iterations) {
+            StreamBatches(&magic_wand_batched[i], iterations);
+        }});
+    }
+    benchmarks.push_back({"magic_wand/rasterize_stroke", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            RasterizeStroke(stroke, kStrokePoints, 1.0f, 1.0f, kRasterSize, kRasterSize, raster);
+            ClobberMemory();
+        }
+    }});
+    benchmarks.push_back({"magic_wand/rasterize_stroke_time", [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            RasterizeStrokeTime(stroke, kStrokePoints, 1.0f, 1.0f, kRasterSize, kRasterSize,
+                                raster);
+            ClobberMemory();
+        }
+    }});
+    benchmarks.push_back({"oled/render_text", [&](uint64_t iterations) {
+        // Same screen as DisplayRecordingStatus()
+        for (uint64_t i = 0; i < iterations; i++) {
+            oled_display_clear();
+            oled_display_text(0, 0, "GAINS");
+            oled_display_text(0, 20, "Recording...");
+            oled_display_text(0, 40, "123 samples");
+            ClobberMemory();
+        }
+    }});
+    // One op = one screen change into the framebuffer, old way vs prerendered
+    for (const OledScreenCase& screen : kOledScreens) {
+        const std::string name = std::string("oled/screen_") + screen.name;
+        benchmarks.push_back({name + "_text", [&screen](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                screen.text();
+                ClobberMemory();
+            }
+        }});
+        benchmarks.push_back({name, [&screen](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                screen.prerendered();
+                ClobberMemory();
+            }
+        }});
+    }
+    benchmarks.push_back({"oled/flush", [&](uint64_t iterations) {
+        // Addressing + 1 KB framebuffer encoded into I2C command links
+        for (uint64_t i = 0; i < iterations; i++) {
+            if (oled_display_update() != ESP_OK) exit(1);
+        }
+    }});
+    benchmarks.push_back({"vote/weighted_vote", [&](uint64_t iterations) {
+        float scores[NUM_POSTURE_CLASSES];
+        for (uint64_t i = 0; i < iterations; i++) {
+            const int count = 2 + static_cast<int>(i % 14);
+            DoNotOptimize(WeightedVoteScores(results, count, scores));
+            DoNotOptimize(scores);
+        }
+    }});
+    benchmarks.push_back({"metrics/record", [&](uint64_t iterations) {
+        // Cost added to every loop() stage by the metrics registry
+        static MetricsRegistry metrics;
+        for (uint64_t i = 0; i < iterations; i++) {
+            metrics.Record(METRIC_SAMPLE_INTERVAL, static_cast<uint32_t>(20000 + (i & 8191)));
+            metrics.Increment(METRIC_SAMPLES);
+        }
+        DoNotOptimize(metrics.Counter(METRIC_SAMPLES));
+    }});
+
+    if (list) {
+        for (const Benchmark& b : benchmarks) printf("%s\n", b.name.c_str());
+        return 0;
+    }
+
+    // Bus traffic of one frame, to see what the flush benchmark encodes
+    HostI2cResetStats();
+    oled_display_update();
+    const HostI2cStats frame = HostI2cGetStats();
+
+    const std::vector<BenchResult> bench_results = RunBenchmarks(benchmarks, config);
+    PrintResults(bench_results);
+    for (const char* model : {"pushup", "magic_wand"}) {
+        std::string line;
+        for (const BenchResult& result : bench_results) {
+            const std::string prefix = std::string("batch/") + model + "_b";
+            if (result.name.compare(0, prefix.size(), prefix) != 0 || result.ns_per_op <= 0) {
+                continue;
+            }
+            const int batch = atoi(result.name.c_str() + prefix.size());
+            char entry[64];
+            snprintf(entry, sizeof(entry), " batch %d: %.0f,", batch,
+                     batch * 1e9 / result.ns_per_op);
+            line += entry;
+        }
+        if (!line.empty()) {
+            line.pop_back();
+            printf("[BENCH] %s windows/s:%s\n", model, line.c_str());
+        }
+    }
+    printf("[BENCH] OLED frame: %llu I2C bytes in %llu transactions\n",
+           static_cast<unsigned long long>(frame.bytes),
+           static_cast<unsigned long long>(frame.transactions));
+
+    if (json_path != nullptr && !WriteResultsJson(bench_results, json_path)) return 1;
+    if (baseline_path != nullptr) {
+        std::vector<BenchResult> baseline;
+        if (!ReadResultsJson(baseline_path, &baseline)) return 1;
+        const int regressions = CompareResults(baseline, bench_results, threshold_pct);
+        printf("[BENCH] %d regression(s) at %.0f%% threshold\n", regressions, threshold_pct);
+        if (regressions > 0) return 2;
+    }
+    return 0;
+}
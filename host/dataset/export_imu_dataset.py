@@ -0,0 +1,119 @@
+"""
+Convert session JSON files (dataset_raw / dataset_clean) into the binary
+.gimu column store read by the host tools. See host/dataset/imu_dataset.h
+for the file layout.
+
+Usage:
+    python host/dataset/export_imu_dataset.py dataset_clean/merged_dataset.json -o merged.gimu
+    python host/dataset/export_imu_dataset.py dataset_raw/*.json -o raw.gimu --participant-from-file
+"""
+
+import argparse
+import json
+import struct
+import sys
+from array import array
+from pathlib import Path
+
+MAGIC = b"GIMU"
+VERSION = 1
+CHANNELS = ("ax", "ay", "az", "gx", "gy", "gz")
+NAME_LENGTH = 32
+
+FLAG_NORMALIZED = 1 << 0
+FLAG_FILTERED = 1 << 1
+
+HEADER_FORMAT = "<4sIIIIIIIQQ16s"   # ImuDatasetHeader, 64 bytes
+RECORD_FORMAT = "<QIHHIIQ"          # ImuSessionRecord, 32 bytes
+
+
+def intern(table, name):
+    # Keyed on the stored bytes, as ImuDatasetWriter::Intern: names that only
+    # differ past byte 31 share an entry
+    name = (name or "").encode("utf-8")[:NAME_LENGTH - 1]
+    if name not in table:
+        table.append(name)
+    return table.index(name)
+
+
+def pack_name(name):
+    return name.ljust(NAME_LENGTH, b"\0")
+
+
+def export(paths, out_path, participant_from_file=False, label_key=None):
+    labels, participants, records = [], [], []
+    sample_rate = None
+    flags = 0
+
+    with open(out_path, "wb") as out:
+        out.write(b"\0" * struct.calcsize(HEADER_FORMAT))
+        offset = out.tell()
+        total_samples = 0
+
+        for path in paths:
+            with open(path, "r") as f:
+                raw = json.load(f)
+
+            meta = raw.get("metadata", {})
+            rate = int(meta.get("sample_rate_hz", 40))
+            if sample_rate is None:
+                sample_rate = rate
+            elif rate != sample_rate:
+                sys.exit(f"ERROR: {path} is {rate} Hz, expected {sample_rate} Hz")
+            if meta.get("normalized"):
+                flags |= FLAG_NORMALIZED
+            if meta.get("format_version") == "2.0":
+                flags |= FLAG_FILTERED
+
+            for index, session in enumerate(raw["sessions"]):
+                data = session.get("data", [])
+                if not data:
+                    continue
+
+                key = label_key or ("posture_label" if "posture_label" in session else "phase_label")
+                label = intern(labels, session.get(key, ""))
+                participant_name = session.get("participant_id") or ""
+                if participant_from_file and not participant_name:
+                    participant_name = Path(path).stem
+                participant = intern(participants, participant_name)
+
+                for channel in CHANNELS:
+                    array("f", (float(d[channel]) for d in data)).tofile(out)
+
+                source_session = int(session.get("session_id", index))
+                records.append((offset, len(data), label, participant, source_session & 0xFFFFFFFF, 0, 0))
+                offset += len(data) * len(CHANNELS) * 4
+                total_samples += len(data)
+
+            print(f"  {path}: {len(raw['sessions'])} sessions")
+
+        labels = labels or [b""]
+        participants = participants or [b""]
+        index_offset = offset
+        for record in records:
+            out.write(struct.pack(RECORD_FORMAT, *record))
+        for name in labels + participants:
+            out.write(pack_name(name))
+
+        out.seek(0)
+        out.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, sample_rate or 40, len(CHANNELS),
+                              len(records), len(labels), len(participants), flags,
+                              index_offset, total_samples, b"\0" * 16))
+
+    print(f"Wrote {out_path}: {len(records)} sessions, {total_samples} samples, labels={[name.decode('utf-8', 'replace') for name in labels]}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export session JSON to a .gimu dataset")
+    parser.add_argument("inputs", nargs="+", help="session JSON files")
+    parser.add_argument("-o", "--output", required=True, help="output .gimu path")
+    parser.add_argument("--participant-from-file", action="store_true",
+                        help="use the JSON file name as participant id when it is empty")
+    parser.add_argument("--label-key", default=None,
+                        help="session field holding the class (default: posture_label, else phase_label)")
+    args = parser.parse_args()
+    export(args.inputs, args.output, args.participant_from_file, args.label_key)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+#include "gimu_loader.h"
+
+#include <cstdio>
+
+#include "imu_dataset.h"
+#include "window_index.h"
+
+struct GimuLoader {
+    ImuDataset dataset;
+    WindowIndex index;
+};
+
+GimuLoader* gimu_loader_open(const char* dataset_path, const char* index_path) {
+    GimuLoader* loader = new GimuLoader();
+    if (!loader->dataset.Open(dataset_path) || !loader->index.Open(index_path, &loader->dataset)) {
+        delete loader;
+        return nullptr;
+    }
+    return loader;
+}
+
+void gimu_loader_close(GimuLoader* loader) {
+    delete loader;
+}
+
+int gimu_loader_window_size(const GimuLoader* loader) {
+    return static_cast<int>(loader->index.header().window_size);
+}
+
+int gimu_loader_channels(const GimuLoader*) {
+    return kImuChannels;
+}
+
+int gimu_loader_num_windows(const GimuLoader* loader) {
+    return loader->index.num_windows();
+}
+
+int gimu_loader_split_begin(const GimuLoader* loader, int split) {
+    if (split < 0 || split >= kNumSplits) return 0;
+    return loader->index.SplitBegin(split);
+}
+
+int gimu_loader_split_size(const GimuLoader* loader, int split) {
+    if (split < 0 || split >= kNumSplits) return 0;
+    return loader->index.SplitSize(split);
+}
+
+int gimu_loader_num_labels(const GimuLoader* loader) {
+    return loader->dataset.num_labels();
+}
+
+const char* gimu_loader_label_name(const GimuLoader* loader, int label) {
+    if (label < 0 || label >= loader->dataset.num_labels()) return "";
+    return loader->dataset.LabelName(label);
+}
+
+int gimu_loader_gather(const GimuLoader* loader, const int32_t* windows, int count,
+                       const float* mean, const float* std, float* x, int32_t* labels) {
+    const int window_size = gimu_loader_window_size(loader);
+    const int num_windows = loader->index.num_windows();
+    float scale[kImuChannels];
+    float shift[kImuChannels];
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        scale[ch] = std != nullptr ? 1.0f / std[ch] : 1.0f;
+        shift[ch] = mean != nullptr ? mean[ch] : 0.0f;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (windows[i] < 0 || windows[i] >= num_windows) {
+            fprintf(stderr, "[WINDOWS] ERROR: window %d of %d requested\n", windows[i],
+                    num_windows);
+            return -1;
+        }
+        const WindowRecord& w = loader->index.record(windows[i]);
+        float* out = x + static_cast<size_t>(i) * window_size * kImuChannels;
+        // Column store to time-major: each channel is one contiguous run
+        for (int ch = 0; ch < kImuChannels; ch++) {
+            const float* column = loader->dataset.Column(w.session, ch) + w.offset;
+            for (int t = 0; t < window_size; t++) {
+                out[t * kImuChannels + ch] = (column[t] - shift[ch]) * scale[ch];
+            }
+        }
+        if (labels != nullptr) labels[i] = w.label;
+    }
+    return count;
+}
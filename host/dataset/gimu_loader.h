@@ -0,0 +1,53 @@
+#ifndef GIMU_LOADER_H_
+#define GIMU_LOADER_H_
+
+#include <stdint.h>
+
+/* C API over a .gimu dataset and its .gwix window index (window_index.h) for
+ * training loaders; host/dataset/gimu_loader.py wraps it with ctypes. Both
+ * files are memory mapped: a batch is gathered from the column store into
+ * the caller's buffer with no parsing and no intermediate copy, so epochs
+ * cost what the page cache and memcpy cost. Build it as a shared library:
+ *
+ *   g++ -std=gnu++17 -O2 -shared -fPIC -I host host/dataset/imu_dataset.cpp \
+ *       host/dataset/window_index.cpp host/dataset/gimu_loader.cpp -o libgimu_loader.so
+ *
+ * A loader is read-only after open, so several threads may gather from it
+ * at once. Errors are printed to stderr.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct GimuLoader GimuLoader;
+
+/* Map a dataset and an index built from it; NULL on failure */
+GimuLoader* gimu_loader_open(const char* dataset_path, const char* index_path);
+void gimu_loader_close(GimuLoader* loader);
+
+int gimu_loader_window_size(const GimuLoader* loader);
+int gimu_loader_channels(const GimuLoader* loader);
+int gimu_loader_num_windows(const GimuLoader* loader);
+
+/* Records of one split (0 train, 1 validation, 2 test) are
+ * [split_begin, split_begin + split_size) */
+int gimu_loader_split_begin(const GimuLoader* loader, int split);
+int gimu_loader_split_size(const GimuLoader* loader, int split);
+
+int gimu_loader_num_labels(const GimuLoader* loader);
+const char* gimu_loader_label_name(const GimuLoader* loader, int label);
+
+/* Gather count windows by record index into x, laid out like the model input
+ * [count][window_size][channels] (time-major). With mean and std (one value
+ * per channel, may be NULL) every value becomes (v - mean) / std. labels
+ * (may be NULL) receives the label of each window. Returns count, or -1 if
+ * a record index is out of range (x is then partly written). */
+int gimu_loader_gather(const GimuLoader* loader, const int32_t* windows, int count,
+                       const float* mean, const float* std, float* x, int32_t* labels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GIMU_LOADER_H_ */
@@ -0,0 +1,199 @@
+"""
+Batches of training windows from a .gimu dataset and its .gwix window index
+(built by host/windows). Both files are memory mapped: the window records
+are a numpy view of the .gwix, and batches are gathered from the .gimu
+column store by libgimu_loader.so (host/dataset/gimu_loader.h) straight into
+a preallocated array. Without the library the same batches come from a
+numpy gather over the mapped columns, which is slower but needs no build.
+
+    loader = GimuLoader("merged.gimu", "merged.gwix", lib="libgimu_loader.so")
+    mean, std = loader.channel_stats("train")
+    for x, y in loader.batches("train", 64, mean=mean, std=std, seed=epoch):
+        ...   # x: float32 [batch, window, 6], y: int32 [batch]
+
+Usage (prints the splits and times one epoch):
+    python host/dataset/gimu_loader.py merged.gimu merged.gwix --lib libgimu_loader.so
+"""
+
+import argparse
+import ctypes
+import struct
+import time
+
+import numpy as np
+
+GIMU_HEADER_FORMAT = "<4sIIIIIIIQQ16s"   # ImuDatasetHeader, 64 bytes
+GWIX_HEADER_FORMAT = "<4sIIII3IIIQQ8s"   # WindowIndexHeader, 64 bytes
+NAME_LENGTH = 32
+SPLITS = ("train", "validation", "test")
+
+SESSION_DTYPE = np.dtype([("data_offset", "<u8"), ("sample_count", "<u4"), ("label", "<u2"),
+                          ("participant", "<u2"), ("source_session", "<u4"), ("flags", "<u4"),
+                          ("reserved", "<u8")])
+WINDOW_DTYPE = np.dtype([("session", "<u4"), ("offset", "<u4"), ("label", "<u2"),
+                         ("participant", "<u2"), ("split", "u1"), ("reserved", "u1", 3)])
+
+
+def _names(raw, offset, count):
+    return [bytes(raw[offset + i * NAME_LENGTH:offset + (i + 1) * NAME_LENGTH])
+            .split(b"\0", 1)[0].decode("utf-8", "replace") for i in range(count)]
+
+
+def _load_library(path):
+    lib = ctypes.CDLL(path)
+    lib.gimu_loader_open.restype = ctypes.c_void_p
+    lib.gimu_loader_open.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+    lib.gimu_loader_close.argtypes = [ctypes.c_void_p]
+    float_p = ctypes.POINTER(ctypes.c_float)
+    int_p = ctypes.POINTER(ctypes.c_int32)
+    lib.gimu_loader_gather.restype = ctypes.c_int
+    lib.gimu_loader_gather.argtypes = [ctypes.c_void_p, int_p, ctypes.c_int, float_p, float_p,
+                                       float_p, int_p]
+    return lib
+
+
+def _pointer(array, ctype):
+    return None if array is None else array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+class GimuLoader:
+    def __init__(self, dataset_path, index_path, lib=None):
+        self._raw = np.memmap(dataset_path, dtype=np.uint8, mode="r")
+        (magic, _, self.sample_rate_hz, self.channels, num_sessions, num_labels, num_participants,
+         _, index_offset, total_samples, _) = struct.unpack_from(GIMU_HEADER_FORMAT, self._raw)
+        if magic != b"GIMU":
+            raise ValueError(f"{dataset_path} is not a .gimu file")
+        self.sessions = np.frombuffer(self._raw, SESSION_DTYPE, num_sessions, index_offset)
+        names_offset = index_offset + num_sessions * SESSION_DTYPE.itemsize
+        self.labels = _names(self._raw, names_offset, num_labels)
+        self.participants = _names(self._raw, names_offset + num_labels * NAME_LENGTH,
+                                   num_participants)
+
+        index = np.memmap(index_path, dtype=np.uint8, mode="r")
+        header = struct.unpack_from(GWIX_HEADER_FORMAT, index)
+        if header[0] != b"GWIX" or header[1] != 1:
+            raise ValueError(f"{index_path} is not a version 1 .gwix file")
+        self.window_size, self.stride, num_windows = header[2:5]
+        split_windows = header[5:8]
+        if header[8] != num_sessions or header[10] != total_samples:
+            raise ValueError(f"{index_path} was built from another dataset")
+        self.windows = np.frombuffer(index, WINDOW_DTYPE, num_windows,
+                                     struct.calcsize(GWIX_HEADER_FORMAT))
+        bounds = np.concatenate(([0], np.cumsum(split_windows)))
+        self._splits = {name: (int(bounds[i]), int(bounds[i + 1])) for i, name in enumerate(SPLITS)}
+
+        self._lib, self._handle = None, None
+        if lib is not None:
+            self._lib = _load_library(lib)
+            self._handle = self._lib.gimu_loader_open(str(dataset_path).encode(),
+                                                      str(index_path).encode())
+            if not self._handle:
+                raise ValueError(f"libgimu_loader could not open {dataset_path} / {index_path}")
+
+    def close(self):
+        if self._handle:
+            self._lib.gimu_loader_close(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def split(self, name):
+        """Record indices of one split, in file order (train is pre-shuffled)."""
+        begin, end = self._splits[name]
+        return np.arange(begin, end, dtype=np.int32)
+
+    def column(self, session, channel):
+        """One channel of one session as a zero-copy view of the mapped file."""
+        record = self.sessions[session]
+        count = int(record["sample_count"])
+        offset = int(record["data_offset"]) + channel * count * 4
+        return np.frombuffer(self._raw, np.float32, count, offset)
+
+    def gather(self, ids, mean=None, std=None, out=None):
+        """Windows ids as float32 [len(ids), window, channels] and their labels."""
+        ids = np.ascontiguousarray(ids, dtype=np.int32)
+        shape = (len(ids), self.window_size, self.channels)
+        x = out[:len(ids)] if out is not None else np.empty(shape, np.float32)
+        y = np.empty(len(ids), np.int32)
+        if self._handle:
+            mean = None if mean is None else np.ascontiguousarray(mean, np.float32)
+            std = None if std is None else np.ascontiguousarray(std, np.float32)
+            if self._lib.gimu_loader_gather(self._handle, _pointer(ids, ctypes.c_int32), len(ids),
+                                            _pointer(mean, ctypes.c_float),
+                                            _pointer(std, ctypes.c_float),
+                                            _pointer(x, ctypes.c_float),
+                                            _pointer(y, ctypes.c_int32)) != len(ids):
+                raise IndexError("window index out of range")
+            return x, y
+        for i, w in enumerate(self.windows[ids]):
+            start = int(w["offset"])
+            for ch in range(self.channels):
+                x[i, :, ch] = self.column(int(w["session"]), ch)[start:start + self.window_size]
+            y[i] = w["label"]
+        if mean is not None:
+            x -= mean
+        if std is not None:
+            x /= std
+        return x, y
+
+    def batches(self, split, batch_size, mean=None, std=None, seed=None):
+        """Yield (x, y) over one split; seed reshuffles the order per epoch.
+        x is reused between batches, copy it to keep it."""
+        ids = self.split(split)
+        if seed is not None:
+            np.random.default_rng(seed).shuffle(ids)
+        buffer = np.empty((batch_size, self.window_size, self.channels), np.float32)
+        for first in range(0, len(ids), batch_size):
+            yield self.gather(ids[first:first + batch_size], mean, std, buffer)
+
+    def channel_stats(self, split="train"):
+        """Per-channel mean and std over the distinct sessions of a split."""
+        sessions = np.unique(self.windows[slice(*self._splits[split])]["session"])
+        total = np.zeros(self.channels)
+        total_sq = np.zeros(self.channels)
+        count = 0
+        for s in sessions:
+            record = self.sessions[s]
+            samples = int(record["sample_count"])
+            columns = np.frombuffer(self._raw, np.float32, samples * self.channels,
+                                    int(record["data_offset"])).reshape(self.channels, samples)
+            total += columns.sum(axis=1, dtype=np.float64)
+            total_sq += np.square(columns, dtype=np.float64).sum(axis=1)
+            count += samples
+        mean = total / max(count, 1)
+        std = np.sqrt(np.maximum(total_sq / max(count, 1) - np.square(mean), 1e-12))
+        return mean.astype(np.float32), std.astype(np.float32)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Time one epoch over a .gimu/.gwix pair")
+    parser.add_argument("dataset", help=".gimu dataset")
+    parser.add_argument("index", help=".gwix window index built from it")
+    parser.add_argument("--lib", default=None, help="libgimu_loader.so (default: numpy gather)")
+    parser.add_argument("--batch", type=int, default=64)
+    args = parser.parse_args()
+
+    with GimuLoader(args.dataset, args.index, args.lib) as loader:
+        print(f"{len(loader.windows)} windows of {loader.window_size} (stride {loader.stride}), "
+              f"labels={loader.labels}")
+        for name in SPLITS:
+            w = loader.windows[slice(*loader._splits[name])]
+            per_label = np.bincount(w["label"], minlength=len(loader.labels))
+            print(f"  {name:<10} {len(w):7d} windows, {len(np.unique(w['participant'])):3d} "
+                  f"participants, per label {per_label.tolist()}")
+        mean, std = loader.channel_stats("train")
+        start = time.perf_counter()
+        count = 0
+        for x, y in loader.batches("train", args.batch, mean=mean, std=std, seed=0):
+            count += len(y)
+        seconds = time.perf_counter() - start
+        print(f"Epoch: {count} train windows in {seconds * 1000:.1f} ms "
+              f"({count / seconds:.0f} windows/s, {'C gather' if args.lib else 'numpy gather'})")
+
+
+if __name__ == "__main__":
+    main()
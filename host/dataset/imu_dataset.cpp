@@ -0,0 +1,254 @@
+#include "imu_dataset.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+// ============================================================================
+// READER
+// ============================================================================
+
+ImuDataset::ImuDataset()
+    : base_(nullptr), size_(0), header_(nullptr), sessions_(nullptr),
+      label_names_(nullptr), participant_names_(nullptr) {}
+
+ImuDataset::~ImuDataset() {
+    Close();
+}
+
+bool ImuDataset::Open(const char* path) {
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[DATASET] ERROR: cannot open %s\n", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ImuDatasetHeader))) {
+        fprintf(stderr, "[DATASET] ERROR: %s is too small to be a dataset\n", path);
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "[DATASET] ERROR: mmap failed for %s\n", path);
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+    header_ = reinterpret_cast<const ImuDatasetHeader*>(base_);
+
+    if (memcmp(header_->magic, kImuDatasetMagic, sizeof(kImuDatasetMagic)) != 0) {
+        fprintf(stderr, "[DATASET] ERROR: %s is not a .gimu file\n", path);
+        Close();
+        return false;
+    }
+    if (header_->version != kImuDatasetVersion || header_->num_channels != kImuChannels) {
+        fprintf(stderr, "[DATASET] ERROR: unsupported version %u / %u channels\n",
+                header_->version, header_->num_channels);
+        Close();
+        return false;
+    }
+
+    const uint64_t index_bytes =
+        static_cast<uint64_t>(header_->num_sessions) * sizeof(ImuSessionRecord) +
+        static_cast<uint64_t>(header_->num_labels + header_->num_participants) * kImuNameLength;
+    if (header_->index_offset < sizeof(ImuDatasetHeader) ||
+        header_->index_offset + index_bytes > size_) {
+        fprintf(stderr, "[DATASET] ERROR: index of %s is truncated (was the writer closed?)\n", path);
+        Close();
+        return false;
+    }
+
+    sessions_ = reinterpret_cast<const ImuSessionRecord*>(base_ + header_->index_offset);
+    label_names_ = reinterpret_cast<const char*>(sessions_ + header_->num_sessions);
+    participant_names_ = label_names_ + header_->num_labels * kImuNameLength;
+
+    for (uint32_t i = 0; i < header_->num_sessions; i++) {
+        const ImuSessionRecord& rec = sessions_[i];
+        const uint64_t bytes = static_cast<uint64_t>(rec.sample_count) * kImuChannels * sizeof(float);
+        if (rec.data_offset + bytes > header_->index_offset ||
+            rec.label >= header_->num_labels ||
+            rec.participant >= header_->num_participants) {
+            fprintf(stderr, "[DATASET] ERROR: session %u of %s is corrupt\n", i, path);
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ImuDataset::Close() {
+    if (base_ != nullptr) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+    }
+    base_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    sessions_ = nullptr;
+    label_names_ = nullptr;
+    participant_names_ = nullptr;
+}
+
+const float* ImuDataset::Column(int session, int channel) const {
+    const ImuSessionRecord& rec = sessions_[session];
+    const float* first = reinterpret_cast<const float*>(base_ + rec.data_offset);
+    return first + static_cast<size_t>(channel) * rec.sample_count;
+}
+
+const char* ImuDataset::LabelName(int label) const {
+    return label_names_ + label * kImuNameLength;
+}
+
+const char* ImuDataset::ParticipantName(int participant) const {
+    return participant_names_ + participant * kImuNameLength;
+}
+
+void ImuDataset::ReadSeries(int session, ImuSeries* out) const {
+    const int n = static_cast<int>(sessions_[session].sample_count);
+    out->Resize(n);
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        memcpy(out->columns[ch].data(), Column(session, ch), n * sizeof(float));
+    }
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+ImuDatasetWriter::ImuDatasetWriter()
+    : file_(nullptr), offset_(0), total_samples_(0), sample_rate_hz_(0), flags_(0) {}
+
+ImuDatasetWriter::~ImuDatasetWriter() {
+    if (file_ != nullptr) {
+        Close();
+    }
+}
+
+bool ImuDatasetWriter::Open(const char* path, uint32_t sample_rate_hz, uint32_t flags) {
+    file_ = fopen(path, "wb");
+    if (file_ == nullptr) {
+        fprintf(stderr, "[DATASET] ERROR: cannot create %s\n", path);
+        return false;
+    }
+    sample_rate_hz_ = sample_rate_hz;
+    flags_ = flags;
+    records_.clear();
+    labels_.clear();
+    participants_.clear();
+    total_samples_ = 0;
+
+    // Placeholder header, patched in Close()
+    ImuDatasetHeader header = {};
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+        fprintf(stderr, "[DATASET] ERROR: write failed for %s\n", path);
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    offset_ = sizeof(header);
+    return true;
+}
+
+int ImuDatasetWriter::Intern(std::vector<std::string>* table, const char* name) {
+    std::string key(name != nullptr ? name : "");
+    if (key.size() >= static_cast<size_t>(kImuNameLength)) {
+        key.resize(kImuNameLength - 1);
+    }
+    for (size_t i = 0; i < table->size(); i++) {
+        if ((*table)[i] == key) return static_cast<int>(i);
+    }
+    table->push_back(key);
+    return static_cast<int>(table->size() - 1);
+}
+
+int ImuDatasetWriter::InternLabel(const char* name) {
+    return Intern(&labels_, name);
+}
+
+int ImuDatasetWriter::InternParticipant(const char* name) {
+    return Intern(&participants_, name);
+}
+
+bool ImuDatasetWriter::WriteSession(const float* const columns[kImuChannels], int sample_count,
+                                    int label, int participant, uint32_t source_session,
+                                    uint32_t flags) {
+    if (file_ == nullptr || sample_count <= 0) return false;
+
+    ImuSessionRecord rec = {};
+    rec.data_offset = offset_;
+    rec.sample_count = static_cast<uint32_t>(sample_count);
+    rec.label = static_cast<uint16_t>(label);
+    rec.participant = static_cast<uint16_t>(participant);
+    rec.source_session = source_session;
+    rec.flags = flags;
+
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        if (fwrite(columns[ch], sizeof(float), sample_count, file_) != static_cast<size_t>(sample_count)) {
+            fprintf(stderr, "[DATASET] ERROR: short write in session %zu\n", records_.size());
+            return false;
+        }
+    }
+    offset_ += static_cast<uint64_t>(sample_count) * kImuChannels * sizeof(float);
+    total_samples_ += sample_count;
+    records_.push_back(rec);
+    return true;
+}
+
+bool ImuDatasetWriter::WriteSession(const ImuSeries& series, int label, int participant,
+                                    uint32_t source_session, uint32_t flags) {
+    const float* columns[kImuChannels];
+    for (int ch = 0; ch < kImuChannels; ch++) {
+        columns[ch] = series.columns[ch].data();
+    }
+    return WriteSession(columns, series.length(), label, participant, source_session, flags);
+}
+
+bool ImuDatasetWriter::Close() {
+    if (file_ == nullptr) return false;
+
+    // Every table needs at least one entry so readers can index it
+    if (labels_.empty()) labels_.push_back("");
+    if (participants_.empty()) participants_.push_back("");
+
+    bool ok = fwrite(records_.data(), sizeof(ImuSessionRecord), records_.size(), file_) == records_.size();
+
+    char name[kImuNameLength];
+    for (const std::string& label : labels_) {
+        memset(name, 0, sizeof(name));
+        memcpy(name, label.data(), label.size());
+        ok = ok && fwrite(name, sizeof(name), 1, file_) == 1;
+    }
+    for (const std::string& participant : participants_) {
+        memset(name, 0, sizeof(name));
+        memcpy(name, participant.data(), participant.size());
+        ok = ok && fwrite(name, sizeof(name), 1, file_) == 1;
+    }
+
+    ImuDatasetHeader header = {};
+    memcpy(header.magic, kImuDatasetMagic, sizeof(kImuDatasetMagic));
+    header.version = kImuDatasetVersion;
+    header.sample_rate_hz = sample_rate_hz_;
+    header.num_channels = kImuChannels;
+    header.num_sessions = static_cast<uint32_t>(records_.size());
+    header.num_labels = static_cast<uint32_t>(labels_.size());
+    header.num_participants = static_cast<uint32_t>(participants_.size());
+    header.flags = flags_;
+    header.index_offset = offset_;
+    header.total_samples = total_samples_;
+
+    ok = ok && fseek(file_, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = (fclose(file_) == 0) && ok;
+    file_ = nullptr;
+
+    if (!ok) {
+        fprintf(stderr, "[DATASET] ERROR: failed to finalize dataset\n");
+    }
+    return ok;
+}
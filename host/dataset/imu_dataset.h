@@ -0,0 +1,166 @@
+#ifndef IMU_DATASET_H_
+#define IMU_DATASET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// GAINS binary IMU dataset (.gimu)
+// ============================================================================
+//
+// Column store used by the host tools instead of the session JSON files.
+// All values are little endian.
+//
+//   [ImuDatasetHeader]                        64 bytes at offset 0
+//   session 0: ax[n0] ay[n0] az[n0] gx[n0] gy[n0] gz[n0]   float32 columns
+//   session 1: ax[n1] ...
+//   ...
+//   [ImuSessionRecord x num_sessions]         at header.index_offset
+//   [label names      x num_labels]           kImuNameLength bytes each
+//   [participant names x num_participants]    kImuNameLength bytes each
+//
+// Sessions are appended as they are produced and the index is written last,
+// so writers can stream sessions without knowing the total up front.
+
+constexpr char kImuDatasetMagic[4] = {'G', 'I', 'M', 'U'};
+constexpr uint32_t kImuDatasetVersion = 1;
+constexpr int kImuChannels = 6;        // ax, ay, az, gx, gy, gz
+constexpr int kImuNameLength = 32;     // fixed-size, zero padded strings
+
+// Header flags
+constexpr uint32_t kImuDatasetNormalized = 1u << 0;  // mean/std already applied
+constexpr uint32_t kImuDatasetFiltered = 1u << 1;    // Preprocessor chain applied
+
+// Session flags
+constexpr uint32_t kImuSessionAugmented = 1u << 0;
+
+struct ImuDatasetHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sample_rate_hz;
+    uint32_t num_channels;
+    uint32_t num_sessions;
+    uint32_t num_labels;
+    uint32_t num_participants;
+    uint32_t flags;
+    uint64_t index_offset;   // byte offset of the session table
+    uint64_t total_samples;  // sum of sample_count over all sessions
+    uint8_t reserved[16];
+};
+static_assert(sizeof(ImuDatasetHeader) == 64, "header layout is part of the file format");
+
+struct ImuSessionRecord {
+    uint64_t data_offset;     // byte offset of the ax column
+    uint32_t sample_count;
+    uint16_t label;           // index into the label table
+    uint16_t participant;     // index into the participant table
+    uint32_t source_session;  // session id in the source file (parent id if augmented)
+    uint32_t flags;
+    uint64_t reserved;
+};
+static_assert(sizeof(ImuSessionRecord) == 32, "record layout is part of the file format");
+
+// Channel-major buffer for one session: columns[ch][t]
+struct ImuSeries {
+    std::vector<float> columns[kImuChannels];
+
+    int length() const { return static_cast<int>(columns[0].size()); }
+    void Resize(int n) {
+        for (int ch = 0; ch < kImuChannels; ch++) columns[ch].resize(n);
+    }
+};
+
+// ============================================================================
+// READER
+// ============================================================================
+
+// Read-only view of a .gimu file. The file is memory mapped, so column
+// pointers stay valid for the lifetime of the object.
+class ImuDataset {
+public:
+    ImuDataset();
+    ~ImuDataset();
+
+    ImuDataset(const ImuDataset&) = delete;
+    ImuDataset& operator=(const ImuDataset&) = delete;
+
+    // Map and validate a dataset file. Prints the reason to stderr on failure.
+    bool Open(const char* path);
+    void Close();
+
+    const ImuDatasetHeader& header() const { return *header_; }
+    int num_sessions() const { return static_cast<int>(header_->num_sessions); }
+    const ImuSessionRecord& session(int i) const { return sessions_[i]; }
+
+    // Pointer to sample_count floats of one channel of one session
+    const float* Column(int session, int channel) const;
+
+    const char* LabelName(int label) const;
+    const char* ParticipantName(int participant) const;
+    int num_labels() const { return static_cast<int>(header_->num_labels); }
+    int num_participants() const { return static_cast<int>(header_->num_participants); }
+
+    // Copy one session into a channel-major buffer
+    void ReadSeries(int session, ImuSeries* out) const;
+
+    const uint8_t* data() const { return base_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* base_;
+    size_t size_;
+    const ImuDatasetHeader* header_;
+    const ImuSessionRecord* sessions_;
+    const char* label_names_;
+    const char* participant_names_;
+};
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+// Streams sessions into a .gimu file. Label and participant tables are
+// built on the fly; Close() writes the index and patches the header.
+class ImuDatasetWriter {
+public:
+    ImuDatasetWriter();
+    ~ImuDatasetWriter();
+
+    ImuDatasetWriter(const ImuDatasetWriter&) = delete;
+    ImuDatasetWriter& operator=(const ImuDatasetWriter&) = delete;
+
+    bool Open(const char* path, uint32_t sample_rate_hz, uint32_t flags);
+
+    // Returns the table index for a name, adding it if needed
+    int InternLabel(const char* name);
+    int InternParticipant(const char* name);
+
+    // Append one session. columns[ch] must hold sample_count floats.
+    bool WriteSession(const float* const columns[kImuChannels], int sample_count,
+                      int label, int participant, uint32_t source_session,
+                      uint32_t flags);
+    bool WriteSession(const ImuSeries& series, int label, int participant,
+                      uint32_t source_session, uint32_t flags);
+
+    bool Close();
+
+    int num_sessions() const { return static_cast<int>(records_.size()); }
+    uint64_t total_samples() const { return total_samples_; }
+
+private:
+    FILE* file_;
+    uint64_t offset_;
+    uint64_t total_samples_;
+    uint32_t sample_rate_hz_;
+    uint32_t flags_;
+    std::vector<ImuSessionRecord> records_;
+    std::vector<std::string> labels_;
+    std::vector<std::string> participants_;
+
+    static int Intern(std::vector<std::string>* table, const char* name);
+};
+
+#endif  // IMU_DATASET_H_
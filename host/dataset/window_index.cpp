@@ -0,0 +1,301 @@
+#include "window_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+namespace {
+
+// splitmix64: small, and the same sequence on every platform
+class IndexRng {
+public:
+    explicit IndexRng(uint64_t seed) : state_(seed) {}
+
+    uint64_t Next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n)
+    uint32_t Below(uint32_t n) {
+        return static_cast<uint32_t>(((Next() >> 32) * static_cast<uint64_t>(n)) >> 32);
+    }
+
+private:
+    uint64_t state_;
+};
+
+template <typename T>
+void Shuffle(std::vector<T>* items, IndexRng* rng) {
+    for (size_t i = items->size(); i > 1; i--) {
+        std::swap((*items)[i - 1], (*items)[rng->Below(static_cast<uint32_t>(i))]);
+    }
+}
+
+// Groups of one class dealt to the splits: test first, then validation, the
+// rest to train. Each evaluation split gets one group when there are enough
+// to keep one for training.
+void DealGroups(const std::vector<int>& groups, const WindowIndexConfig& config,
+                std::vector<uint8_t>* group_split) {
+    const int n = static_cast<int>(groups.size());
+    int test = static_cast<int>(lroundf(n * config.test_fraction));
+    int validation = static_cast<int>(lroundf(n * config.validation_fraction));
+    if (config.validation_fraction > 0.0f && validation == 0 && n >= 2) validation = 1;
+    if (config.test_fraction > 0.0f && test == 0 && n >= 3) test = 1;
+    while (test + validation >= n && test > 0) test--;
+    while (test + validation >= n && validation > 0) validation--;
+    for (int i = 0; i < n; i++) {
+        const uint8_t split = i < test ? kSplitTest
+                              : i < test + validation ? kSplitValidation
+                                                      : kSplitTrain;
+        (*group_split)[groups[i]] = split;
+    }
+}
+
+}  // namespace
+
+const char* WindowSplitName(int split) {
+    switch (split) {
+        case kSplitTrain:
+            return "train";
+        case kSplitValidation:
+            return "validation";
+        case kSplitTest:
+            return "test";
+    }
+    return "?";
+}
+
+// ============================================================================
+// BUILDER
+// ============================================================================
+
+bool BuildWindowIndex(const ImuDataset& dataset, const WindowIndexConfig& config,
+                      WindowIndexHeader* header, std::vector<WindowRecord>* records,
+                      WindowIndexStats* stats) {
+    memset(header, 0, sizeof(*header));
+    memset(stats, 0, sizeof(*stats));
+    records->clear();
+    if (config.window_size <= 0 || config.stride <= 0) {
+        fprintf(stderr, "[WINDOWS] ERROR: window size and stride must be positive\n");
+        return false;
+    }
+
+    // Split groups: participants, or without a participant table recorded
+    // sessions, each with the augmented copies made from it (same source id)
+    const bool by_participant = dataset.num_participants() > 1;
+    std::vector<int> session_group(dataset.num_sessions());
+    int num_groups = 0;
+    if (by_participant) {
+        for (int s = 0; s < dataset.num_sessions(); s++) {
+            session_group[s] = dataset.session(s).participant;
+        }
+        num_groups = dataset.num_participants();
+    } else {
+        std::map<uint64_t, int> source_group;
+        for (int s = 0; s < dataset.num_sessions(); s++) {
+            const ImuSessionRecord& rec = dataset.session(s);
+            const uint64_t key = (static_cast<uint64_t>(rec.participant) << 32) | rec.source_session;
+            auto inserted = source_group.insert(std::make_pair(key, num_groups));
+            if (inserted.second) num_groups++;
+            session_group[s] = inserted.first->second;
+        }
+    }
+    auto group_of = [&](int s) { return session_group[s]; };
+
+    // Class of a group: the label most of its recorded (not augmented) sessions have
+    const int num_labels = dataset.num_labels();
+    std::vector<int> votes(static_cast<size_t>(num_groups) * num_labels, 0);
+    std::vector<int> augmented_votes(votes.size(), 0);
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const ImuSessionRecord& rec = dataset.session(s);
+        const size_t slot = static_cast<size_t>(group_of(s)) * num_labels + rec.label;
+        if (rec.flags & kImuSessionAugmented) {
+            augmented_votes[slot]++;
+        } else {
+            votes[slot]++;
+        }
+    }
+    std::vector<std::vector<int>> class_groups(num_labels);
+    for (int g = 0; g < num_groups; g++) {
+        const int* v = &votes[static_cast<size_t>(g) * num_labels];
+        const int* a = &augmented_votes[static_cast<size_t>(g) * num_labels];
+        const bool recorded = std::any_of(v, v + num_labels, [](int x) { return x > 0; });
+        if (!recorded && !std::any_of(a, a + num_labels, [](int x) { return x > 0; })) continue;
+        const int* counts = recorded ? v : a;
+        class_groups[std::max_element(counts, counts + num_labels) - counts].push_back(g);
+    }
+
+    // Stratified: every class deals its own shuffled groups
+    IndexRng rng(config.seed);
+    std::vector<uint8_t> group_split(num_groups, kSplitTrain);
+    for (std::vector<int>& groups : class_groups) {
+        Shuffle(&groups, &rng);
+        DealGroups(groups, config, &group_split);
+    }
+
+    std::vector<WindowRecord> by_split[kNumSplits];
+    std::vector<bool> group_counted[kNumSplits];
+    for (int split = 0; split < kNumSplits; split++) group_counted[split].assign(num_groups, false);
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const ImuSessionRecord& rec = dataset.session(s);
+        const int group = group_of(s);
+        const uint8_t split = group_split[group];
+        if (static_cast<int>(rec.sample_count) < config.window_size) {
+            stats->short_sessions++;
+            continue;
+        }
+        if ((rec.flags & kImuSessionAugmented) && split != kSplitTrain) {
+            stats->dropped_augmented++;
+            continue;
+        }
+        stats->sessions[split]++;
+        if (!group_counted[split][group]) {
+            group_counted[split][group] = true;
+            stats->participants[split]++;
+        }
+        for (uint32_t offset = 0; offset + config.window_size <= rec.sample_count;
+             offset += config.stride) {
+            WindowRecord w = {};
+            w.session = static_cast<uint32_t>(s);
+            w.offset = offset;
+            w.label = rec.label;
+            w.participant = rec.participant;
+            w.split = split;
+            by_split[split].push_back(w);
+        }
+    }
+    Shuffle(&by_split[kSplitTrain], &rng);
+
+    for (int split = 0; split < kNumSplits; split++) {
+        records->insert(records->end(), by_split[split].begin(), by_split[split].end());
+        header->split_windows[split] = static_cast<uint32_t>(by_split[split].size());
+    }
+    if (records->empty()) {
+        fprintf(stderr, "[WINDOWS] ERROR: no session is %d samples long\n", config.window_size);
+        return false;
+    }
+    memcpy(header->magic, kWindowIndexMagic, sizeof(kWindowIndexMagic));
+    header->version = kWindowIndexVersion;
+    header->window_size = static_cast<uint32_t>(config.window_size);
+    header->stride = static_cast<uint32_t>(config.stride);
+    header->num_windows = static_cast<uint32_t>(records->size());
+    header->dataset_sessions = dataset.header().num_sessions;
+    header->dataset_labels = dataset.header().num_labels;
+    header->dataset_samples = dataset.header().total_samples;
+    header->seed = config.seed;
+    return true;
+}
+
+bool WriteWindowIndex(const char* path, const WindowIndexHeader& header,
+                      const std::vector<WindowRecord>& records) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "[WINDOWS] ERROR: cannot create %s\n", path);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(records.data(), sizeof(WindowRecord), records.size(), file) == records.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "[WINDOWS] ERROR: write failed for %s\n", path);
+    }
+    return ok;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+WindowIndex::WindowIndex() : base_(nullptr), size_(0), header_(nullptr), records_(nullptr) {}
+
+WindowIndex::~WindowIndex() {
+    Close();
+}
+
+bool WindowIndex::Open(const char* path, const ImuDataset* dataset) {
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[WINDOWS] ERROR: cannot open %s\n", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(WindowIndexHeader))) {
+        fprintf(stderr, "[WINDOWS] ERROR: %s is too small to be a window index\n", path);
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "[WINDOWS] ERROR: mmap failed for %s\n", path);
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+    header_ = reinterpret_cast<const WindowIndexHeader*>(base_);
+    records_ = reinterpret_cast<const WindowRecord*>(base_ + sizeof(WindowIndexHeader));
+
+    if (memcmp(header_->magic, kWindowIndexMagic, sizeof(kWindowIndexMagic)) != 0 ||
+        header_->version != kWindowIndexVersion) {
+        fprintf(stderr, "[WINDOWS] ERROR: %s is not a version %u .gwix file\n", path,
+                kWindowIndexVersion);
+        Close();
+        return false;
+    }
+    uint64_t split_total = 0;
+    for (int split = 0; split < kNumSplits; split++) split_total += header_->split_windows[split];
+    if (split_total != header_->num_windows ||
+        sizeof(WindowIndexHeader) + static_cast<uint64_t>(header_->num_windows) *
+                                        sizeof(WindowRecord) > size_) {
+        fprintf(stderr, "[WINDOWS] ERROR: %s is truncated\n", path);
+        Close();
+        return false;
+    }
+
+    if (dataset == nullptr) return true;
+    if (header_->dataset_sessions != dataset->header().num_sessions ||
+        header_->dataset_samples != dataset->header().total_samples) {
+        fprintf(stderr, "[WINDOWS] ERROR: %s was built from another dataset\n", path);
+        Close();
+        return false;
+    }
+    for (uint32_t i = 0; i < header_->num_windows; i++) {
+        const WindowRecord& w = records_[i];
+        if (w.session >= header_->dataset_sessions ||
+            static_cast<uint64_t>(w.offset) + header_->window_size >
+                dataset->session(w.session).sample_count) {
+            fprintf(stderr, "[WINDOWS] ERROR: window %u of %s is outside its session\n", i, path);
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void WindowIndex::Close() {
+    if (base_ != nullptr) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+    }
+    base_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    records_ = nullptr;
+}
+
+int WindowIndex::SplitBegin(int split) const {
+    int begin = 0;
+    for (int s = 0; s < split; s++) begin += SplitSize(s);
+    return begin;
+}
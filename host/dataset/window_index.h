@@ -0,0 +1,126 @@
+#ifndef WINDOW_INDEX_H_
+#define WINDOW_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "imu_dataset.h"
+
+// ============================================================================
+// GAINS window index (.gwix)
+// ============================================================================
+//
+// The training windows of a .gimu dataset as (session, offset) pairs, so a
+// loader gathers batches straight from the memory-mapped column store
+// instead of re-slicing the session JSON every epoch. All values are little
+// endian.
+//
+//   [WindowIndexHeader]                       64 bytes at offset 0
+//   [WindowRecord x num_windows]              16 bytes each
+//
+// Records are grouped by split (train, then validation, then test). Train is
+// shuffled; validation and test keep dataset order. Every record is one
+// window of window_size samples starting at offset, labelled with its
+// session's label.
+//
+// The split is by participant, stratified by class: each participant goes
+// to the class most of its sessions have, and the participants of every
+// class are shuffled and dealt to the splits by fraction, so no participant
+// has windows on both sides and every split sees every class it can.
+// Augmented sessions follow their participant into train and are left out
+// of validation and test. Without a participant table (at most one
+// participant) recorded sessions are split instead, and augmented copies go
+// with the session they were made from (same source session id).
+
+constexpr char kWindowIndexMagic[4] = {'G', 'W', 'I', 'X'};
+constexpr uint32_t kWindowIndexVersion = 1;
+
+enum WindowSplit { kSplitTrain = 0, kSplitValidation, kSplitTest, kNumSplits };
+
+const char* WindowSplitName(int split);
+
+struct WindowIndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t window_size;
+    uint32_t stride;
+    uint32_t num_windows;
+    uint32_t split_windows[kNumSplits];   // Records per split, in split order
+    uint32_t dataset_sessions;            // Of the .gimu it was built from
+    uint32_t dataset_labels;
+    uint64_t dataset_samples;             // total_samples of that .gimu
+    uint64_t seed;
+    uint8_t reserved[8];
+};
+static_assert(sizeof(WindowIndexHeader) == 64, "header layout is part of the file format");
+
+struct WindowRecord {
+    uint32_t session;       // Index into the .gimu session table
+    uint32_t offset;        // First sample of the window in the session
+    uint16_t label;         // Label table index of the .gimu
+    uint16_t participant;   // Participant table index of the .gimu
+    uint8_t split;          // WindowSplit
+    uint8_t reserved[3];
+};
+static_assert(sizeof(WindowRecord) == 16, "record layout is part of the file format");
+
+struct WindowIndexConfig {
+    int window_size = 50;          // Model input (WINDOW_SIZE)
+    int stride = 10;               // As the notebook slices
+    float validation_fraction = 0.2f;
+    float test_fraction = 0.2f;
+    uint64_t seed = 1;
+};
+
+struct WindowIndexStats {
+    int participants[kNumSplits];
+    int sessions[kNumSplits];
+    int short_sessions;           // Shorter than a window, no records
+    int dropped_augmented;        // Augmented sessions of evaluation participants
+};
+
+// Build the index records in file order. Prints the reason and returns
+// false if the dataset has no windows.
+bool BuildWindowIndex(const ImuDataset& dataset, const WindowIndexConfig& config,
+                      WindowIndexHeader* header, std::vector<WindowRecord>* records,
+                      WindowIndexStats* stats);
+
+bool WriteWindowIndex(const char* path, const WindowIndexHeader& header,
+                      const std::vector<WindowRecord>& records);
+
+// ============================================================================
+// READER
+// ============================================================================
+
+// Read-only, memory-mapped view of a .gwix file
+class WindowIndex {
+public:
+    WindowIndex();
+    ~WindowIndex();
+
+    WindowIndex(const WindowIndex&) = delete;
+    WindowIndex& operator=(const WindowIndex&) = delete;
+
+    // Map and validate an index; with dataset, also check that it was built
+    // from that dataset and that every window lies inside its session.
+    // Prints the reason to stderr on failure.
+    bool Open(const char* path, const ImuDataset* dataset = nullptr);
+    void Close();
+
+    const WindowIndexHeader& header() const { return *header_; }
+    int num_windows() const { return static_cast<int>(header_->num_windows); }
+    const WindowRecord& record(int i) const { return records_[i]; }
+
+    // First record and record count of one split
+    int SplitBegin(int split) const;
+    int SplitSize(int split) const { return static_cast<int>(header_->split_windows[split]); }
+
+private:
+    const uint8_t* base_;
+    size_t size_;
+    const WindowIndexHeader* header_;
+    const WindowRecord* records_;
+};
+
+#endif  // WINDOW_INDEX_H_
@@ -0,0 +1,652 @@
+/* GAINS idle mode check
+ * Runs the idle-mode parts of the firmware loop (src/main.cpp: button and
+ * recording state machine, ReadIMU, IdleMode, light sleep) over a simulated
+ * day in virtual time, against a register model of the ICM-20600
+ * (host/shim/fake_icm20600.h) driven by the real imu_provider.cpp I2C code.
+ *
+ * The day: the device rests on a table (with sensor noise and an hour of
+ * sub-threshold vibration), is turned slowly once at night (too slowly for
+ * the WOM threshold), is picked up once an hour while the user is up,
+ * records three workouts and gets two lone button presses. The same day is
+ * run without idle sleep, with INT_STATUS polling (the board: INT is not
+ * wired) and with the INT pin waking the CPU. Checked:
+ *   - IMU registers while asleep and after wake, and the ODR after wake
+ *   - sleep after IdleModeConfig::sleep_after_ms without activity, never
+ *     while recording
+ *   - every pickup during sleep wakes the device, nothing else does
+ *   - a press that wakes the device does not start a recording, workouts
+ *     record normally
+ *   - wake latency (motion onset to the first sample at full rate) within
+ *     the poll interval + one WOM sample + gyro start-up
+ *   - Preprocessor::Prime: first window after a motion wake compared with a
+ *     preprocessor that never slept, primed with the rest sample (firmware)
+ *     or the first sample after the wake, or with the stale or cleared state
+ * and the battery life of each run from the IMU model's supply current plus
+ * assumed MCU/OLED currents (kMcu*, kOled*). Returns 1 if a check fails.
+ *
+ *   host_idle
+ *   host_idle --hours 72 --verbose
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Arduino.h"
+#include "constants.h"
+#include "fake_icm20600.h"
+#include "idle_mode.h"
+#include "imu_config.h"
+#include "imu_provider.h"
+#include "model_config.h"
+#include "preprocessing.h"
+
+namespace {
+
+// Assumed supply currents (mA) for the battery estimate. The ESP32-S3 at
+// 240 MHz idling in delay() and in light sleep, one poll (light-sleep exit,
+// one-byte I2C read, re-entry) and the SSD1306 showing a few lines / off.
+constexpr double kMcuActiveMa = 40.0;
+constexpr double kMcuLightSleepMa = 0.24;
+constexpr double kPollActiveMs = 1.0;
+constexpr double kOledOnMa = 6.0;
+constexpr double kOledOffMa = 0.01;
+constexpr double kBatteryMah = 400.0;
+
+constexpr uint32_t kLoopDelayMs = 10;     // delay(10) at the end of loop()
+constexpr uint32_t kPressMs = 150;        // Button held down
+constexpr uint64_t kPickupUs = 600000;    // Pickup motion
+constexpr uint64_t kSlowTurnUs = 30000000;  // Turn under the WOM threshold
+constexpr uint32_t kIntStepUs = 1000;     // INT pin check while asleep
+constexpr uint32_t kReferenceMs = 60000;  // History of the never-slept preprocessor
+constexpr uint64_t kUsPerHour = 3600ull * 1000000ull;
+
+// ============================================================================
+// THE DAY
+// ============================================================================
+
+struct Pickup {
+    uint64_t start_us;
+    uint64_t duration_us;
+    float from_deg;  // Tilt about y before and after
+    float to_deg;
+    float lift_g;    // Peak of the lift (up, then down) halfway
+};
+
+struct Day {
+    std::vector<Pickup> pickups;   // In time order
+    std::vector<uint64_t> presses;
+    uint64_t vibration_start_us = 0;
+    uint64_t vibration_end_us = 0;
+    int workouts = 0;
+};
+
+uint32_t g_seed = 12345;
+uint32_t NextRandom() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+// Pickups at minutes 10-40 of every hour from 7 to 22 h, workouts (pickup,
+// then start/stop/idle presses) and lone presses at minute 50, so presses
+// never fall into the awake time after a pickup
+Day MakeDay(int hours) {
+    Day day;
+    const uint64_t minute = 60ull * 1000000ull;
+    float tilt = 0.0f;
+    for (int h = 0; h < hours; h++) {
+        const uint64_t hour = h * kUsPerHour;
+        const int hour_of_day = h % 24;
+        if (hour_of_day == 3) {
+            day.pickups.push_back({hour + 30 * minute, kSlowTurnUs, tilt, tilt + 25.0f, 0.0f});
+            tilt += 25.0f;
+        }
+        if (hour_of_day >= 7 && hour_of_day <= 22) {
+            const float to = (NextRandom() % 2) ? 0.0f : 10.0f + (NextRandom() % 40);
+            day.pickups.push_back({hour + 10 * minute + (NextRandom() % (30 * 60)) * 1000000ull,
+                                   kPickupUs, tilt, to, 0.25f});
+            tilt = to;
+        }
+        if (hour_of_day == 7 || hour_of_day == 12 || hour_of_day == 18) {
+            const uint64_t start = hour + 50 * minute;
+            day.pickups.push_back({start, kPickupUs, tilt, 0.0f, 0.25f});
+            tilt = 0.0f;
+            day.presses.push_back(start + 3000000);               // Start recording
+            day.presses.push_back(start + 3000000 + 3 * minute);  // Stop
+            day.presses.push_back(start + 18000000 + 3 * minute); // Back to idle
+            day.workouts++;
+        }
+        if (hour_of_day == 9 || hour_of_day == 20) day.presses.push_back(hour + 50 * minute);
+    }
+    day.vibration_start_us = 14 * kUsPerHour;
+    day.vibration_end_us = 15 * kUsPerHour;
+    return day;
+}
+
+// Repeatable noise in [-1, 1] per sample time
+float Noise(uint64_t t_us, uint32_t salt) {
+    uint32_t x = static_cast<uint32_t>(t_us / 1000) * 2654435761u ^ salt * 40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    return (x & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+void DayMotion(uint64_t t_us, float accel_g[3], float gyro_dps[3], void* context) {
+    const Day* day = static_cast<const Day*>(context);
+    float tilt_deg = 0.0f;
+    float tilt_rate_dps = 0.0f;
+    float lift_g = 0.0f;
+    for (const Pickup& pickup : day->pickups) {
+        if (t_us < pickup.start_us) break;
+        if (t_us >= pickup.start_us + pickup.duration_us) {
+            tilt_deg = pickup.to_deg;
+            continue;
+        }
+        // Raised-cosine tilt with a lift in the middle
+        const float s = static_cast<float>(t_us - pickup.start_us) / pickup.duration_us;
+        const float blend = 0.5f - 0.5f * cosf(static_cast<float>(M_PI) * s);
+        tilt_deg = pickup.from_deg + (pickup.to_deg - pickup.from_deg) * blend;
+        tilt_rate_dps = (pickup.to_deg - pickup.from_deg) * 0.5f * static_cast<float>(M_PI) *
+                        sinf(static_cast<float>(M_PI) * s) / (pickup.duration_us / 1e6f);
+        lift_g = pickup.lift_g * sinf(2.0f * static_cast<float>(M_PI) * s);
+        break;
+    }
+    const float tilt = tilt_deg * static_cast<float>(M_PI) / 180.0f;
+    accel_g[0] = sinf(tilt);
+    accel_g[1] = 0.0f;
+    accel_g[2] = cosf(tilt) + lift_g;
+    if (t_us >= day->vibration_start_us && t_us < day->vibration_end_us) {
+        accel_g[2] += 0.012f * sinf(2.0f * static_cast<float>(M_PI) * 12.0f * (t_us / 1e6f));
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        accel_g[axis] += 0.004f * Noise(t_us, axis);
+        gyro_dps[axis] = 0.05f * Noise(t_us, 3 + axis);
+    }
+    gyro_dps[1] += tilt_rate_dps;
+}
+
+// ReadIMU() of the motion at t_us, for the offline priming comparison
+void MotionSample(const Day& day, uint64_t t_us, float accel[3], float gyro[3]) {
+    DayMotion(t_us, accel, gyro, const_cast<Day*>(&day));
+    for (int axis = 0; axis < 3; axis++) {
+        accel[axis] = roundf(accel[axis] * 16384.0f) / 16384.0f;
+        gyro[axis] = roundf(gyro[axis] * 131.072f) / 131.072f;
+    }
+}
+
+bool ButtonLevel(const Day& day, uint64_t t_us) {
+    for (uint64_t press : day.presses) {
+        if (t_us >= press && t_us < press + kPressMs * 1000ull) return true;
+    }
+    return false;
+}
+
+// First press starting in (from_us, to_us], or 0
+uint64_t NextPress(const Day& day, uint64_t from_us, uint64_t to_us) {
+    for (uint64_t press : day.presses) {
+        if (press > from_us && press <= to_us) return press;
+    }
+    return 0;
+}
+
+// Pickups (not slow turns) starting in [from_us, to_us)
+int PickupsIn(const Day& day, uint64_t from_us, uint64_t to_us) {
+    int count = 0;
+    for (const Pickup& pickup : day.pickups) {
+        if (pickup.duration_us == kPickupUs && pickup.start_us >= from_us &&
+            pickup.start_us < to_us) {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+// ============================================================================
+// ONE RUN
+// ============================================================================
+
+enum WakeMode { kNoSleep, kPoll, kIntPin, kWakeModes };
+const char* const kModeNames[kWakeModes] = {"always awake", "poll INT_STATUS", "INT pin"};
+
+struct RunResult {
+    IdleModeStats stats = {};
+    int recordings = 0;
+    int transitions = 0;
+    int wake_press_recordings = 0;  // Recordings started by the press that woke it
+    int false_wakes = 0;            // Motion wakes without a pickup
+    int missed_pickups = 0;         // Pickups during sleep that did not wake it
+    int early_sleeps = 0;           // Less than sleep_after_ms after activity
+    int late_sleeps = 0;            // Much more than sleep_after_ms after activity
+    int register_errors = 0;
+    int odr_errors = 0;
+    std::vector<double> latency_ms;
+    double prime_rms[4] = {};  // Per kPrimeVariants vs never slept (g), summed
+    int prime_windows = 0;
+    double asleep_s = 0;
+    double imu_uas = 0;
+};
+
+// Register file after EnterImuWakeOnMotion / ExitImuWakeOnMotion
+int CheckRegisters(const FakeIcm20600& imu, const ImuWakeConfig& wake,
+                   const ImuFilterConfig& filter, bool asleep) {
+    struct Expected {
+        uint8_t reg, value;
+    };
+    const Expected sleeping[] = {
+        {ICM20600_Regs::PWR_MGMT_1, 0x20},
+        {ICM20600_Regs::PWR_MGMT_2, 0x07},
+        {ICM20600_Regs::INT_ENABLE, 0xE0},
+        {ICM20600_Regs::ACCEL_INTEL_CTRL, 0xC0},
+        {ICM20600_Regs::ACCEL_WOM_X_THR, wake.threshold_lsb},
+        {ICM20600_Regs::ACCEL_WOM_Y_THR, wake.threshold_lsb},
+        {ICM20600_Regs::ACCEL_WOM_Z_THR, wake.threshold_lsb},
+        {ICM20600_Regs::SMPLRT_DIV, wake.smplrt_div},
+    };
+    const Expected awake[] = {
+        {ICM20600_Regs::PWR_MGMT_1, 0x00},
+        {ICM20600_Regs::PWR_MGMT_2, 0x00},
+        {ICM20600_Regs::INT_ENABLE, 0x01},  // DATA_RDY
+        {ICM20600_Regs::ACCEL_INTEL_CTRL, 0x00},
+        {ICM20600_Regs::SMPLRT_DIV, filter.smplrt_div},
+        {ICM20600_Regs::CONFIG, filter.config},
+        {ICM20600_Regs::ACCEL_CONFIG2, filter.accel_config2},
+    };
+    const Expected* expected = asleep ? sleeping : awake;
+    const size_t count = asleep ? sizeof(sleeping) / sizeof(sleeping[0])
+                                : sizeof(awake) / sizeof(awake[0]);
+    int errors = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t value = imu.Register(expected[i].reg);
+        if (value != expected[i].value) {
+            printf("[IDLE] register 0x%02X = 0x%02X, expected 0x%02X %s\n", expected[i].reg, value,
+                   expected[i].value, asleep ? "asleep" : "after wake");
+            errors++;
+        }
+    }
+    return errors;
+}
+
+const char* const kPrimeVariants[] = {"rest sample", "first sample", "stale state",
+                                      "cleared state"};
+
+// RMS difference of the accel outputs over the first window after a wake,
+// per kPrimeVariants, against a preprocessor that saw every sample
+void ComparePriming(const Day& day, const Preprocessor& stale, const float* rest_accel,
+                    const float* rest_gyro, uint64_t first_us, RunResult* result) {
+    const uint64_t period_us = SAMPLE_PERIOD_MS * 1000ull;
+    float accel[3];
+    float gyro[3];
+    float out[NUM_IMU_CHANNELS];
+    Preprocessor reference = stale;
+    reference.Reset();
+    for (uint64_t i = kReferenceMs / SAMPLE_PERIOD_MS; i > 0; i--) {
+        MotionSample(day, first_us - i * period_us, accel, gyro);
+        reference.ProcessSample(accel, gyro, out);
+    }
+
+    Preprocessor variants[4] = {stale, stale, stale, stale};
+    variants[0].Reset();
+    variants[0].Prime(rest_accel, rest_gyro);
+    MotionSample(day, first_us, accel, gyro);
+    variants[1].Reset();
+    variants[1].Prime(accel, gyro);
+    variants[3].Reset();
+    double sum_sq[4] = {};
+    for (int t = 0; t < WINDOW_SIZE; t++) {
+        MotionSample(day, first_us + t * period_us, accel, gyro);
+        float expected[NUM_IMU_CHANNELS];
+        reference.ProcessSample(accel, gyro, expected);
+        for (int v = 0; v < 4; v++) {
+            variants[v].ProcessSample(accel, gyro, out);
+            for (int ch = 0; ch < ACCEL_CHANNELS; ch++) {
+                sum_sq[v] += (out[ch] - expected[ch]) * (out[ch] - expected[ch]);
+            }
+        }
+    }
+    for (int v = 0; v < 4; v++) {
+        result->prime_rms[v] += sqrt(sum_sq[v] / (WINDOW_SIZE * ACCEL_CHANNELS));
+    }
+    result->prime_windows++;
+}
+
+// The idle-mode parts of loop() over the day. Day times are relative to the
+// start of the run.
+bool RunDay(const Day& day_in, int hours, WakeMode mode, const IdleModeConfig& config,
+            RunResult* result) {
+    const uint64_t start_us = HostClockUs();
+    const uint64_t end_us = start_us + hours * kUsPerHour;
+    Day day = day_in;
+    for (Pickup& pickup : day.pickups) pickup.start_us += start_us;
+    for (uint64_t& press : day.presses) press += start_us;
+    day.vibration_start_us += start_us;
+    day.vibration_end_us += start_us;
+
+    FakeIcm20600 imu;
+    imu.SetMotion(DayMotion, &day);
+    HostI2cAttach(kIMU_Address, &imu);
+    if (!SetupIMU()) return false;
+    const ImuFilterConfig filter = ModelImuFilterConfig();
+    if (!ConfigureImuFilter(filter)) return false;
+
+    Preprocessor preprocessor;
+    preprocessor.SetHardwareLowpass(true);
+    Preprocessor stale;  // State at the last sleep
+    IdleMode idle(config);
+    idle.Reset(millis(), &filter);
+
+    enum { IDLE, RECORDING, DISPLAYING_RESULT } state = IDLE;
+    bool last_button = false;
+    bool first_sample = false;  // First sample after a wake pending
+    float rest_accel[3];
+    float rest_gyro[3];
+    uint64_t last_event_us = HostClockUs();  // Press, recording, wake or pickup end
+    uint64_t sleep_us = 0;
+    uint64_t wake_us = 0;
+    uint64_t wake_onset_us = 0;  // Start of the pickup that woke it, 0 = none
+    uint64_t wake_samples = 0;
+    bool odr_checked = true;
+
+    while (HostClockUs() < end_us) {
+        uint64_t now = HostClockUs();
+        if (idle.Asleep()) {
+            // IdleSleepStep(): light sleep until a button change, the INT pin
+            // or the poll timer
+            uint64_t wake_at = mode == kIntPin ? end_us : now + config.poll_interval_ms * 1000ull;
+            const uint64_t press = NextPress(day, now, wake_at);
+            bool gpio_wake = press != 0;
+            if (gpio_wake) wake_at = press;
+            if (mode == kIntPin) {
+                while (HostClockUs() + kIntStepUs < wake_at) {
+                    HostClockAdvanceUs(kIntStepUs);
+                    imu.Update();
+                    if (imu.IntPin()) {
+                        wake_at = HostClockUs();
+                        gpio_wake = true;
+                        break;
+                    }
+                }
+            }
+            if (wake_at > end_us) wake_at = end_us;
+            if (wake_at > HostClockUs()) HostClockAdvanceUs(wake_at - HostClockUs());
+            now = HostClockUs();
+            if (now >= end_us) break;
+
+            // A GPIO wake is the button unless INT_STATUS shows motion
+            const uint32_t motion_wakes = idle.stats().motion_wakes;
+            if (!idle.Poll(millis(), gpio_wake)) continue;
+
+            // WakeFromIdle()
+            idle.RestSample(rest_accel, rest_gyro);
+            preprocessor.Reset();
+            preprocessor.Prime(rest_accel, rest_gyro);
+            first_sample = true;
+            result->asleep_s += (now - sleep_us) / 1e6;
+            result->register_errors += CheckRegisters(imu, idle.wake_config(), filter, false);
+            // The pickup that woke it: the last one since the sleep (INT_STATUS
+            // stays latched until the poll)
+            wake_onset_us = 0;
+            for (const Pickup& pickup : day.pickups) {
+                if (pickup.duration_us == kPickupUs && pickup.start_us >= sleep_us &&
+                    pickup.start_us <= now) {
+                    wake_onset_us = pickup.start_us;
+                }
+            }
+            const bool motion = idle.stats().motion_wakes > motion_wakes;
+            if (motion && wake_onset_us == 0) result->false_wakes++;
+            result->missed_pickups += PickupsIn(day, sleep_us, now) - (motion ? 1 : 0);
+            if (!motion) wake_onset_us = 0;
+            last_button = ButtonLevel(day, HostClockUs());
+            wake_us = HostClockUs();
+            last_event_us = now;
+            wake_samples = imu.samples();
+            odr_checked = false;
+            continue;
+        }
+
+        // Awake: loop() with the button/recording state machine
+        const bool button = ButtonLevel(day, now);
+        if (button != last_button) {
+            last_button = button;
+            if (button) {
+                idle.OnActivity(millis());
+                last_event_us = now;
+                result->transitions++;
+                if (state == IDLE) {
+                    state = RECORDING;
+                    result->recordings++;
+                    if (now - wake_us < 1000000) result->wake_press_recordings++;
+                } else if (state == RECORDING) {
+                    state = DISPLAYING_RESULT;
+                } else {
+                    state = IDLE;
+                }
+            }
+        }
+
+        float accel[3];
+        float gyro[3];
+        if (ReadIMU(accel, gyro)) {
+            if (first_sample && wake_onset_us != 0) {
+                result->latency_ms.push_back((now - wake_onset_us) / 1e3);
+                ComparePriming(day, stale, rest_accel, rest_gyro, now, result);
+            }
+            first_sample = false;
+            float processed[NUM_IMU_CHANNELS];
+            preprocessor.ProcessSample(accel, gyro, processed);
+            idle.OnSample(millis(), accel, gyro);
+        }
+        if (state == RECORDING) {
+            idle.OnActivity(millis());
+            last_event_us = now;
+        }
+        // Full-rate ODR again one second after the wake
+        if (!odr_checked && now - wake_us >= 1000000) {
+            const uint64_t samples = imu.samples() - wake_samples;
+            const uint64_t expected = (now - wake_us) / (SAMPLE_PERIOD_MS * 1000ull);
+            if (samples + 1 < expected || samples > expected + 1) result->odr_errors++;
+            odr_checked = true;
+        }
+
+        if (mode != kNoSleep && state != RECORDING && idle.ShouldSleep(millis())) {
+            stale = preprocessor;
+            if (idle.Sleep(millis())) {
+                sleep_us = HostClockUs();
+                result->register_errors += CheckRegisters(imu, idle.wake_config(), filter, true);
+                // Motion keeps it awake, so the last event may be a pickup
+                uint64_t last_us = last_event_us;
+                for (const Pickup& pickup : day.pickups) {
+                    const uint64_t end = pickup.start_us + pickup.duration_us;
+                    if (pickup.duration_us == kPickupUs && pickup.start_us < sleep_us &&
+                        end > last_us) {
+                        last_us = end;
+                    }
+                }
+                const uint64_t quiet_ms = (sleep_us - last_event_us) / 1000;
+                const uint64_t after_motion_ms = (sleep_us - last_us) / 1000;
+                if (quiet_ms < config.sleep_after_ms) result->early_sleeps++;
+                if (after_motion_ms > config.sleep_after_ms + 1000) result->late_sleeps++;
+                continue;
+            }
+        }
+
+        delay(kLoopDelayMs);
+    }
+
+    if (idle.Asleep()) {
+        result->asleep_s += (end_us - sleep_us) / 1e6;
+        // Pickups late in the last sleep still have to wake it
+        for (const Pickup& pickup : day.pickups) {
+            if (pickup.duration_us == kPickupUs && pickup.start_us >= sleep_us &&
+                pickup.start_us + kPickupUs + 1000000 < end_us) {
+                result->missed_pickups++;
+            }
+        }
+    }
+    result->stats = idle.stats();
+    result->imu_uas = imu.charge_uas();
+    HostI2cAttach(kIMU_Address, nullptr);
+    return true;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+// Average supply current (mA) of a run from its awake/asleep time and polls
+double AverageCurrentMa(const RunResult& result, int hours, WakeMode mode) {
+    const double total_s = hours * 3600.0;
+    const double awake_s = total_s - result.asleep_s;
+    double charge_mas = awake_s * (kMcuActiveMa + kOledOnMa) +
+                        result.asleep_s * (kMcuLightSleepMa + kOledOffMa) +
+                        result.imu_uas / 1000.0;
+    if (mode == kPoll) {
+        charge_mas += result.stats.polls * kPollActiveMs / 1000.0 * kMcuActiveMa;
+    }
+    return charge_mas / total_s;
+}
+
+int g_failures = 0;
+void Check(bool ok, const char* mode, const char* what) {
+    if (ok) return;
+    printf("[IDLE] FAIL (%s): %s\n", mode, what);
+    g_failures++;
+}
+
+void PrintUsage() {
+    printf("Usage: host_idle [options]\n");
+    printf("  --hours N        simulated time (default 24)\n");
+    printf("  --threshold G    wake-on-motion threshold in g (default %.3f)\n",
+           IdleModeConfig().wom_threshold_g);
+    printf("  --poll-ms N      light sleep between INT_STATUS polls (default %u)\n",
+           static_cast<unsigned>(IdleModeConfig().poll_interval_ms));
+    printf("  --verbose        show the firmware's serial output\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int hours = 24;
+    IdleModeConfig config;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--hours") == 0 && value) {
+            hours = atoi(argv[++i]);
+        } else if (strcmp(arg, "--threshold") == 0 && value) {
+            config.wom_threshold_g = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--poll-ms") == 0 && value) {
+            config.poll_interval_ms = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (hours < 1 || config.poll_interval_ms < 1) {
+        PrintUsage();
+        return 1;
+    }
+
+    HostClockSetVirtual(true);
+    Serial.muted = !verbose;
+    const Day day = MakeDay(hours);
+    const ImuWakeConfig wake = ImuWakeConfigFor(config.wom_threshold_g, config.wom_period_ms);
+    printf("[IDLE] %d h: %zu pickups, %d workouts, %zu presses. Sleep after %u ms, "
+           "WOM %.3f g (%u LSB) at %.1f Hz, poll every %u ms\n",
+           hours, day.pickups.size(), day.workouts, day.presses.size(),
+           static_cast<unsigned>(config.sleep_after_ms), wake.threshold_g, wake.threshold_lsb,
+           wake.odr_hz, static_cast<unsigned>(config.poll_interval_ms));
+
+    printf("%-16s %6s %7s %7s %7s %8s %22s %9s %9s\n", "mode", "sleeps", "motion", "button",
+           "asleep", "polls", "wake latency ms", "avg mA", "battery");
+    double awake_ma = 0;
+    RunResult poll_result;
+    for (int m = 0; m < kWakeModes; m++) {
+        const WakeMode mode = static_cast<WakeMode>(m);
+        RunResult result;
+        if (!RunDay(day, hours, mode, config, &result)) {
+            fprintf(stderr, "[IDLE] ERROR: IMU setup failed on the fake IMU\n");
+            return 1;
+        }
+        const double ma = AverageCurrentMa(result, hours, mode);
+        if (mode == kNoSleep) awake_ma = ma;
+        if (mode == kPoll) poll_result = result;
+
+        double min_ms = 0, max_ms = 0, mean_ms = 0;
+        for (size_t i = 0; i < result.latency_ms.size(); i++) {
+            const double ms = result.latency_ms[i];
+            if (i == 0 || ms < min_ms) min_ms = ms;
+            if (i == 0 || ms > max_ms) max_ms = ms;
+            mean_ms += ms / result.latency_ms.size();
+        }
+        char latency[32] = "-";
+        if (!result.latency_ms.empty()) {
+            snprintf(latency, sizeof(latency), "%.0f / %.0f / %.0f", min_ms, mean_ms, max_ms);
+        }
+        char battery[32];
+        snprintf(battery, sizeof(battery), "%.1f d", kBatteryMah / ma / 24.0);
+        printf("%-16s %6u %7u %7u %6.1f%% %8u %22s %9.2f %9s\n", kModeNames[m],
+               static_cast<unsigned>(result.stats.sleeps),
+               static_cast<unsigned>(result.stats.motion_wakes),
+               static_cast<unsigned>(result.stats.button_wakes),
+               100.0 * result.asleep_s / (hours * 3600.0),
+               static_cast<unsigned>(result.stats.polls), latency, ma, battery);
+
+        const char* name = kModeNames[m];
+        Check(result.stats.errors == 0, name, "I2C errors");
+        Check(result.register_errors == 0, name, "IMU registers");
+        Check(result.odr_errors == 0, name, "ODR after wake");
+        if (mode == kNoSleep) {
+            // Every press is a state change
+            Check(result.transitions == static_cast<int>(day.presses.size()), name,
+                  "presses handled as state changes");
+            Check(result.stats.sleeps == 0, name, "slept");
+            continue;
+        }
+        // Lone presses only wake it
+        Check(result.recordings == day.workouts, name, "workouts recorded");
+        Check(result.transitions == 3 * day.workouts, name, "presses handled as state changes");
+        Check(result.wake_press_recordings == 0, name, "a wake press started a recording");
+        Check(result.stats.sleeps > 0, name, "never slept");
+        Check(result.false_wakes == 0, name, "motion wake without a pickup");
+        Check(result.missed_pickups == 0, name, "pickup during sleep did not wake it");
+        Check(result.early_sleeps == 0, name, "slept before sleep_after_ms without activity");
+        Check(result.late_sleeps == 0, name, "did not sleep sleep_after_ms after activity");
+        // Pickup -> WOM sample -> (poll) -> gyro start-up -> next loop()
+        const double bound_ms = (mode == kPoll ? config.poll_interval_ms : 0) +
+                                2.0 * config.wom_period_ms + IMU_GYRO_STARTUP_MS + 2 * kLoopDelayMs;
+        Check(!result.latency_ms.empty() && max_ms <= bound_ms, name, "wake latency");
+    }
+    printf("[IDLE] battery: %.0f mAh; assumed MCU %.0f mA awake / %.2f mA light sleep, OLED "
+           "%.0f mA, %.0f ms per poll; IMU from the register model. Idle sleep: %.1fx "
+           "(poll), see host/README.md\n",
+           kBatteryMah, kMcuActiveMa, kMcuLightSleepMa, kOledOnMa, kPollActiveMs,
+           awake_ma / AverageCurrentMa(poll_result, hours, kPoll));
+
+    // Filter state at the first sample after a motion wake
+    if (poll_result.prime_windows > 0) {
+        const double n = poll_result.prime_windows;
+        printf("[IDLE] first window after %d motion wakes (poll), accel RMS vs never slept:",
+               poll_result.prime_windows);
+        for (int v = 0; v < 4; v++) {
+            printf("%s %s %.4f g", v ? "," : "", kPrimeVariants[v], poll_result.prime_rms[v] / n);
+        }
+        printf("\n");
+        for (int v = 1; v < 4; v++) {
+            Check(poll_result.prime_rms[0] < poll_result.prime_rms[v], kModeNames[kPoll],
+                  "priming with the rest sample is not closest to never having slept");
+        }
+    }
+
+    if (g_failures > 0) {
+        printf("[IDLE] %d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("[IDLE] all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,550 @@
+/* GAINS linker map report
+ * Reads the GNU ld map of a firmware build (env xiao_release writes
+ * .pio/build/xiao_release/firmware.map) and reports how full each memory
+ * segment is, every output section with its placement, and the largest
+ * symbols. The hot path (GAINS_HOT / ARM_NN_HOT, see include/hot_path.h) is
+ * checked symbol by symbol: anything on it that landed in flash code runs
+ * through the flash cache and is flagged, and the exit code is 2.
+ *
+ *   host_linkmap --map firmware.map [--top 25] [--hot NAME]...
+ *
+ * Placement comes from the output section name as the ESP-IDF linker
+ * scripts use it (.iram0.*, .dram0.*, .flash.text, .flash.rodata, .rtc.*),
+ * and from the ESP32-S3 / ESP32 address map otherwise. Only global symbols
+ * have a line in the map; an input section without one (a static function
+ * or a -ffunction-sections piece) is reported under its section name.
+ */
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Default hot path: the leaf loops, not their dispatchers. The per-sample
+// preprocessing filters, the fused batch norm loop and the int8 kernels that
+// run on every inference (the no-DSP CMSIS-NN path the ESP32 takes).
+const char* const kDefaultHot[] = {
+    "Preprocessor::ProcessSample",
+    "Preprocessor::ApplyMedianFilter",
+    "Preprocessor::ApplyButterworthFilter",
+    "Preprocessor::ApplyBiquad",
+    "ChannelAffineEval",
+    "arm_convolve_s8",
+    "arm_nn_mat_mult_kernel_s8_s16",
+    "arm_q7_to_q15_with_offset",
+    "arm_depthwise_conv_s8",
+    "arm_nn_vec_mat_mult_t_s8",
+};
+
+constexpr size_t kMaxNameLength = 100;   // Template names in the top list
+
+enum Placement {
+    kIram,
+    kDram,
+    kFlashCode,
+    kFlashData,
+    kRtc,
+    kPsram,
+    kOther,
+    kNumPlacements,
+};
+
+const char* const kPlacementNames[kNumPlacements] = {
+    "IRAM", "DRAM", "flash code", "flash data", "RTC", "PSRAM", "other",
+};
+
+struct MemoryRegion {
+    std::string name;
+    uint64_t origin;
+    uint64_t length;
+};
+
+struct OutputSection {
+    std::string name;
+    uint64_t address;
+    uint64_t size;
+    Placement placement;
+};
+
+// A global symbol sized up to the next one, or an input section without any
+struct Piece {
+    std::string name;       // Demangled
+    std::string section;    // Input section
+    std::string object;
+    uint64_t address;
+    uint64_t size;
+    int output;             // Index into the output sections
+    bool named;             // From a symbol line, not the section name
+};
+
+struct InputSection {
+    std::string name;
+    std::string object;
+    uint64_t address = 0;
+    uint64_t size = 0;
+    int output = -1;
+    std::vector<std::pair<uint64_t, std::string>> symbols;
+};
+
+void PrintUsage() {
+    printf("Usage: host_linkmap --map FILE.map [options]\n");
+    printf("  --top N           largest symbols to list (default 25, 0 = none)\n");
+    printf("  --hot NAME        also check NAME (as Class::Method, no parameters or\n");
+    printf("                    template arguments); repeatable\n");
+    printf("  --only-hot        check only the --hot names, not the default hot path\n");
+}
+
+bool StartsWith(const std::string& s, const char* prefix) {
+    return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+std::string Trim(const std::string& s) {
+    const size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    const size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string Demangle(const std::string& name) {
+    if (!StartsWith(name, "_Z")) return name;
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+    if (status != 0 || demangled == nullptr) return name;
+    std::string result(demangled);
+    free(demangled);
+    return result;
+}
+
+// "ns::Class<T, 3>::Method(float const*) const" -> "ns::Class::Method", for
+// matching against the hot list
+std::string BareName(std::string name) {
+    std::string trimmed = Trim(name);
+    if (trimmed.size() > 6 && trimmed.compare(trimmed.size() - 6, 6, " const") == 0) {
+        trimmed.resize(trimmed.size() - 6);
+    }
+    if (!trimmed.empty() && trimmed.back() == ')') {
+        int depth = 0;
+        for (size_t i = trimmed.size(); i-- > 0;) {
+            if (trimmed[i] == ')') depth++;
+            if (trimmed[i] == '(' && --depth == 0) {
+                trimmed.resize(i);
+                break;
+            }
+        }
+    }
+    std::string bare;
+    int depth = 0;
+    for (char c : trimmed) {
+        if (c == '<') depth++;
+        if (depth == 0) bare += c;
+        if (c == '>' && depth > 0) depth--;
+    }
+    const char* kAnonymous = "(anonymous namespace)::";
+    for (size_t at; (at = bare.find(kAnonymous)) != std::string::npos;) {
+        bare.erase(at, strlen(kAnonymous));
+    }
+    return bare;
+}
+
+// Function or object name from a -ffunction-sections / -fdata-sections
+// section name; empty for sections like .iram1.12 that do not carry one
+std::string NameFromSection(const std::string& section) {
+    const char* const kPrefixes[] = {
+        ".text.", ".literal.", ".rodata.", ".data.rel.ro.", ".data.", ".bss.", ".sbss.",
+        ".sdata.", ".iram1.", ".dram1.", ".rtc.text.", ".rtc.data.",
+    };
+    for (const char* prefix : kPrefixes) {
+        if (!StartsWith(section, prefix)) continue;
+        std::string rest = section.substr(strlen(prefix));
+        bool literals = StartsWith(section, ".literal.");
+        const char* kLiteralSuffix = ".literal";   // .iram1.3.literal
+        if (rest.size() > strlen(kLiteralSuffix) &&
+            rest.compare(rest.size() - strlen(kLiteralSuffix), std::string::npos,
+                         kLiteralSuffix) == 0) {
+            rest.resize(rest.size() - strlen(kLiteralSuffix));
+            literals = true;
+        }
+        // Numbered (.iram1.12) and merged constant sections (.rodata.str1.1, .rodata.cst4)
+        if (rest.empty() || rest.find_first_not_of("0123456789.") == std::string::npos ||
+            ((StartsWith(rest, "str") || StartsWith(rest, "cst")) && rest.size() > 3 &&
+             isdigit(static_cast<unsigned char>(rest[3])))) {
+            return std::string();
+        }
+        std::string name = Demangle(rest);
+        if (literals) name += " [literals]";
+        return name;
+    }
+    return std::string();
+}
+
+std::string BaseName(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool InRange(uint64_t address, uint64_t begin, uint64_t end) {
+    return address >= begin && address < end;
+}
+
+Placement Classify(const std::string& section, uint64_t address) {
+    if (StartsWith(section, ".iram0")) return kIram;
+    if (StartsWith(section, ".dram0")) return kDram;
+    if (StartsWith(section, ".flash.text") || StartsWith(section, ".flash_text")) return kFlashCode;
+    if (StartsWith(section, ".flash")) return kFlashData;
+    if (StartsWith(section, ".rtc")) return kRtc;
+    if (StartsWith(section, ".ext_ram")) return kPsram;
+    // ESP32-S3
+    if (InRange(address, 0x40370000, 0x403E0000)) return kIram;
+    if (InRange(address, 0x3FC88000, 0x3FD00000)) return kDram;
+    if (InRange(address, 0x42000000, 0x44000000)) return kFlashCode;
+    if (InRange(address, 0x3C000000, 0x3E000000)) return kFlashData;
+    if (InRange(address, 0x600FE000, 0x60100000)) return kRtc;
+    // ESP32
+    if (InRange(address, 0x40080000, 0x400A0000)) return kIram;
+    if (InRange(address, 0x3FFAE000, 0x40000000)) return kDram;
+    if (InRange(address, 0x400D0000, 0x40400000)) return kFlashCode;
+    if (InRange(address, 0x3F400000, 0x3F800000)) return kFlashData;
+    return kOther;
+}
+
+// Leading hex numbers of a map line: "0x40374000 0x1a4 file.o" -> 2 numbers,
+// rest = "file.o"
+int ParseNumbers(const std::string& line, uint64_t* numbers, int max, std::string* rest) {
+    size_t pos = 0;
+    int count = 0;
+    while (count < max) {
+        pos = line.find_first_not_of(' ', pos);
+        if (pos == std::string::npos || line.compare(pos, 2, "0x") != 0) break;
+        char* end = nullptr;
+        numbers[count++] = strtoull(line.c_str() + pos, &end, 16);
+        pos = end - line.c_str();
+    }
+    if (rest != nullptr) *rest = pos == std::string::npos ? std::string() : Trim(line.substr(pos));
+    return count;
+}
+
+class MapParser {
+public:
+    bool Parse(const char* path) {
+        FILE* file = fopen(path, "r");
+        if (file == nullptr) {
+            printf("[LINKMAP] Cannot open %s\n", path);
+            return false;
+        }
+        char buffer[4096];
+        std::string line;
+        while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+            line += buffer;
+            if (line.empty() || line.back() != '\n') continue;   // Longer than the buffer
+            line.pop_back();
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            ParseLine(line);
+            line.clear();
+        }
+        if (!line.empty()) ParseLine(line);
+        fclose(file);
+        FlushInput();
+        if (!in_script_) {
+            printf("[LINKMAP] %s has no \"Linker script and memory map\" part; not a GNU ld map?\n",
+                   path);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<MemoryRegion> regions;
+    std::vector<OutputSection> outputs;
+    std::vector<Piece> pieces;
+
+private:
+    enum Pending {
+        kPendingNone,
+        kPendingOutput,
+        kPendingInput,
+    };
+
+    void ParseLine(const std::string& line) {
+        if (line == "Memory Configuration") {
+            in_memory_ = true;
+            return;
+        }
+        if (line == "Linker script and memory map") {
+            in_memory_ = false;
+            in_script_ = true;
+            return;
+        }
+        if (in_memory_) {
+            ParseRegion(line);
+            return;
+        }
+        if (!in_script_ || line.empty()) return;
+
+        uint64_t numbers[2];
+        std::string rest;
+        if (line[0] != ' ') {
+            // Output section ".name addr size", or a script line (LOAD, OUTPUT, /DISCARD/)
+            FlushInput();
+            pending_ = kPendingNone;
+            output_ = -1;
+            if (line[0] != '.') return;
+            const size_t space = line.find(' ');
+            const std::string name = line.substr(0, space);
+            if (space == std::string::npos) {
+                pending_ = kPendingOutput;
+                pending_name_ = name;
+                return;
+            }
+            if (ParseNumbers(line.substr(space), numbers, 2, nullptr) == 2) {
+                AddOutput(name, numbers[0], numbers[1]);
+            }
+            return;
+        }
+
+        if (line.size() > 1 && line[1] != ' ') {
+            // Input section " .name addr size object", a pattern " *(...)" or " *fill*"
+            FlushInput();
+            pending_ = kPendingNone;
+            if (output_ < 0 || line[1] == '*') return;
+            const std::string body = line.substr(1);
+            const size_t space = body.find(' ');
+            const std::string name = body.substr(0, space);
+            if (space == std::string::npos) {
+                pending_ = kPendingInput;
+                pending_name_ = name;
+                return;
+            }
+            if (ParseNumbers(body.substr(space), numbers, 2, &rest) == 2) {
+                StartInput(name, numbers[0], numbers[1], rest);
+            }
+            return;
+        }
+
+        // Indented: continuation of a wrapped header, or a symbol "addr name"
+        const int count = ParseNumbers(line, numbers, 2, &rest);
+        if (count == 2 && pending_ == kPendingOutput) {
+            AddOutput(pending_name_, numbers[0], numbers[1]);
+        } else if (count == 2 && pending_ == kPendingInput) {
+            StartInput(pending_name_, numbers[0], numbers[1], rest);
+        } else if (count == 1 && input_.size > 0 && !rest.empty() &&
+                   rest.find('=') == std::string::npos && !StartsWith(rest, "PROVIDE") &&
+                   !StartsWith(rest, "ASSERT") && InRange(numbers[0], input_.address,
+                                                          input_.address + input_.size)) {
+            input_.symbols.emplace_back(numbers[0], rest);
+        }
+        pending_ = kPendingNone;
+    }
+
+    // "iram0_0_seg      0x40370000 0x50000 xr"
+    void ParseRegion(const std::string& line) {
+        const size_t space = line.find(' ');
+        if (space == std::string::npos || line[0] == ' ' || StartsWith(line, "Name") ||
+            StartsWith(line, "*default*")) {
+            return;
+        }
+        uint64_t numbers[2];
+        if (ParseNumbers(line.substr(space), numbers, 2, nullptr) == 2) {
+            regions.push_back({line.substr(0, space), numbers[0], numbers[1]});
+        }
+    }
+
+    void AddOutput(const std::string& name, uint64_t address, uint64_t size) {
+        // Address 0: not loaded (.debug_*, .comment, .xtensa.info, ...)
+        if (address == 0) return;
+        outputs.push_back({name, address, size, Classify(name, address)});
+        output_ = static_cast<int>(outputs.size()) - 1;
+    }
+
+    void StartInput(const std::string& name, uint64_t address, uint64_t size,
+                    const std::string& object) {
+        if (output_ < 0) return;
+        input_ = InputSection();
+        input_.name = name;
+        input_.object = object;
+        input_.address = address;
+        input_.size = size;
+        input_.output = output_;
+    }
+
+    void FlushInput() {
+        if (input_.size == 0) {
+            input_ = InputSection();
+            return;
+        }
+        const uint64_t end = input_.address + input_.size;
+        if (input_.symbols.empty()) {
+            std::string name = NameFromSection(input_.name);
+            const bool named = !name.empty();
+            if (!named) name = "[" + input_.name + "]";
+            pieces.push_back({name, input_.name, input_.object, input_.address, input_.size,
+                              input_.output, named});
+        } else {
+            std::sort(input_.symbols.begin(), input_.symbols.end());
+            for (size_t i = 0; i < input_.symbols.size(); i++) {
+                const uint64_t next =
+                    i + 1 < input_.symbols.size() ? input_.symbols[i + 1].first : end;
+                pieces.push_back({Demangle(input_.symbols[i].second), input_.name, input_.object,
+                                  input_.symbols[i].first, next - input_.symbols[i].first,
+                                  input_.output, true});
+            }
+        }
+        input_ = InputSection();
+    }
+
+    bool in_memory_ = false;
+    bool in_script_ = false;
+    Pending pending_ = kPendingNone;
+    std::string pending_name_;
+    int output_ = -1;
+    InputSection input_;
+};
+
+void PrintSegments(const MapParser& map) {
+    if (map.regions.empty()) return;
+    printf("%-22s %12s %10s %10s %10s %6s\n", "segment", "origin", "length", "used", "free",
+           "used%");
+    for (const MemoryRegion& region : map.regions) {
+        uint64_t used = 0;
+        for (const OutputSection& output : map.outputs) {
+            if (InRange(output.address, region.origin, region.origin + region.length)) {
+                used += output.size;
+            }
+        }
+        const uint64_t free = used < region.length ? region.length - used : 0;
+        printf("%-22s %#12" PRIx64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %5.1f%%\n",
+               region.name.c_str(), region.origin, region.length, used, free,
+               region.length > 0 ? 100.0 * used / region.length : 0.0);
+    }
+    printf("\n");
+}
+
+void PrintSections(const MapParser& map) {
+    uint64_t totals[kNumPlacements] = {};
+    printf("%-28s %12s %10s  %s\n", "section", "address", "size", "placement");
+    for (const OutputSection& output : map.outputs) {
+        if (output.size == 0) continue;
+        totals[output.placement] += output.size;
+        printf("%-28s %#12" PRIx64 " %10" PRIu64 "  %s\n", output.name.c_str(), output.address,
+               output.size, kPlacementNames[output.placement]);
+    }
+    printf("\n%-12s %10s\n", "placement", "bytes");
+    for (int p = 0; p < kNumPlacements; p++) {
+        if (totals[p] > 0) printf("%-12s %10" PRIu64 "\n", kPlacementNames[p], totals[p]);
+    }
+    printf("\n");
+}
+
+void PrintTop(const MapParser& map, int top) {
+    if (top <= 0) return;
+    std::vector<const Piece*> sorted;
+    for (const Piece& piece : map.pieces) sorted.push_back(&piece);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Piece* a, const Piece* b) { return a->size > b->size; });
+    if (static_cast<int>(sorted.size()) > top) sorted.resize(top);
+    printf("%8s  %-10s  %-20s  %s\n", "size", "placement", "section", "symbol (object)");
+    for (const Piece* piece : sorted) {
+        const OutputSection& output = map.outputs[piece->output];
+        std::string name = piece->name;
+        if (name.size() > kMaxNameLength) name = name.substr(0, kMaxNameLength - 3) + "...";
+        printf("%8" PRIu64 "  %-10s  %-20s  %s (%s)\n", piece->size,
+               kPlacementNames[output.placement], output.name.c_str(), name.c_str(),
+               BaseName(piece->object).c_str());
+    }
+    printf("\n");
+}
+
+// Returns the number of hot symbols found in flash code
+int CheckHot(const MapParser& map, const std::vector<std::string>& hot) {
+    bool esp_map = false;
+    for (const OutputSection& output : map.outputs) {
+        if (output.placement != kOther) esp_map = true;
+    }
+    if (!esp_map) {
+        printf("[LINKMAP] No ESP32 sections in this map; placement is not checked\n");
+    }
+
+    int in_flash = 0;
+    printf("%-40s %-10s %8s %12s  %s\n", "hot path", "placement", "size", "address", "status");
+    for (const std::string& name : hot) {
+        int found = 0;
+        for (const Piece& piece : map.pieces) {
+            // Literal pools follow their function's section; the check is on the code
+            if (!piece.named || BareName(piece.name) != name) continue;
+            const Placement placement = map.outputs[piece.output].placement;
+            if (placement != kIram && placement != kFlashCode && esp_map) continue;
+            found++;
+            const char* status = "ok";
+            if (placement == kFlashCode) {
+                status = "IN FLASH";
+                in_flash++;
+            } else if (!esp_map) {
+                status = "-";
+            }
+            printf("%-40s %-10s %8" PRIu64 " %#12" PRIx64 "  %s\n", name.c_str(),
+                   kPlacementNames[placement], piece.size, piece.address, status);
+        }
+        if (found == 0) {
+            printf("%-40s %-10s %8s %12s  %s\n", name.c_str(), "-", "-", "-",
+                   "not found (inlined or not linked)");
+        }
+    }
+    printf("\n");
+    return in_flash;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* map_path = nullptr;
+    int top = 25;
+    bool only_hot = false;
+    std::vector<std::string> hot;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--map") == 0 && value) {
+            map_path = argv[++i];
+        } else if (strcmp(arg, "--top") == 0 && value) {
+            top = atoi(argv[++i]);
+        } else if (strcmp(arg, "--hot") == 0 && value) {
+            hot.push_back(argv[++i]);
+        } else if (strcmp(arg, "--only-hot") == 0) {
+            only_hot = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (map_path == nullptr) {
+        PrintUsage();
+        return 1;
+    }
+    if (!only_hot) hot.insert(hot.begin(), std::begin(kDefaultHot), std::end(kDefaultHot));
+
+    MapParser map;
+    if (!map.Parse(map_path)) return 1;
+    uint64_t mapped = 0;
+    for (const Piece& piece : map.pieces) mapped += piece.size;
+    printf("[LINKMAP] %s: %zu memory segments, %zu output sections, %zu symbols and pieces "
+           "(%" PRIu64 " bytes)\n\n",
+           map_path, map.regions.size(), map.outputs.size(), map.pieces.size(), mapped);
+
+    PrintSegments(map);
+    PrintSections(map);
+    PrintTop(map, top);
+    const int in_flash = CheckHot(map, hot);
+    if (in_flash > 0) {
+        printf("[LINKMAP] %d hot symbol(s) run from flash: build with -DGAINS_HOT_IRAM "
+               "(env xiao_release) or mark them GAINS_HOT\n",
+               in_flash);
+        return 2;
+    }
+    return 0;
+}
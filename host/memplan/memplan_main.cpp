@@ -0,0 +1,244 @@
+/* GAINS memory plan report
+ * Allocates every model twice, once with in-place aliasing disabled and once
+ * with it enabled (MicroAllocator::SetInPlaceAliasing), and prints the arena
+ * each plan needs. Both interpreters are run on the same random inputs and
+ * their outputs have to match bit for bit.
+ *
+ * Without arguments the pushup and magic wand models (as flashed and after
+ * graph fusion) and the example models bundled with the TFLM library are
+ * reported. --model adds a .tflite file or a C array source (xxd -i style,
+ * like the *_model_data.cpp files).
+ *
+ *   host_memplan
+ *   host_memplan --model model.tflite --model other_model_data.cpp
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "fused_ops.h"
+#include "graph_fusion.h"
+#include "magic_wand_model_data.h"
+#include "pushup_model_data.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 512 * 1024;  // Fits person_detection
+constexpr int kCheckInputs = 8;            // Random inputs compared per model
+
+// Example models of the bundled TFLM library, relative to the project root
+constexpr const char* kExampleModels[][2] = {
+    {"hello_world", "magic_wand/lib/Arduino_TensorFlowLite/examples/hello_world/model.cpp"},
+    {"micro_speech",
+     "magic_wand/lib/Arduino_TensorFlowLite/examples/micro_speech/micro_features_model.cpp"},
+    {"person_detection",
+     "magic_wand/lib/Arduino_TensorFlowLite/examples/person_detection/"
+     "person_detect_model_data.cpp"},
+    {"magic_wand_example",
+     "magic_wand/lib/Arduino_TensorFlowLite/examples/magic_wand/magic_wand_model_data.cpp"},
+};
+
+struct ModelEntry {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+void PrintUsage() {
+    printf("Usage: host_memplan [options]\n");
+    printf("  --model FILE     also report FILE (.tflite or a C array .cpp/.cc)\n");
+    printf("  --no-builtin     skip the pushup, magic wand and example models\n");
+}
+
+bool EndsWith(const std::string& s, const char* suffix) {
+    const size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Binary .tflite, or the 0x.. bytes between the first "= {" and "}" of a
+// C array source
+bool LoadModel(const std::string& path, std::vector<uint8_t>* data) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "[MEMPLAN] ERROR: cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::string contents;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) contents.append(buffer, n);
+    fclose(f);
+
+    data->clear();
+    if (!EndsWith(path, ".cpp") && !EndsWith(path, ".cc") && !EndsWith(path, ".c")) {
+        data->assign(contents.begin(), contents.end());
+        return !data->empty();
+    }
+    size_t pos = contents.find("= {");
+    const size_t end = contents.find('}', pos);
+    if (pos == std::string::npos || end == std::string::npos) {
+        fprintf(stderr, "[MEMPLAN] ERROR: no array initializer in %s\n", path.c_str());
+        return false;
+    }
+    while ((pos = contents.find("0x", pos)) != std::string::npos && pos < end) {
+        data->push_back(static_cast<uint8_t>(strtoul(contents.c_str() + pos, nullptr, 16)));
+        pos += 2;
+    }
+    if (data->empty()) {
+        fprintf(stderr, "[MEMPLAN] ERROR: empty array in %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Random input in a range that keeps float models finite
+void FillInput(TfLiteTensor* tensor, uint32_t* state) {
+    if (tensor->type == kTfLiteFloat32) {
+        float* values = tensor->data.f;
+        for (size_t i = 0; i < tensor->bytes / sizeof(float); i++) {
+            *state = *state * 1664525u + 1013904223u;
+            values[i] = (*state >> 8) / 8388608.0f - 1.0f;
+        }
+        return;
+    }
+    for (size_t i = 0; i < tensor->bytes; i++) {
+        *state = *state * 1664525u + 1013904223u;
+        tensor->data.uint8[i] = static_cast<uint8_t>(*state >> 24);
+    }
+}
+
+class PlannedInterpreter {
+public:
+    PlannedInterpreter(const ModelEntry& model, const tflite::MicroOpResolver& resolver,
+                       bool in_place)
+        : arena_(kArenaSize) {
+        allocator_ = tflite::MicroAllocator::Create(arena_.data(), arena_.size());
+        allocator_->SetInPlaceAliasing(in_place);
+        interpreter_ = new tflite::MicroInterpreter(tflite::GetModel(model.data.data()), resolver,
+                                                    allocator_);
+        ok_ = interpreter_->AllocateTensors() == kTfLiteOk;
+    }
+    ~PlannedInterpreter() { delete interpreter_; }
+
+    bool ok() const { return ok_; }
+    tflite::MicroInterpreter* interpreter() { return interpreter_; }
+    size_t aliased_bytes() const { return allocator_->in_place_aliased_bytes(); }
+
+private:
+    std::vector<uint8_t> arena_;
+    tflite::MicroAllocator* allocator_;  // Lives in the arena
+    tflite::MicroInterpreter* interpreter_;
+    bool ok_;
+};
+
+// Same random inputs into both plans, every output compared byte for byte
+bool OutputsMatch(tflite::MicroInterpreter* planned, tflite::MicroInterpreter* in_place) {
+    uint32_t state = 12345;
+    for (int n = 0; n < kCheckInputs; n++) {
+        const uint32_t input_state = state;
+        for (size_t i = 0; i < planned->inputs_size(); i++) FillInput(planned->input(i), &state);
+        state = input_state;
+        for (size_t i = 0; i < in_place->inputs_size(); i++) FillInput(in_place->input(i), &state);
+        if (planned->Invoke() != kTfLiteOk || in_place->Invoke() != kTfLiteOk) return false;
+        for (size_t i = 0; i < planned->outputs_size(); i++) {
+            const TfLiteTensor* a = planned->output(i);
+            const TfLiteTensor* b = in_place->output(i);
+            if (a->bytes != b->bytes || memcmp(a->data.raw, b->data.raw, a->bytes) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Report(const ModelEntry& model, const tflite::MicroOpResolver& resolver) {
+    PlannedInterpreter planned(model, resolver, false);
+    PlannedInterpreter in_place(model, resolver, true);
+    if (!planned.ok() || !in_place.ok()) {
+        fprintf(stderr, "[MEMPLAN] ERROR: %s: tensor allocation failed\n", model.name.c_str());
+        return false;
+    }
+    if (!OutputsMatch(planned.interpreter(), in_place.interpreter())) {
+        fprintf(stderr, "[MEMPLAN] ERROR: %s: in-place plan changes the outputs\n",
+                model.name.c_str());
+        return false;
+    }
+    const size_t before = planned.interpreter()->arena_used_bytes();
+    const size_t after = in_place.interpreter()->arena_used_bytes();
+    const size_t ops = tflite::GetModel(model.data.data())->subgraphs()->Get(0)->operators()->size();
+    const long long saved = static_cast<long long>(before) - static_cast<long long>(after);
+    printf("%-22s %5zu %10zu %10zu %8lld %6.1f%% %9zu\n", model.name.c_str(), ops, before, after,
+           saved, before ? 100.0 * saved / before : 0.0, in_place.aliased_bytes());
+    return true;
+}
+
+void AddFused(const ModelEntry& model, std::vector<ModelEntry>* models) {
+    ModelEntry fused;
+    GraphFusionReport report;
+    fused.name = model.name + " (fused)";
+    if (!FuseModel(model.data.data(), &fused.data, &report)) {
+        fprintf(stderr, "[MEMPLAN] %s: fusion not supported, skipped\n", model.name.c_str());
+        return;
+    }
+    models->push_back(fused);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> extra_paths;
+    bool builtin = true;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--model") == 0 && value) {
+            extra_paths.push_back(argv[++i]);
+        } else if (strcmp(arg, "--no-builtin") == 0) {
+            builtin = false;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<ModelEntry> models;
+    if (builtin) {
+        ModelEntry pushup{"pushup", std::vector<uint8_t>(
+                                        g_pushup_model_data,
+                                        g_pushup_model_data + g_pushup_model_data_len)};
+        ModelEntry wand{"magic_wand", std::vector<uint8_t>(
+                                          g_magic_wand_model_data,
+                                          g_magic_wand_model_data + g_magic_wand_model_data_len)};
+        models.push_back(pushup);
+        AddFused(pushup, &models);
+        models.push_back(wand);
+        AddFused(wand, &models);
+        for (const auto& example : kExampleModels) {
+            ModelEntry entry{example[0], {}};
+            if (!LoadModel(example[1], &entry.data)) {
+                fprintf(stderr, "[MEMPLAN] run from the project root to find the examples\n");
+                return 1;
+            }
+            models.push_back(entry);
+        }
+    }
+    for (const std::string& path : extra_paths) {
+        ModelEntry entry{path, {}};
+        if (!LoadModel(path, &entry.data)) return 1;
+        models.push_back(entry);
+    }
+
+    tflite::AllOpsResolver resolver;
+    AddFusedOps(resolver);
+
+    printf("[MEMPLAN] Arena bytes without / with in-place aliasing\n");
+    printf("%-22s %5s %10s %10s %8s %7s %9s\n", "model", "ops", "planned", "in-place", "saved",
+           "", "aliased");
+    bool ok = true;
+    for (const ModelEntry& model : models) ok = Report(model, resolver) && ok;
+    return ok ? 0 : 1;
+}
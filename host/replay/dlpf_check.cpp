@@ -0,0 +1,250 @@
+#include "replay/dlpf_check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench/bench.h"
+#include "imu_config.h"
+#include "model_config.h"
+#include "preprocessing.h"
+
+namespace {
+
+constexpr float kAccelLsb = 2.0f / 32768.0f;  // ReadIMU() scales
+constexpr float kGyroLsb = 250.0f / 32768.0f;
+constexpr int kTimingPasses = 5;
+
+// 2nd-order Butterworth lowpass, direct form II transposed like the Preprocessor
+struct DlpfModel {
+    float b0, b1, b2, a1, a2;
+    float w1, w2;
+
+    void Design(float cutoff_hz, float fs_hz) {
+        cutoff_hz = std::min(cutoff_hz, 0.45f * fs_hz);
+        const float k = tanf(static_cast<float>(M_PI) * cutoff_hz / fs_hz);
+        const float norm = 1.0f / (1.0f + sqrtf(2.0f) * k + k * k);
+        b0 = k * k * norm;
+        b1 = 2.0f * b0;
+        b2 = b0;
+        a1 = 2.0f * (k * k - 1.0f) * norm;
+        a2 = (1.0f - sqrtf(2.0f) * k + k * k) * norm;
+    }
+
+    // State of a filter that has seen x forever
+    void Settle(float x) {
+        w1 = x - b0 * x;
+        w2 = b2 * x - a2 * x;
+    }
+
+    float Apply(float x) {
+        const float y = b0 * x + w1;
+        w1 = b1 * x - a1 * y + w2;
+        w2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+// What ReadIMU() returns: the value on the register grid
+float Snap(float value, float lsb) {
+    float counts = roundf(value / lsb);
+    counts = std::max(-32768.0f, std::min(32767.0f, counts));
+    return counts * lsb;
+}
+
+// Raw samples of one session as the IMU delivers them, with or without the DLPF
+void SessionSamples(const ImuDataset& dataset, int s, const ImuFilterConfig* dlpf,
+                    std::vector<float>* samples) {
+    const uint32_t sample_count = dataset.session(s).sample_count;
+    samples->resize(static_cast<size_t>(sample_count) * NUM_CHANNELS);
+    DlpfModel filters[NUM_CHANNELS];
+    const float fs = 1000.0f / SAMPLE_PERIOD_MS;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        const float* column = dataset.Column(s, ch);
+        const float lsb = ch < 3 ? kAccelLsb : kGyroLsb;
+        if (dlpf != nullptr) {
+            filters[ch].Design(ch < 3 ? dlpf->accel_bandwidth_hz : dlpf->gyro_bandwidth_hz, fs);
+            if (sample_count > 0) filters[ch].Settle(column[0]);
+        }
+        for (uint32_t t = 0; t < sample_count; t++) {
+            const float value = dlpf != nullptr ? filters[ch].Apply(column[t]) : column[t];
+            (*samples)[t * NUM_CHANNELS + ch] = Snap(value, lsb);
+        }
+    }
+}
+
+// One pass of the dataset through the replay
+struct PathResult {
+    uint64_t windows = 0;
+    uint64_t correct = 0;
+    uint64_t agree = 0;  // Same class as the software path
+    double diff_sq[NUM_CHANNELS] = {};
+    double ref_sq[NUM_CHANNELS] = {};
+};
+
+// Replays every session. The software path (dlpf == nullptr) fills the
+// reference outputs and classes, a DLPF path is compared with them.
+bool ReplayPath(const ImuDataset& dataset, const std::vector<int>& sessions,
+                const std::vector<int>& labels, const ImuFilterConfig* dlpf, int window_stride,
+                PushupReplay* replay, std::vector<std::vector<float>>* reference_out,
+                std::vector<std::vector<int>>* reference_classes, PathResult* result) {
+    replay->SetHardwareLowpass(dlpf != nullptr);
+    std::vector<float> samples;
+    for (size_t i = 0; i < sessions.size(); i++) {
+        SessionSamples(dataset, sessions[i], dlpf, &samples);
+        std::vector<float>& ref_out = (*reference_out)[i];
+        std::vector<int>& ref_classes = (*reference_classes)[i];
+        if (dlpf == nullptr) {
+            ref_out.resize(samples.size());
+            ref_classes.clear();
+        }
+        replay->Reset();
+        size_t window = 0;
+        const size_t sample_count = samples.size() / NUM_CHANNELS;
+        for (size_t t = 0; t < sample_count; t++) {
+            float processed[NUM_CHANNELS];
+            replay->PushSample(&samples[t * NUM_CHANNELS], processed);
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                if (dlpf == nullptr) {
+                    ref_out[t * NUM_CHANNELS + ch] = processed[ch];
+                } else if (t >= WINDOW_SIZE) {
+                    // After the gravity filter transient both paths share
+                    const double ref = ref_out[t * NUM_CHANNELS + ch];
+                    result->diff_sq[ch] += (processed[ch] - ref) * (processed[ch] - ref);
+                    result->ref_sq[ch] += ref * ref;
+                }
+            }
+
+            if (t + 1 < WINDOW_SIZE || (t + 1 - WINDOW_SIZE) % window_stride != 0) continue;
+            PushupPrediction prediction;
+            if (!replay->Classify(&prediction)) return false;
+            result->windows++;
+            if (prediction.best_class == labels[i]) result->correct++;
+            if (dlpf == nullptr) {
+                ref_classes.push_back(prediction.best_class);
+            } else if (ref_classes[window] == prediction.best_class) {
+                result->agree++;
+            }
+            window++;
+        }
+    }
+    replay->SetHardwareLowpass(false);
+    return true;
+}
+
+void PrintPath(const char* name, const PathResult& result, bool reference) {
+    printf("%-16s", name);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (reference) {
+            printf(" %6s", "-");
+        } else {
+            printf(" %5.1f%%", result.ref_sq[ch] > 0
+                                   ? 100.0 * sqrt(result.diff_sq[ch] / result.ref_sq[ch])
+                                   : 0.0);
+        }
+    }
+    const double windows = result.windows ? static_cast<double>(result.windows) : 1.0;
+    printf(" %8.1f%%", 100.0 * result.correct / windows);
+    if (reference) {
+        printf(" %8s\n", "-");
+    } else {
+        printf(" %8.1f%%\n", 100.0 * result.agree / windows);
+    }
+}
+
+// Minimum over passes of the ProcessSample time per sample
+double TimeProcessSample(const std::vector<std::vector<float>>& sessions, bool hardware_lowpass) {
+    static Preprocessor preprocessor;
+    preprocessor.SetHardwareLowpass(hardware_lowpass);
+    double best_ns = 0;
+    for (int pass = 0; pass < kTimingPasses; pass++) {
+        uint64_t samples = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const std::vector<float>& session : sessions) {
+            preprocessor.Reset();
+            float out[NUM_CHANNELS];
+            for (size_t i = 0; i < session.size(); i += NUM_CHANNELS) {
+                preprocessor.ProcessSample(&session[i], &session[i + 3], out);
+                DoNotOptimize(out);
+            }
+            samples += session.size() / NUM_CHANNELS;
+        }
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start).count();
+        if (samples > 0 && (pass == 0 || ns / samples < best_ns)) best_ns = ns / samples;
+    }
+    return best_ns;
+}
+
+}  // namespace
+
+bool CheckImuDlpf(const ImuDataset& dataset, PushupReplay* replay, int window_stride) {
+    const ImuFilterConfig config = ModelImuFilterConfig();
+    printf("[DLPF] firmware: SMPLRT_DIV %u (ODR %.1f Hz), A_DLPF_CFG %u (accel %.1f Hz), "
+           "DLPF_CFG %u (gyro %.1f Hz)\n",
+           config.smplrt_div, config.odr_hz, config.accel_config2, config.accel_bandwidth_hz,
+           config.config, config.gyro_bandwidth_hz);
+
+    std::vector<int> sessions;
+    std::vector<int> labels;
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const int expected = PostureClassFromLabel(dataset.LabelName(dataset.session(s).label));
+        if (expected < 0 || dataset.session(s).sample_count < WINDOW_SIZE) continue;
+        sessions.push_back(s);
+        labels.push_back(expected);
+    }
+    std::vector<std::vector<float>> reference_out(sessions.size());
+    std::vector<std::vector<int>> reference_classes(sessions.size());
+
+    // Filtered-sample difference (RMS, relative to the software path) and
+    // window accuracy for every DLPF setting pair below Nyquist
+    printf("%-16s %6s %6s %6s %6s %6s %6s %9s %9s\n", "accel/gyro Hz", "ax", "ay", "az", "gx",
+           "gy", "gz", "accuracy", "agree");
+    PathResult software;
+    if (!ReplayPath(dataset, sessions, labels, nullptr, window_stride, replay, &reference_out,
+                    &reference_classes, &software)) {
+        return false;
+    }
+    PrintPath("software", software, true);
+    const float kRequestedHz[] = {20.0f, 10.0f, 5.0f};
+    for (float accel_hz : kRequestedHz) {
+        for (float gyro_hz : kRequestedHz) {
+            const ImuFilterConfig candidate =
+                ImuFilterConfigFor(SAMPLE_PERIOD_MS, accel_hz, gyro_hz);
+            if (candidate.accel_bandwidth_hz > candidate.odr_hz / 2 ||
+                candidate.gyro_bandwidth_hz > candidate.odr_hz / 2) {
+                continue;
+            }
+            PathResult result;
+            if (!ReplayPath(dataset, sessions, labels, &candidate, window_stride, replay,
+                            &reference_out, &reference_classes, &result)) {
+                return false;
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "%.1f/%.1f%s", candidate.accel_bandwidth_hz,
+                     candidate.gyro_bandwidth_hz,
+                     candidate.config == config.config &&
+                             candidate.accel_config2 == config.accel_config2
+                         ? " *"
+                         : "");
+            PrintPath(name, result, false);
+        }
+    }
+
+    // ProcessSample cost on the same samples
+    std::vector<std::vector<float>> software_samples(sessions.size());
+    std::vector<std::vector<float>> hardware_samples(sessions.size());
+    for (size_t i = 0; i < sessions.size(); i++) {
+        SessionSamples(dataset, sessions[i], nullptr, &software_samples[i]);
+        SessionSamples(dataset, sessions[i], &config, &hardware_samples[i]);
+    }
+    const double software_ns = TimeProcessSample(software_samples, false);
+    const double hardware_ns = TimeProcessSample(hardware_samples, true);
+    printf("[DLPF] * = firmware setting. ProcessSample %.1f ns/sample in software, "
+           "%.1f with the DLPF (%.1f%% less)\n",
+           software_ns, hardware_ns,
+           software_ns > 0 ? 100.0 * (1.0 - hardware_ns / software_ns) : 0.0);
+    return true;
+}
@@ -0,0 +1,25 @@
+/* Check for the IMU DLPF configuration (include/imu_config.h).
+ * Replays a raw dataset twice: once through the full software Preprocessor,
+ * once through a model of the ICM-20600 DLPF followed by the Preprocessor with
+ * SetHardwareLowpass(true), as the firmware runs with ENABLE_IMU_DLPF. Reports
+ * the difference of the filtered samples per channel, ProcessSample cost per
+ * sample and window accuracy on both paths.
+ *
+ * The recordings are 40 Hz samples taken with the reset-default DLPF, so the
+ * sensor's 1 kHz filter cannot be reproduced: the model is a 2nd-order
+ * Butterworth lowpass at the configured bandwidth applied to the 40 Hz stream
+ * (cutoffs at or above 0.45 fs are clamped there), in steady state from the
+ * first sample because the sensor filters continuously. It shows what the
+ * model sees in band; the aliasing the hardware filter removes is already in
+ * the recordings.
+ */
+#ifndef HOST_REPLAY_DLPF_CHECK_H_
+#define HOST_REPLAY_DLPF_CHECK_H_
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+// Returns false only on errors; the numbers are for reading
+bool CheckImuDlpf(const ImuDataset& dataset, PushupReplay* replay, int window_stride);
+
+#endif  // HOST_REPLAY_DLPF_CHECK_H_
@@ -0,0 +1,206 @@
+#include "replay/filter_op_check.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "imu_filter_op.h"
+#include "pushup_inference.h"
+#include "pushup_model_data.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "third_party/flatbuffers/include/flatbuffers/flexbuffers.h"
+
+namespace {
+
+constexpr float kAccelLsb = 2.0f / 32768.0f;   // Same as add_imu_filter_op.py
+constexpr float kGyroLsb = 250.0f / 32768.0f;
+constexpr int kArenaSize = 120 * 1024;
+
+int AddTensor(tflite::ModelT* model, tflite::SubGraphT* subgraph, const char* name,
+              tflite::TensorType type, const std::vector<int32_t>& shape) {
+    model->buffers.emplace_back(new tflite::BufferT());
+    std::unique_ptr<tflite::TensorT> tensor(new tflite::TensorT());
+    tensor->name = name;
+    tensor->type = type;
+    tensor->shape = shape;
+    tensor->buffer = static_cast<uint32_t>(model->buffers.size() - 1);
+    subgraph->tensors.push_back(std::move(tensor));
+    return static_cast<int>(subgraph->tensors.size() - 1);
+}
+
+struct FilterOpStats {
+    uint64_t windows = 0;
+    uint64_t mismatched = 0;
+    uint64_t filter_runs = 0;  // InvokeRange(0, 1) between inferences
+    uint64_t op_us = 0;
+    uint64_t reference_us = 0;
+    int max_output_diff = 0;
+};
+
+// Classify every window_stride samples on both paths, feeding the op the way
+// the firmware does (FillRawInput() and PushSample() in src/main.cpp)
+bool ComparePaths(const ImuDataset& dataset, PushupReplay* replay,
+                  tflite::MicroInterpreter* interpreter, int window_stride, FilterOpStats* stats) {
+    TfLiteTensor* raw_input = interpreter->input(0);
+    TfLiteTensor* count_input = interpreter->input(1);
+    int16_t raw_window[WINDOW_SIZE][NUM_CHANNELS];
+
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        replay->Reset();
+        memset(raw_window, 0, sizeof(raw_window));
+        int new_samples = 0;
+        bool reset_pending = true;  // First run of a recording resets the op
+        auto fill_raw_input = [&]() {
+            memcpy(raw_input->data.i16, raw_window, sizeof(raw_window));
+            count_input->data.i32[0] = reset_pending ? -1 : new_samples;
+            new_samples = 0;
+            reset_pending = false;
+        };
+        const uint32_t sample_count = dataset.session(s).sample_count;
+        for (uint32_t t = 0; t < sample_count; t++) {
+            float raw[NUM_CHANNELS];
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = dataset.Column(s, ch)[t];
+            memmove(raw_window[0], raw_window[1], sizeof(raw_window) - sizeof(raw_window[0]));
+            QuantizeRawSample(&raw[0], &raw[3], raw_input, raw_window[WINDOW_SIZE - 1]);
+
+            // The reference sees the same register-resolution sample the IMU would deliver
+            // (recorded JSON values are rounded decimals, not multiples of the LSB)
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                raw[ch] = raw_window[WINDOW_SIZE - 1][ch] * (ch < 3 ? kAccelLsb : kGyroLsb);
+            }
+            replay->PushSample(raw);
+            if (++new_samples >= WINDOW_SIZE) {
+                fill_raw_input();
+                if (interpreter->InvokeRange(0, 1) != kTfLiteOk) {
+                    fprintf(stderr, "[FILTER-OP] ERROR: filter op failed\n");
+                    return false;
+                }
+                stats->filter_runs++;
+            }
+
+            if (t + 1 < WINDOW_SIZE || (t + 1 - WINDOW_SIZE) % window_stride != 0) continue;
+
+            PushupPrediction reference;
+            if (!replay->Classify(&reference)) return false;
+            int8_t reference_out[NUM_POSTURE_CLASSES];
+            memcpy(reference_out, replay->interpreter()->output(0)->data.int8,
+                   sizeof(reference_out));
+
+            fill_raw_input();
+            const auto start = std::chrono::steady_clock::now();
+            if (interpreter->Invoke() != kTfLiteOk) {
+                fprintf(stderr, "[FILTER-OP] ERROR: invoke failed\n");
+                return false;
+            }
+            stats->op_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            stats->reference_us += reference.latency_us;
+
+            const int8_t* out = interpreter->output(0)->data.int8;
+            bool same = true;
+            for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+                const int diff = abs(out[c] - reference_out[c]);
+                if (diff > stats->max_output_diff) stats->max_output_diff = diff;
+                if (diff != 0) same = false;
+            }
+            stats->windows++;
+            if (!same) stats->mismatched++;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+std::vector<uint8_t> BuildFilterOpModel() {
+    // Mirrors add_filter_op() in add_imu_filter_op.py
+    std::unique_ptr<tflite::ModelT> model(tflite::GetModel(g_pushup_model_data)->UnPack());
+    tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+    const int model_input = subgraph->inputs[0];
+    const std::vector<int32_t> shape = subgraph->tensors[model_input]->shape;
+
+    const int raw = AddTensor(model.get(), subgraph, "imu_raw", tflite::TensorType_INT16, shape);
+    std::unique_ptr<tflite::QuantizationParametersT> quant(new tflite::QuantizationParametersT());
+    quant->scale = {kAccelLsb, kAccelLsb, kAccelLsb, kGyroLsb, kGyroLsb, kGyroLsb};
+    quant->zero_point = {0, 0, 0, 0, 0, 0};
+    quant->quantized_dimension = 2;
+    subgraph->tensors[raw]->quantization = std::move(quant);
+    const int count = AddTensor(model.get(), subgraph, "new_samples", tflite::TensorType_INT32, {1});
+
+    std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+    code->builtin_code = tflite::BuiltinOperator_CUSTOM;
+    code->deprecated_builtin_code = tflite::BuiltinOperator_CUSTOM;
+    code->custom_code = kImuFilterOpName;
+    model->operator_codes.push_back(std::move(code));
+
+    flexbuffers::Builder options;
+    options.Map([&]() {
+        options.Vector("mean", [&]() {
+            for (float v : imu_mean) options.Double(v);
+        });
+        options.Vector("std", [&]() {
+            for (float v : imu_std) options.Double(v);
+        });
+    });
+    options.Finish();
+
+    std::unique_ptr<tflite::OperatorT> op(new tflite::OperatorT());
+    op->opcode_index = static_cast<uint32_t>(model->operator_codes.size() - 1);
+    op->inputs = {raw, count};
+    op->outputs = {model_input};
+    op->custom_options = options.GetBuffer();
+    op->custom_options_format = tflite::CustomOptionsFormat_FLEXBUFFERS;
+    subgraph->operators.insert(subgraph->operators.begin(), std::move(op));
+    subgraph->inputs = {raw, count};
+    model->signature_defs.clear();
+
+    // The TFLM copy of flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(16 * 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    return std::vector<uint8_t>(builder.GetBufferPointer(),
+                                builder.GetBufferPointer() + builder.GetSize());
+}
+
+bool CheckFilterOp(const ImuDataset& dataset, PushupReplay* replay, int window_stride) {
+    const std::vector<uint8_t> model_data = BuildFilterOpModel();
+    static tflite::AllOpsResolver resolver;
+    if (resolver.FindOp(kImuFilterOpName) == nullptr &&
+        resolver.AddCustom(kImuFilterOpName, Register_GAINS_IMU_FILTER()) != kTfLiteOk) {
+        return false;
+    }
+    alignas(16) static uint8_t arena[kArenaSize];
+    tflite::MicroInterpreter interpreter(tflite::GetModel(model_data.data()), resolver, arena,
+                                         kArenaSize);
+    if (interpreter.AllocateTensors() != kTfLiteOk) {
+        fprintf(stderr, "[FILTER-OP] ERROR: tensor allocation failed\n");
+        return false;
+    }
+    printf("[FILTER-OP] model %zu bytes (+%d), arena %zu bytes\n", model_data.size(),
+           static_cast<int>(model_data.size()) - g_pushup_model_data_len,
+           interpreter.arena_used_bytes());
+
+    // The training stride, then inferences further apart than the window (idle,
+    // backed-off schedule), where the op has to be run alone in between
+    const int strides[] = {window_stride, WINDOW_SIZE + 7};
+    bool ok = true;
+    for (int stride : strides) {
+        FilterOpStats stats;
+        if (!ComparePaths(dataset, replay, &interpreter, stride, &stats)) return false;
+        printf("[FILTER-OP] stride %d: %llu windows, %llu with different outputs (max diff %d LSB), "
+               "%llu filter-only runs\n",
+               stride, static_cast<unsigned long long>(stats.windows),
+               static_cast<unsigned long long>(stats.mismatched), stats.max_output_diff,
+               static_cast<unsigned long long>(stats.filter_runs));
+        if (stride == window_stride && stats.windows > 0) {
+            printf("[FILTER-OP] invoke with op %.1f us/window, reference path %.1f us/window\n",
+                   static_cast<double>(stats.op_us) / stats.windows,
+                   static_cast<double>(stats.reference_us) / stats.windows);
+        }
+        if (stats.mismatched != 0) ok = false;
+    }
+    return ok;
+}
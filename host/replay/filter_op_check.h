@@ -0,0 +1,21 @@
+/* Equivalence check for the GAINS_IMU_FILTER custom op (include/imu_filter_op.h).
+ * Builds the same graph add_imu_filter_op.py emits (op prepended to the
+ * pushup model) in memory and replays a raw dataset through it and through
+ * the firmware path (Preprocessor + NormalizeWindow + QuantizeWindow).
+ */
+#ifndef HOST_REPLAY_FILTER_OP_CHECK_H_
+#define HOST_REPLAY_FILTER_OP_CHECK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+// Pushup model with GAINS_IMU_FILTER in front of it (serialized .tflite)
+std::vector<uint8_t> BuildFilterOpModel();
+
+// Returns true if every window gives bit-identical model outputs on both paths
+bool CheckFilterOp(const ImuDataset& dataset, PushupReplay* replay, int window_stride);
+
+#endif  // HOST_REPLAY_FILTER_OP_CHECK_H_
@@ -0,0 +1,189 @@
+#include "replay/first_stage_fit.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "first_stage.h"
+
+namespace {
+
+struct Window {
+    float x[NUM_FIRST_STAGE_FEATURES];
+    int label;
+};
+
+void Softmax(const float weights[][NUM_FIRST_STAGE_FEATURES], const float* bias, const float* x,
+             float* probs) {
+    float max_score = -1e30f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        probs[c] = bias[c];
+        for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) probs[c] += weights[c][f] * x[f];
+        if (probs[c] > max_score) max_score = probs[c];
+    }
+    float total = 0.0f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        probs[c] = expf(probs[c] - max_score);
+        total += probs[c];
+    }
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) probs[c] /= total;
+}
+
+}  // namespace
+
+bool FitFirstStage(const ImuDataset& dataset, PushupReplay* replay,
+                   const FirstStageFitConfig& config, const char* header_path) {
+    // Collect features at the training stride, streamed exactly like the device
+    std::vector<Window> windows;
+    const std::vector<int> folds = RecordingFolds(dataset);
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const int label = PostureClassFromLabel(dataset.LabelName(dataset.session(s).label));
+        if (label < 0 || (config.fold >= 0 && folds[s] != config.fold)) continue;
+        FirstStageClassifier first_stage;
+        replay->Reset();
+        const uint32_t count = dataset.session(s).sample_count;
+        for (uint32_t t = 0; t < count; t++) {
+            float raw[NUM_CHANNELS];
+            float processed[NUM_CHANNELS];
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = dataset.Column(s, ch)[t];
+            replay->PushSample(raw, processed);
+            first_stage.OnSample(raw, processed);
+            if (t + 1 >= WINDOW_SIZE && (t + 1 - WINDOW_SIZE) % config.window_stride == 0) {
+                Window w;
+                FirstStageFeatureVector(first_stage.Features(), w.x);
+                w.label = label;
+                windows.push_back(w);
+            }
+        }
+    }
+    if (windows.empty()) {
+        fprintf(stderr, "[FIT] ERROR: no labelled windows\n");
+        return false;
+    }
+
+    // Standardize
+    float mean[NUM_FIRST_STAGE_FEATURES] = {0};
+    float stddev[NUM_FIRST_STAGE_FEATURES] = {0};
+    for (const Window& w : windows) {
+        for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) mean[f] += w.x[f];
+    }
+    for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) mean[f] /= windows.size();
+    for (const Window& w : windows) {
+        for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) {
+            stddev[f] += (w.x[f] - mean[f]) * (w.x[f] - mean[f]);
+        }
+    }
+    for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) {
+        stddev[f] = sqrtf(stddev[f] / windows.size()) + 1e-6f;
+    }
+    for (Window& w : windows) {
+        for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) w.x[f] = (w.x[f] - mean[f]) / stddev[f];
+    }
+
+    // Multinomial logistic regression, full-batch gradient descent
+    float weights[NUM_POSTURE_CLASSES][NUM_FIRST_STAGE_FEATURES] = {{0}};
+    float bias[NUM_POSTURE_CLASSES] = {0};
+    for (int it = 0; it < config.iterations; it++) {
+        float grad_w[NUM_POSTURE_CLASSES][NUM_FIRST_STAGE_FEATURES] = {{0}};
+        float grad_b[NUM_POSTURE_CLASSES] = {0};
+        for (const Window& w : windows) {
+            float probs[NUM_POSTURE_CLASSES];
+            Softmax(weights, bias, w.x, probs);
+            for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+                const float err = probs[c] - (c == w.label ? 1.0f : 0.0f);
+                grad_b[c] += err;
+                for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) grad_w[c][f] += err * w.x[f];
+            }
+        }
+        const float step = config.learning_rate / windows.size();
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+            bias[c] -= step * grad_b[c];
+            for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) {
+                weights[c][f] -= step * grad_w[c][f] + config.learning_rate * config.l2 * weights[c][f];
+            }
+        }
+    }
+
+    // Per-class exit threshold: the lowest confidence at which exits predicting
+    // that class are at least target_precision correct (2.0 = never exit)
+    float threshold[NUM_POSTURE_CLASSES];
+    int exits[NUM_POSTURE_CLASSES] = {0};
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        threshold[c] = 2.0f;
+        for (int step = 50; step < 100; step++) {
+            const float candidate = step / 100.0f;
+            int predicted = 0;
+            int correct = 0;
+            for (const Window& w : windows) {
+                float probs[NUM_POSTURE_CLASSES];
+                Softmax(weights, bias, w.x, probs);
+                int best = 0;
+                for (int k = 1; k < NUM_POSTURE_CLASSES; k++) {
+                    if (probs[k] > probs[best]) best = k;
+                }
+                if (best != c || probs[best] < candidate) continue;
+                predicted++;
+                if (w.label == c) correct++;
+            }
+            if (predicted > 0 && correct >= config.target_precision * predicted) {
+                threshold[c] = candidate;
+                exits[c] = predicted;
+                break;
+            }
+        }
+    }
+
+    if (config.fold >= 0) {
+        printf("[FIT] %zu windows of fold %d\n", windows.size(), config.fold);
+    } else {
+        printf("[FIT] %zu windows\n", windows.size());
+    }
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        if (threshold[c] <= 1.0f) {
+            printf("  %-12s exit at p >= %.2f (%d windows, %.1f%%)\n", posture_labels[c],
+                   threshold[c], exits[c], 100.0 * exits[c] / windows.size());
+        } else {
+            printf("  %-12s never exits\n", posture_labels[c]);
+        }
+    }
+
+    FILE* f = fopen(header_path, "w");
+    if (f == nullptr) {
+        fprintf(stderr, "[FIT] ERROR: cannot write %s\n", header_path);
+        return false;
+    }
+    fprintf(f, "#ifndef FIRST_STAGE_PARAMS_H_\n#define FIRST_STAGE_PARAMS_H_\n\n");
+    if (config.fold >= 0) {
+        fprintf(f, "// Generated by host/replay --fit-first-stage from %zu windows (recording fold %d)\n",
+                windows.size(), config.fold);
+    } else {
+        fprintf(f, "// Generated by host/replay --fit-first-stage from %zu windows\n", windows.size());
+    }
+    fprintf(f, "// Features: pitch range (deg), rep duration (s), log10 vertical energy (g^2)\n");
+    fprintf(f, "// Exit thresholds target %.0f%% precision; 2.0 = class never exits\n\n",
+            100.0f * config.target_precision);
+    auto write_row = [f](const float* v, int n) {
+        fprintf(f, "{");
+        for (int i = 0; i < n; i++) fprintf(f, "%s%.6ff", i ? ", " : "", v[i]);
+        fprintf(f, "}");
+    };
+    fprintf(f, "constexpr float kFirstStageMean[%d] = ", NUM_FIRST_STAGE_FEATURES);
+    write_row(mean, NUM_FIRST_STAGE_FEATURES);
+    fprintf(f, ";\nconstexpr float kFirstStageStd[%d] = ", NUM_FIRST_STAGE_FEATURES);
+    write_row(stddev, NUM_FIRST_STAGE_FEATURES);
+    fprintf(f, ";\nconstexpr float kFirstStageWeights[%d][%d] = {\n", NUM_POSTURE_CLASSES,
+            NUM_FIRST_STAGE_FEATURES);
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        fprintf(f, "    ");
+        write_row(weights[c], NUM_FIRST_STAGE_FEATURES);
+        fprintf(f, ",  // %s\n", posture_labels[c]);
+    }
+    fprintf(f, "};\nconstexpr float kFirstStageBias[%d] = ", NUM_POSTURE_CLASSES);
+    write_row(bias, NUM_POSTURE_CLASSES);
+    fprintf(f, ";\nconstexpr float kFirstStageExitThreshold[%d] = ", NUM_POSTURE_CLASSES);
+    write_row(threshold, NUM_POSTURE_CLASSES);
+    fprintf(f, ";\n\n#endif  // FIRST_STAGE_PARAMS_H_\n");
+    fclose(f);
+    printf("[FIT] Wrote %s\n", header_path);
+    return true;
+}
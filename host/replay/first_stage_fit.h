@@ -0,0 +1,24 @@
+/* Fits the cascade first stage (include/first_stage.h) on a raw .gimu
+ * dataset and writes include/first_stage_params.h.
+ */
+#ifndef HOST_REPLAY_FIRST_STAGE_FIT_H_
+#define HOST_REPLAY_FIRST_STAGE_FIT_H_
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+struct FirstStageFitConfig {
+    int window_stride = 10;          // Training stride
+    int iterations = 3000;           // Full-batch gradient descent steps
+    float learning_rate = 0.5f;
+    float l2 = 1e-3f;
+    float target_precision = 0.9f;   // Exit only where the first stage is at least this precise
+    int fold = -1;                   // Fit on this RecordingFolds() fold only, -1 = every session
+};
+
+// Returns false (after printing the error) if the dataset has no usable windows
+// or the header cannot be written.
+bool FitFirstStage(const ImuDataset& dataset, PushupReplay* replay,
+                   const FirstStageFitConfig& config, const char* header_path);
+
+#endif  // HOST_REPLAY_FIRST_STAGE_FIT_H_
@@ -0,0 +1,184 @@
+#include "replay/personalization_check.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "model_config.h"
+#include "personalization.h"
+
+namespace {
+
+constexpr int kInferenceStride = 8;  // Samples between invokes (200 ms)
+constexpr int kMaxAdaptReps = 3;     // Labelled reps per class, 1..kMaxAdaptReps
+
+// One model invoke of a session
+struct Window {
+    float probs[NUM_POSTURE_CLASSES];
+    int8_t embedding[PERSONAL_MAX_EMBEDDING];
+};
+
+struct Session {
+    int label = 0;
+    int participant = 0;
+    int fold = 0;
+    std::vector<Window> windows;
+};
+
+enum Head { kHeadModel, kHeadBlend, kHeadReplace, kNumHeads };
+
+struct Score {
+    int sessions = 0;
+    int vote_correct = 0;
+    int windows = 0;
+    int window_correct = 0;
+};
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Windows of one session through the head in its current mode, scored like
+// the firmware's confidence-weighted vote
+void ScoreSession(const Session& session, const PersonalHead& head,
+                  const TfLiteTensor& embedding_params, Score* score, uint64_t* apply_ns,
+                  uint64_t* applied) {
+    float vote[NUM_POSTURE_CLASSES] = {0};
+    TfLiteTensor embedding = embedding_params;
+    for (const Window& w : session.windows) {
+        float probs[NUM_POSTURE_CLASSES];
+        memcpy(probs, w.probs, sizeof(probs));
+        int best = 0;
+        for (int c = 1; c < NUM_POSTURE_CLASSES; c++) {
+            if (probs[c] > probs[best]) best = c;
+        }
+        float confidence = probs[best];
+        if (head.Mode() != PERSONAL_OFF) {
+            embedding.data.int8 = const_cast<int8_t*>(w.embedding);
+            const uint64_t start = NowNs();
+            head.Apply(&embedding, probs, best, confidence);
+            *apply_ns += NowNs() - start;
+            (*applied)++;
+        }
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) vote[c] += probs[c] * confidence;
+        score->windows++;
+        if (best == session.label) score->window_correct++;
+    }
+    int vote_class = 0;
+    for (int c = 1; c < NUM_POSTURE_CLASSES; c++) {
+        if (vote[c] > vote[vote_class]) vote_class = c;
+    }
+    score->sessions++;
+    if (vote_class == session.label) score->vote_correct++;
+}
+
+}  // namespace
+
+bool CheckPersonalization(const ImuDataset& dataset, PushupReplay* replay) {
+    const TfLiteTensor* embedding = replay->embedding();
+    PersonalHead head;
+    if (!head.Init(embedding)) {
+        fprintf(stderr, "[PERSONAL] ERROR: the model has no usable embedding output\n");
+        return false;
+    }
+    const int embedding_size = static_cast<int>(embedding->bytes);
+
+    // Model probabilities and embeddings of every session, as on the device
+    std::vector<Session> sessions;
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const ImuSessionRecord& record = dataset.session(s);
+        const int label = PostureClassFromLabel(dataset.LabelName(record.label));
+        if (label < 0 || (record.flags & kImuSessionAugmented)) continue;
+        Session session;
+        session.label = label;
+        session.participant = record.participant;
+        replay->Reset();
+        for (uint32_t t = 0; t < record.sample_count; t++) {
+            float raw[NUM_CHANNELS];
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = dataset.Column(s, ch)[t];
+            replay->PushSample(raw);
+            if (!replay->WindowFull() || (t + 1 - WINDOW_SIZE) % kInferenceStride != 0) continue;
+            PushupPrediction prediction;
+            if (!replay->Classify(&prediction)) return false;
+            Window w;
+            memcpy(w.probs, prediction.probs, sizeof(w.probs));
+            memcpy(w.embedding, embedding->data.int8, embedding_size);
+            session.windows.push_back(w);
+        }
+        if (!session.windows.empty()) sessions.push_back(session);
+    }
+    if (sessions.empty()) {
+        fprintf(stderr, "[PERSONAL] ERROR: no labelled sessions in the dataset\n");
+        return false;
+    }
+    printf("[PERSONAL] %d sessions in %d recordings, embedding of %d int8 (scale %.4f, zero "
+           "point %d)\n",
+           static_cast<int>(sessions.size()), dataset.num_participants(), embedding_size,
+           embedding->params.scale, static_cast<int>(embedding->params.zero_point));
+    printf("%-6s %8s %8s %8s %8s %8s %8s %8s\n", "reps", "test", "model", "blend", "replace",
+           "model-w", "blend-w", "repl-w");
+
+    // Two folds: the recordings of each class alternate between them
+    std::vector<int> rank(dataset.num_participants(), -1);
+    int recordings[NUM_POSTURE_CLASSES] = {0};
+    for (Session& session : sessions) {
+        if (rank[session.participant] < 0) {
+            rank[session.participant] = recordings[session.label]++;
+        }
+        session.fold = rank[session.participant] % 2;
+    }
+
+    uint64_t label_ns = 0;
+    uint64_t labelled = 0;
+    uint64_t apply_ns = 0;
+    uint64_t applied = 0;
+    const int adapt_reps[] = {1, 2, 3, 5, 10};
+    for (int reps : adapt_reps) {
+        Score scores[kNumHeads];
+        for (int fold = 0; fold < 2; fold++) {
+            // Label the first reps of each class in this fold
+            head.Clear();
+            int used[NUM_POSTURE_CLASSES] = {0};
+            for (const Session& session : sessions) {
+                if (session.fold != fold || used[session.label] >= reps) continue;
+                used[session.label]++;
+                for (const Window& w : session.windows) {
+                    TfLiteTensor collected = *embedding;
+                    collected.data.int8 = const_cast<int8_t*>(w.embedding);
+                    head.Collect(&collected);
+                }
+                const uint64_t start = NowNs();
+                head.LabelPending(session.label);
+                label_ns += NowNs() - start;
+                labelled++;
+            }
+
+            // Every session of the other fold
+            const PersonalMode modes[kNumHeads] = {PERSONAL_OFF, PERSONAL_BLEND,
+                                                   PERSONAL_REPLACE};
+            for (const Session& session : sessions) {
+                if (session.fold == fold) continue;
+                for (int h = 0; h < kNumHeads; h++) {
+                    head.SetMode(modes[h]);
+                    ScoreSession(session, head, *embedding, &scores[h], &apply_ns, &applied);
+                }
+            }
+        }
+        const double n = scores[kHeadModel].sessions ? scores[kHeadModel].sessions : 1;
+        const double w = scores[kHeadModel].windows ? scores[kHeadModel].windows : 1;
+        printf("%-6d %8d %7.1f%% %7.1f%% %7.1f%% %7.1f%% %7.1f%% %7.1f%%\n", reps,
+               scores[kHeadModel].sessions, 100.0 * scores[kHeadModel].vote_correct / n,
+               100.0 * scores[kHeadBlend].vote_correct / n,
+               100.0 * scores[kHeadReplace].vote_correct / n,
+               100.0 * scores[kHeadModel].window_correct / w,
+               100.0 * scores[kHeadBlend].window_correct / w,
+               100.0 * scores[kHeadReplace].window_correct / w);
+    }
+    printf("[PERSONAL] labelling a rep: %.2f us, head per window: %.2f us (host)\n",
+           labelled ? label_ns / 1000.0 / labelled : 0.0,
+           applied ? apply_ns / 1000.0 / applied : 0.0);
+    return true;
+}
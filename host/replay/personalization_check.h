@@ -0,0 +1,22 @@
+/* Check for the on-device personalization head (include/personalization.h)
+ * on held-out recordings. Every session is replayed through the firmware
+ * path with the model invoked every 200 ms; the embedding output of each
+ * invoke is kept with its model probabilities. The participant table of the
+ * .gimu holds one recording run per entry, each of a single class; the runs
+ * of each class alternate between two folds. Per fold, as the device would
+ * be used: the first reps of each class are labelled into a fresh
+ * PersonalHead and every session of the other fold is classified with the
+ * model alone, the blended head and the head alone. Reports the vote and
+ * per-window accuracy for 1 to 10 labelled reps per class and the cost of
+ * labelling and applying the head.
+ */
+#ifndef HOST_REPLAY_PERSONALIZATION_CHECK_H_
+#define HOST_REPLAY_PERSONALIZATION_CHECK_H_
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+// Returns false only on errors; the numbers are for reading
+bool CheckPersonalization(const ImuDataset& dataset, PushupReplay* replay);
+
+#endif  // HOST_REPLAY_PERSONALIZATION_CHECK_H_
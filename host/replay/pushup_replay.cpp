@@ -0,0 +1,107 @@
+#include "replay/pushup_replay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include "personalization.h"
+#include "pushup_inference.h"
+#include "pushup_model_data.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+int PostureClassFromLabel(const char* name) {
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        if (strcmp(name, posture_labels[c]) == 0) return c;
+    }
+    return -1;
+}
+
+std::vector<int> RecordingFolds(const ImuDataset& dataset) {
+    std::vector<int> folds(dataset.num_sessions(), -1);
+    std::vector<int> rank(dataset.num_participants(), -1);
+    int recordings[NUM_POSTURE_CLASSES] = {0};
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const int label = PostureClassFromLabel(dataset.LabelName(dataset.session(s).label));
+        if (label < 0) continue;
+        const int participant = dataset.session(s).participant;
+        if (rank[participant] < 0) rank[participant] = recordings[label]++;
+        folds[s] = rank[participant] % 2;
+    }
+    return folds;
+}
+
+PushupReplay::PushupReplay() : interpreter_(nullptr) {}
+
+bool PushupReplay::Init() {
+    const tflite::Model* model = tflite::GetModel(g_pushup_model_data);
+    if (model->version() != TFLITE_SCHEMA_VERSION) {
+        fprintf(stderr, "[REPLAY] ERROR: model schema %u, expected %d\n",
+                static_cast<unsigned>(model->version()), TFLITE_SCHEMA_VERSION);
+        return false;
+    }
+    // As the firmware with ENABLE_PERSONALIZATION: the embedding is output(1)
+    if (ExposeEmbedding(g_pushup_model_data, &model_data_)) {
+        model = tflite::GetModel(model_data_.data());
+    }
+    interpreter_ = new (interpreter_storage_)
+        tflite::MicroInterpreter(model, resolver_, tensor_arena_, kTensorArenaSize);
+    if (interpreter_->AllocateTensors() != kTfLiteOk) {
+        fprintf(stderr, "[REPLAY] ERROR: tensor allocation failed\n");
+        return false;
+    }
+    return true;
+}
+
+void PushupReplay::Reset() {
+    preprocessor_.Reset();
+    first_stage_.Reset();
+    window_.Reset();
+}
+
+void PushupReplay::PushSample(const float* raw, float* processed) {
+    float sample[NUM_CHANNELS];
+    preprocessor_.ProcessSample(&raw[0], &raw[3], sample);
+    first_stage_.OnSample(&raw[0], sample);
+    window_.Push(sample);
+    if (processed != nullptr) {
+        memcpy(processed, sample, sizeof(sample));
+    }
+}
+
+bool PushupReplay::Classify(PushupPrediction* prediction, bool cascade) {
+    if (!WindowFull()) return false;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto elapsed_us = [](Clock::time_point from) {
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - from).count());
+    };
+
+    prediction->early_exit = false;
+    prediction->invoke_us = 0;
+    if (cascade && first_stage_.Classify(prediction->probs, prediction->best_class,
+                                         prediction->confidence)) {
+        prediction->early_exit = true;
+        prediction->latency_us = elapsed_us(start);
+        return true;
+    }
+
+    float normalized_window[WINDOW_SIZE][NUM_CHANNELS];
+    NormalizeWindow(window_.Window(WINDOW_SIZE), normalized_window);
+    QuantizeWindow(normalized_window, interpreter_->input(0));
+
+    const auto invoke_start = Clock::now();
+    TfLiteStatus status = interpreter_->Invoke();
+    prediction->invoke_us = elapsed_us(invoke_start);
+    if (status != kTfLiteOk) {
+        fprintf(stderr, "[REPLAY] ERROR: invoke failed\n");
+        return false;
+    }
+
+    DequantizePosture(interpreter_->output(0), prediction->probs, prediction->best_class,
+                      prediction->confidence);
+    prediction->latency_us = elapsed_us(start);
+    return true;
+}
@@ -0,0 +1,81 @@
+/* Host model of the pushup firmware's sample -> window -> inference path.
+ * Uses the firmware's own Preprocessor, NormalizeWindow/QuantizeWindow and
+ * model data, so predictions match what the device computes for the same
+ * raw samples (up to float differences between the ESP32 and the host).
+ */
+#ifndef HOST_REPLAY_PUSHUP_REPLAY_H_
+#define HOST_REPLAY_PUSHUP_REPLAY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "dataset/imu_dataset.h"
+#include "first_stage.h"
+#include "model_config.h"
+#include "preprocessing.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "window_ring.h"
+
+struct PushupPrediction {
+    float probs[NUM_POSTURE_CLASSES];
+    int best_class;
+    float confidence;
+    bool early_exit;      // Decided by the cascade first stage, no Invoke()
+    uint32_t invoke_us;   // Invoke() only
+    uint32_t latency_us;  // End to end: first stage + normalize/quantize + Invoke + dequantize
+};
+
+// Index of a posture label in posture_labels, -1 if unknown
+int PostureClassFromLabel(const char* name);
+
+// Two folds by recording (dataset participant): the recordings of each class
+// alternate between them. Fold of every session, -1 if it has no posture label.
+std::vector<int> RecordingFolds(const ImuDataset& dataset);
+
+class PushupReplay {
+public:
+    PushupReplay();
+
+    // Load the model and allocate tensors. Prints the error and returns false on failure.
+    bool Init();
+
+    // Start of a new recording: clear filters and the sliding window
+    void Reset();
+
+    // Preprocess one raw sample [ax, ay, az (g), gx, gy, gz (deg/s)] and append
+    // it to the window. processed (optional) receives the filtered sample.
+    void PushSample(const float* raw, float* processed = nullptr);
+
+    // Preprocessor::SetHardwareLowpass, for samples that went through the IMU's DLPF
+    void SetHardwareLowpass(bool enabled) { preprocessor_.SetHardwareLowpass(enabled); }
+
+    bool WindowFull() const { return window_.Full(); }
+
+    // Normalize, quantize and invoke on the current window. With cascade the
+    // first stage runs first and the model only when it is not confident.
+    bool Classify(PushupPrediction* prediction, bool cascade = false);
+
+    tflite::MicroInterpreter* interpreter() { return interpreter_; }
+
+    // Penultimate-layer activations of the last Classify() that invoked the
+    // model (personalization.h), nullptr if the model has no embedding output
+    const TfLiteTensor* embedding() {
+        return interpreter_->outputs_size() > 1 ? interpreter_->output(1) : nullptr;
+    }
+
+private:
+    static constexpr int kTensorArenaSize = 120 * 1024;
+
+    Preprocessor preprocessor_;
+    FirstStageClassifier first_stage_;
+    WindowRing<float, WINDOW_SIZE, NUM_CHANNELS> window_;
+
+    std::vector<uint8_t> model_data_;  // Model with the embedding output
+    tflite::AllOpsResolver resolver_;
+    tflite::MicroInterpreter* interpreter_;
+    alignas(16) uint8_t tensor_arena_[kTensorArenaSize];
+    alignas(tflite::MicroInterpreter) uint8_t interpreter_storage_[sizeof(tflite::MicroInterpreter)];
+};
+
+#endif  // HOST_REPLAY_PUSHUP_REPLAY_H_
@@ -0,0 +1,161 @@
+#include "replay/rep_check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "model_config.h"
+#include "rep_analytics.h"
+
+namespace {
+
+constexpr int kSetSessions = 15;     // Reps per joined set
+constexpr int kGapSamples = 40;      // Pause before every rep in a set (1 s)
+constexpr int kLeadInSamples = 160;  // Filters settling before a recording (4 s)
+
+// Per posture label, over the sessions that gave exactly one rep
+struct LabelStats {
+    int sessions = 0;
+    int one_rep = 0;
+    double duration_ms = 0;
+    double eccentric_ms = 0;
+    double concentric_ms = 0;
+    double excursion_deg = 0;
+    double depth_cm = 0;
+    double duration_ratio = 0;  // Rep duration / session duration
+};
+
+void RawSample(const ImuDataset& dataset, int session, uint32_t t, float raw[NUM_CHANNELS]) {
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = dataset.Column(session, ch)[t];
+}
+
+// The device samples continuously, so the filters have settled when a
+// recording starts; hold the first sample of the recording until they have
+void LeadIn(PushupReplay* replay, const ImuDataset& dataset, int session) {
+    float raw[NUM_CHANNELS];
+    RawSample(dataset, session, 0, raw);
+    replay->Reset();
+    for (int t = 0; t < kLeadInSamples; t++) replay->PushSample(raw);
+}
+
+// Feed one raw sample through the firmware path, as PushSample() does
+bool Push(PushupReplay* replay, RepAnalytics* reps, const float raw[NUM_CHANNELS]) {
+    float processed[NUM_CHANNELS];
+    replay->PushSample(raw, processed);
+    return reps->OnSample(raw, processed);
+}
+
+}  // namespace
+
+bool CheckRepAnalytics(const ImuDataset& dataset, PushupReplay* replay) {
+    RepAnalytics reps;
+    std::vector<LabelStats> labels(dataset.num_labels());
+    int sessions = 0;
+    int count_histogram[3] = {};  // 0, 1, 2+ reps
+    int too_long = 0;
+
+    // One recording per session
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const ImuSessionRecord& record = dataset.session(s);
+        if ((record.flags & kImuSessionAugmented) || record.sample_count == 0) continue;
+        LeadIn(replay, dataset, s);
+        reps.Reset();
+        float raw[NUM_CHANNELS];
+        for (uint32_t t = 0; t < record.sample_count; t++) {
+            RawSample(dataset, s, t, raw);
+            Push(replay, &reps, raw);
+        }
+        reps.Finish();
+
+        const RepSetSummary& summary = reps.Summary();
+        const uint32_t session_ms = record.sample_count * SAMPLE_PERIOD_MS;
+        LabelStats& stats = labels[record.label];
+        sessions++;
+        stats.sessions++;
+        count_histogram[summary.reps < 2 ? summary.reps : 2]++;
+        if (summary.reps != 1) continue;
+        const RepMetrics& rep = summary.last;
+        if (rep.duration_ms > session_ms) too_long++;
+        stats.one_rep++;
+        stats.duration_ms += rep.duration_ms;
+        stats.eccentric_ms += rep.eccentric_ms;
+        stats.concentric_ms += rep.concentric_ms;
+        stats.excursion_deg += rep.excursion_deg;
+        stats.depth_cm += rep.depth_cm;
+        stats.duration_ratio += static_cast<double>(rep.duration_ms) / session_ms;
+    }
+    if (sessions == 0) {
+        fprintf(stderr, "[REPS] ERROR: no recorded sessions in the dataset\n");
+        return false;
+    }
+
+    printf("[REPS] %d sessions (one rep each): %d with 1 rep (%.1f%%), %d with none, "
+           "%d with more; %d reps longer than their session\n",
+           sessions, count_histogram[1], 100.0 * count_histogram[1] / sessions,
+           count_histogram[0], count_histogram[2], too_long);
+    printf("%-14s %8s %8s %9s %9s %9s %10s %9s %9s\n", "label", "sessions", "1 rep", "rep s",
+           "down s", "up s", "pitch deg", "depth cm", "of sess");
+    for (int l = 0; l < dataset.num_labels(); l++) {
+        const LabelStats& stats = labels[l];
+        if (stats.sessions == 0) continue;
+        const double n = stats.one_rep ? stats.one_rep : 1;
+        printf("%-14s %8d %7.1f%% %9.2f %9.2f %9.2f %10.1f %9.1f %8.0f%%\n",
+               dataset.LabelName(l), stats.sessions, 100.0 * stats.one_rep / stats.sessions,
+               stats.duration_ms / n / 1000.0, stats.eccentric_ms / n / 1000.0,
+               stats.concentric_ms / n / 1000.0, stats.excursion_deg / n, stats.depth_cm / n,
+               100.0 * stats.duration_ratio / n);
+    }
+
+    // The same reps joined into sets per participant
+    int sets = 0;
+    int exact_sets = 0;
+    int expected_total = 0;
+    int counted_total = 0;
+    int abs_error_total = 0;
+    int s = 0;
+    while (s < dataset.num_sessions()) {
+        const int participant = dataset.session(s).participant;
+        LeadIn(replay, dataset, s);
+        reps.Reset();
+        int expected = 0;
+        float last[NUM_CHANNELS];
+        for (; s < dataset.num_sessions() && expected < kSetSessions &&
+               dataset.session(s).participant == participant;
+             s++) {
+            const ImuSessionRecord& record = dataset.session(s);
+            if ((record.flags & kImuSessionAugmented) || record.sample_count == 0) continue;
+            // Recordings stop before the trunk is still: ease from where the
+            // last rep stopped into the start of the next one, then hold it
+            float raw[NUM_CHANNELS];
+            RawSample(dataset, s, 0, raw);
+            for (int t = 1; t <= kGapSamples; t++) {
+                const float w = expected > 0 ? fminf(1.0f, 2.0f * t / kGapSamples) : 1.0f;
+                float gap[NUM_CHANNELS];
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                    gap[ch] = last[ch] + w * (raw[ch] - last[ch]);
+                }
+                Push(replay, &reps, gap);
+            }
+            for (uint32_t t = 0; t < record.sample_count; t++) {
+                RawSample(dataset, s, t, raw);
+                Push(replay, &reps, raw);
+            }
+            memcpy(last, raw, sizeof(last));
+            expected++;
+        }
+        reps.Finish();
+        if (expected == 0) continue;
+        const int counted = reps.Summary().reps;
+        sets++;
+        if (counted == expected) exact_sets++;
+        expected_total += expected;
+        counted_total += counted;
+        abs_error_total += counted > expected ? counted - expected : expected - counted;
+    }
+    printf("[REPS] %d joined sets of up to %d reps: %d counted exactly, %d of %d reps counted, "
+           "mean |error| %.2f reps/set\n",
+           sets, kSetSessions, exact_sets, counted_total, expected_total,
+           sets ? static_cast<double>(abs_error_total) / sets : 0.0);
+    return true;
+}
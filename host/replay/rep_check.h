@@ -0,0 +1,24 @@
+/* Check for the streaming rep analytics (include/rep_analytics.h) against the
+ * hand-labelled recordings. Every session of dataset_raw is one rep,
+ * started and stopped by hand, with its posture label:
+ *   - per session: the raw samples go through the firmware Preprocessor and
+ *     RepAnalytics as one recording; exactly one rep should come out, no
+ *     longer than the session. Tempo, excursion and depth are reported per
+ *     label, so partial-rom should show a smaller range than good-form.
+ *   - per set: the sessions of each participant are joined into sets of up
+ *     to 15 with a 1 s pause before every rep (easing from the last sample
+ *     of the previous rep to the first of the next) and replayed as one
+ *     recording; the rep count should be the number of sessions.
+ * Each recording follows 4 s of its first sample: on the device the filters
+ * run long before the button press.
+ */
+#ifndef HOST_REPLAY_REP_CHECK_H_
+#define HOST_REPLAY_REP_CHECK_H_
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+// Returns false only on errors; the numbers are for reading
+bool CheckRepAnalytics(const ImuDataset& dataset, PushupReplay* replay);
+
+#endif  // HOST_REPLAY_REP_CHECK_H_
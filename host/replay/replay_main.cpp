@@ -0,0 +1,344 @@
+/* GAINS host replay
+ * Replays recorded raw sessions (.gimu, see host/dataset/export_imu_dataset.py)
+ * through the firmware preprocessing + model in virtual time, the way the
+ * device sees them during a recording, and compares inference schedules and
+ * the cascaded early exit.
+ *
+ *   host_replay --in raw.gimu [--schedule fixed|adaptive|both] [--cascade] [--csv out.csv]
+ *   host_replay --in raw.gimu --fit-first-stage include/first_stage_params.h [--fold 0]
+ *   host_replay --in raw.gimu --cascade --fold 1
+ *   host_replay --in raw.gimu --check-filter-op
+ *   host_replay --in raw.gimu --check-dlpf
+ *   host_replay --in raw.gimu --check-reps
+ *   host_replay --in raw.gimu --check-personalization
+ *   host_replay --in raw.gimu --bench-spectral [--spectral-csv features.csv]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "dataset/imu_dataset.h"
+#include "inference_scheduler.h"
+#include "replay/dlpf_check.h"
+#include "replay/filter_op_check.h"
+#include "replay/first_stage_fit.h"
+#include "replay/personalization_check.h"
+#include "replay/pushup_replay.h"
+#include "replay/rep_check.h"
+#include "replay/spectral_bench.h"
+
+namespace {
+
+constexpr uint32_t kFixedIntervalMs = 200;  // Old INFERENCE_INTERVAL_MS
+
+enum Schedule { kScheduleFixed, kScheduleAdaptive };
+const char* const kScheduleNames[] = {"fixed", "adaptive"};
+
+struct ReplayMode {
+    Schedule schedule;
+    bool cascade;
+};
+
+struct ReplayStats {
+    int sessions = 0;
+    int final_correct = 0;      // Last inference of the recording (what the device shows)
+    int vote_correct = 0;       // Confidence-weighted vote over all inferences
+    uint64_t inferences = 0;
+    uint64_t invokes = 0;       // Inferences that ran the CNN
+    uint64_t correct_inferences = 0;
+    uint64_t exits = 0;
+    uint64_t correct_exits = 0;
+    uint64_t skipped = 0;
+    std::vector<uint32_t> latency_us;
+};
+
+void PrintUsage() {
+    printf("Usage: host_replay --in FILE.gimu [options]\n");
+    printf("  --schedule S            fixed, adaptive or both (default both)\n");
+    printf("  --cascade               also run every schedule with the first-stage early exit\n");
+    printf("  --limit N               stop after N sessions\n");
+    printf("  --fold N                only the recordings of fold N (0 or 1) for replay and fitting\n");
+    printf("  --csv FILE              per-inference results\n");
+    printf("  --fit-first-stage FILE  fit the cascade first stage and write its params header\n");
+    printf("  --exit-precision F      first-stage exit precision target for fitting (default 0.9)\n");
+    printf("  --check-filter-op       compare the GAINS_IMU_FILTER model with the firmware path\n");
+    printf("  --check-dlpf            compare the IMU DLPF configuration with software filtering\n");
+    printf("  --check-reps            count and measure reps on the hand-labelled sessions\n");
+    printf("  --check-personalization adapt the nearest-class-mean head per participant\n");
+    printf("  --bench-spectral        compare spectral frontend features with the raw window input\n");
+    printf("  --spectral-csv FILE     with --bench-spectral: write the spectral features per window\n");
+}
+
+void ModeName(const ReplayMode& mode, char* out, size_t size) {
+    snprintf(out, size, "%s%s", kScheduleNames[mode.schedule], mode.cascade ? "+cascade" : "");
+}
+
+// Replay one recording: samples arrive every SAMPLE_PERIOD_MS and inference
+// runs when the schedule says so, exactly like loop() while RECORDING
+bool ReplaySession(PushupReplay* replay, const ImuDataset& dataset, int session, int expected,
+                   const ReplayMode& mode, ReplayStats* stats, FILE* csv) {
+    const ImuSessionRecord& record = dataset.session(session);
+    const float* columns[kImuChannels];
+    for (int ch = 0; ch < kImuChannels; ch++) columns[ch] = dataset.Column(session, ch);
+
+    char mode_name[32];
+    ModeName(mode, mode_name, sizeof(mode_name));
+
+    InferenceScheduler scheduler;
+    replay->Reset();
+    scheduler.Reset(0);
+    uint32_t last_fixed_ms = 0;
+    bool fixed_started = false;
+
+    float vote[NUM_POSTURE_CLASSES] = {0};
+    int last_class = -1;
+    auto record_prediction = [&](const PushupPrediction& prediction, uint32_t t) {
+        last_class = prediction.best_class;
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+            vote[c] += prediction.probs[c] * prediction.confidence;
+        }
+        const bool correct = prediction.best_class == expected;
+        stats->inferences++;
+        stats->latency_us.push_back(prediction.latency_us);
+        if (correct) stats->correct_inferences++;
+        if (prediction.early_exit) {
+            stats->exits++;
+            if (correct) stats->correct_exits++;
+        } else {
+            stats->invokes++;
+        }
+        if (csv != nullptr) {
+            fprintf(csv, "%s,%d,%d,%u,%u,%.1f,%d,%d,%u,%.4f,%.4f,%.4f,%.4f\n", mode_name, session,
+                    expected, t, t * SAMPLE_PERIOD_MS, scheduler.CurrentRateHz(),
+                    prediction.best_class, prediction.early_exit ? 1 : 0, prediction.latency_us,
+                    prediction.probs[0], prediction.probs[1], prediction.probs[2],
+                    prediction.probs[3]);
+        }
+    };
+
+    for (uint32_t t = 0; t < record.sample_count; t++) {
+        const uint32_t now_ms = t * SAMPLE_PERIOD_MS;
+        float raw[NUM_CHANNELS];
+        float processed[NUM_CHANNELS];
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = columns[ch][t];
+        replay->PushSample(raw, processed);
+        scheduler.OnSample(processed);
+        if (!replay->WindowFull()) continue;
+
+        bool run = false;
+        if (mode.schedule == kScheduleFixed) {
+            run = !fixed_started || now_ms - last_fixed_ms >= kFixedIntervalMs;
+            if (run) {
+                last_fixed_ms = now_ms;
+                fixed_started = true;
+            }
+        } else {
+            run = scheduler.ShouldInfer(now_ms);
+        }
+        if (!run) continue;
+
+        PushupPrediction prediction;
+        if (!replay->Classify(&prediction, mode.cascade)) return false;
+        scheduler.OnPrediction(prediction.best_class, prediction.confidence);
+        record_prediction(prediction, t);
+    }
+
+    // Stop: the firmware refreshes a stale result before voting
+    if (mode.schedule == kScheduleAdaptive && record.sample_count > 0 &&
+        scheduler.ShouldInferFinal((record.sample_count - 1) * SAMPLE_PERIOD_MS)) {
+        PushupPrediction prediction;
+        if (!replay->Classify(&prediction, mode.cascade)) return false;
+        record_prediction(prediction, record.sample_count - 1);
+    }
+
+    int vote_class = 0;
+    for (int c = 1; c < NUM_POSTURE_CLASSES; c++) {
+        if (vote[c] > vote[vote_class]) vote_class = c;
+    }
+    stats->sessions++;
+    if (mode.schedule == kScheduleAdaptive) stats->skipped += scheduler.SkippedCount();
+    if (last_class >= 0 && last_class == expected) stats->final_correct++;
+    if (last_class >= 0 && vote_class == expected) stats->vote_correct++;
+    return true;
+}
+
+uint32_t Percentile(std::vector<uint32_t>* values, double pct) {
+    if (values->empty()) return 0;
+    const size_t index = static_cast<size_t>(pct / 100.0 * (values->size() - 1) + 0.5);
+    std::nth_element(values->begin(), values->begin() + index, values->end());
+    return (*values)[index];
+}
+
+void PrintStats(const ReplayMode& mode, ReplayStats* s) {
+    char name[32];
+    ModeName(mode, name, sizeof(name));
+    const double n = s->sessions > 0 ? s->sessions : 1;
+    const double inferences = s->inferences > 0 ? s->inferences : 1;
+    const uint32_t p50 = Percentile(&s->latency_us, 50);
+    const uint32_t p95 = Percentile(&s->latency_us, 95);
+    const uint32_t p99 = Percentile(&s->latency_us, 99);
+    const uint32_t max = Percentile(&s->latency_us, 100);
+    printf("%-17s %6.1f%% %6.1f%% %7llu %7llu %6.1f%% %6.1f%% %6.1f%% %7llu %6u %6u %6u %6u\n",
+           name, 100.0 * s->final_correct / n, 100.0 * s->vote_correct / n,
+           static_cast<unsigned long long>(s->inferences),
+           static_cast<unsigned long long>(s->invokes), 100.0 * s->exits / inferences,
+           s->exits ? 100.0 * s->correct_exits / s->exits : 0.0,
+           100.0 * s->correct_inferences / inferences, static_cast<unsigned long long>(s->skipped),
+           p50, p95, p99, max);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* in_path = nullptr;
+    const char* csv_path = nullptr;
+    const char* fit_path = nullptr;
+    const char* schedule_arg = "both";
+    bool cascade = false;
+    bool check_filter_op = false;
+    bool check_dlpf = false;
+    bool check_reps = false;
+    bool check_personalization = false;
+    bool bench_spectral = false;
+    SpectralBenchConfig spectral_config;
+    int limit = 0;
+    int fold = -1;
+    FirstStageFitConfig fit_config;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--in") == 0 && value) {
+            in_path = argv[++i];
+        } else if (strcmp(arg, "--schedule") == 0 && value) {
+            schedule_arg = argv[++i];
+        } else if (strcmp(arg, "--cascade") == 0) {
+            cascade = true;
+        } else if (strcmp(arg, "--check-filter-op") == 0) {
+            check_filter_op = true;
+        } else if (strcmp(arg, "--check-dlpf") == 0) {
+            check_dlpf = true;
+        } else if (strcmp(arg, "--check-reps") == 0) {
+            check_reps = true;
+        } else if (strcmp(arg, "--check-personalization") == 0) {
+            check_personalization = true;
+        } else if (strcmp(arg, "--bench-spectral") == 0) {
+            bench_spectral = true;
+        } else if (strcmp(arg, "--spectral-csv") == 0 && value) {
+            spectral_config.csv_path = argv[++i];
+        } else if (strcmp(arg, "--limit") == 0 && value) {
+            limit = atoi(argv[++i]);
+        } else if (strcmp(arg, "--fold") == 0 && value) {
+            fold = atoi(argv[++i]);
+            fit_config.fold = fold;
+        } else if (strcmp(arg, "--csv") == 0 && value) {
+            csv_path = argv[++i];
+        } else if (strcmp(arg, "--fit-first-stage") == 0 && value) {
+            fit_path = argv[++i];
+        } else if (strcmp(arg, "--exit-precision") == 0 && value) {
+            fit_config.target_precision = static_cast<float>(atof(argv[++i]));
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (in_path == nullptr) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<ReplayMode> modes;
+    for (int pass = 0; pass < (cascade ? 2 : 1); pass++) {
+        if (strcmp(schedule_arg, "fixed") == 0 || strcmp(schedule_arg, "both") == 0) {
+            modes.push_back({kScheduleFixed, pass == 1});
+        }
+        if (strcmp(schedule_arg, "adaptive") == 0 || strcmp(schedule_arg, "both") == 0) {
+            modes.push_back({kScheduleAdaptive, pass == 1});
+        }
+    }
+    if (modes.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    ImuDataset dataset;
+    if (!dataset.Open(in_path)) return 1;
+    if (dataset.header().flags & kImuDatasetFiltered) {
+        fprintf(stderr, "[REPLAY] WARNING: %s is already filtered, replay expects raw samples\n",
+                in_path);
+    }
+
+    static PushupReplay replay;
+    if (!replay.Init()) return 1;
+
+    if (fit_path != nullptr) {
+        return FitFirstStage(dataset, &replay, fit_config, fit_path) ? 0 : 1;
+    }
+    if (check_filter_op) {
+        return CheckFilterOp(dataset, &replay, fit_config.window_stride) ? 0 : 1;
+    }
+    if (check_dlpf) {
+        return CheckImuDlpf(dataset, &replay, fit_config.window_stride) ? 0 : 1;
+    }
+    if (check_reps) {
+        return CheckRepAnalytics(dataset, &replay) ? 0 : 1;
+    }
+    if (check_personalization) {
+        return CheckPersonalization(dataset, &replay) ? 0 : 1;
+    }
+    if (bench_spectral) {
+        return RunSpectralBench(dataset, &replay, spectral_config) ? 0 : 1;
+    }
+
+    FILE* csv = nullptr;
+    if (csv_path != nullptr) {
+        csv = fopen(csv_path, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "[REPLAY] ERROR: cannot open %s\n", csv_path);
+            return 1;
+        }
+        fprintf(csv, "mode,session,expected,sample,time_ms,rate_hz,predicted,early_exit,"
+                     "latency_us,p0,p1,p2,p3\n");
+    }
+
+    int sessions = dataset.num_sessions();
+    if (limit > 0 && limit < sessions) sessions = limit;
+
+    const std::vector<int> folds = RecordingFolds(dataset);
+    std::vector<ReplayStats> stats(modes.size());
+    for (size_t m = 0; m < modes.size(); m++) {
+        for (int s = 0; s < sessions; s++) {
+            const int expected = PostureClassFromLabel(dataset.LabelName(dataset.session(s).label));
+            if (expected < 0 || dataset.session(s).sample_count < WINDOW_SIZE) continue;
+            if (fold >= 0 && folds[s] != fold) continue;
+            if (!ReplaySession(&replay, dataset, s, expected, modes[m], &stats[m], csv)) {
+                return 1;
+            }
+        }
+    }
+    if (csv != nullptr) fclose(csv);
+
+    if (fold >= 0) {
+        printf("[REPLAY] %s: %d sessions of fold %d\n", in_path, stats[0].sessions, fold);
+    } else {
+        printf("[REPLAY] %s: %d sessions\n", in_path, stats[0].sessions);
+    }
+    printf("%-17s %7s %7s %7s %7s %7s %7s %7s %7s %6s %6s %6s %6s\n", "mode", "final", "vote",
+           "infer", "invoke", "exit", "exit-ok", "win-ok", "skipped", "p50us", "p95us", "p99us",
+           "maxus");
+    for (size_t m = 0; m < modes.size(); m++) PrintStats(modes[m], &stats[m]);
+    if (modes.size() >= 2 && modes[0].schedule == kScheduleFixed && stats[0].invokes > 0) {
+        for (size_t m = 1; m < modes.size(); m++) {
+            char name[32];
+            ModeName(modes[m], name, sizeof(name));
+            printf("[REPLAY] %s vs fixed: %.1f%% fewer invokes, final accuracy %+.1f points\n",
+                   name,
+                   100.0 * (1.0 - static_cast<double>(stats[m].invokes) / stats[0].invokes),
+                   100.0 * (stats[m].final_correct - stats[0].final_correct) /
+                       (stats[0].sessions ? stats[0].sessions : 1));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,257 @@
+#include "replay/spectral_bench.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "imu_spectral_frontend.h"
+#include "pushup_inference.h"
+
+namespace {
+
+constexpr int kRawFeatureSize = WINDOW_SIZE * NUM_CHANNELS;
+
+struct FeatureSet {
+    const char* name;
+    int size;
+    std::vector<float> x;  // num_windows x size
+};
+
+struct LinearModel {
+    std::vector<float> mean;
+    std::vector<float> stddev;
+    std::vector<float> weights;  // NUM_POSTURE_CLASSES x size
+    float bias[NUM_POSTURE_CLASSES];
+};
+
+uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int Predict(const LinearModel& model, int size, const float* x, float* scratch) {
+    for (int f = 0; f < size; f++) scratch[f] = (x[f] - model.mean[f]) / model.stddev[f];
+    int best = 0;
+    float best_logit = -1e30f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        float logit = model.bias[c];
+        const float* w = &model.weights[c * size];
+        for (int f = 0; f < size; f++) logit += w[f] * scratch[f];
+        if (logit > best_logit) {
+            best_logit = logit;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// Multinomial logistic regression on standardized features (same recipe as
+// the first-stage fit), trained on the windows with train[i] set
+LinearModel FitLinear(const FeatureSet& set, const std::vector<int>& labels,
+                      const std::vector<bool>& train, const SpectralBenchConfig& config) {
+    const int size = set.size;
+    const int n = static_cast<int>(labels.size());
+    LinearModel model;
+    model.mean.assign(size, 0.0f);
+    model.stddev.assign(size, 0.0f);
+    model.weights.assign(NUM_POSTURE_CLASSES * size, 0.0f);
+    memset(model.bias, 0, sizeof(model.bias));
+
+    int train_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (!train[i]) continue;
+        train_count++;
+        for (int f = 0; f < size; f++) model.mean[f] += set.x[i * size + f];
+    }
+    for (int f = 0; f < size; f++) model.mean[f] /= train_count;
+    for (int i = 0; i < n; i++) {
+        if (!train[i]) continue;
+        for (int f = 0; f < size; f++) {
+            const float d = set.x[i * size + f] - model.mean[f];
+            model.stddev[f] += d * d;
+        }
+    }
+    for (int f = 0; f < size; f++) model.stddev[f] = sqrtf(model.stddev[f] / train_count) + 1e-6f;
+
+    std::vector<float> standardized;
+    std::vector<int> train_labels;
+    for (int i = 0; i < n; i++) {
+        if (!train[i]) continue;
+        for (int f = 0; f < size; f++) {
+            standardized.push_back((set.x[i * size + f] - model.mean[f]) / model.stddev[f]);
+        }
+        train_labels.push_back(labels[i]);
+    }
+
+    std::vector<float> grad_w(NUM_POSTURE_CLASSES * size);
+    for (int it = 0; it < config.iterations; it++) {
+        std::fill(grad_w.begin(), grad_w.end(), 0.0f);
+        float grad_b[NUM_POSTURE_CLASSES] = {0};
+        for (int i = 0; i < train_count; i++) {
+            const float* x = &standardized[i * size];
+            float logits[NUM_POSTURE_CLASSES];
+            float max_logit = -1e30f;
+            for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+                logits[c] = model.bias[c];
+                const float* w = &model.weights[c * size];
+                for (int f = 0; f < size; f++) logits[c] += w[f] * x[f];
+                if (logits[c] > max_logit) max_logit = logits[c];
+            }
+            float sum = 0.0f;
+            for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+                logits[c] = expf(logits[c] - max_logit);
+                sum += logits[c];
+            }
+            for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+                const float err = logits[c] / sum - (c == train_labels[i] ? 1.0f : 0.0f);
+                grad_b[c] += err;
+                float* g = &grad_w[c * size];
+                for (int f = 0; f < size; f++) g[f] += err * x[f];
+            }
+        }
+        const float step = config.learning_rate / train_count;
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+            model.bias[c] -= step * grad_b[c];
+            for (int f = 0; f < size; f++) {
+                float& w = model.weights[c * size + f];
+                w -= step * grad_w[c * size + f] + config.learning_rate * config.l2 * w;
+            }
+        }
+    }
+    return model;
+}
+
+}  // namespace
+
+bool RunSpectralBench(const ImuDataset& dataset, PushupReplay* replay,
+                      const SpectralBenchConfig& config) {
+    ImuSpectralFrontend frontend;
+    if (!frontend.Init()) {
+        fprintf(stderr, "[SPECTRAL] ERROR: frontend allocation failed\n");
+        return false;
+    }
+
+    FeatureSet raw_set = {"raw 50x6", kRawFeatureSize, {}};
+    FeatureSet spectral_set = {"spectral", SPECTRAL_FEATURE_SIZE, {}};
+    std::vector<int> labels;
+    std::vector<bool> train;
+    std::vector<int> sessions;
+    std::vector<int> cnn_predictions;
+    uint64_t frontend_ns = 0;
+    uint64_t frontend_samples = 0;
+    uint64_t raw_input_ns = 0;
+    uint64_t invoke_us = 0;
+
+    const bool by_participant = dataset.num_participants() > 1;
+    float window[WINDOW_SIZE][NUM_CHANNELS];
+    for (int s = 0; s < dataset.num_sessions(); s++) {
+        const int label = PostureClassFromLabel(dataset.LabelName(dataset.session(s).label));
+        if (label < 0) continue;
+        const bool held_out = (by_participant ? dataset.session(s).participant : s) % 4 == 0;
+
+        replay->Reset();
+        frontend.Reset();
+        memset(window, 0, sizeof(window));
+        int head = 0;
+        const uint32_t count = dataset.session(s).sample_count;
+        for (uint32_t t = 0; t < count; t++) {
+            float raw[NUM_CHANNELS];
+            float processed[NUM_CHANNELS];
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) raw[ch] = dataset.Column(s, ch)[t];
+            replay->PushSample(raw, processed);
+            memcpy(window[head], processed, sizeof(processed));
+            head = (head + 1) % WINDOW_SIZE;
+
+            const uint64_t start = NowNs();
+            frontend.ProcessSample(processed);
+            frontend_ns += NowNs() - start;
+            frontend_samples++;
+
+            if (t + 1 < WINDOW_SIZE || (t + 1 - WINDOW_SIZE) % config.window_stride != 0) continue;
+            if (frontend.FrameCount() < SPECTRAL_NUM_FRAMES) continue;
+
+            // Raw input exactly as the firmware builds it
+            float normalized[WINDOW_SIZE][NUM_CHANNELS];
+            const uint64_t raw_start = NowNs();
+            NormalizeWindow(window, WINDOW_SIZE, head, normalized);
+            QuantizeWindow(normalized, replay->interpreter()->input(0));
+            raw_input_ns += NowNs() - raw_start;
+            raw_set.x.insert(raw_set.x.end(), &normalized[0][0],
+                             &normalized[0][0] + kRawFeatureSize);
+
+            float spectral[SPECTRAL_FEATURE_SIZE];
+            frontend.GetFeatures(spectral);
+            spectral_set.x.insert(spectral_set.x.end(), spectral, spectral + SPECTRAL_FEATURE_SIZE);
+
+            PushupPrediction prediction;
+            if (!replay->Classify(&prediction)) return false;
+            invoke_us += prediction.invoke_us;
+            cnn_predictions.push_back(prediction.best_class);
+
+            labels.push_back(label);
+            train.push_back(!held_out);
+            sessions.push_back(s);
+        }
+    }
+
+    const int n = static_cast<int>(labels.size());
+    int test_count = 0;
+    int cnn_correct = 0;
+    for (int i = 0; i < n; i++) {
+        if (train[i]) continue;
+        test_count++;
+        if (cnn_predictions[i] == labels[i]) cnn_correct++;
+    }
+    if (test_count == 0 || test_count == n) {
+        fprintf(stderr, "[SPECTRAL] ERROR: need both training and held-out windows\n");
+        return false;
+    }
+
+    if (config.csv_path != nullptr) {
+        FILE* csv = fopen(config.csv_path, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "[SPECTRAL] ERROR: cannot write %s\n", config.csv_path);
+            return false;
+        }
+        fprintf(csv, "session,label,held_out");
+        for (int f = 0; f < SPECTRAL_FEATURE_SIZE; f++) fprintf(csv, ",f%d", f);
+        fprintf(csv, "\n");
+        for (int i = 0; i < n; i++) {
+            fprintf(csv, "%d,%s,%d", sessions[i], posture_labels[labels[i]], train[i] ? 0 : 1);
+            for (int f = 0; f < SPECTRAL_FEATURE_SIZE; f++) {
+                fprintf(csv, ",%.4f", spectral_set.x[i * SPECTRAL_FEATURE_SIZE + f]);
+            }
+            fprintf(csv, "\n");
+        }
+        fclose(csv);
+    }
+
+    const double frontend_per_window_us =
+        static_cast<double>(frontend_ns) / frontend_samples * config.window_stride / 1000.0;
+    printf("[SPECTRAL] %d windows (%d held out), frontend %.0f ns/sample\n", n, test_count,
+           static_cast<double>(frontend_ns) / frontend_samples);
+    printf("%-10s %7s %14s %12s %10s\n", "input", "values", "input us/win", "linear MACs",
+           "held-out");
+    const FeatureSet* sets[] = {&raw_set, &spectral_set};
+    for (const FeatureSet* set : sets) {
+        const LinearModel model = FitLinear(*set, labels, train, config);
+        std::vector<float> scratch(set->size);
+        int correct = 0;
+        for (int i = 0; i < n; i++) {
+            if (!train[i] && Predict(model, set->size, &set->x[i * set->size], scratch.data()) ==
+                                 labels[i]) {
+                correct++;
+            }
+        }
+        const double input_us = set == &raw_set ? static_cast<double>(raw_input_ns) / n / 1000.0
+                                                : frontend_per_window_us;
+        printf("%-10s %7d %14.2f %12d %9.1f%%\n", set->name, set->size, input_us,
+               set->size * NUM_POSTURE_CLASSES, 100.0 * correct / test_count);
+    }
+    printf("%-10s %7d %14.2f %12s %9.1f%%  (CNN, %.0f us/invoke)\n", "raw 50x6", kRawFeatureSize,
+           static_cast<double>(raw_input_ns) / n / 1000.0, "-", 100.0 * cnn_correct / test_count,
+           static_cast<double>(invoke_us) / n);
+    return true;
+}
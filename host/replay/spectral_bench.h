@@ -0,0 +1,30 @@
+/* Benchmark of the streaming spectral frontend (include/imu_spectral_frontend.h)
+ * against the raw 50x6 model input.
+ *
+ * Streams a raw dataset through the firmware preprocessing, builds both
+ * inputs for every window at the training stride and reports:
+ *   - input size and per-window feature cost (frontend amortized per window
+ *     vs NormalizeWindow + QuantizeWindow)
+ *   - held-out accuracy of the same small classifier (softmax regression) on
+ *     either input, plus the committed CNN on the raw window for reference
+ * Sessions of every fourth participant (every fourth session if the dataset
+ * has no participant table) are held out.
+ */
+#ifndef HOST_REPLAY_SPECTRAL_BENCH_H_
+#define HOST_REPLAY_SPECTRAL_BENCH_H_
+
+#include "dataset/imu_dataset.h"
+#include "replay/pushup_replay.h"
+
+struct SpectralBenchConfig {
+    int window_stride = 10;      // Training stride
+    int iterations = 1500;       // Full-batch gradient descent steps
+    float learning_rate = 0.5f;
+    float l2 = 1e-3f;
+    const char* csv_path = nullptr;  // Optional: spectral features + label per window
+};
+
+bool RunSpectralBench(const ImuDataset& dataset, PushupReplay* replay,
+                      const SpectralBenchConfig& config);
+
+#endif  // HOST_REPLAY_SPECTRAL_BENCH_H_
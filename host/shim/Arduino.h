@@ -0,0 +1,134 @@
+#ifndef HOST_SHIM_ARDUINO_H_
+#define HOST_SHIM_ARDUINO_H_
+
+// Minimal Arduino API so firmware sources (src/preprocessing.cpp, ...) and
+// the vendored TFLM library build on the host. Only what those sources use.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// As the ESP32 core does
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Host clock: steady_clock by default. In virtual time micros()/millis()
+// only move when delay()/delayMicroseconds() or HostClockAdvanceUs() are
+// called, so tools can run firmware code for hours of device time in
+// milliseconds and get the same timings on every run.
+void HostClockSetVirtual(bool enabled);
+bool HostClockIsVirtual();
+uint64_t HostClockUs();  // micros() without the 32-bit wrap
+
+// What virtual time was spent on
+enum HostTimeKind {
+    HOST_TIME_CPU,     // HostChargeCycles() and HostClockAdvanceUs() by default
+    HOST_TIME_DELAY,   // delay(), delayMicroseconds(), vTaskDelay()
+    HOST_TIME_I2C,     // i2c_master_cmd_begin() bus time
+    HOST_TIME_SERIAL,  // Serial calls
+    HOST_TIME_SLEEP,   // esp_light_sleep_start()
+    NUM_HOST_TIME_KINDS
+};
+
+void HostClockAdvanceUs(uint64_t us, HostTimeKind kind = HOST_TIME_CPU);
+uint64_t HostClockTotalUs(HostTimeKind kind);  // Since HostClockSetVirtual(true)
+
+// Virtual time: hook runs the tool's events due at now_us (button edges,
+// serial input, ...) and returns when the next one is due (UINT64_MAX for
+// none). Every clock advance stops at each event on the way, so events land
+// inside a delay() at their own time.
+typedef uint64_t (*HostEventHook)(uint64_t now_us, void* context);
+void HostClockSetEventHook(HostEventHook hook, void* context, uint64_t first_event_us);
+uint64_t HostClockNextEventUs();
+
+// Modeled device cost of the shim calls, charged in virtual time only. All
+// zero by default (the calls are free); the simulator (host/sim) sets them.
+struct HostCostModel {
+    uint32_t cpu_mhz;              // HostChargeCycles() cycles -> us
+    uint32_t i2c_hz;               // Bus clock, 9 bit times per byte; 0 = free
+    uint32_t i2c_transaction_us;   // Driver overhead per i2c_master_cmd_begin()
+    uint32_t serial_call_cycles;   // Per Serial call (print, available, read, ...)
+    uint32_t serial_byte_ns;       // Per byte written
+    uint32_t light_sleep_wake_us;  // Exit from esp_light_sleep_start()
+};
+void HostSetCostModel(const HostCostModel& model);
+const HostCostModel& HostGetCostModel();
+void HostChargeCycles(uint64_t cycles, HostTimeKind kind = HOST_TIME_CPU);
+
+// GPIO: inputs are driven by the host tool, outputs only remembered
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+// Drive an input pin; an attached interrupt runs on a matching edge
+void HostGpioSet(uint8_t pin, int level);
+
+// Serial writes to stdout unless muted; reads return what the host tool
+// queued with Input().
+class HostSerial {
+public:
+    bool muted = false;  // Host tools running firmware code quietly
+    // Sees all output, muted or not
+    void (*tap)(const char* data, size_t len, void* context) = nullptr;
+    void* tap_context = nullptr;
+
+    void begin(unsigned long) {}
+    void end() {}
+    explicit operator bool() const { return true; }
+    int available();
+    int read();
+    int peek();
+    size_t readBytes(uint8_t* buffer, size_t length);
+    void flush() { fflush(stdout); }
+    size_t write(uint8_t c) { return Emit(reinterpret_cast<const char*>(&c), 1); }
+    size_t write(const uint8_t* buffer, size_t size) {
+        return Emit(reinterpret_cast<const char*>(buffer), size);
+    }
+    size_t print(const char* s) { return Emit(s, strlen(s)); }
+    size_t print(char c) { return Emit(&c, 1); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(T v) { return print(v) + println(); }
+    size_t println(double v, int digits) { return print(v, digits) + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    // Host side: bytes for available()/read()
+    void Input(const char* data, size_t len);
+
+private:
+    size_t Emit(const char* data, size_t len);
+
+    std::string input_;
+    size_t input_pos_ = 0;
+};
+
+extern HostSerial Serial;
+
+#endif  // HOST_SHIM_ARDUINO_H_
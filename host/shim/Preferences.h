@@ -0,0 +1,29 @@
+#ifndef HOST_SHIM_PREFERENCES_H_
+#define HOST_SHIM_PREFERENCES_H_
+
+// Arduino-ESP32 Preferences (NVS key/value store) for host runs of
+// src/main.cpp. Namespaces live in memory for the life of the process, so a
+// host tool can restart the firmware and see what it stored; nothing is
+// written to disk. Only the byte-blob API the firmware uses.
+
+#include <cstddef>
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false, const char* partition_label = nullptr);
+    void end();
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t max_len);
+    size_t getBytesLength(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+private:
+    std::string name_;
+    bool open_ = false;
+    bool read_only_ = false;
+};
+
+#endif  // HOST_SHIM_PREFERENCES_H_
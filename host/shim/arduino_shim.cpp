@@ -0,0 +1,289 @@
+#include "Arduino.h"
+#include "Preferences.h"
+
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+HostSerial Serial;
+
+namespace {
+const auto kStart = std::chrono::steady_clock::now();
+bool g_virtual = false;
+uint64_t g_virtual_us = 0;
+uint64_t g_totals_us[NUM_HOST_TIME_KINDS] = {};
+HostCostModel g_costs = {};
+uint64_t g_pending_cycles = 0;  // Below one us, carried to the next charge
+
+HostEventHook g_event_hook = nullptr;
+void* g_event_context = nullptr;
+uint64_t g_next_event_us = UINT64_MAX;
+
+// Preferences: "namespace/key" -> blob
+std::map<std::string, std::vector<uint8_t>> g_preferences;
+
+constexpr int kPins = 49;
+struct Pin {
+    uint8_t mode;
+    int level;
+    void (*isr)();
+    int isr_mode;
+};
+Pin g_pins[kPins] = {};
+
+// Serial calls cost CPU time, output bytes take bus time
+void ChargeSerial(size_t bytes) {
+    if (!g_virtual) return;
+    HostChargeCycles(g_costs.serial_call_cycles, HOST_TIME_SERIAL);
+    if (bytes > 0 && g_costs.serial_byte_ns > 0) {
+        HostClockAdvanceUs((bytes * g_costs.serial_byte_ns + 999) / 1000, HOST_TIME_SERIAL);
+    }
+}
+}  // namespace
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+void HostClockSetVirtual(bool enabled) {
+    g_virtual = enabled;
+    g_virtual_us = 0;
+    g_pending_cycles = 0;
+    for (uint64_t& total : g_totals_us) total = 0;
+}
+
+bool HostClockIsVirtual() {
+    return g_virtual;
+}
+
+void HostClockAdvanceUs(uint64_t us, HostTimeKind kind) {
+    const uint64_t target = g_virtual_us + us;
+    g_totals_us[kind] += us;
+    // Events inside the advance run at their own time
+    while (g_event_hook != nullptr && g_next_event_us <= target) {
+        if (g_next_event_us > g_virtual_us) g_virtual_us = g_next_event_us;
+        g_next_event_us = g_event_hook(g_virtual_us, g_event_context);
+    }
+    g_virtual_us = target;
+}
+
+uint64_t HostClockTotalUs(HostTimeKind kind) {
+    return g_totals_us[kind];
+}
+
+void HostClockSetEventHook(HostEventHook hook, void* context, uint64_t first_event_us) {
+    g_event_hook = hook;
+    g_event_context = context;
+    g_next_event_us = hook != nullptr ? first_event_us : UINT64_MAX;
+}
+
+uint64_t HostClockNextEventUs() {
+    return g_next_event_us;
+}
+
+uint64_t HostClockUs() {
+    if (g_virtual) return g_virtual_us;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - kStart).count());
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(HostClockUs());
+}
+
+unsigned long millis() {
+    return static_cast<unsigned long>(HostClockUs() / 1000);
+}
+
+void delay(unsigned long ms) {
+    if (g_virtual) {
+        HostClockAdvanceUs(static_cast<uint64_t>(ms) * 1000, HOST_TIME_DELAY);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (g_virtual) {
+        HostClockAdvanceUs(us, HOST_TIME_DELAY);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ============================================================================
+// COST MODEL
+// ============================================================================
+
+void HostSetCostModel(const HostCostModel& model) {
+    g_costs = model;
+}
+
+const HostCostModel& HostGetCostModel() {
+    return g_costs;
+}
+
+void HostChargeCycles(uint64_t cycles, HostTimeKind kind) {
+    if (!g_virtual || g_costs.cpu_mhz == 0) return;
+    g_pending_cycles += cycles;
+    const uint64_t us = g_pending_cycles / g_costs.cpu_mhz;
+    if (us == 0) return;
+    g_pending_cycles -= us * g_costs.cpu_mhz;
+    HostClockAdvanceUs(us, kind);
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+// Inputs read LOW until driven: the board's button is active high
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < kPins) g_pins[pin].mode = mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < kPins ? g_pins[pin].level : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < kPins) g_pins[pin].level = value ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode) {
+    if (interrupt >= kPins) return;
+    g_pins[interrupt].isr = isr;
+    g_pins[interrupt].isr_mode = mode;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if (interrupt < kPins) g_pins[interrupt].isr = nullptr;
+}
+
+void tone(uint8_t, unsigned int, unsigned long) {}
+
+void noTone(uint8_t) {}
+
+void HostGpioSet(uint8_t pin, int level) {
+    if (pin >= kPins) return;
+    Pin& p = g_pins[pin];
+    level = level ? HIGH : LOW;
+    if (level == p.level) return;
+    p.level = level;
+    const int edge = level == HIGH ? RISING : FALLING;
+    if (p.isr != nullptr && (p.isr_mode & edge) != 0) p.isr();
+}
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+
+int HostSerial::available() {
+    ChargeSerial(0);
+    return static_cast<int>(input_.size() - input_pos_);
+}
+
+int HostSerial::read() {
+    ChargeSerial(0);
+    if (input_pos_ >= input_.size()) return -1;
+    const unsigned char c = static_cast<unsigned char>(input_[input_pos_++]);
+    if (input_pos_ == input_.size()) {
+        input_.clear();
+        input_pos_ = 0;
+    }
+    return c;
+}
+
+int HostSerial::peek() {
+    ChargeSerial(0);
+    return input_pos_ < input_.size() ? static_cast<unsigned char>(input_[input_pos_]) : -1;
+}
+
+size_t HostSerial::readBytes(uint8_t* buffer, size_t length) {
+    ChargeSerial(0);
+    const size_t n = min(length, input_.size() - input_pos_);
+    memcpy(buffer, input_.data() + input_pos_, n);
+    input_pos_ += n;
+    if (input_pos_ == input_.size()) {
+        input_.clear();
+        input_pos_ = 0;
+    }
+    return n;
+}
+
+void HostSerial::Input(const char* data, size_t len) {
+    input_.append(data, len);
+}
+
+size_t HostSerial::printf(const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    const int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    if (static_cast<size_t>(n) < sizeof(buffer)) return Emit(buffer, n);
+
+    std::string long_text(n + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&long_text[0], long_text.size(), format, args);
+    va_end(args);
+    return Emit(long_text.data(), n);
+}
+
+size_t HostSerial::Emit(const char* data, size_t len) {
+    ChargeSerial(len);
+    if (tap != nullptr) tap(data, len, tap_context);
+    if (muted) return len;
+    return fwrite(data, 1, len, stdout);
+}
+
+// ============================================================================
+// PREFERENCES
+// ============================================================================
+
+bool Preferences::begin(const char* name, bool read_only, const char*) {
+    name_ = name;
+    read_only_ = read_only;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!open_ || read_only_) return 0;
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    g_preferences[name_ + "/" + key].assign(bytes, bytes + len);
+    return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t max_len) {
+    if (!open_) return 0;
+    const auto it = g_preferences.find(name_ + "/" + key);
+    if (it == g_preferences.end() || it->second.size() > max_len) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!open_) return 0;
+    const auto it = g_preferences.find(name_ + "/" + key);
+    return it == g_preferences.end() ? 0 : it->second.size();
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || read_only_) return false;
+    return g_preferences.erase(name_ + "/" + key) > 0;
+}
+
+bool Preferences::clear() {
+    if (!open_ || read_only_) return false;
+    const std::string prefix = name_ + "/";
+    for (auto it = g_preferences.begin(); it != g_preferences.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? g_preferences.erase(it) : ++it;
+    }
+    return true;
+}
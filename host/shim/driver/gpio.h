@@ -0,0 +1,22 @@
+#ifndef HOST_SHIM_DRIVER_GPIO_H_
+#define HOST_SHIM_DRIVER_GPIO_H_
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_5 = 5,
+    GPIO_NUM_6 = 6,
+    GPIO_NUM_MAX = 49,  // Any pin number below fits
+} gpio_num_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE = 1,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_LOW_LEVEL = 4,
+    GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+#endif  // HOST_SHIM_DRIVER_GPIO_H_
@@ -0,0 +1,90 @@
+#ifndef HOST_SHIM_DRIVER_I2C_H_
+#define HOST_SHIM_DRIVER_I2C_H_
+
+// Legacy ESP-IDF I2C master API as used by src/oled_display.cpp and
+// src/imu_provider.cpp. Command links are heap-allocated byte lists like on
+// the device; i2c_master_cmd_begin() hands the written bytes to the host
+// capture below instead of a bus, and to a HostI2cDevice attached at the
+// target address, which also answers reads. Reads from an address without a
+// device fail like a NACK.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+#define pdMS_TO_TICKS(ms) (ms)  // FreeRTOS, normally via the driver headers
+void vTaskDelay(uint32_t ticks);  // delay(), so it follows the host clock
+
+typedef int i2c_port_t;
+#define I2C_NUM_0 0
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER = 1,
+} i2c_mode_t;
+
+#define I2C_MASTER_WRITE 0
+#define I2C_MASTER_READ 1
+
+typedef enum {
+    I2C_MASTER_ACK = 0,
+    I2C_MASTER_NACK = 1,
+    I2C_MASTER_LAST_NACK = 2,
+} i2c_ack_type_t;
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    int scl_io_num;
+    bool sda_pullup_en;
+    bool scl_pullup_en;
+    struct {
+        uint32_t clk_speed;
+    } master;
+    uint32_t clk_flags;
+} i2c_config_t;
+
+typedef struct HostI2cCmd* i2c_cmd_handle_t;
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags);
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t len, bool ack_en);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t* data, size_t len, i2c_ack_type_t ack);
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t* data, i2c_ack_type_t ack);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, int ticks_to_wait);
+
+// Host capture of everything sent with i2c_master_cmd_begin()
+struct HostI2cStats {
+    uint64_t transactions;
+    uint64_t bytes;      // Including address and control bytes
+    uint32_t checksum;   // FNV-1a over all bytes, to compare encodings
+};
+const HostI2cStats& HostI2cGetStats();
+void HostI2cResetStats();
+
+// Virtual time charged for transactions to a 7-bit address (by the first
+// START) under the cost model's i2c_hz (Arduino.h); reset with the stats
+uint64_t HostI2cBusUs(uint8_t address);
+
+// Register-level model of a chip on the bus (e.g. host/shim/fake_icm20600.h).
+// Write() gets the bytes after the address byte of a write, Read() fills the
+// bytes of a read; a write then a repeated-start read arrive as two calls.
+class HostI2cDevice {
+public:
+    virtual ~HostI2cDevice() {}
+    virtual void Write(const uint8_t* data, size_t len) = 0;
+    virtual void Read(uint8_t* data, size_t len) = 0;
+};
+
+// Attach (or with nullptr detach) the device answering at a 7-bit address
+void HostI2cAttach(uint8_t address, HostI2cDevice* device);
+
+#endif  // HOST_SHIM_DRIVER_I2C_H_
@@ -0,0 +1,28 @@
+#ifndef HOST_SHIM_ESP_ERR_H_
+#define HOST_SHIM_ESP_ERR_H_
+
+// ESP-IDF error codes for host builds of src/oled_display.cpp and src/imu_provider.cpp
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_TIMEOUT 0x107
+
+const char* esp_err_to_name(esp_err_t code);
+
+#define ESP_ERROR_CHECK(x)                                                    \
+    do {                                                                      \
+        esp_err_t err_rc_ = (x);                                              \
+        if (err_rc_ != ESP_OK) {                                              \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: %s\n", esp_err_to_name(err_rc_)); \
+            abort();                                                          \
+        }                                                                     \
+    } while (0)
+
+#endif  // HOST_SHIM_ESP_ERR_H_
@@ -0,0 +1,314 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "Arduino.h"
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_task_wdt.h"
+
+// One START (or repeated START) and the writes/reads after it, in order.
+// Writes point into the byte list, so a command link still costs one
+// allocation for its bytes.
+struct HostI2cOp {
+    bool read;
+    size_t offset;   // Write: first byte in bytes
+    size_t len;
+    uint8_t* dest;   // Read
+};
+
+constexpr int kMaxOps = 8;
+
+struct HostI2cCmd {
+    uint8_t* bytes;
+    size_t size;
+    size_t capacity;
+    HostI2cOp ops[kMaxOps];
+    int op_count;
+    int starts[kMaxOps];  // Index of the first op of every START
+    int start_count;
+    bool overflow;
+};
+
+namespace {
+HostI2cStats g_i2c_stats = {0, 0, 2166136261u};
+HostI2cDevice* g_devices[128] = {};
+uint64_t g_bus_us[128] = {};
+
+constexpr int kGpioPins = GPIO_NUM_MAX;
+gpio_int_type_t g_wakeup_levels[kGpioPins] = {};
+bool g_timer_wakeup = false;
+uint64_t g_timer_wakeup_us = 0;
+esp_sleep_wakeup_cause_t g_wakeup_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+HostWatchdogStats g_wdt = {0, 0, 0};
+uint64_t g_wdt_last_reset_us = 0;
+
+esp_err_t Append(i2c_cmd_handle_t cmd, const uint8_t* data, size_t len) {
+    if (cmd->size + len > cmd->capacity) {
+        size_t capacity = cmd->capacity ? cmd->capacity * 2 : 32;
+        while (capacity < cmd->size + len) capacity *= 2;
+        uint8_t* bytes = static_cast<uint8_t*>(realloc(cmd->bytes, capacity));
+        if (bytes == nullptr) return ESP_FAIL;
+        cmd->bytes = bytes;
+        cmd->capacity = capacity;
+    }
+    // Consecutive writes are one op
+    HostI2cOp* last = cmd->op_count > 0 ? &cmd->ops[cmd->op_count - 1] : nullptr;
+    const bool after_start = cmd->start_count > 0 && cmd->starts[cmd->start_count - 1] == cmd->op_count;
+    if (last != nullptr && !last->read && !after_start) {
+        last->len += len;
+    } else if (cmd->op_count < kMaxOps) {
+        cmd->ops[cmd->op_count++] = {false, cmd->size, len, nullptr};
+    } else {
+        cmd->overflow = true;
+    }
+    memcpy(cmd->bytes + cmd->size, data, len);
+    cmd->size += len;
+    return ESP_OK;
+}
+
+// Hands one command link to the attached devices. Each START begins with
+// the address byte; a segment for an address without a device only fails
+// when it reads.
+esp_err_t Deliver(i2c_cmd_handle_t cmd) {
+    if (cmd->overflow) return ESP_FAIL;
+    for (int s = 0; s < cmd->start_count; s++) {
+        const int first = cmd->starts[s];
+        const int end = s + 1 < cmd->start_count ? cmd->starts[s + 1] : cmd->op_count;
+        if (first >= end || cmd->ops[first].read) continue;
+        const uint8_t address_byte = cmd->bytes[cmd->ops[first].offset];
+        HostI2cDevice* device = g_devices[address_byte >> 1];
+        for (int i = first; i < end; i++) {
+            const HostI2cOp& op = cmd->ops[i];
+            if (op.read) {
+                if (device == nullptr) return ESP_FAIL;
+                device->Read(op.dest, op.len);
+            } else if (device != nullptr) {
+                // The address byte is not part of the data
+                const size_t skip = i == first ? 1 : 0;
+                if (op.len > skip) device->Write(cmd->bytes + op.offset + skip, op.len - skip);
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+// Bus time of one command link: 9 bit times per byte (8 data + ACK) plus a
+// START and the STOP, and the driver's per-transaction overhead
+uint64_t BusUs(const HostI2cCmd* cmd) {
+    const HostCostModel& costs = HostGetCostModel();
+    if (costs.i2c_hz == 0) return 0;
+    size_t bytes = cmd->size;
+    for (int i = 0; i < cmd->op_count; i++) {
+        if (cmd->ops[i].read) bytes += cmd->ops[i].len;
+    }
+    const uint64_t bits = 9 * bytes + cmd->start_count + 1;
+    return (bits * 1000000 + costs.i2c_hz - 1) / costs.i2c_hz + costs.i2c_transaction_us;
+}
+
+bool GpioWakeupPending() {
+    for (int pin = 0; pin < kGpioPins; pin++) {
+        const gpio_int_type_t level = g_wakeup_levels[pin];
+        if (level == GPIO_INTR_LOW_LEVEL && digitalRead(pin) == LOW) return true;
+        if (level == GPIO_INTR_HIGH_LEVEL && digitalRead(pin) == HIGH) return true;
+    }
+    return false;
+}
+
+void UpdateWatchdog() {
+    if (g_wdt.timeout_s == 0) return;
+    const uint64_t gap = HostClockUs() - g_wdt_last_reset_us;
+    if (gap > g_wdt.longest_gap_us) g_wdt.longest_gap_us = gap;
+}
+}  // namespace
+
+void vTaskDelay(uint32_t ticks) {
+    delay(ticks);
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "ESP_ERR_UNKNOWN";
+    }
+}
+
+esp_err_t i2c_param_config(i2c_port_t, const i2c_config_t*) {
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t, i2c_mode_t, size_t, size_t, int) {
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return static_cast<i2c_cmd_handle_t>(calloc(1, sizeof(HostI2cCmd)));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+    if (cmd == nullptr) return;
+    free(cmd->bytes);
+    free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+    if (cmd->start_count == kMaxOps) {
+        cmd->overflow = true;
+        return ESP_OK;
+    }
+    cmd->starts[cmd->start_count++] = cmd->op_count;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool) {
+    return Append(cmd, &data, 1);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t len, bool) {
+    return Append(cmd, data, len);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t* data, size_t len, i2c_ack_type_t) {
+    if (cmd->op_count == kMaxOps) {
+        cmd->overflow = true;
+        return ESP_OK;
+    }
+    cmd->ops[cmd->op_count++] = {true, 0, len, data};
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t* data, i2c_ack_type_t ack) {
+    return i2c_master_read(cmd, data, 1, ack);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t) {
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t, i2c_cmd_handle_t cmd, int) {
+    g_i2c_stats.transactions++;
+    g_i2c_stats.bytes += cmd->size;
+    for (size_t i = 0; i < cmd->size; i++) {
+        g_i2c_stats.checksum = (g_i2c_stats.checksum ^ cmd->bytes[i]) * 16777619u;
+    }
+    // The device answers at the end of the transfer
+    const uint64_t bus_us = BusUs(cmd);
+    if (bus_us > 0) {
+        if (cmd->start_count > 0 && cmd->starts[0] < cmd->op_count && !cmd->ops[cmd->starts[0]].read) {
+            g_bus_us[(cmd->bytes[cmd->ops[cmd->starts[0]].offset] >> 1) & 0x7F] += bus_us;
+        }
+        HostClockAdvanceUs(bus_us, HOST_TIME_I2C);
+    }
+    return Deliver(cmd);
+}
+
+const HostI2cStats& HostI2cGetStats() {
+    return g_i2c_stats;
+}
+
+void HostI2cResetStats() {
+    g_i2c_stats = {0, 0, 2166136261u};
+    memset(g_bus_us, 0, sizeof(g_bus_us));
+}
+
+uint64_t HostI2cBusUs(uint8_t address) {
+    return g_bus_us[address & 0x7F];
+}
+
+void HostI2cAttach(uint8_t address, HostI2cDevice* device) {
+    g_devices[address & 0x7F] = device;
+}
+
+// ============================================================================
+// SYSTEM, WATCHDOG
+// ============================================================================
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return ESP_RST_POWERON;
+}
+
+esp_err_t esp_task_wdt_init(uint32_t timeout_s, bool) {
+    g_wdt = {timeout_s, 0, 0};
+    g_wdt_last_reset_us = HostClockUs();
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(void*) {
+    return g_wdt.timeout_s > 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_task_wdt_reset(void) {
+    UpdateWatchdog();
+    const uint64_t now = HostClockUs();
+    if (g_wdt.timeout_s > 0 && now - g_wdt_last_reset_us > g_wdt.timeout_s * 1000000ull) {
+        g_wdt.expirations++;
+    }
+    g_wdt_last_reset_us = now;
+    return ESP_OK;
+}
+
+HostWatchdogStats HostWatchdogGetStats() {
+    UpdateWatchdog();
+    return g_wdt;
+}
+
+// ============================================================================
+// LIGHT SLEEP
+// ============================================================================
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (gpio_num < 0 || gpio_num >= kGpioPins) return ESP_FAIL;
+    g_wakeup_levels[gpio_num] = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= kGpioPins) return ESP_FAIL;
+    g_wakeup_levels[gpio_num] = GPIO_INTR_DISABLE;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    g_timer_wakeup = true;
+    g_timer_wakeup_us = time_in_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start(void) {
+    g_wakeup_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    if (!HostClockIsVirtual()) {
+        if (g_timer_wakeup && !GpioWakeupPending()) delay(g_timer_wakeup_us / 1000);
+        g_wakeup_cause = GpioWakeupPending() ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+        return ESP_OK;
+    }
+
+    const uint64_t deadline = g_timer_wakeup ? HostClockUs() + g_timer_wakeup_us : UINT64_MAX;
+    while (g_wakeup_cause == ESP_SLEEP_WAKEUP_UNDEFINED) {
+        const uint64_t now = HostClockUs();
+        if (GpioWakeupPending()) {
+            g_wakeup_cause = ESP_SLEEP_WAKEUP_GPIO;
+        } else if (now >= deadline) {
+            g_wakeup_cause = ESP_SLEEP_WAKEUP_TIMER;
+        } else {
+            // Only a host event can change a wakeup pin
+            const uint64_t next = std::min(deadline, HostClockNextEventUs());
+            if (next == UINT64_MAX) return ESP_FAIL;  // Would never wake
+            HostClockAdvanceUs(next - now, HOST_TIME_SLEEP);
+        }
+    }
+    HostClockAdvanceUs(HostGetCostModel().light_sleep_wake_us, HOST_TIME_SLEEP);
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void) {
+    return g_wakeup_cause;
+}
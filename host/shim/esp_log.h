@@ -0,0 +1,12 @@
+#ifndef HOST_SHIM_ESP_LOG_H_
+#define HOST_SHIM_ESP_LOG_H_
+
+// ESP_LOGx to stderr
+
+#include <cstdio>
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#endif  // HOST_SHIM_ESP_LOG_H_
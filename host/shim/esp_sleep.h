@@ -0,0 +1,27 @@
+#ifndef HOST_SHIM_ESP_SLEEP_H_
+#define HOST_SHIM_ESP_SLEEP_H_
+
+// Light sleep for host runs of src/main.cpp. In virtual time the clock runs
+// (as HOST_TIME_SLEEP) to the timer wakeup or until a wakeup pin shows its
+// level, stopping at every host event on the way (Arduino.h). In real time
+// it is a delay() until the timer.
+
+#include <cstdint>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_TIMER = 4,
+    ESP_SLEEP_WAKEUP_GPIO = 7,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num);
+esp_err_t esp_sleep_enable_gpio_wakeup(void);
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_light_sleep_start(void);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+#endif  // HOST_SHIM_ESP_SLEEP_H_
@@ -0,0 +1,22 @@
+#ifndef HOST_SHIM_ESP_SYSTEM_H_
+#define HOST_SHIM_ESP_SYSTEM_H_
+
+// Reset reason for host runs of src/main.cpp: always a power-on reset
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason(void);
+
+#endif  // HOST_SHIM_ESP_SYSTEM_H_
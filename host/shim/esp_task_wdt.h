@@ -0,0 +1,25 @@
+#ifndef HOST_SHIM_ESP_TASK_WDT_H_
+#define HOST_SHIM_ESP_TASK_WDT_H_
+
+// Task watchdog for host runs of src/main.cpp. Nothing resets: the host
+// records the longest gap between resets on the host clock instead, and how
+// often it was longer than the timeout (each would have been a reset).
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+esp_err_t esp_task_wdt_init(uint32_t timeout_s, bool panic);
+esp_err_t esp_task_wdt_add(void* task);
+esp_err_t esp_task_wdt_reset(void);
+
+struct HostWatchdogStats {
+    uint32_t timeout_s;      // 0 until esp_task_wdt_init()
+    uint64_t longest_gap_us;
+    uint32_t expirations;
+};
+
+// Includes the time since the last reset
+HostWatchdogStats HostWatchdogGetStats();
+
+#endif  // HOST_SHIM_ESP_TASK_WDT_H_
@@ -0,0 +1,236 @@
+#include "fake_icm20600.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "Arduino.h"
+
+namespace {
+
+// Register addresses, as in include/imu_provider.h
+constexpr uint8_t kSmplrtDiv = 0x19;
+constexpr uint8_t kConfig = 0x1A;
+constexpr uint8_t kGyroConfig = 0x1B;
+constexpr uint8_t kAccelConfig = 0x1C;
+constexpr uint8_t kAccelWomXThr = 0x20;
+constexpr uint8_t kIntPinCfg = 0x37;
+constexpr uint8_t kIntEnable = 0x38;
+constexpr uint8_t kIntStatus = 0x3A;
+constexpr uint8_t kAccelXoutH = 0x3B;
+constexpr uint8_t kGyroXoutH = 0x43;
+constexpr uint8_t kAccelIntelCtrl = 0x69;
+constexpr uint8_t kPwrMgmt1 = 0x6B;
+constexpr uint8_t kPwrMgmt2 = 0x6C;
+constexpr uint8_t kWhoAmI = 0x75;
+
+constexpr uint8_t kPwrReset = 0x80;
+constexpr uint8_t kPwrSleep = 0x40;
+constexpr uint8_t kPwrCycle = 0x20;
+constexpr uint8_t kIntLevelLow = 0x80;
+constexpr uint8_t kIntRdClear = 0x10;
+constexpr uint8_t kIntelEnable = 0x80;
+constexpr uint8_t kIntelComparePrevious = 0x40;
+constexpr uint8_t kDataReady = 0x01;
+constexpr float kWomLsbG = 0.004f;
+
+// Approximate typical supply currents (uA), rounded from the ICM-20600
+// datasheet; accel low-power is for ODRs up to ~50 Hz
+enum PowerMode { kSleep, kAccelLowPower, kAccelOnly, kGyroOnly, kSixAxis, kPowerModes };
+constexpr double kCurrentUa[kPowerModes] = {4.0, 30.0, 370.0, 2600.0, 2790.0};
+
+void StillMotion(uint64_t, float accel_g[3], float gyro_dps[3], void*) {
+    accel_g[0] = 0.0f;
+    accel_g[1] = 0.0f;
+    accel_g[2] = 1.0f;
+    gyro_dps[0] = gyro_dps[1] = gyro_dps[2] = 0.0f;
+}
+
+int16_t ToCounts(float value, float lsb_per_unit) {
+    const float counts = roundf(value * lsb_per_unit);
+    if (counts > 32767.0f) return 32767;
+    if (counts < -32768.0f) return -32768;
+    return static_cast<int16_t>(counts);
+}
+
+}  // namespace
+
+FakeIcm20600::FakeIcm20600()
+    : pointer_(0),
+      motion_(StillMotion),
+      motion_context_(nullptr),
+      last_update_us_(HostClockUs()),
+      next_sample_us_(0),
+      has_reference_(false),
+      samples_(0),
+      wom_events_(0),
+      unread_(false),
+      dropped_(0),
+      fresh_reads_(0),
+      repeat_reads_(0),
+      stale_polls_(0),
+      charge_ua_us_(0) {
+    ResetRegisters();
+}
+
+void FakeIcm20600::SetMotion(FakeImuMotion motion, void* context) {
+    motion_ = motion != nullptr ? motion : StillMotion;
+    motion_context_ = context;
+}
+
+void FakeIcm20600::ResetRegisters() {
+    memset(regs_, 0, sizeof(regs_));
+    regs_[kPwrMgmt1] = kPwrSleep | 0x01;
+    regs_[kWhoAmI] = 0x11;
+    has_reference_ = false;
+    next_sample_us_ = HostClockUs();
+}
+
+double FakeIcm20600::CurrentUa() const {
+    const uint8_t pwr1 = regs_[kPwrMgmt1];
+    const uint8_t pwr2 = regs_[kPwrMgmt2];
+    const bool accel_on = (pwr2 & 0x38) != 0x38;
+    const bool gyro_on = (pwr2 & 0x07) != 0x07;
+    if ((pwr1 & kPwrSleep) || (!accel_on && !gyro_on)) return kCurrentUa[kSleep];
+    if (gyro_on) return kCurrentUa[accel_on ? kSixAxis : kGyroOnly];
+    return kCurrentUa[(pwr1 & kPwrCycle) ? kAccelLowPower : kAccelOnly];
+}
+
+uint64_t FakeIcm20600::SamplePeriodUs() const {
+    const uint8_t pwr1 = regs_[kPwrMgmt1];
+    if (pwr1 & kPwrSleep) return 0;
+    const uint8_t dlpf = regs_[kConfig] & 0x07;
+    const bool divided = (pwr1 & kPwrCycle) || (dlpf >= 1 && dlpf <= 6);
+    return divided ? 1000ull * (1 + regs_[kSmplrtDiv]) : 1000ull;
+}
+
+void FakeIcm20600::Sample(uint64_t t_us) {
+    float accel[3];
+    float gyro[3];
+    motion_(t_us, accel, gyro, motion_context_);
+    samples_++;
+    if (unread_) dropped_++;
+    unread_ = true;
+
+    const uint8_t pwr2 = regs_[kPwrMgmt2];
+    const float accel_lsb = 16384.0f / (1 << ((regs_[kAccelConfig] >> 3) & 3));
+    const float gyro_lsb = (32768.0f / 250.0f) / (1 << ((regs_[kGyroConfig] >> 3) & 3));
+    for (int axis = 0; axis < 3; axis++) {
+        const bool accel_on = !(pwr2 & (0x20 >> axis));
+        const bool gyro_on = !(pwr2 & (0x04 >> axis));
+        const int16_t a = accel_on ? ToCounts(accel[axis], accel_lsb) : 0;
+        const int16_t g = gyro_on ? ToCounts(gyro[axis], gyro_lsb) : 0;
+        regs_[kAccelXoutH + 2 * axis] = static_cast<uint8_t>(static_cast<uint16_t>(a) >> 8);
+        regs_[kAccelXoutH + 2 * axis + 1] = static_cast<uint8_t>(a & 0xFF);
+        regs_[kGyroXoutH + 2 * axis] = static_cast<uint8_t>(static_cast<uint16_t>(g) >> 8);
+        regs_[kGyroXoutH + 2 * axis + 1] = static_cast<uint8_t>(g & 0xFF);
+    }
+    if (regs_[kIntEnable] & kDataReady) regs_[kIntStatus] |= kDataReady;
+
+    if (!(regs_[kAccelIntelCtrl] & kIntelEnable)) return;
+    if (!has_reference_) {
+        memcpy(reference_g_, accel, sizeof(reference_g_));
+        has_reference_ = true;
+        return;
+    }
+    uint8_t wom = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        const uint8_t bit = static_cast<uint8_t>(0x80 >> axis);
+        const float threshold = regs_[kAccelWomXThr + axis] * kWomLsbG;
+        if ((regs_[kIntEnable] & bit) && fabsf(accel[axis] - reference_g_[axis]) > threshold) {
+            wom |= bit;
+        }
+    }
+    if (wom != 0) {
+        regs_[kIntStatus] |= wom;
+        wom_events_++;
+    }
+    if (regs_[kAccelIntelCtrl] & kIntelComparePrevious) {
+        memcpy(reference_g_, accel, sizeof(reference_g_));
+    }
+}
+
+void FakeIcm20600::Update() {
+    const uint64_t now = HostClockUs();
+    if (now <= last_update_us_) return;
+    charge_ua_us_ += CurrentUa() * static_cast<double>(now - last_update_us_);
+    last_update_us_ = now;
+
+    const uint64_t period = SamplePeriodUs();
+    if (period == 0) return;
+    // Without wake-on-motion only the latest sample is visible
+    if (!(regs_[kAccelIntelCtrl] & kIntelEnable) && next_sample_us_ + period <= now) {
+        const uint64_t skipped = (now - next_sample_us_) / period;
+        samples_ += skipped;
+        dropped_ += skipped - (unread_ ? 0 : 1);
+        unread_ = true;
+        next_sample_us_ += skipped * period;
+    }
+    while (next_sample_us_ <= now) {
+        Sample(next_sample_us_);
+        next_sample_us_ += period;
+    }
+}
+
+void FakeIcm20600::WriteRegister(uint8_t reg, uint8_t value) {
+    reg &= 0x7F;
+    if (reg == kWhoAmI || reg == kIntStatus || (reg >= kAccelXoutH && reg <= 0x48)) return;
+    if (reg == kPwrMgmt1 && (value & kPwrReset)) {
+        ResetRegisters();
+        return;
+    }
+    regs_[reg] = value;
+    if (reg == kAccelIntelCtrl) has_reference_ = false;
+    // A new rate or power mode starts sampling over
+    if (reg == kSmplrtDiv || reg == kConfig || reg == kPwrMgmt1 || reg == kPwrMgmt2) {
+        const uint64_t period = SamplePeriodUs();
+        next_sample_us_ = HostClockUs() + period;
+    }
+}
+
+uint8_t FakeIcm20600::ReadRegister(uint8_t reg) {
+    reg &= 0x7F;
+    const uint8_t value = regs_[reg];
+    if (reg == kIntStatus || (regs_[kIntPinCfg] & kIntRdClear)) regs_[kIntStatus] = 0;
+    return value;
+}
+
+void FakeIcm20600::Write(const uint8_t* data, size_t len) {
+    Update();
+    if (len == 0) return;
+    pointer_ = data[0] & 0x7F;
+    for (size_t i = 1; i < len; i++) {
+        WriteRegister(pointer_, data[i]);
+        pointer_ = (pointer_ + 1) & 0x7F;
+    }
+}
+
+void FakeIcm20600::Read(uint8_t* data, size_t len) {
+    Update();
+    // A data read starts at or before ACCEL_XOUT_H; one that also read a
+    // clear DATA_RDY is a poll the firmware discards
+    const bool data_read = pointer_ <= kAccelXoutH && pointer_ + len > kAccelXoutH;
+    const bool status_read = pointer_ <= kIntStatus && pointer_ + len > kIntStatus;
+    if (data_read && status_read && !(regs_[kIntStatus] & kDataReady)) {
+        stale_polls_++;
+    } else if (data_read) {
+        if (unread_) {
+            fresh_reads_++;
+        } else {
+            repeat_reads_++;
+        }
+        unread_ = false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = ReadRegister(pointer_);
+        pointer_ = (pointer_ + 1) & 0x7F;
+    }
+}
+
+bool FakeIcm20600::IntActive() const {
+    return (regs_[kIntStatus] & regs_[kIntEnable] & 0xE1) != 0;
+}
+
+bool FakeIcm20600::IntPin() const {
+    const bool low_active = (regs_[kIntPinCfg] & kIntLevelLow) != 0;
+    return IntActive() != low_active;
+}
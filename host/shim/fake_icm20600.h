@@ -0,0 +1,88 @@
+#ifndef HOST_SHIM_FAKE_ICM20600_H_
+#define HOST_SHIM_FAKE_ICM20600_H_
+
+// Register-level model of the ICM-20600 for host runs of src/imu_provider.cpp.
+// Attach it with HostI2cAttach(kIMU_Address, &imu) and the firmware's own I2C
+// sequences configure and read it. It follows the host clock (Arduino.h,
+// usually in virtual time) and models what the firmware relies on:
+//   - register file with auto-increment reads/writes, WHO_AM_I 0x11, reset
+//     values, DEVICE_RESET
+//   - sampling at 1 kHz / (1 + SMPLRT_DIV) with the DLPF on (DLPF_CFG 1-6) or
+//     in accel low-power (CYCLE) mode, else 1 kHz; data registers scaled by
+//     ACCEL_CONFIG/GYRO_CONFIG full scale, zero for axes in standby
+//   - wake-on-motion: with ACCEL_INTEL_EN every accel sample is compared
+//     with the previous one (ACCEL_INTEL_MODE 1) or the first one after
+//     enabling (0); an axis that moved more than ACCEL_WOM_x_THR * 4 mg sets
+//     its INT_STATUS bit if enabled in INT_ENABLE; likewise DATA_RDY for
+//     every sample
+//   - INT_STATUS cleared by reading it (or by any read with INT_RD_CLEAR),
+//     INT pin level from the enabled status bits and INT_LEVEL
+//   - supply current per power mode, integrated over time
+//   - sample accounting for the firmware's reads of ACCEL_XOUT_H: samples
+//     overwritten before a read (dropped), reads that see no new sample
+//     (repeats) and reads the firmware can discard because they also
+//     returned DATA_RDY clear (stale polls)
+// The DLPF itself, noise and start-up times are not modelled.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "driver/i2c.h"
+
+// The motion the sensor feels at t_us: accel in g, gyro in deg/s
+typedef void (*FakeImuMotion)(uint64_t t_us, float accel_g[3], float gyro_dps[3], void* context);
+
+class FakeIcm20600 : public HostI2cDevice {
+public:
+    FakeIcm20600();
+
+    // Default: lying flat and still (0, 0, 1 g)
+    void SetMotion(FakeImuMotion motion, void* context);
+
+    void Write(const uint8_t* data, size_t len) override;
+    void Read(uint8_t* data, size_t len) override;
+
+    // Runs the sensor up to the host clock; reads and writes call it first
+    void Update();
+
+    uint8_t Register(uint8_t reg) const { return regs_[reg & 0x7F]; }
+    bool IntActive() const;  // An enabled interrupt is pending
+    bool IntPin() const;     // INT level after INT_LEVEL (active low if set)
+
+    uint64_t samples() const { return samples_; }
+    uint64_t wom_events() const { return wom_events_; }
+    uint64_t dropped() const { return dropped_; }
+    uint64_t fresh_reads() const { return fresh_reads_; }
+    uint64_t repeat_reads() const { return repeat_reads_; }
+    uint64_t stale_polls() const { return stale_polls_; }
+    // Charge drawn since construction in uA*s, from approximate typical
+    // currents per mode (see kCurrentUa in fake_icm20600.cpp)
+    double charge_uas() const { return charge_ua_us_ / 1e6; }
+    double CurrentUa() const;  // In the present mode
+
+private:
+    void ResetRegisters();
+    uint64_t SamplePeriodUs() const;  // 0 when nothing is sampled
+    void Sample(uint64_t t_us);
+    void WriteRegister(uint8_t reg, uint8_t value);
+    uint8_t ReadRegister(uint8_t reg);
+
+    uint8_t regs_[128];
+    uint8_t pointer_;
+    FakeImuMotion motion_;
+    void* motion_context_;
+    uint64_t last_update_us_;
+    uint64_t next_sample_us_;
+    bool has_reference_;
+    float reference_g_[3];
+    uint64_t samples_;
+    uint64_t wom_events_;
+    bool unread_;  // A sample since the last data read
+    uint64_t dropped_;
+    uint64_t fresh_reads_;
+    uint64_t repeat_reads_;
+    uint64_t stale_polls_;
+    double charge_ua_us_;
+};
+
+#endif  // HOST_SHIM_FAKE_ICM20600_H_
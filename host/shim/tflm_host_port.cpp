@@ -0,0 +1,15 @@
+// TFLM platform hooks for host builds (the firmware uses src/tflm_esp32_port.cpp)
+#include <cstdio>
+
+#include "tensorflow/lite/micro/debug_log.h"
+#include "tensorflow/lite/micro/system_setup.h"
+
+extern "C" void DebugLog(const char* s) {
+    fputs(s, stderr);
+}
+
+namespace tflite {
+
+void InitializeTarget() {}
+
+}  // namespace tflite
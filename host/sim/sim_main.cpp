@@ -0,0 +1,744 @@
+/* GAINS firmware simulator
+ * Runs setup() and loop() from src/main.cpp unchanged in virtual time (the
+ * host/shim clock) for hours of device time in seconds. Everything around
+ * the firmware is simulated: the ICM-20600 register model
+ * (host/shim/fake_icm20600.h) with pushup and pickup motion, the OLED on the
+ * I2C capture, the button through its interrupt, serial input and output,
+ * light sleep and the task watchdog.
+ *
+ * Virtual time only moves where the device would spend time, from a cost
+ * model (SimCosts, --costs FILE):
+ *   - CPU: cycles per loop() iteration, per IMU sample pushed through
+ *     preprocessing, and per TFLM operator (fixed + per MAC + per element,
+ *     from the tensor shapes of the model the interpreter runs, charged
+ *     through a MicroProfilerInterface so InvokeStep() slices see them)
+ *   - I2C: bus time at i2c_hz for every byte plus a per-transaction overhead
+ *   - serial: per call and per byte written
+ *   - delay(), delayMicroseconds(), light sleep: their own durations
+ * The defaults are estimates for the ESP32-S3 at 240 MHz; the model cost can
+ * be calibrated with invoke_us from the device's 'm' metrics.
+ *
+ * The scenario: the device lies still, and every --set-interval-min minutes
+ * it is picked up and a set of 10-20 pushups is recorded (start, stop and
+ * back-to-idle presses; every second set with 'r' over serial instead).
+ * Between sets it goes to idle sleep. Reported: loop period percentiles,
+ * deadline misses (awake loop() iterations longer than a sample period) by
+ * cause, IMU samples dropped (overwritten before a read), read twice or
+ * skipped on DATA_RDY, the firmware's own metrics, presses handled, the
+ * watchdog's longest gap.
+ * The same options give the same report on every run.
+ *
+ *   host_sim
+ *   host_sim --hours 24 --set-interval-min 60
+ *   host_sim --print-costs > costs.txt; host_sim --costs costs.txt
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "constants.h"
+#include "esp_task_wdt.h"
+#include "fake_icm20600.h"
+#include "idle_mode.h"
+#include "metrics.h"
+#include "model_config.h"
+#include "oled_display.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "third_party/flatbuffers/include/flatbuffers/flexbuffers.h"
+
+// src/main.cpp
+void setup();
+void loop();
+extern const tflite::Model* model;
+extern tflite::MicroInterpreter* interpreter;
+extern IdleMode idle_mode;
+extern MetricsRegistry metrics;
+
+namespace {
+
+constexpr uint8_t kButtonPin = 3;  // BUTTON_PIN in main.cpp, active high
+constexpr uint32_t kPressMs = 150;
+constexpr uint64_t kPickupUs = 600000;
+constexpr uint64_t kUsPerMinute = 60ull * 1000000ull;
+
+// ============================================================================
+// COST MODEL
+// ============================================================================
+
+struct SimCosts {
+    uint32_t cpu_mhz = 240;
+    uint32_t loop_cycles = 20000;     // loop() outside the parts below
+    uint32_t sample_cycles = 40000;   // Per ReadIMU() sample: preprocessing, first stage, scheduler
+    uint32_t op_cycles = 5000;        // Per TFLM operator
+    uint32_t mac_cycles = 6;          // Per multiply-accumulate (conv, depthwise, FC)
+    uint32_t element_cycles = 8;      // Per element of the operator's larger of input 0 / output 0
+    uint32_t invoke_us = 0;           // Nonzero: scale the operator costs to this per Invoke()
+    uint32_t i2c_hz = 400000;
+    uint32_t i2c_transaction_us = 40;
+    uint32_t serial_call_cycles = 2000;
+    uint32_t serial_byte_ns = 1000;
+    uint32_t light_sleep_wake_us = 500;
+};
+
+struct CostKey {
+    const char* name;
+    uint32_t SimCosts::*member;
+};
+
+const CostKey kCostKeys[] = {
+    {"cpu_mhz", &SimCosts::cpu_mhz},
+    {"loop_cycles", &SimCosts::loop_cycles},
+    {"sample_cycles", &SimCosts::sample_cycles},
+    {"op_cycles", &SimCosts::op_cycles},
+    {"mac_cycles", &SimCosts::mac_cycles},
+    {"element_cycles", &SimCosts::element_cycles},
+    {"invoke_us", &SimCosts::invoke_us},
+    {"i2c_hz", &SimCosts::i2c_hz},
+    {"i2c_transaction_us", &SimCosts::i2c_transaction_us},
+    {"serial_call_cycles", &SimCosts::serial_call_cycles},
+    {"serial_byte_ns", &SimCosts::serial_byte_ns},
+    {"light_sleep_wake_us", &SimCosts::light_sleep_wake_us},
+};
+
+// "key value" lines, '#' starts a comment
+bool LoadCosts(const char* path, SimCosts* costs) {
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "[SIM] ERROR: cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    int line_number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) *comment = '\0';
+        char key[64];
+        unsigned long value = 0;
+        const int fields = sscanf(line, "%63s %lu", key, &value);
+        if (fields <= 0) continue;
+        const CostKey* found = nullptr;
+        for (const CostKey& k : kCostKeys) {
+            if (strcmp(k.name, key) == 0) found = &k;
+        }
+        if (fields != 2 || found == nullptr) {
+            fprintf(stderr, "[SIM] ERROR: %s:%d: expected '<cost> <value>'\n", path, line_number);
+            ok = false;
+            continue;
+        }
+        costs->*(found->member) = static_cast<uint32_t>(value);
+    }
+    fclose(f);
+    return ok;
+}
+
+void PrintCosts(const SimCosts& costs) {
+    for (const CostKey& k : kCostKeys) printf("%s %u\n", k.name, costs.*(k.member));
+}
+
+// ============================================================================
+// MODEL COSTS
+// ============================================================================
+
+struct OpCost {
+    const char* name;  // As the profiler tags the node
+    uint64_t macs;
+    uint64_t cycles;
+};
+
+uint64_t NumElements(const tflite::SubGraph* subgraph, const flatbuffers::Vector<int32_t>* list,
+                     size_t i) {
+    if (list == nullptr || i >= list->size() || list->Get(i) < 0) return 0;
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(list->Get(i));
+    if (tensor->shape() == nullptr) return 0;
+    uint64_t n = 1;
+    for (int32_t d : *tensor->shape()) n *= d > 0 ? d : 1;
+    return n;
+}
+
+int Dim(const tflite::SubGraph* subgraph, const flatbuffers::Vector<int32_t>* list, size_t i,
+        size_t dim) {
+    if (list == nullptr || i >= list->size() || list->Get(i) < 0) return 0;
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(list->Get(i));
+    if (tensor->shape() == nullptr || dim >= tensor->shape()->size()) return 0;
+    return tensor->shape()->Get(dim);
+}
+
+// Multiply-accumulates of one operator from its tensor shapes
+uint64_t OperatorMacs(const tflite::SubGraph* subgraph, const tflite::Operator* op,
+                      tflite::BuiltinOperator code, const char* custom) {
+    const auto* in = op->inputs();
+    const auto* out = op->outputs();
+    switch (code) {
+        case tflite::BuiltinOperator_CONV_2D:
+            // Filter [Cout, KH, KW, Cin]
+            return NumElements(subgraph, out, 0) * Dim(subgraph, in, 1, 1) *
+                   Dim(subgraph, in, 1, 2) * Dim(subgraph, in, 1, 3);
+        case tflite::BuiltinOperator_DEPTHWISE_CONV_2D:
+            // Filter [1, KH, KW, C * M]
+            return NumElements(subgraph, out, 0) * Dim(subgraph, in, 1, 1) *
+                   Dim(subgraph, in, 1, 2);
+        case tflite::BuiltinOperator_FULLY_CONNECTED:
+            // Weights [units, depth]
+            return NumElements(subgraph, out, 0) * Dim(subgraph, in, 1, 1);
+        default:
+            break;
+    }
+    if (custom == nullptr || strcmp(custom, "GAINS_CONV_POOL") != 0) return 0;
+    // The conv at input resolution (VALID, conv_stride_*), pooled afterwards
+    int stride_h = 1;
+    int stride_w = 1;
+    if (op->custom_options() != nullptr) {
+        const flexbuffers::Map options =
+            flexbuffers::GetRoot(op->custom_options()->data(), op->custom_options()->size())
+                .AsMap();
+        stride_h = std::max(1, options["conv_stride_h"].AsInt32());
+        stride_w = std::max(1, options["conv_stride_w"].AsInt32());
+    }
+    const int kh = Dim(subgraph, in, 1, 1);
+    const int kw = Dim(subgraph, in, 1, 2);
+    const int conv_h = (Dim(subgraph, in, 0, 1) - kh) / stride_h + 1;
+    const int conv_w = (Dim(subgraph, in, 0, 2) - kw) / stride_w + 1;
+    if (conv_h <= 0 || conv_w <= 0) return 0;
+    return static_cast<uint64_t>(Dim(subgraph, in, 0, 0)) * conv_h * conv_w *
+           Dim(subgraph, in, 1, 0) * kh * kw * Dim(subgraph, in, 1, 3);
+}
+
+std::vector<OpCost> ModelOpCosts(const tflite::Model* m, const SimCosts& costs) {
+    std::vector<OpCost> ops;
+    const tflite::SubGraph* subgraph = m->subgraphs()->Get(0);
+    uint64_t total = 0;
+    for (const tflite::Operator* op : *subgraph->operators()) {
+        const tflite::OperatorCode* opcode = m->operator_codes()->Get(op->opcode_index());
+        const tflite::BuiltinOperator code = tflite::GetBuiltinCode(opcode);
+        const char* custom = code == tflite::BuiltinOperator_CUSTOM && opcode->custom_code()
+                                 ? opcode->custom_code()->c_str()
+                                 : nullptr;
+        OpCost cost;
+        cost.name = custom != nullptr ? custom : tflite::EnumNameBuiltinOperator(code);
+        cost.macs = OperatorMacs(subgraph, op, code, custom);
+        const uint64_t elements = std::max(NumElements(subgraph, op->inputs(), 0),
+                                           NumElements(subgraph, op->outputs(), 0));
+        cost.cycles = costs.op_cycles + costs.mac_cycles * cost.macs +
+                      costs.element_cycles * elements;
+        total += cost.cycles;
+        ops.push_back(cost);
+    }
+    if (costs.invoke_us > 0 && total > 0) {
+        const double scale = static_cast<double>(costs.invoke_us) * costs.cpu_mhz / total;
+        for (OpCost& op : ops) op.cycles = static_cast<uint64_t>(op.cycles * scale + 0.5);
+    }
+    return ops;
+}
+
+// Charges each operator's cycles when it ends. Nodes are matched by tag in
+// model order; an invoke that restarts (Invoke() after an aborted
+// InvokeStep()) is found again by searching from the first node.
+class SimProfiler : public tflite::MicroProfilerInterface {
+public:
+    explicit SimProfiler(std::vector<OpCost> ops) : ops_(std::move(ops)) {}
+
+    uint32_t BeginEvent(const char* tag) override {
+        size_t node = next_;
+        if (node >= ops_.size() || strcmp(ops_[node].name, tag) != 0) {
+            for (node = 0; node < ops_.size() && strcmp(ops_[node].name, tag) != 0; node++) {
+            }
+        }
+        if (node == ops_.size()) {
+            next_ = 0;
+            return UINT32_MAX;
+        }
+        next_ = node + 1 == ops_.size() ? 0 : node + 1;
+        return static_cast<uint32_t>(node);
+    }
+
+    void EndEvent(uint32_t node) override {
+        operators_++;
+        if (node < ops_.size()) {
+            cycles_ += ops_[node].cycles;
+            HostChargeCycles(ops_[node].cycles);
+        } else {
+            unmatched_++;
+        }
+    }
+
+    uint64_t ModelCycles() const {
+        uint64_t total = 0;
+        for (const OpCost& op : ops_) total += op.cycles;
+        return total;
+    }
+    uint64_t ModelMacs() const {
+        uint64_t total = 0;
+        for (const OpCost& op : ops_) total += op.macs;
+        return total;
+    }
+    size_t nodes() const { return ops_.size(); }
+    uint64_t operators() const { return operators_; }
+    uint64_t unmatched() const { return unmatched_; }
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    std::vector<OpCost> ops_;
+    size_t next_ = 0;
+    uint64_t operators_ = 0;
+    uint64_t unmatched_ = 0;
+    uint64_t cycles_ = 0;
+};
+
+// The IMU model, plus the CPU cost of pushing each sample it hands out
+class SimImu : public FakeIcm20600 {
+public:
+    uint32_t sample_cycles = 0;
+
+    void Read(uint8_t* data, size_t len) override {
+        const uint64_t reads = fresh_reads() + repeat_reads();
+        FakeIcm20600::Read(data, len);
+        if (fresh_reads() + repeat_reads() != reads) HostChargeCycles(sample_cycles);
+    }
+};
+
+// ============================================================================
+// SCENARIO
+// ============================================================================
+
+struct Workout {
+    uint64_t pickup_us;
+    uint64_t reps_start_us;
+    uint64_t reps_end_us;
+    float rep_hz;
+    bool serial;  // Toggled with 'r' instead of the button
+};
+
+enum EventKind { kButtonDown, kButtonUp, kSerialToggle, kEnd };
+
+struct Event {
+    uint64_t t_us;
+    EventKind kind;
+};
+
+struct Scenario {
+    std::vector<Workout> workouts;
+    std::vector<Event> events;  // In time order
+    size_t next_event = 0;
+    int toggles = 0;            // Presses and 'r' sent
+    bool in_setup = true;
+};
+
+uint32_t g_seed = 2024;
+uint32_t NextRandom() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+// Sets every interval_min from minute 1 until the end: pickup, start after
+// 3 s, reps from 5 s, stop 1 s after the last rep, back to idle 3 s later
+Scenario MakeScenario(int hours, int interval_min) {
+    Scenario scenario;
+    const uint64_t end_us = hours * 60 * kUsPerMinute;
+    for (uint64_t t = kUsPerMinute; t + 2 * kUsPerMinute < end_us; t += interval_min * kUsPerMinute) {
+        Workout w;
+        w.pickup_us = t;
+        w.reps_start_us = t + 5000000;
+        w.rep_hz = 1.0f / (1.0f + (NextRandom() % 600) / 1000.0f);
+        const int reps = 10 + NextRandom() % 11;
+        w.reps_end_us = w.reps_start_us + static_cast<uint64_t>(reps / w.rep_hz * 1e6f);
+        w.serial = scenario.workouts.size() % 2 == 1;
+        scenario.workouts.push_back(w);
+
+        const uint64_t toggles[3] = {t + 3000000, w.reps_end_us + 1000000,
+                                     w.reps_end_us + 4000000};
+        for (uint64_t at : toggles) {
+            if (w.serial) {
+                scenario.events.push_back({at, kSerialToggle});
+            } else {
+                scenario.events.push_back({at, kButtonDown});
+                scenario.events.push_back({at + kPressMs * 1000ull, kButtonUp});
+            }
+            scenario.toggles++;
+        }
+    }
+    scenario.events.push_back({end_us, kEnd});
+    return scenario;
+}
+
+uint64_t RunEvents(uint64_t now_us, void* context) {
+    Scenario* s = static_cast<Scenario*>(context);
+    while (s->next_event < s->events.size() && s->events[s->next_event].t_us <= now_us) {
+        const Event& e = s->events[s->next_event++];
+        switch (e.kind) {
+            case kButtonDown: HostGpioSet(kButtonPin, HIGH); break;
+            case kButtonUp: HostGpioSet(kButtonPin, LOW); break;
+            case kSerialToggle: Serial.Input("r", 1); break;
+            case kEnd:
+                // setup() hangs in while (1) delay() on a fatal error
+                if (s->in_setup) {
+                    fprintf(stderr, "[SIM] ERROR: setup() did not return\n");
+                    exit(1);
+                }
+                break;
+        }
+    }
+    return s->next_event < s->events.size() ? s->events[s->next_event].t_us : UINT64_MAX;
+}
+
+// Repeatable noise in [-1, 1] per sample time
+float Noise(uint64_t t_us, uint32_t salt) {
+    uint32_t x = static_cast<uint32_t>(t_us / 1000) * 2654435761u ^ salt * 40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    return (x & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+// Flat and still between sets; a lift when picked up; pushups as a vertical
+// oscillation with the matching pitch rate
+void ScenarioMotion(uint64_t t_us, float accel_g[3], float gyro_dps[3], void* context) {
+    const Scenario* s = static_cast<const Scenario*>(context);
+    accel_g[0] = 0.0f;
+    accel_g[1] = 0.0f;
+    accel_g[2] = 1.0f;
+    gyro_dps[0] = gyro_dps[1] = gyro_dps[2] = 0.0f;
+    const auto after = std::upper_bound(
+        s->workouts.begin(), s->workouts.end(), t_us,
+        [](uint64_t t, const Workout& w) { return t < w.pickup_us; });
+    if (after != s->workouts.begin()) {
+        const Workout& w = *(after - 1);
+        const float pi = static_cast<float>(M_PI);
+        if (t_us < w.pickup_us + kPickupUs) {
+            accel_g[2] += 0.25f * sinf(2.0f * pi * (t_us - w.pickup_us) / kPickupUs);
+        } else if (t_us >= w.reps_start_us && t_us < w.reps_end_us) {
+            const float phase = 2.0f * pi * w.rep_hz * ((t_us - w.reps_start_us) / 1e6f);
+            accel_g[0] = 0.08f * sinf(phase);
+            accel_g[2] += 0.35f * sinf(phase);
+            gyro_dps[1] = 25.0f * cosf(phase);
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        accel_g[axis] += 0.004f * Noise(t_us, axis);
+        gyro_dps[axis] += 0.05f * Noise(t_us, 3 + axis);
+    }
+}
+
+// ============================================================================
+// OBSERVATION
+// ============================================================================
+
+// Serial output of the firmware, by line
+struct SerialTap {
+    std::string line;
+    std::string cause_tag;  // Of the current loop() iteration
+    int state_changes = 0;
+    int timing_warnings = 0;
+    int inferences = 0;
+    const Scenario* scenario = nullptr;
+    std::vector<float> rep_periods;  // Each "[REPS] #" duration over its set's rep period
+};
+
+bool StartsWith(const std::string& line, const char* prefix) {
+    return line.compare(0, strlen(prefix), prefix) == 0;
+}
+
+void OnSerial(const char* data, size_t len, void* context) {
+    SerialTap* tap = static_cast<SerialTap*>(context);
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != '\n') {
+            tap->line += data[i];
+            continue;
+        }
+        const std::string& line = tap->line;
+        if (StartsWith(line, "[STATE]")) tap->state_changes++;
+        if (StartsWith(line, "[TIMING WARNING]")) tap->timing_warnings++;
+        if (StartsWith(line, "[INFERENCE] Completed")) tap->inferences++;
+        float rep_s = 0.0f;
+        if (StartsWith(line, "[REPS] #") && sscanf(line.c_str(), "[REPS] #%*d: %f s", &rep_s) == 1) {
+            const std::vector<Workout>& workouts = tap->scenario->workouts;
+            const auto after = std::upper_bound(
+                workouts.begin(), workouts.end(), HostClockUs(),
+                [](uint64_t t, const Workout& w) { return t < w.pickup_us; });
+            if (after != workouts.begin()) tap->rep_periods.push_back(rep_s * (after - 1)->rep_hz);
+        }
+        // A state change explains its iteration best, else the first tag
+        if (line[0] == '[' && line.find(']') != std::string::npos &&
+            (tap->cause_tag.empty() || StartsWith(line, "[STATE]"))) {
+            tap->cause_tag = line.substr(0, line.find(']') + 1);
+        }
+        tap->line.clear();
+    }
+}
+
+// Where an iteration's time went
+enum Spend { kSpendCpu, kSpendDelay, kSpendOled, kSpendImu, kSpendSerial, kSpends };
+const char* const kSpendNames[kSpends] = {"cpu", "delay", "i2c oled", "i2c imu", "serial"};
+
+struct Totals {
+    uint64_t us[kSpends];
+    uint64_t sleep_us;
+    uint64_t dropped, fresh, repeats, stale;
+
+    static Totals Now(const FakeIcm20600& imu) {
+        Totals t;
+        t.us[kSpendCpu] = HostClockTotalUs(HOST_TIME_CPU);
+        t.us[kSpendDelay] = HostClockTotalUs(HOST_TIME_DELAY);
+        t.us[kSpendOled] = HostI2cBusUs(OLED_I2C_ADDR);
+        t.us[kSpendImu] = HostI2cBusUs(kIMU_Address);
+        t.us[kSpendSerial] = HostClockTotalUs(HOST_TIME_SERIAL);
+        t.sleep_us = HostClockTotalUs(HOST_TIME_SLEEP);
+        t.dropped = imu.dropped();
+        t.fresh = imu.fresh_reads();
+        t.repeats = imu.repeat_reads();
+        t.stale = imu.stale_polls();
+        return t;
+    }
+};
+
+struct Cause {
+    std::string name;
+    uint32_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+};
+
+void AddCause(std::vector<Cause>* causes, const std::string& name, uint64_t us) {
+    for (Cause& c : *causes) {
+        if (c.name == name) {
+            c.count++;
+            c.total_us += us;
+            c.max_us = std::max(c.max_us, us);
+            return;
+        }
+    }
+    causes->push_back({name, 1, us, us});
+}
+
+double Percentile(std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    const size_t i = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[i] / 1000.0;
+}
+
+void PrintUsage() {
+    printf("Usage: host_sim [options]\n");
+    printf("  --hours N             simulated time (default 8)\n");
+    printf("  --set-interval-min N  minutes between pushup sets (default 20)\n");
+    printf("  --deadline-ms N       loop() iterations longer than this are misses (default %d)\n",
+           SAMPLE_PERIOD_MS);
+    printf("  --costs FILE          cost model overrides, '<cost> <value>' lines\n");
+    printf("  --print-costs         print the cost model in that format and exit\n");
+    printf("  --verbose             show the firmware's serial output and every miss\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int hours = 8;
+    int interval_min = 20;
+    uint32_t deadline_ms = SAMPLE_PERIOD_MS;
+    SimCosts costs;
+    bool print_costs = false;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--hours") == 0 && value) {
+            hours = atoi(argv[++i]);
+        } else if (strcmp(arg, "--set-interval-min") == 0 && value) {
+            interval_min = atoi(argv[++i]);
+        } else if (strcmp(arg, "--deadline-ms") == 0 && value) {
+            deadline_ms = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--costs") == 0 && value) {
+            if (!LoadCosts(argv[++i], &costs)) return 1;
+        } else if (strcmp(arg, "--print-costs") == 0) {
+            print_costs = true;
+        } else if (strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (print_costs) {
+        PrintCosts(costs);
+        return 0;
+    }
+    if (hours < 1 || interval_min < 3 || costs.cpu_mhz == 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    HostClockSetVirtual(true);
+    HostCostModel shim_costs = {};
+    shim_costs.cpu_mhz = costs.cpu_mhz;
+    shim_costs.i2c_hz = costs.i2c_hz;
+    shim_costs.i2c_transaction_us = costs.i2c_transaction_us;
+    shim_costs.serial_call_cycles = costs.serial_call_cycles;
+    shim_costs.serial_byte_ns = costs.serial_byte_ns;
+    shim_costs.light_sleep_wake_us = costs.light_sleep_wake_us;
+    HostSetCostModel(shim_costs);
+    HostI2cResetStats();
+
+    Scenario scenario = MakeScenario(hours, interval_min);
+    const uint64_t end_us = scenario.events.back().t_us;
+    SimImu imu;
+    imu.sample_cycles = costs.sample_cycles;
+    imu.SetMotion(ScenarioMotion, &scenario);
+    HostI2cAttach(kIMU_Address, &imu);
+    SerialTap tap;
+    tap.scenario = &scenario;
+    Serial.tap = OnSerial;
+    Serial.tap_context = &tap;
+    Serial.muted = !verbose;
+    HostClockSetEventHook(RunEvents, &scenario, scenario.events.front().t_us);
+
+    setup();
+    scenario.in_setup = false;
+    const uint64_t setup_us = HostClockUs();
+    SimProfiler profiler(ModelOpCosts(model, costs));
+    interpreter->SetProfiler(&profiler);
+
+    // loop() until the end, every iteration measured
+    std::vector<uint32_t> loop_us;
+    std::vector<Cause> causes;
+    uint64_t awake_us = 0;
+    uint64_t awake_spend[kSpends] = {};
+    uint64_t awake_samples = 0;  // Produced by the IMU while awake
+    uint64_t dropped = 0;
+    uint64_t repeats = 0;
+    uint64_t stale = 0;
+    uint64_t misses = 0;
+    while (HostClockUs() < end_us) {
+        const bool asleep = idle_mode.Asleep();
+        const uint64_t start_us = HostClockUs();
+        const Totals before = Totals::Now(imu);
+        tap.cause_tag.clear();
+
+        HostChargeCycles(costs.loop_cycles);
+        loop();
+
+        const Totals after = Totals::Now(imu);
+        const uint64_t us = HostClockUs() - start_us;
+        if (asleep || after.sleep_us != before.sleep_us) continue;
+
+        loop_us.push_back(static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX)));
+        awake_us += us;
+        int dominant = 0;
+        for (int k = 0; k < kSpends; k++) {
+            const uint64_t spent = after.us[k] - before.us[k];
+            awake_spend[k] += spent;
+            if (spent > after.us[dominant] - before.us[dominant]) dominant = k;
+        }
+        awake_samples += (after.fresh - before.fresh) + (after.dropped - before.dropped);
+        dropped += after.dropped - before.dropped;
+        repeats += after.repeats - before.repeats;
+        stale += after.stale - before.stale;
+        if (us > deadline_ms * 1000ull) {
+            misses++;
+            const std::string cause = std::string(kSpendNames[dominant]) + " " +
+                                      (tap.cause_tag.empty() ? "-" : tap.cause_tag);
+            AddCause(&causes, cause, us);
+            if (verbose) {
+                printf("[SIM] miss at %.3f s: loop() took %.1f ms, mostly %s\n", start_us / 1e6,
+                       us / 1e3, cause.c_str());
+            }
+        }
+    }
+    const double wall_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    // ========================================================================
+    // REPORT
+    // ========================================================================
+    const double sim_s = HostClockUs() / 1e6;
+    printf("[SIM] %d h simulated in %.2f s (%.0fx real time); setup() took %.2f s; %zu sets "
+           "every %d min, %d toggles sent\n",
+           hours, wall_s, sim_s / wall_s, setup_us / 1e6, scenario.workouts.size(), interval_min,
+           scenario.toggles);
+    printf("[SIM] model: %zu nodes, %.2f M MACs, %.1f ms per invoke at %u MHz%s; %llu operators "
+           "run, %llu unmatched\n",
+           profiler.nodes(), profiler.ModelMacs() / 1e6,
+           profiler.ModelCycles() / (costs.cpu_mhz * 1e3), costs.cpu_mhz,
+           costs.invoke_us ? " (calibrated)" : "",
+           static_cast<unsigned long long>(profiler.operators()),
+           static_cast<unsigned long long>(profiler.unmatched()));
+
+    std::sort(loop_us.begin(), loop_us.end());
+    const double asleep_s = HostClockTotalUs(HOST_TIME_SLEEP) / 1e6;
+    printf("[SIM] awake %.1f min (%zu loops), asleep %.1f min (%.1f%%)\n", awake_us / 6e7,
+           loop_us.size(), asleep_s / 60.0, 100.0 * asleep_s / sim_s);
+    printf("[SIM] awake loop() period ms: p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+           Percentile(loop_us, 50), Percentile(loop_us, 90), Percentile(loop_us, 99),
+           Percentile(loop_us, 99.9), loop_us.empty() ? 0.0 : loop_us.back() / 1000.0);
+    printf("[SIM] awake time:");
+    for (int k = 0; k < kSpends; k++) {
+        printf("%s %s %.1f%%", k ? "," : "", kSpendNames[k],
+               awake_us ? 100.0 * awake_spend[k] / awake_us : 0.0);
+    }
+    printf("\n");
+
+    printf("[SIM] deadline misses (awake loop() > %u ms): %llu (%.3f%% of loops)\n", deadline_ms,
+           static_cast<unsigned long long>(misses),
+           loop_us.empty() ? 0.0 : 100.0 * misses / loop_us.size());
+    std::sort(causes.begin(), causes.end(),
+              [](const Cause& a, const Cause& b) { return a.total_us > b.total_us; });
+    if (!causes.empty()) printf("  %-28s %7s %9s %9s\n", "mostly / first tag", "count", "mean ms",
+                                "max ms");
+    for (const Cause& c : causes) {
+        printf("  %-28s %7u %9.1f %9.1f\n", c.name.c_str(), c.count,
+               c.total_us / 1e3 / c.count, c.max_us / 1e3);
+    }
+
+    printf("[SIM] IMU while awake: %llu samples, %llu dropped (%.2f%%, overwritten before a "
+           "read), %llu reads repeated a sample, %llu skipped on DATA_RDY\n",
+           static_cast<unsigned long long>(awake_samples),
+           static_cast<unsigned long long>(dropped),
+           awake_samples ? 100.0 * dropped / awake_samples : 0.0,
+           static_cast<unsigned long long>(repeats), static_cast<unsigned long long>(stale));
+
+    const LatencyHistogram& period = metrics.Histogram(METRIC_LOOP_PERIOD);
+    const LatencyHistogram& invoke = metrics.Histogram(METRIC_INVOKE);
+    const LatencyHistogram& flush = metrics.Histogram(METRIC_OLED_FLUSH);
+    printf("[SIM] firmware metrics: %u samples, %u deadline misses, %u slow loops, %u "
+           "inferences (%u early exits, %d invokes), loop period p99 < %u us, invoke max %u us, "
+           "%u OLED flushes (max %u us)\n",
+           metrics.Counter(METRIC_SAMPLES), metrics.Counter(METRIC_DEADLINE_MISSES),
+           metrics.Counter(METRIC_SLOW_LOOPS), metrics.Counter(METRIC_INFERENCES),
+           metrics.Counter(METRIC_EARLY_EXITS), tap.inferences,
+           period.PercentileUpperBoundUs(99), invoke.max_us, flush.count, flush.max_us);
+
+    // Rep times come from the sample count, so they only hold if every IMU
+    // sample is pushed once
+    std::vector<float>& rep_periods = tap.rep_periods;
+    std::sort(rep_periods.begin(), rep_periods.end());
+    auto rep_at = [&rep_periods](size_t percent) {
+        return rep_periods.empty() ? 0.0f : rep_periods[rep_periods.size() * percent / 100];
+    };
+    printf("[SIM] reps: %zu counted, duration / scenario rep period p10 %.2f, p50 %.2f, p90 %.2f\n",
+           rep_periods.size(), rep_at(10), rep_at(50), rep_at(90));
+
+    const IdleModeStats& idle = idle_mode.stats();
+    const HostWatchdogStats wdt = HostWatchdogGetStats();
+    printf("[SIM] %d of %d toggles handled (%d timing warnings); idle: %u sleeps, %u motion "
+           "wakes, %u button wakes; watchdog: longest gap %.2f s of %u s, %u expirations\n",
+           tap.state_changes, scenario.toggles, tap.timing_warnings,
+           static_cast<unsigned>(idle.sleeps), static_cast<unsigned>(idle.motion_wakes),
+           static_cast<unsigned>(idle.button_wakes), wdt.longest_gap_us / 1e6, wdt.timeout_s,
+           wdt.expirations);
+    const HostI2cStats& i2c = HostI2cGetStats();
+    printf("[SIM] I2C: %llu transactions, %llu bytes, checksum %08x (equal across runs)\n",
+           static_cast<unsigned long long>(i2c.transactions),
+           static_cast<unsigned long long>(i2c.bytes), i2c.checksum);
+
+    interpreter->SetProfiler(nullptr);
+    HostClockSetEventHook(nullptr, nullptr, 0);
+    return 0;
+}
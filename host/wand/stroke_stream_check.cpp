@@ -0,0 +1,200 @@
+#include "wand/stroke_stream_check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "stroke_stream.h"
+
+namespace {
+
+// Same as magic_wand/src/main.cpp
+constexpr int kStructBytes = 2 * sizeof(int32_t) + 2 * kStrokeStreamMaxPoints;
+constexpr double kFlushMs = 100.0;         // kStrokeStreamFlushMs
+constexpr int kFlushPoints = 8;            // kStrokeStreamFlushPoints
+constexpr double kPointIntervalMs = 22.0;  // Every 4th IMU read of a ~5.5 ms loop
+constexpr int kDropEvery = 5;              // Lossy run: every fifth notification is lost
+
+// Radio time of one notification on the LE 1M PHY without data length
+// extension: ATT (3) + L2CAP (4) header, split into 27-byte link-layer
+// payloads. Each PDU costs 10 bytes of framing, the central's empty PDU and
+// two inter-frame spaces.
+double NotificationAirUs(int value_bytes) {
+    int remaining = value_bytes + 3 + 4;
+    double us = 0.0;
+    while (remaining > 0) {
+        const int pdu = remaining < 27 ? remaining : 27;
+        us += (pdu + 10) * 8.0 + 80.0 + 2 * 150.0;
+        remaining -= pdu;
+    }
+    return us;
+}
+
+// The firmware's stroke struct and stream state for one gesture
+struct Device {
+    uint8_t buffer[kStructBytes];
+    StrokeStreamEncoder encoder;
+    double last_flush_ms = 0.0;
+
+    void SetState(int32_t state) { memcpy(buffer, &state, sizeof(state)); }
+    int32_t state() const {
+        int32_t s;
+        memcpy(&s, buffer, sizeof(s));
+        return s;
+    }
+    void SetLength(int32_t length) { memcpy(buffer + sizeof(int32_t), &length, sizeof(length)); }
+    int32_t length() const {
+        int32_t n;
+        memcpy(&n, buffer + sizeof(int32_t), sizeof(n));
+        return n;
+    }
+    int8_t* points() { return reinterpret_cast<int8_t*>(buffer + 2 * sizeof(int32_t)); }
+};
+
+struct LinkStats {
+    int packets = 0;
+    int dropped = 0;
+    int gaps = 0;
+    int resyncs = 0;
+    int malformed = 0;
+    bool last_dropped = false;
+    int done_lost = 0;      // The stroke's final packet itself was lost
+    long stream_bytes = 0;
+    double stream_us = 0.0;
+    int updates = 0;        // Flushes that sent something
+    long full_bytes = 0;    // Full struct notified on every update instead
+    double full_us = 0.0;
+    int absolute_packets = 0;  // New points as plain int8 pairs, same header
+    long absolute_bytes = 0;
+    double absolute_us = 0.0;
+};
+
+// StreamStroke(): flush when forced, after kFlushPoints new points or kFlushMs
+void Flush(Device* device, bool force, double now_ms, bool lossy, StrokeStreamDecoder* decoder,
+           LinkStats* stats) {
+    const int pending = device->encoder.Pending(device->length());
+    if (!force && pending < kFlushPoints && now_ms - device->last_flush_ms < kFlushMs) return;
+    device->last_flush_ms = now_ms;
+
+    uint8_t packet[kStrokeStreamPacketBytes];
+    int length;
+    bool sent = false;
+    while ((length = device->encoder.Encode(device->points(), device->length(), device->state(),
+                                            packet)) > 0) {
+        sent = true;
+        stats->packets++;
+        stats->stream_bytes += length;
+        stats->stream_us += NotificationAirUs(length);
+        // The same points as plain int8 pairs, 8 per notification
+        int left = packet[3];
+        do {
+            const int take = left < 8 ? left : 8;
+            const int bytes = kStrokeStreamHeaderBytes + 2 * take;
+            stats->absolute_packets++;
+            stats->absolute_bytes += bytes;
+            stats->absolute_us += NotificationAirUs(bytes);
+            left -= take;
+        } while (left > 0);
+        if (lossy && stats->packets % kDropEvery == 0) {
+            stats->dropped++;
+            stats->last_dropped = true;
+            continue;
+        }
+        stats->last_dropped = false;
+        const StrokeStreamDecoder::Result result = decoder->Decode(packet, length);
+        if (result == StrokeStreamDecoder::kStrokeMalformed) stats->malformed++;
+        if (result == StrokeStreamDecoder::kStrokeGap) {
+            // The client reads the stroke characteristic, which the
+            // firmware keeps current
+            stats->gaps++;
+            if (decoder->Resync(device->buffer, kStructBytes)) stats->resyncs++;
+        }
+    }
+    if (sent) {
+        stats->updates++;
+        stats->full_bytes += kStructBytes;
+        stats->full_us += NotificationAirUs(kStructBytes);
+    }
+}
+
+bool Matches(const StrokeStreamDecoder& decoder, Device* device) {
+    return decoder.state() == device->state() && decoder.point_count() == device->length() &&
+           memcmp(decoder.points(), device->points(), 2 * device->length()) == 0;
+}
+
+// Returns the number of strokes reconstructed exactly when they finish
+int RunLink(const std::vector<WandStroke>& strokes, bool lossy, LinkStats* stats) {
+    Device device;
+    memset(device.buffer, 0, sizeof(device.buffer));
+    StrokeStreamDecoder decoder;
+    int exact = 0;
+    double now_ms = 0.0;
+    for (const WandStroke& stroke : strokes) {
+        // 'r': new gesture, drawing
+        device.SetState(1);
+        device.SetLength(0);
+        device.encoder.BeginStroke();
+        Flush(&device, true, now_ms, lossy, &decoder, stats);
+
+        const int count = stroke.point_count() < kStrokeStreamMaxPoints ? stroke.point_count()
+                                                                         : kStrokeStreamMaxPoints;
+        for (int i = 0; i < count; i++) {
+            now_ms += kPointIntervalMs;
+            device.points()[2 * i] = stroke.points[2 * i];
+            device.points()[2 * i + 1] = stroke.points[2 * i + 1];
+            device.SetLength(i + 1);
+            Flush(&device, false, now_ms, lossy, &decoder, stats);
+        }
+
+        // 's': done, then back to waiting after classification
+        device.SetState(2);
+        Flush(&device, true, now_ms, lossy, &decoder, stats);
+        if (Matches(decoder, &device)) exact++;
+        if (stats->last_dropped) stats->done_lost++;
+        device.SetState(0);
+        device.SetLength(0);
+        Flush(&device, true, now_ms, lossy, &decoder, stats);
+        now_ms += 1000.0;
+    }
+    return exact;
+}
+
+}  // namespace
+
+bool CheckStrokeStream(const std::vector<WandStroke>& strokes) {
+    int points = 0;
+    for (const WandStroke& stroke : strokes) {
+        points += stroke.point_count() < kStrokeStreamMaxPoints ? stroke.point_count()
+                                                                : kStrokeStreamMaxPoints;
+    }
+    const int n = static_cast<int>(strokes.size());
+
+    LinkStats clean;
+    const int clean_exact = RunLink(strokes, false, &clean);
+    LinkStats lossy;
+    const int lossy_exact = RunLink(strokes, true, &lossy);
+
+    printf("[STREAM] %d strokes, %d points, flush every %d points or %.0f ms, point every %.0f ms\n",
+           n, points, kFlushPoints, kFlushMs, kPointIntervalMs);
+    printf("[STREAM] Clean link: %d/%d strokes exact, %d packets (%.1f points each, %.2f bytes "
+           "per point incl. header), %d malformed\n",
+           clean_exact, n, clean.packets, static_cast<double>(points) / clean.packets,
+           static_cast<double>(clean.stream_bytes) / points, clean.malformed);
+    printf("[STREAM] Every %dth packet lost: %d/%d strokes exact, %d lost, %d gaps, %d resyncs "
+           "from the stroke struct, %d strokes whose last packet was the lost one\n",
+           kDropEvery, lossy_exact, n, lossy.dropped, lossy.gaps, lossy.resyncs, lossy.done_lost);
+
+    printf("%-34s %10s %14s %16s %8s\n", "per stroke", "bytes", "radio_ms", "notifications", "ratio");
+    const double per = n > 0 ? 1.0 / n : 0.0;
+    printf("%-34s %10.0f %14.2f %16.1f %8s\n", "delta stream", clean.stream_bytes * per,
+           clean.stream_us * per / 1000.0, clean.packets * per, "1.0x");
+    printf("%-34s %10.0f %14.2f %16.1f %7.1fx\n", "new points as int8 pairs",
+           clean.absolute_bytes * per, clean.absolute_us * per / 1000.0, clean.absolute_packets * per,
+           clean.absolute_us / clean.stream_us);
+    printf("%-34s %10.0f %14.2f %16.1f %7.1fx\n", "full struct per update (MTU >= 331)",
+           clean.full_bytes * per, clean.full_us * per / 1000.0, clean.updates * per,
+           clean.full_us / clean.stream_us);
+    // A lost last packet only shows with the next one, after the check
+    return clean_exact == n && lossy_exact + lossy.done_lost == n && clean.malformed == 0 &&
+           lossy.malformed == 0;
+}
@@ -0,0 +1,20 @@
+/* Check for the live stroke notifications (magic_wand/src/stroke_stream.h).
+ * Every stroke is fed point by point to the encoder with the firmware's
+ * flush policy (StreamStroke() in magic_wand/src/main.cpp) and decoded as a
+ * client would. The decoder must end every stroke with exactly the
+ * firmware's points and state, both on a clean link and with every fifth
+ * notification dropped (gaps repaired by reading the full stroke struct).
+ * Also reports the notification bytes and radio time against notifying the
+ * full 328-byte stroke struct on every update.
+ */
+#ifndef HOST_WAND_STROKE_STREAM_CHECK_H_
+#define HOST_WAND_STROKE_STREAM_CHECK_H_
+
+#include <vector>
+
+#include "wand/wand_dataset.h"
+
+// Returns false if any stroke is not reconstructed exactly
+bool CheckStrokeStream(const std::vector<WandStroke>& strokes);
+
+#endif  // HOST_WAND_STROKE_STREAM_CHECK_H_
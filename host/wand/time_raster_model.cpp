@@ -0,0 +1,112 @@
+#include "wand/time_raster_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "rasterize_stroke.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+// Real input value of each RGB channel and of the time channel at stroke
+// time t in [0, 1), for an input quantized with scale 1 and zero point -128
+// (the raster byte + 128, like the Colab PNGs)
+void PixelValues(float t, float rgb[3], float* time) {
+    if (t < 0.5f) {
+        rgb[0] = 255.0f * (1.0f - 2.0f * t);
+        rgb[1] = 255.0f * 2.0f * t;
+        rgb[2] = 0.0f;
+    } else {
+        rgb[0] = 0.0f;
+        rgb[1] = 255.0f * (2.0f - 2.0f * t);
+        rgb[2] = 255.0f * (2.0f * t - 1.0f);
+    }
+    *time = (kTimeRasterStart + 128) + roundf(t * (127 - kTimeRasterStart));
+}
+
+}  // namespace
+
+std::vector<uint8_t> DeriveTimeRasterModel(const unsigned char* rgb_model) {
+    std::unique_ptr<tflite::ModelT> model(tflite::GetModel(rgb_model)->UnPack());
+    tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+    tflite::TensorT* input = subgraph->tensors[subgraph->inputs[0]].get();
+    if (input->type != tflite::TensorType_INT8 || input->shape.size() != 4 ||
+        input->shape[3] != 3 || input->quantization == nullptr ||
+        input->quantization->zero_point.empty() || input->quantization->zero_point[0] != -128) {
+        fprintf(stderr, "[WAND] ERROR: expected an int8 [1, H, W, 3] input with zero point -128\n");
+        return {};
+    }
+    tflite::OperatorT* conv = subgraph->operators[0].get();
+    const tflite::OperatorCodeT* code = model->operator_codes[conv->opcode_index].get();
+    // Models from older converters only set the deprecated int8 field
+    const int32_t builtin = std::max<int32_t>(code->builtin_code, code->deprecated_builtin_code);
+    if (builtin != tflite::BuiltinOperator_CONV_2D || conv->inputs[0] != subgraph->inputs[0]) {
+        fprintf(stderr, "[WAND] ERROR: first op must be a CONV_2D on the model input\n");
+        return {};
+    }
+
+    // Least-squares gamma[c] with rgb[c](t) ~= gamma[c] * time(t) over the stroke
+    float gamma[3];
+    double rgb_time[3] = {0.0, 0.0, 0.0};
+    double time_time = 0.0;
+    for (int i = 0; i < 256; i++) {
+        float rgb[3];
+        float time;
+        PixelValues(i / 256.0f, rgb, &time);
+        for (int c = 0; c < 3; c++) rgb_time[c] += rgb[c] * time;
+        time_time += time * time;
+    }
+    for (int c = 0; c < 3; c++) gamma[c] = static_cast<float>(rgb_time[c] / time_time);
+
+    // Fold the filter [O, KH, KW, 3] -> [O, KH, KW, 1] and requantize per output
+    tflite::TensorT* filter = subgraph->tensors[conv->inputs[1]].get();
+    tflite::TensorT* bias = subgraph->tensors[conv->inputs[2]].get();
+    std::vector<uint8_t>& filter_data = model->buffers[filter->buffer]->data;
+    std::vector<uint8_t>& bias_data = model->buffers[bias->buffer]->data;
+    std::vector<float>& filter_scales = filter->quantization->scale;
+    const int outputs = filter->shape[0];
+    const int taps = filter->shape[1] * filter->shape[2];
+    std::vector<uint8_t> folded(outputs * taps);
+    std::vector<float> new_scales(outputs);
+    for (int o = 0; o < outputs; o++) {
+        const float scale = filter_scales[filter_scales.size() == 1 ? 0 : o];
+        std::vector<float> weights(taps);
+        float max_abs = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            const int8_t* q = reinterpret_cast<const int8_t*>(&filter_data[(o * taps + k) * 3]);
+            weights[k] = scale * (gamma[0] * q[0] + gamma[1] * q[1] + gamma[2] * q[2]);
+            max_abs = fmaxf(max_abs, fabsf(weights[k]));
+        }
+        new_scales[o] = max_abs > 0.0f ? max_abs / 127.0f : scale;
+        for (int k = 0; k < taps; k++) {
+            const int8_t q = static_cast<int8_t>(lroundf(weights[k] / new_scales[o]));
+            memcpy(&folded[o * taps + k], &q, 1);
+        }
+        // Bias keeps its real value, its scale is input_scale * filter_scale
+        int32_t bias_q;
+        memcpy(&bias_q, &bias_data[o * sizeof(int32_t)], sizeof(bias_q));
+        bias_q = static_cast<int32_t>(lround(static_cast<double>(bias_q) * scale / new_scales[o]));
+        memcpy(&bias_data[o * sizeof(int32_t)], &bias_q, sizeof(bias_q));
+    }
+    filter_data = folded;
+    filter->shape[3] = 1;
+    filter_scales = new_scales;
+    filter->quantization->zero_point.assign(outputs, 0);
+    std::vector<float>& bias_scales = bias->quantization->scale;
+    bias_scales.resize(outputs);
+    for (int o = 0; o < outputs; o++) {
+        bias_scales[o] = input->quantization->scale[0] * new_scales[o];
+    }
+    input->shape[3] = 1;
+    if (input->shape_signature.size() == 4) input->shape_signature[3] = 1;
+
+    // The TFLM copy of flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(128 * 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    return std::vector<uint8_t>(builder.GetBufferPointer(),
+                                builder.GetBufferPointer() + builder.GetSize());
+}
@@ -0,0 +1,19 @@
+/* Single-channel (time raster) variant of an RGB magic wand model without
+ * retraining: the first conv is folded from 3 input channels to the one
+ * RasterizeStrokeTime() channel by a least-squares fit of each RGB channel
+ * as a multiple of the time value, then requantized per output channel.
+ * Everything after the first conv is unchanged. This only approximates the
+ * RGB model; magic_wand/train_wand_model.py --encoding time trains a proper
+ * one. Used by host_wand to compare encodings without TensorFlow.
+ */
+#ifndef HOST_WAND_TIME_RASTER_MODEL_H_
+#define HOST_WAND_TIME_RASTER_MODEL_H_
+
+#include <cstdint>
+#include <vector>
+
+// Serialized .tflite, empty (with the error printed) if the model does not
+// start with a CONV_2D on a [1, H, W, 3] int8 input
+std::vector<uint8_t> DeriveTimeRasterModel(const unsigned char* rgb_model);
+
+#endif  // HOST_WAND_TIME_RASTER_MODEL_H_
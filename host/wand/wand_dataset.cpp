@@ -0,0 +1,193 @@
+#include "wand/wand_dataset.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr float kCoordScale = 0.6f;  // kCoordScale in magic_wand/src/main.cpp
+
+// Minimal recursive-descent reader for the wanddata layout:
+// {"strokes": [{"index": N, "strokePoints": [{"x": F, "y": F}, ...], "label": "S"}, ...]}
+// Unknown keys are skipped.
+class StrokeJsonReader {
+public:
+    explicit StrokeJsonReader(const std::string& text) : text_(text), pos_(0) {}
+
+    bool ReadFile(std::vector<WandStroke>* strokes) {
+        if (!Consume('{')) return false;
+        if (Consume('}')) return true;
+        do {
+            std::string key;
+            if (!ReadString(&key) || !Consume(':')) return false;
+            if (key == "strokes") {
+                if (!ReadStrokes(strokes)) return false;
+            } else if (!SkipValue()) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    size_t position() const { return pos_; }
+
+private:
+    bool ReadStrokes(std::vector<WandStroke>* strokes) {
+        if (!Consume('[')) return false;
+        if (Consume(']')) return true;
+        do {
+            WandStroke stroke;
+            stroke.file_index = static_cast<int>(strokes->size());
+            if (!ReadStroke(&stroke)) return false;
+            strokes->push_back(stroke);
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    bool ReadStroke(WandStroke* stroke) {
+        if (!Consume('{')) return false;
+        if (Consume('}')) return true;
+        do {
+            std::string key;
+            if (!ReadString(&key) || !Consume(':')) return false;
+            if (key == "label") {
+                if (!ReadString(&stroke->label)) return false;
+            } else if (key == "index") {
+                double index;
+                if (!ReadNumber(&index)) return false;
+                stroke->file_index = static_cast<int>(index);
+            } else if (key == "strokePoints") {
+                if (!ReadPoints(stroke)) return false;
+            } else if (!SkipValue()) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ReadPoints(WandStroke* stroke) {
+        if (!Consume('[')) return false;
+        if (Consume(']')) return true;
+        do {
+            double x = 0.0;
+            double y = 0.0;
+            if (!Consume('{')) return false;
+            do {
+                std::string key;
+                double value;
+                if (!ReadString(&key) || !Consume(':') || !ReadNumber(&value)) return false;
+                if (key == "x") x = value;
+                if (key == "y") y = value;
+            } while (Consume(','));
+            if (!Consume('}')) return false;
+            if (stroke->point_count() < kWandMaxStrokePoints) {
+                stroke->points.push_back(EncodeCoord(static_cast<float>(x)));
+                stroke->points.push_back(EncodeCoord(static_cast<float>(y)));
+            }
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    // [-0.6, 0.6] -> int8, as in UpdateStrokeFromGyroSample()
+    static int8_t EncodeCoord(float coord) {
+        float r = coord / kCoordScale;
+        if (r > 1.0f) r = 1.0f;
+        if (r < -1.0f) r = -1.0f;
+        int32_t value = static_cast<int32_t>(roundf(r * 128.0f));
+        if (value > 127) value = 127;
+        if (value < -128) value = -128;
+        return static_cast<int8_t>(value);
+    }
+
+    bool SkipValue() {
+        SkipSpace();
+        if (pos_ >= text_.size()) return false;
+        const char c = text_[pos_];
+        if (c == '"') {
+            std::string ignored;
+            return ReadString(&ignored);
+        }
+        if (c == '{' || c == '[') {
+            const char close = c == '{' ? '}' : ']';
+            pos_++;
+            if (Consume(close)) return true;
+            do {
+                if (c == '{') {
+                    std::string key;
+                    if (!ReadString(&key) || !Consume(':')) return false;
+                }
+                if (!SkipValue()) return false;
+            } while (Consume(','));
+            return Consume(close);
+        }
+        // Number, true, false, null
+        const size_t start = pos_;
+        while (pos_ < text_.size() && (isalnum(static_cast<unsigned char>(text_[pos_])) ||
+                                       strchr("+-.", text_[pos_]) != nullptr)) {
+            pos_++;
+        }
+        return pos_ > start;
+    }
+
+    bool ReadString(std::string* out) {
+        if (!Consume('"')) return false;
+        out->clear();
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) pos_++;
+            out->push_back(text_[pos_++]);
+        }
+        return Consume('"');
+    }
+
+    bool ReadNumber(double* value) {
+        SkipSpace();
+        const char* start = text_.c_str() + pos_;
+        char* end = nullptr;
+        *value = strtod(start, &end);
+        if (end == start) return false;
+        pos_ += end - start;
+        return true;
+    }
+
+    void SkipSpace() {
+        while (pos_ < text_.size() && isspace(static_cast<unsigned char>(text_[pos_]))) pos_++;
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& text_;
+    size_t pos_;
+};
+
+}  // namespace
+
+bool LoadWandStrokes(const char* path, std::vector<WandStroke>* strokes) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "[WAND] ERROR: cannot open %s\n", path);
+        return false;
+    }
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) text.append(chunk, n);
+    fclose(file);
+
+    StrokeJsonReader reader(text);
+    if (!reader.ReadFile(strokes)) {
+        fprintf(stderr, "[WAND] ERROR: %s: unexpected JSON near byte %zu\n", path,
+                reader.position());
+        return false;
+    }
+    return true;
+}
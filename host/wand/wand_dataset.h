@@ -0,0 +1,28 @@
+/* Magic wand strokes from the wanddata_*.json files the Colab notebook
+ * trains on (and that PrintStrokeAsJson() prints): float stroke points in
+ * [-0.6, 0.6] plus a label. Loaded into the int8 encoding the firmware
+ * passes to RasterizeStroke().
+ */
+#ifndef HOST_WAND_WAND_DATASET_H_
+#define HOST_WAND_WAND_DATASET_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct WandStroke {
+    std::string label;
+    int file_index;               // Stroke "index" in its file
+    std::vector<int8_t> points;   // x/y pairs, [-1, 1] -> [-128, 127]
+    int point_count() const { return static_cast<int>(points.size() / 2); }
+};
+
+// Same as UpdateStrokeFromGyroSample(): firmware stroke points are limited to
+// stroke_transmit_max_length
+constexpr int kWandMaxStrokePoints = 160;
+
+// Appends the strokes of one wanddata JSON file. Prints the error and
+// returns false if the file cannot be read or parsed.
+bool LoadWandStrokes(const char* path, std::vector<WandStroke>* strokes);
+
+#endif  // HOST_WAND_WAND_DATASET_H_
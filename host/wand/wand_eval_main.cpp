@@ -0,0 +1,262 @@
+/* GAINS magic wand evaluator
+ * Runs wanddata_*.json strokes through the firmware's raster + quantize +
+ * invoke path and reports accuracy and per-stage latency for each model.
+ * The input encoding follows the model input: 3 channels = RasterizeStroke()
+ * RGB raster, 1 channel = RasterizeStrokeTime() time raster.
+ *
+ *   host_wand magic_wand/wanddata_0.json magic_wand/wanddata_1.json
+ *   host_wand --model wand_time.tflite magic_wand/wanddata_*.json
+ *   host_wand --write-derived wand_time_derived.tflite magic_wand/wanddata_*.json
+ *   host_wand --check-stream magic_wand/wanddata_*.json
+ *
+ * Without --model the built-in RGB model is compared with a time-raster
+ * model derived from it (see time_raster_model.h).
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "magic_wand_model_data.h"
+#include "rasterize_stroke.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "wand/stroke_stream_check.h"
+#include "wand/time_raster_model.h"
+#include "wand/wand_dataset.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kArenaSize = 80 * 1024;  // kTensorArenaSize in magic_wand/src/main.cpp
+constexpr int kRasterSize = 32;
+constexpr int kLabelCount = 2;
+const char* const kLabels[kLabelCount] = {"0", "1"};
+constexpr float kMinConfidence = 0.35f;  // Same UNKNOWN logic as the firmware
+constexpr float kMinMargin = 0.08f;
+
+struct WandModel {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+struct EvalResult {
+    int channels = 0;
+    int strokes = 0;
+    int correct = 0;
+    int unknown = 0;           // Below kMinConfidence/kMinMargin
+    int confident_correct = 0; // Correct and not unknown
+    double raster_us = 0.0;    // Per stroke, mean over all repeats
+    double quantize_us = 0.0;
+    double invoke_us = 0.0;
+};
+
+double ElapsedUs(Clock::time_point from) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - from).count();
+}
+
+int LabelIndex(const std::string& label) {
+    for (int i = 0; i < kLabelCount; i++) {
+        if (label == kLabels[i]) return i;
+    }
+    return -1;
+}
+
+bool ReadFile(const char* path, std::vector<uint8_t>* data) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "[WAND] ERROR: cannot open %s\n", path);
+        return false;
+    }
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data->insert(data->end(), chunk, chunk + n);
+    fclose(file);
+    return true;
+}
+
+bool WriteFile(const char* path, const std::vector<uint8_t>& data) {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr || fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        fprintf(stderr, "[WAND] ERROR: cannot write %s\n", path);
+        if (file != nullptr) fclose(file);
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+bool Evaluate(const WandModel& model, const std::vector<WandStroke>& strokes, int repeat,
+              EvalResult* result) {
+    static tflite::AllOpsResolver resolver;
+    alignas(16) static uint8_t arena[kArenaSize];
+    tflite::MicroInterpreter interpreter(tflite::GetModel(model.data.data()), resolver, arena,
+                                         kArenaSize);
+    if (interpreter.AllocateTensors() != kTfLiteOk) {
+        fprintf(stderr, "[WAND] ERROR: %s: tensor allocation failed\n", model.name.c_str());
+        return false;
+    }
+    TfLiteTensor* input = interpreter.input(0);
+    result->channels = input->dims->data[input->dims->size - 1];
+    if (result->channels != 1 && result->channels != 3) {
+        fprintf(stderr, "[WAND] ERROR: %s: %d input channels, expected 1 or 3\n",
+                model.name.c_str(), result->channels);
+        return false;
+    }
+    const int input_bytes = kRasterSize * kRasterSize * result->channels;
+    const float input_scale = input->params.scale;
+    const int input_zp = input->params.zero_point;
+
+    int8_t raster[kRasterSize * kRasterSize * 3];
+    for (int r = 0; r < repeat; r++) {
+        for (const WandStroke& stroke : strokes) {
+            std::vector<int8_t> points = stroke.points;
+            auto start = Clock::now();
+            if (result->channels == 3) {
+                RasterizeStroke(points.data(), stroke.point_count(), 1.0f, 1.0f, kRasterSize,
+                                kRasterSize, raster);
+            } else {
+                RasterizeStrokeTime(points.data(), stroke.point_count(), 1.0f, 1.0f, kRasterSize,
+                                    kRasterSize, raster);
+            }
+            result->raster_us += ElapsedUs(start);
+
+            // Same quantization as the firmware: raster + 128 is the [0, 255] pixel
+            start = Clock::now();
+            for (int i = 0; i < input_bytes; i++) {
+                const float pixel = static_cast<float>(raster[i] + 128);
+                int32_t q = static_cast<int32_t>(roundf(pixel / input_scale)) + input_zp;
+                if (q < -128) q = -128;
+                if (q > 127) q = 127;
+                input->data.int8[i] = static_cast<int8_t>(q);
+            }
+            result->quantize_us += ElapsedUs(start);
+
+            start = Clock::now();
+            if (interpreter.Invoke() != kTfLiteOk) {
+                fprintf(stderr, "[WAND] ERROR: %s: invoke failed\n", model.name.c_str());
+                return false;
+            }
+            result->invoke_us += ElapsedUs(start);
+            if (r > 0) continue;
+
+            const TfLiteTensor* output = interpreter.output(0);
+            float best_prob = -1.0f;
+            float second_prob = -1.0f;
+            int best = -1;
+            for (int i = 0; i < kLabelCount; i++) {
+                const float p = output->params.scale *
+                                (static_cast<int>(output->data.int8[i]) - output->params.zero_point);
+                if (p > best_prob) {
+                    second_prob = best_prob;
+                    best_prob = p;
+                    best = i;
+                } else if (p > second_prob) {
+                    second_prob = p;
+                }
+            }
+            const bool confident = best_prob >= kMinConfidence && best_prob - second_prob >= kMinMargin;
+            const bool correct = best == LabelIndex(stroke.label);
+            result->strokes++;
+            if (correct) result->correct++;
+            if (!confident) result->unknown++;
+            if (correct && confident) result->confident_correct++;
+        }
+    }
+    const double runs = static_cast<double>(repeat) * strokes.size();
+    result->raster_us /= runs;
+    result->quantize_us /= runs;
+    result->invoke_us /= runs;
+    return true;
+}
+
+void PrintUsage() {
+    printf("Usage: host_wand [options] WANDDATA.json...\n");
+    printf("  --model FILE.tflite      evaluate this model (repeatable, default: built-in RGB model\n");
+    printf("                           and the time-raster model derived from it)\n");
+    printf("  --repeat N               timing passes over the strokes (default 20)\n");
+    printf("  --write-derived FILE     write the derived time-raster model as .tflite\n");
+    printf("  --check-stream           round-trip the strokes through the live BLE stroke stream\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<const char*> json_paths;
+    std::vector<const char*> model_paths;
+    const char* derived_path = nullptr;
+    int repeat = 20;
+    bool check_stream = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--model") == 0 && value) {
+            model_paths.push_back(argv[++i]);
+        } else if (strcmp(arg, "--repeat") == 0 && value) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(arg, "--write-derived") == 0 && value) {
+            derived_path = argv[++i];
+        } else if (strcmp(arg, "--check-stream") == 0) {
+            check_stream = true;
+        } else if (arg[0] != '-') {
+            json_paths.push_back(arg);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (json_paths.empty()) {
+        PrintUsage();
+        return 1;
+    }
+    if (repeat < 1) repeat = 1;
+
+    std::vector<WandStroke> strokes;
+    for (const char* path : json_paths) {
+        if (!LoadWandStrokes(path, &strokes)) return 1;
+    }
+    int labelled = 0;
+    for (const WandStroke& stroke : strokes) {
+        if (LabelIndex(stroke.label) >= 0) labelled++;
+    }
+    printf("[WAND] %zu strokes (%d with a known label) from %zu file(s)\n", strokes.size(),
+           labelled, json_paths.size());
+    if (check_stream) return CheckStrokeStream(strokes) ? 0 : 1;
+
+    std::vector<WandModel> models;
+    if (model_paths.empty() || derived_path != nullptr) {
+        const WandModel rgb = {"builtin_rgb", std::vector<uint8_t>(
+            g_magic_wand_model_data, g_magic_wand_model_data + g_magic_wand_model_data_len)};
+        const WandModel derived = {"derived_time", DeriveTimeRasterModel(g_magic_wand_model_data)};
+        if (derived.data.empty()) return 1;
+        if (derived_path != nullptr && !WriteFile(derived_path, derived.data)) return 1;
+        if (model_paths.empty()) {
+            models.push_back(rgb);
+            models.push_back(derived);
+        }
+    }
+    for (const char* path : model_paths) {
+        WandModel model = {path, {}};
+        if (!ReadFile(path, &model.data)) return 1;
+        models.push_back(model);
+    }
+
+    printf("%-24s %4s %6s %9s %8s %9s %9s %11s %9s %9s\n", "model", "ch", "bytes", "accuracy",
+           "unknown", "conf-ok", "raster_us", "quantize_us", "invoke_us", "total_us");
+    for (const WandModel& model : models) {
+        EvalResult result;
+        if (!Evaluate(model, strokes, repeat, &result)) return 1;
+        const double n = result.strokes > 0 ? result.strokes : 1;
+        printf("%-24s %4d %6d %8.1f%% %7.1f%% %8.1f%% %9.1f %11.1f %9.1f %9.1f\n",
+               model.name.c_str(), result.channels, kRasterSize * kRasterSize * result.channels,
+               100.0 * result.correct / n, 100.0 * result.unknown / n,
+               100.0 * result.confident_correct / n, result.raster_us, result.quantize_us,
+               result.invoke_us, result.raster_us + result.quantize_us + result.invoke_us);
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/* GAINS window index builder
+ * Slices a .gimu dataset into training windows once, splits them by
+ * participant (stratified by class) and writes the .gwix index that
+ * host/dataset/gimu_loader.py reads through the C loader. After writing,
+ * the index is reopened through that loader and one epoch of every split is
+ * gathered to check it and report the throughput.
+ *
+ *   host_windows --in merged.gimu --out merged.gwix [--window 50] [--stride 10]
+ *                [--validation 0.2] [--test 0.2] [--seed 1] [--batch 64]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "dataset/gimu_loader.h"
+#include "dataset/imu_dataset.h"
+#include "dataset/window_index.h"
+
+namespace {
+
+void PrintUsage() {
+    printf("Usage: host_windows --in FILE.gimu --out FILE.gwix [options]\n");
+    printf("  --window N        samples per window (default 50)\n");
+    printf("  --stride N        samples between window starts (default 10)\n");
+    printf("  --validation F    share of each class's participants for validation (default 0.2)\n");
+    printf("  --test F          share of each class's participants for test (default 0.2)\n");
+    printf("  --seed N          split and shuffle seed (default 1)\n");
+    printf("  --batch N         windows per gather in the epoch check (default 64)\n");
+}
+
+// One epoch of every split through the C loader, batch by batch
+bool GatherEpoch(const char* dataset_path, const char* index_path, int batch) {
+    GimuLoader* loader = gimu_loader_open(dataset_path, index_path);
+    if (loader == nullptr) return false;
+    const int window_size = gimu_loader_window_size(loader);
+    const int channels = gimu_loader_channels(loader);
+    std::vector<float> x(static_cast<size_t>(batch) * window_size * channels);
+    std::vector<int32_t> labels(batch);
+    std::vector<int32_t> ids(batch);
+
+    const auto start = std::chrono::steady_clock::now();
+    int gathered = 0;
+    double checksum = 0.0;
+    bool ok = true;
+    for (int split = 0; split < kNumSplits && ok; split++) {
+        const int begin = gimu_loader_split_begin(loader, split);
+        const int end = begin + gimu_loader_split_size(loader, split);
+        for (int first = begin; first < end && ok; first += batch) {
+            const int count = first + batch <= end ? batch : end - first;
+            for (int i = 0; i < count; i++) ids[i] = first + i;
+            ok = gimu_loader_gather(loader, ids.data(), count, nullptr, nullptr, x.data(),
+                                    labels.data()) == count;
+            checksum += x[0] + labels[0];
+            gathered += count;
+        }
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    gimu_loader_close(loader);
+    if (!ok) return false;
+    printf("[WINDOWS] Epoch through the loader: %d windows in %.2f ms (%.2f M windows/s, "
+           "batch %d, checksum %.3g)\n",
+           gathered, seconds * 1000.0, seconds > 0 ? gathered / seconds / 1e6 : 0.0, batch,
+           checksum);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* in_path = nullptr;
+    const char* out_path = nullptr;
+    WindowIndexConfig config;
+    int batch = 64;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--in") == 0 && value) {
+            in_path = argv[++i];
+        } else if (strcmp(arg, "--out") == 0 && value) {
+            out_path = argv[++i];
+        } else if (strcmp(arg, "--window") == 0 && value) {
+            config.window_size = atoi(argv[++i]);
+        } else if (strcmp(arg, "--stride") == 0 && value) {
+            config.stride = atoi(argv[++i]);
+        } else if (strcmp(arg, "--validation") == 0 && value) {
+            config.validation_fraction = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--test") == 0 && value) {
+            config.test_fraction = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--seed") == 0 && value) {
+            config.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--batch") == 0 && value) {
+            batch = atoi(argv[++i]);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (in_path == nullptr || out_path == nullptr || batch <= 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    ImuDataset dataset;
+    if (!dataset.Open(in_path)) return 1;
+
+    const auto start = std::chrono::steady_clock::now();
+    WindowIndexHeader header;
+    std::vector<WindowRecord> records;
+    WindowIndexStats stats;
+    if (!BuildWindowIndex(dataset, config, &header, &records, &stats)) return 1;
+    if (!WriteWindowIndex(out_path, header, records)) return 1;
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[WINDOWS] %s: %d sessions -> %u windows of %d (stride %d) in %.1f ms, %s\n", in_path,
+           dataset.num_sessions(), header.num_windows, config.window_size, config.stride,
+           seconds * 1000.0,
+           dataset.num_participants() > 1 ? "split by participant" : "split by session");
+    if (stats.short_sessions > 0 || stats.dropped_augmented > 0) {
+        printf("[WINDOWS] %d sessions shorter than a window, %d augmented sessions of "
+               "validation/test participants left out\n",
+               stats.short_sessions, stats.dropped_augmented);
+    }
+
+    // Windows per split and label
+    std::vector<int> per_label(static_cast<size_t>(kNumSplits) * dataset.num_labels(), 0);
+    for (const WindowRecord& w : records) per_label[w.split * dataset.num_labels() + w.label]++;
+    printf("%-11s %8s %8s %8s", "split", "groups", "sessions", "windows");
+    for (int l = 0; l < dataset.num_labels(); l++) printf(" %13s", dataset.LabelName(l));
+    printf("\n");
+    for (int split = 0; split < kNumSplits; split++) {
+        printf("%-11s %8d %8d %8u", WindowSplitName(split), stats.participants[split],
+               stats.sessions[split], header.split_windows[split]);
+        for (int l = 0; l < dataset.num_labels(); l++) {
+            printf(" %13d", per_label[split * dataset.num_labels() + l]);
+        }
+        printf("\n");
+    }
+    for (int l = 0; l < dataset.num_labels(); l++) {
+        for (int split = kSplitValidation; split < kNumSplits; split++) {
+            const bool wanted = split == kSplitValidation ? config.validation_fraction > 0.0f
+                                                          : config.test_fraction > 0.0f;
+            if (wanted && per_label[split * dataset.num_labels() + l] == 0) {
+                printf("[WINDOWS] WARNING: no %s windows of %s (too few participants)\n",
+                       WindowSplitName(split), dataset.LabelName(l));
+            }
+        }
+    }
+
+    return GatherEpoch(in_path, out_path, batch) ? 0 : 1;
+}
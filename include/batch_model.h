@@ -0,0 +1,33 @@
+#ifndef BATCH_MODEL_H_
+#define BATCH_MODEL_H_
+
+#include <cstdint>
+#include <vector>
+
+// Batch dimension rewrite
+// TFLM reads tensor shapes straight from the flatbuffer and cannot resize
+// inputs, so a model exported for one [1, ...] window is rewritten before the
+// interpreter is built: dimension 0 of every activation tensor becomes batch
+// and the shape constants of RESHAPE/EXPAND_DIMS follow. One Invoke() then
+// runs batch windows, laid out one after the other in the input and output
+// tensors. The kernels loop over the batch internally, so every window gives
+// exactly the output of a batch-1 invoke (checked by host_bench).
+//
+// Meant for host evaluation of many windows; the firmware classifies one
+// window at a time. Only single-subgraph models whose operators are known to
+// treat dimension 0 as an independent batch are accepted (conv, depthwise,
+// fully connected, pooling, elementwise, softmax, MEAN over other axes, the
+// shape ops and the fused ops of fused_ops.h); apply it after FuseModel().
+// The arena grows roughly batch times.
+
+struct BatchModelReport {
+    int batch;
+    int tensors_resized;   // Activation tensors given the batch dimension
+    int constants_changed; // Shape/axis constants rewritten
+};
+
+// False if the model is not supported (batched stays empty)
+bool BatchModel(const unsigned char* model_data, int batch, std::vector<uint8_t>* batched,
+                BatchModelReport* report);
+
+#endif  // BATCH_MODEL_H_
@@ -12,6 +12,10 @@ constexpr uint32_t kI2C_FREQ = 400000;  // 400 kHz fast mode
 // ICM20600 device address when AD0 is pulled high.
 constexpr uint8_t kIMU_Address = 0x69;
 
+// ICM20600 INT pin. Not wired on the XIAO expansion board (-1): idle mode
+// polls INT_STATUS instead of waking on the pin (idle_mode.h).
+constexpr int kIMU_IntPin = -1;
+
 // Threshold for motion detection helper.
 constexpr float kAccelThreshold = 0.15f;
 
@@ -0,0 +1,68 @@
+#ifndef FIRST_STAGE_H_
+#define FIRST_STAGE_H_
+
+#include "model_config.h"
+
+// Cascaded early exit: first stage
+// Hand-crafted features over the same sliding window as the CNN, all updated
+// in O(1) per sample:
+//   - pitch range: max - min device pitch (from raw accel) in the window
+//   - rep duration: length of the last complete vertical movement segment
+//   - vertical energy: mean squared linear accel along gravity in the window
+// A multinomial logistic regression on the standardized features gives class
+// probabilities. When the best one reaches the exit threshold the CNN is
+// skipped; otherwise the full model in pushup_model_data.cpp runs.
+// Weights come from first_stage_params.h (host/replay --fit-first-stage).
+
+constexpr int NUM_FIRST_STAGE_FEATURES = 3;
+
+struct FirstStageFeatures {
+    float pitch_range_deg;
+    float rep_duration_s;
+    float vertical_energy;
+};
+
+// Classifier inputs before standardization (energy is log10, it spans decades)
+void FirstStageFeatureVector(const FirstStageFeatures& features,
+                             float out[NUM_FIRST_STAGE_FEATURES]);
+
+class FirstStageClassifier {
+public:
+    FirstStageClassifier();
+
+    // Clear the window (start of a new recording)
+    void Reset();
+
+    // Add one sample: raw accel (g) and the preprocessed sample [ax..gz]
+    void OnSample(const float* raw_accel, const float* processed_sample);
+
+    // Features of the current window
+    FirstStageFeatures Features() const;
+
+    // Class probabilities from the current features. Returns true if the
+    // result is confident enough to skip the full model.
+    bool Classify(float probs[NUM_POSTURE_CLASSES], int& best_class, float& confidence) const;
+
+private:
+    // Sliding min/max with monotonic queues of sample numbers (pitch_ is
+    // indexed by sample % WINDOW_SIZE)
+    struct MonotonicQueue {
+        int items[WINDOW_SIZE];
+        int head;
+        int count;
+    };
+    void PushExtreme(MonotonicQueue* queue, bool keep_max);
+
+    float pitch_[WINDOW_SIZE];
+    float vertical_sq_[WINDOW_SIZE];
+    MonotonicQueue pitch_max_;
+    MonotonicQueue pitch_min_;
+    float vertical_sum_sq_;
+    float smoothed_accel_[3];
+    float activity_;
+    int active_run_;
+    int last_rep_samples_;
+    int sample_count_;
+};
+
+#endif  // FIRST_STAGE_H_
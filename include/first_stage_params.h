@@ -0,0 +1,19 @@
+#ifndef FIRST_STAGE_PARAMS_H_
+#define FIRST_STAGE_PARAMS_H_
+
+// Generated by host/replay --fit-first-stage from 534 windows (recording fold 0)
+// Features: pitch range (deg), rep duration (s), log10 vertical energy (g^2)
+// Exit thresholds target 90% precision; 2.0 = class never exits
+
+constexpr float kFirstStageMean[3] = {24.906620f, 1.627817f, -0.502718f};
+constexpr float kFirstStageStd[3] = {8.594430f, 0.384736f, 0.302464f};
+constexpr float kFirstStageWeights[4][3] = {
+    {3.271669f, 0.834049f, 0.783865f},  // good-form
+    {0.216261f, -0.155314f, -0.683527f},  // hips-high
+    {-2.048636f, -1.605309f, -2.229553f},  // hips-sagging
+    {-1.439309f, 0.926575f, 2.129215f},  // partial-rom
+};
+constexpr float kFirstStageBias[4] = {2.842730f, 0.812905f, -1.651940f, -2.003709f};
+constexpr float kFirstStageExitThreshold[4] = {0.540000f, 0.500000f, 0.950000f, 2.000000f};
+
+#endif  // FIRST_STAGE_PARAMS_H_
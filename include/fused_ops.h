@@ -0,0 +1,54 @@
+#ifndef FUSED_OPS_H_
+#define FUSED_OPS_H_
+
+#include "tensorflow/lite/c/common.h"
+
+// Fused TFLM operators emitted by the load-time graph fusion pass
+// (graph_fusion.h). Each one replaces a chain of builtin int8 ops and
+// reproduces their integer arithmetic exactly, but the intermediate tensors
+// stay in registers or a small tile instead of a full arena buffer.
+//
+// GAINS_CHANNEL_AFFINE: MUL by a per-channel constant followed by ADD of a
+// per-channel constant (a batch norm after the activation).
+//   Inputs:  0: x, int8 [..., C]; 1: MUL constant, int8 [C];
+//            2: ADD constant, int8 [C]
+//   Output:  0: int8, shape of x, quantization of the ADD output; may share
+//            the buffer of x (in-place, element by element)
+//   Options: "add_activation", "const_first" (ADD constant was input 0),
+//            "mid_scale", "mid_zero_point" (the MUL output quantization),
+//            "mid_table", "mul_activation"
+//   Persistent: with "mid_table" 1 KB, the ADD-side rescale of every int8
+//            MUL output, in place of one rescale per element. The fusion
+//            pass sets it from kChannelAffineTableMinElements.
+//
+// GAINS_CONV_POOL: CONV_2D (VALID, any fused activation) followed by
+// MAX_POOL_2D (VALID). The conv rows one pooling window needs are computed
+// into a tile and pooled right away, so the conv output never exists as a
+// whole and rows no pooling window reads are skipped.
+//   Inputs:  0: input, int8 [N, H, W, Cin]; 1: filter, int8 [Cout, KH, KW, Cin]
+//            (per-channel quantized); 2: bias, int32 [Cout]
+//   Output:  0: pooled, int8 [N, PH, PW, Cout]
+//   Options: "conv_activation", "conv_scale", "conv_stride_h", "conv_stride_w",
+//            "conv_zero_point", "pool_activation", "pool_filter_h",
+//            "pool_filter_w", "pool_stride_h", "pool_stride_w"
+//
+// Register both with AddFusedOps() next to the builtin ops.
+
+constexpr char kChannelAffineOpName[] = "GAINS_CHANNEL_AFFINE";
+// Elements per invoke from which a channel affine op gets its 1 KB rescale
+// table: one rescale saved per byte of arena
+constexpr int kChannelAffineTableMinElements = 1024;
+constexpr char kConvPoolOpName[] = "GAINS_CONV_POOL";
+
+TfLiteRegistration* Register_GAINS_CHANNEL_AFFINE();
+TfLiteRegistration* Register_GAINS_CONV_POOL();
+
+// resolver.AddCustom() for every fused op (AllOpsResolver or a
+// MicroMutableOpResolver with room for them)
+template <typename Resolver>
+void AddFusedOps(Resolver& resolver) {
+    resolver.AddCustom(kChannelAffineOpName, Register_GAINS_CHANNEL_AFFINE());
+    resolver.AddCustom(kConvPoolOpName, Register_GAINS_CONV_POOL());
+}
+
+#endif  // FUSED_OPS_H_
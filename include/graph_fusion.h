@@ -0,0 +1,43 @@
+#ifndef GRAPH_FUSION_H_
+#define GRAPH_FUSION_H_
+
+#include <cstdint>
+#include <vector>
+
+// Load-time graph fusion
+// Rewrites a .tflite model before the interpreter is built so that chains of
+// operators run as one fused kernel (fused_ops.h) instead of writing every
+// intermediate tensor to the arena and reading it back:
+//
+//   RESHAPE/EXPAND_DIMS/SQUEEZE pairs that restore their input shape,
+//   DEQUANTIZE -> QUANTIZE back to the same parameters and QUANTIZE without
+//   a parameter change                      -> removed (identity)
+//   MUL + ADD by per-channel constants      -> GAINS_CHANNEL_AFFINE
+//   CONV_2D (+ fused ReLU) + MAX_POOL_2D    -> GAINS_CONV_POOL
+//
+// Only single-subgraph int8 models are rewritten and only chains whose
+// intermediates have no other reader. The fused kernels reproduce the
+// integer arithmetic of the ops they replace, so outputs are bit-exact
+// (checked against the unfused graph by host_bench). Unused tensors are
+// dropped afterwards.
+//
+// The rewritten model is a new flatbuffer in RAM (about the model size; the
+// rewrite briefly needs twice that in heap) that must outlive the interpreter.
+// Register the fused ops with AddFusedOps().
+
+struct GraphFusionReport {
+    int identity_ops;     // Operators removed as identities
+    int channel_affine;   // MUL + ADD pairs fused
+    int conv_pool;        // CONV_2D + MAX_POOL_2D pairs fused
+    int ops_before;
+    int ops_after;
+    int tensors_before;
+    int tensors_after;
+};
+
+// False if the model is not supported (fused stays empty). Finding nothing
+// to fuse is not an error: fused gets an equivalent copy.
+bool FuseModel(const unsigned char* model_data, std::vector<uint8_t>* fused,
+               GraphFusionReport* report);
+
+#endif  // GRAPH_FUSION_H_
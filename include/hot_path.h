@@ -0,0 +1,26 @@
+#ifndef HOT_PATH_H_
+#define HOT_PATH_H_
+
+// Placement of the per-sample hot path
+// GAINS_HOT marks a function that runs for every IMU sample or every
+// inference inner loop. With -DGAINS_HOT_IRAM on the device (env
+// xiao_release) it is IRAM_ATTR: the code is linked into internal RAM and
+// never waits for a flash cache refill after the BLE stack or the display
+// code evicted its lines. Elsewhere it expands to nothing, so debug and host
+// builds are unchanged. host/linkmap checks the placement in firmware.map.
+//
+// GAINS_HOT_INLINE forces a small helper into its hot caller, so it follows
+// the caller's placement instead of staying behind in flash.
+//
+// IRAM is small and shared with the BLE stack and the ISRs: mark only what
+// runs per sample, not setup or reporting code.
+#if defined(GAINS_HOT_IRAM) && defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#define GAINS_HOT IRAM_ATTR
+#else
+#define GAINS_HOT
+#endif
+
+#define GAINS_HOT_INLINE inline __attribute__((always_inline))
+
+#endif  // HOT_PATH_H_
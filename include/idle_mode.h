@@ -0,0 +1,92 @@
+#ifndef IDLE_MODE_H_
+#define IDLE_MODE_H_
+
+#include <cstdint>
+
+#include "imu_config.h"
+
+// Wake-on-motion idle mode
+// Outside a recording nothing consumes IMU samples, so after a while without
+// a button press, serial input or motion the IMU drops to accel low-power
+// wake-on-motion (imu_provider.h: gyro in standby, ~30 uA instead of ~2.8 mA),
+// the OLED turns off and the CPU light-sleeps between polls of INT_STATUS.
+// Motion above the threshold or the button wakes it: full-rate sampling
+// resumes with the model's filter config and the Preprocessor is primed
+// (Preprocessor::Prime) with the rest sample: the low-power accel sample of
+// the last poll without motion, i.e. the orientation the device woke from.
+// The first sample after a motion wake is already mid-motion, and a slow
+// turn while asleep stays under the WOM threshold, so neither that sample
+// nor the pre-sleep filter state is as close to never having slept.
+// The ICM-20600 INT pin is not wired on the XIAO expansion board
+// (kIMU_IntPin < 0), so wake latency is bounded by poll_interval_ms; with
+// the pin it wakes the CPU directly. Verified on host with a register model
+// of the IMU (host/idle).
+struct IdleModeConfig {
+    uint32_t sleep_after_ms = 30000;  // No activity for this long -> sleep
+    uint32_t poll_interval_ms = 200;  // Light sleep between INT_STATUS polls
+    uint32_t wom_period_ms = 40;      // Accel low-power ODR while asleep (25 Hz)
+    float wom_threshold_g = 0.06f;    // Per-axis change between samples, IMU and awake check alike
+};
+
+struct IdleModeStats {
+    uint32_t sleeps;        // Wake-on-motion entered
+    uint32_t motion_wakes;  // Woken by a WOM interrupt
+    uint32_t button_wakes;  // ... by the button (or serial)
+    uint32_t polls;         // INT_STATUS reads while asleep
+    uint32_t errors;        // I2C failures entering, polling or leaving
+    uint64_t asleep_ms;     // Total time asleep, finished sleeps only
+};
+
+class IdleMode {
+public:
+    explicit IdleMode(const IdleModeConfig& config = IdleModeConfig());
+
+    // Awake, activity now. filter is what the IMU returns to on wake
+    // (nullptr = reset defaults), it must outlive the IdleMode.
+    void Reset(uint32_t now_ms, const ImuFilterConfig* filter);
+
+    // Button press, serial command or recording: postpones sleep
+    void OnActivity(uint32_t now_ms);
+
+    // Awake raw sample (g, deg/s). Motion counts as activity, using the same
+    // per-axis test as the IMU while asleep (IsMovementDetected).
+    void OnSample(uint32_t now_ms, const float* raw_accel, const float* raw_gyro);
+
+    // Awake and idle for sleep_after_ms
+    bool ShouldSleep(uint32_t now_ms) const;
+
+    // Switches the IMU to wake-on-motion. False (and stays awake, retrying
+    // after sleep_after_ms) if the IMU did not take it.
+    bool Sleep(uint32_t now_ms);
+
+    // Asleep: call after every light sleep with the button/serial state.
+    // Reads INT_STATUS and the accel; on motion, button or an I2C error the
+    // IMU returns to full-rate sampling and this returns true (awake again).
+    bool Poll(uint32_t now_ms, bool button);
+
+    // To prime the filters on wake: accel of the last quiet poll (or of the
+    // last awake sample), gyro of the last awake sample (bias, gyro sleeps)
+    void RestSample(float* accel, float* gyro) const;
+
+    bool Asleep() const { return asleep_; }
+    const IdleModeConfig& config() const { return config_; }
+    const ImuWakeConfig& wake_config() const { return wake_config_; }
+    const IdleModeStats& stats() const { return stats_; }
+
+private:
+    void Wake(uint32_t now_ms);
+
+    IdleModeConfig config_;
+    ImuWakeConfig wake_config_;
+    const ImuFilterConfig* filter_;
+    bool asleep_;
+    uint32_t last_activity_ms_;
+    uint32_t sleep_start_ms_;
+    bool has_last_accel_;
+    float last_accel_[3];
+    float rest_accel_[3];
+    float rest_gyro_[3];
+    IdleModeStats stats_;
+};
+
+#endif  // IDLE_MODE_H_
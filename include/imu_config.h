@@ -0,0 +1,61 @@
+#ifndef IMU_CONFIG_H_
+#define IMU_CONFIG_H_
+
+#include <cstdint>
+
+// ICM-20600 output data rate and digital low-pass filter
+// With FCHOICE_B = 0 (gyro) and ACCEL_FCHOICE_B = 0 the sensor filters at a
+// 1 kHz internal rate and SMPLRT_DIV decimates that to 1 kHz / (1 + div).
+// With the ODR set to the model's sample rate and the DLPF below Nyquist,
+// every register read returns a sample that is already band-limited, so the
+// Preprocessor's median and 10 Hz accel lowpass are redundant
+// (Preprocessor::SetHardwareLowpass). The reset defaults
+// (DLPF_CFG 0, 250 Hz gyro / 218 Hz accel) alias everything above 20 Hz into
+// the 40 Hz stream.
+
+// Requested bandwidths. The median + 4th-order 10 Hz lowpass remove more of
+// the band above a few Hz than one 10 Hz DLPF stage, and the gyro median
+// smooths as much as a 10 Hz DLPF; these settings give the filtered samples
+// closest to the software chain on dataset_raw (host_replay --check-dlpf).
+// Pushup motion stays below 2 Hz.
+constexpr float IMU_ACCEL_DLPF_HZ = 5.0f;
+constexpr float IMU_GYRO_DLPF_HZ = 10.0f;
+
+struct ImuFilterConfig {
+    uint8_t smplrt_div;        // SMPLRT_DIV
+    uint8_t config;            // CONFIG: DLPF_CFG (gyro and temperature)
+    uint8_t accel_config2;     // ACCEL_CONFIG2: A_DLPF_CFG, ACCEL_FCHOICE_B = 0
+    float odr_hz;              // 1 kHz / (1 + smplrt_div)
+    float accel_bandwidth_hz;  // 3 dB bandwidth of the selected settings
+    float gyro_bandwidth_hz;
+};
+
+// Divider for sample_period_ms (clamped to 1-256 ms) and, per sensor, the
+// DLPF setting whose bandwidth is closest to the requested one
+ImuFilterConfig ImuFilterConfigFor(uint32_t sample_period_ms, float accel_bandwidth_hz,
+                                   float gyro_bandwidth_hz);
+
+// The configuration for the model: SAMPLE_PERIOD_MS and the bandwidths above
+ImuFilterConfig ModelImuFilterConfig();
+
+// Wake-on-motion (idle_mode.h)
+// In accel low-power (cycle) mode the sensor wakes for one accel sample every
+// 1 kHz / (1 + SMPLRT_DIV), compares it with the previous sample and sets the
+// WOM bits of INT_STATUS when an axis changed by more than its
+// ACCEL_WOM_x_THR. The gyro is in standby. One threshold LSB is 4 mg at any
+// full scale.
+constexpr float IMU_WOM_LSB_G = 0.004f;
+constexpr uint32_t IMU_GYRO_STARTUP_MS = 35;  // Gyro start-up from standby (datasheet)
+
+struct ImuWakeConfig {
+    uint8_t threshold_lsb;  // ACCEL_WOM_X/Y/Z_THR, all axes alike
+    uint8_t smplrt_div;     // SMPLRT_DIV in cycle mode
+    float threshold_g;      // threshold_lsb * IMU_WOM_LSB_G
+    float odr_hz;           // 1 kHz / (1 + smplrt_div)
+};
+
+// Threshold rounded to the 4 mg grid (1-255 LSB) and the divider for
+// sample_period_ms (clamped to 1-256 ms)
+ImuWakeConfig ImuWakeConfigFor(float threshold_g, uint32_t sample_period_ms);
+
+#endif  // IMU_CONFIG_H_
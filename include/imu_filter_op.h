@@ -0,0 +1,35 @@
+#ifndef IMU_FILTER_OP_H_
+#define IMU_FILTER_OP_H_
+
+#include "tensorflow/lite/c/common.h"
+
+// GAINS_IMU_FILTER custom TFLM operator
+// The Preprocessor chain (median 3, accel lowpass, gyro highpass, gravity
+// removal) plus normalization as the first op of the model graph, so the
+// filters run inside Invoke() and show up in the profiler like any other op.
+// Filter state persists between invokes: every sample is filtered once even
+// though consecutive windows overlap.
+//
+// Inputs:
+//   0: raw window, int16 [1, WINDOW, 6] = [ax, ay, az, gx, gy, gz], oldest
+//      first. Per-channel quantization on axis 2 (g and deg/s per LSB), zero
+//      point 0.
+//   1: new sample count, int32 [1]. Only the last n samples of the window are
+//      new since the previous invoke. n < 0 resets the filters and treats the
+//      whole window as new (start of a recording). n > WINDOW does the same:
+//      the older samples never reached the filters, so callers that go longer
+//      than WINDOW samples between inferences run this op alone
+//      (InvokeRange(0, 1)) to keep the filters fed.
+// Output:
+//   0: filtered, normalized window, int8 [1, WINDOW, 6] with the quantization
+//      of the original model input.
+// Custom options (flexbuffer map): "mean" and "std", 6 floats each.
+//
+// Models containing the op are emitted by add_imu_filter_op.py. Register it
+// with resolver.AddCustom(kImuFilterOpName, Register_GAINS_IMU_FILTER()).
+
+constexpr char kImuFilterOpName[] = "GAINS_IMU_FILTER";
+
+TfLiteRegistration* Register_GAINS_IMU_FILTER();
+
+#endif  // IMU_FILTER_OP_H_
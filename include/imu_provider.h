@@ -3,15 +3,27 @@
 
 #include <cstdint>
 #include "driver/i2c.h"
+#include "constants.h"
+#include "imu_config.h"
 
 // ICM-20600 Register Map
 namespace ICM20600_Regs {
+    constexpr uint8_t SMPLRT_DIV = 0x19;
+    constexpr uint8_t CONFIG = 0x1A;
     constexpr uint8_t PWR_MGMT_1 = 0x6B;
     constexpr uint8_t PWR_MGMT_2 = 0x6C;
     constexpr uint8_t ACCEL_CONFIG = 0x1C;
     constexpr uint8_t ACCEL_CONFIG2 = 0x1D;
     constexpr uint8_t GYRO_CONFIG = 0x1B;
     constexpr uint8_t WHO_AM_I = 0x75;
+
+    constexpr uint8_t ACCEL_WOM_X_THR = 0x20;
+    constexpr uint8_t ACCEL_WOM_Y_THR = 0x21;
+    constexpr uint8_t ACCEL_WOM_Z_THR = 0x22;
+    constexpr uint8_t INT_PIN_CFG = 0x37;
+    constexpr uint8_t INT_ENABLE = 0x38;
+    constexpr uint8_t INT_STATUS = 0x3A;
+    constexpr uint8_t ACCEL_INTEL_CTRL = 0x69;
     
     constexpr uint8_t ACCEL_XOUT_H = 0x3B;
     constexpr uint8_t ACCEL_XOUT_L = 0x3C;
@@ -31,13 +43,38 @@ namespace ICM20600_Regs {
 // Initialize the IMU
 bool SetupIMU();
 
+// Program the output data rate and DLPF (see imu_config.h). SetupIMU()
+// leaves them at their reset defaults.
+bool ConfigureImuFilter(const ImuFilterConfig& config);
+
+// Wake-on-motion (imu_config.h): gyro to standby, accel to low-power cycle
+// mode at config.odr_hz, WOM interrupts on all axes against the previous
+// sample. INT is latched high until INT_STATUS is read.
+bool EnterImuWakeOnMotion(const ImuWakeConfig& config);
+
+// Reads (and so clears) INT_STATUS; *motion is set if any WOM bit was set.
+// With accel_data the latest low-power accel sample (g) is read in the same
+// burst (ACCEL_XOUT_H follows INT_STATUS).
+bool ReadImuWakeStatus(bool* motion, float* accel_data = nullptr);
+
+// Back to both sensors in low-noise mode with the given filter, or the reset
+// defaults if filter is nullptr. Waits for the gyro to start.
+bool ExitImuWakeOnMotion(const ImuFilterConfig* filter);
+
 // Read accelerometer and gyroscope data
 // accel_data: pointer to array of 3 floats for x, y, z acceleration (in g's)
 // gyro_data: pointer to array of 3 floats for x, y, z gyroscope (in deg/s)
+// fresh: if given, INT_STATUS is read in the same burst and *fresh is set
+// when DATA_RDY shows a sample since the last such read (SetupIMU() enables
+// it); a read without one returns the previous sample again
 // Returns true if successful
-bool ReadIMU(float* accel_data, float* gyro_data);
+bool ReadIMU(float* accel_data, float* gyro_data, bool* fresh = nullptr);
 
 // Check if significant movement detected (for gesture start)
-bool IsMovementDetected(const float* accel_data);
+// Without a reference: |accel| deviates from 1 g by more than threshold_g.
+// With one: any axis changed by more than threshold_g, as the IMU's
+// wake-on-motion compares samples.
+bool IsMovementDetected(const float* accel_data, const float* reference = nullptr,
+                        float threshold_g = kAccelThreshold);
 
 #endif  // IMU_PROVIDER_H_
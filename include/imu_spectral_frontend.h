@@ -0,0 +1,72 @@
+#ifndef IMU_SPECTRAL_FRONTEND_H_
+#define IMU_SPECTRAL_FRONTEND_H_
+
+#include <cstdint>
+
+#include "model_config.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/fft.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/log_scale.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/window.h"
+
+// Streaming spectral IMU frontend
+// Short-time band energies of the preprocessed channels, built from the
+// fixed-point audio frontend in experimental/microfrontend/lib: Hann window ->
+// int16 real FFT -> triangular filterbank -> log. Every channel has its own
+// window state, so a frame is produced as soon as the step's last sample
+// arrives; nothing is recomputed for overlapping windows.
+//
+// At 40 Hz: 800 ms windows (32 samples, 1.25 Hz bins) every 200 ms. The
+// filterbank is mel spaced, which is linear at these frequencies.
+// Model input: the last SPECTRAL_NUM_FRAMES frames of 6 x SPECTRAL_NUM_BANDS
+// log amplitudes (1.4 s of motion, 144 values instead of the 50 x 6 window).
+
+constexpr int SPECTRAL_WINDOW_MS = 800;
+constexpr int SPECTRAL_STEP_MS = 200;
+constexpr int SPECTRAL_NUM_BANDS = 6;
+constexpr float SPECTRAL_LOWER_HZ = 0.5f;
+constexpr float SPECTRAL_UPPER_HZ = 12.0f;  // Accel is lowpassed at 10 Hz
+constexpr int SPECTRAL_NUM_FRAMES = 4;
+constexpr int SPECTRAL_FRAME_SIZE = NUM_CHANNELS * SPECTRAL_NUM_BANDS;
+constexpr int SPECTRAL_FEATURE_SIZE = SPECTRAL_NUM_FRAMES * SPECTRAL_FRAME_SIZE;
+
+class ImuSpectralFrontend {
+public:
+    ImuSpectralFrontend();
+    ~ImuSpectralFrontend();
+
+    // Allocate the window/FFT/filterbank state (heap, once at startup).
+    // Returns false if an allocation failed.
+    bool Init();
+
+    // Clear all windows and frames (start of a new recording)
+    void Reset();
+
+    // Add one preprocessed sample [ax, ay, az, gx, gy, gz] (g, deg/s).
+    // Returns true when it completed a new frame.
+    bool ProcessSample(const float* processed_sample);
+
+    // Frames produced since Reset(), the model input is valid once this
+    // reaches SPECTRAL_NUM_FRAMES
+    int FrameCount() const { return frame_count_; }
+
+    // Model input, oldest frame first: [frame][channel][band], natural log of
+    // the band amplitude (0 for silent bands)
+    void GetFeatures(float features[SPECTRAL_FEATURE_SIZE]) const;
+
+private:
+    struct ChannelState {
+        WindowState window;
+        FftState fft;
+        FilterbankState filterbank;
+    };
+
+    ChannelState channels_[NUM_CHANNELS];
+    LogScaleState log_scale_;
+    uint16_t frames_[SPECTRAL_NUM_FRAMES][SPECTRAL_FRAME_SIZE];  // Ring of log frames
+    int frame_head_;                                             // Next ring slot to write
+    int frame_count_;
+    bool initialized_;
+};
+
+#endif  // IMU_SPECTRAL_FRONTEND_H_
@@ -0,0 +1,75 @@
+#ifndef INFERENCE_SCHEDULER_H_
+#define INFERENCE_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "model_config.h"
+
+// Adaptive inference scheduling
+// Replaces the fixed 200 ms inference interval. Two signals drive the rate:
+// 1. Motion energy: EMA of the mean squared normalized sample. Fast movement
+//    (mid-rep) shortens the interval, a static device lengthens it.
+// 2. Prediction stability: when the last few predictions agree with high
+//    confidence the next result is very unlikely to change, so back off,
+//    doubling the interval with every further agreeing prediction.
+// Backing off leaves the last result up to max_interval_ms old, so a final
+// inference runs when the recording stops (ShouldInferFinal), unless the
+// predictions had settled.
+// Thresholds were tuned with host/replay on dataset_raw.
+struct InferenceSchedulerConfig {
+    uint32_t base_interval_ms = 200;     // Old fixed INFERENCE_INTERVAL_MS
+    uint32_t min_interval_ms = 175;      // Fastest rate, used while moving fast
+    uint32_t max_interval_ms = 400;      // Slowest rate, static or settled
+    float energy_alpha = 0.2f;           // EMA weight per sample (~5 samples = 125 ms)
+    float high_motion_energy = 3.0f;     // Normalized energy above this = fast motion
+    float low_motion_energy = 0.5f;      // Normalized energy below this = static
+    float stable_confidence = 0.85f;     // Min confidence for a "stable" prediction
+    int stable_count = 2;                // Agreeing predictions needed to back off
+};
+
+class InferenceScheduler {
+public:
+    explicit InferenceScheduler(const InferenceSchedulerConfig& config = InferenceSchedulerConfig());
+
+    // Forget motion/prediction history and counters (start of a recording)
+    void Reset(uint32_t now_ms);
+
+    // Update motion energy with one preprocessed sample [ax, ay, az, gx, gy, gz]
+    void OnSample(const float* processed_sample);
+
+    // Report the result of an inference
+    void OnPrediction(int best_class, float confidence);
+
+    // True if an inference should run now. Call once per loop iteration.
+    bool ShouldInfer(uint32_t now_ms);
+
+    // True if the last result is older than the base interval when the
+    // recording stops, i.e. a fixed-rate scheduler would have a fresher one,
+    // and the predictions have not settled.
+    bool ShouldInferFinal(uint32_t now_ms);
+
+    // Current interval/rate chosen from motion energy and stability
+    uint32_t CurrentIntervalMs() const { return interval_ms_; }
+    float CurrentRateHz() const { return 1000.0f / interval_ms_; }
+    float MotionEnergy() const { return motion_energy_; }
+    bool IsStable() const;
+
+    // Inferences run, and fixed-interval inferences that were skipped
+    uint32_t InvokeCount() const { return invoke_count_; }
+    uint32_t SkippedCount() const { return skipped_count_; }
+
+private:
+    void UpdateInterval();
+
+    InferenceSchedulerConfig config_;
+    float motion_energy_;
+    int last_class_;
+    int agree_count_;
+    uint32_t interval_ms_;
+    uint32_t last_invoke_ms_;
+    uint32_t last_base_slot_ms_;
+    uint32_t invoke_count_;
+    uint32_t skipped_count_;
+};
+
+#endif  // INFERENCE_SCHEDULER_H_
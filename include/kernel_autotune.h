@@ -0,0 +1,72 @@
+#ifndef KERNEL_AUTOTUNE_H_
+#define KERNEL_AUTOTUNE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Per-node kernel autotuner
+// CONV_2D, DEPTHWISE_CONV_2D and FULLY_CONNECTED can run the reference
+// kernel or one of several CMSIS-NN paths (tensorflow/lite/micro/kernels/
+// kernel_variant.h); by default CMSIS-NN picks one from the layer shape. The
+// tuner allocates the model once per variant, times every node of those ops
+// with InvokeRange() on the same pseudo-random inputs and hashes each node's
+// output. A variant counts for a node only if every output up to and
+// including that node hashes the same as with the reference kernels, so the
+// table never changes a result. The fastest such variant is kept per node;
+// a node only leaves its default variant for a gain above timer noise.
+//
+// The table is applied with tflite::SetKernelVariantTable() around
+// AllocateTensors(). Timings depend on the CPU, so tune where the model runs:
+// the firmware does it at boot with ENABLE_KERNEL_AUTOTUNE and prints the
+// table as a header (include/kernel_variants.h); host_autotune does the same
+// on the host.
+
+constexpr int KERNEL_AUTOTUNE_MAX_NODES = 32;    // Tuned nodes per model
+constexpr int KERNEL_AUTOTUNE_MAX_OPS = 128;     // Operators per model
+constexpr int KERNEL_AUTOTUNE_MAX_REPEAT = 16;
+
+struct KernelTuneNode {
+    uint16_t node_index;
+    uint8_t builtin_code;
+    uint8_t default_variant;   // What the kernel runs without a table
+    uint8_t best_variant;
+    // Total ticks over all repeats per variant, 0 where the node's shape does
+    // not support the variant; exact is false where the output differed.
+    uint32_t ticks[tflite::kKernelVariantCount];
+    bool exact[tflite::kKernelVariantCount];
+};
+
+struct KernelTuneReport {
+    int node_count;
+    int repeat;
+    uint32_t default_ticks;    // Tuned nodes, summed, without a table
+    uint32_t best_ticks;       // The same with the best variants
+    KernelTuneNode nodes[KERNEL_AUTOTUNE_MAX_NODES];
+};
+
+// Tunes every supported node of model. The arena is reused for one
+// interpreter after the other, so it needs the model's usual arena size; the
+// interpreters are gone when this returns. repeat (<= MAX_REPEAT) inputs are
+// timed per variant. Stateful models see the extra invokes.
+bool TuneKernelVariants(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+                        uint8_t* arena, size_t arena_size, int repeat,
+                        KernelTuneReport* report);
+
+// Table entries (best variant per tuned node); returns the entry count
+size_t KernelVariantTableFromReport(const KernelTuneReport& report,
+                                    tflite::KernelVariantEntry* entries, size_t max_entries);
+
+// Writes the table as a C++ header defining
+//   constexpr int <name>Operators = <operator count of the tuned model>;
+//   constexpr tflite::KernelVariantEntry <name>[] = {...};
+// followed by one comment line per node with its timings. Returns the
+// length snprintf would need (output is truncated to out_size).
+size_t FormatKernelVariantHeader(const KernelTuneReport& report, int operator_count,
+                                 const char* name, const char* tuned_on, char* out,
+                                 size_t out_size);
+
+#endif  // KERNEL_AUTOTUNE_H_
@@ -0,0 +1,23 @@
+#ifndef KERNEL_VARIANTS_H_
+#define KERNEL_VARIANTS_H_
+
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
+
+// Kernel variant per node of the fused pushup model, applied in setup()
+// when the operator count matches. Regenerate after retraining:
+//   host_autotune --out include/kernel_variants.h
+// or, for device timings, from the ENABLE_KERNEL_AUTOTUNE boot log.
+// Generated by the kernel autotuner (kernel_autotune.h), tuned on the host.
+// Tuned nodes: 4888 ticks with the default kernels, 4888 with this table
+// (16 inputs).
+constexpr int kPushupKernelVariantsOperators = 15;
+constexpr tflite::KernelVariantEntry kPushupKernelVariants[] = {
+    {1, 3, 2},  // CONV_2D, default cmsis_generic: reference 1097 cmsis_generic 430
+    {3, 3, 2},  // CONV_2D, default cmsis_generic: reference 5636 cmsis_generic 2604
+    {6, 4, 5},  // DEPTHWISE_CONV_2D, default cmsis_dw_opt: reference 341 cmsis_generic 243 cmsis_dw_opt 231
+    {8, 3, 2},  // CONV_2D, default cmsis_generic: reference 3350 cmsis_generic 1603
+    {12, 9, 2},  // FULLY_CONNECTED, default cmsis_generic: reference 28 cmsis_generic 17
+    {13, 9, 2},  // FULLY_CONNECTED, default cmsis_generic: reference 3 cmsis_generic 3
+};
+
+#endif  // KERNEL_VARIANTS_H_
@@ -0,0 +1,117 @@
+#ifndef LAYER_PIPELINE_H_
+#define LAYER_PIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+// Two-stage layer pipeline for streaming windows
+// The operator list of one model is cut in two: stage A runs operators
+// [0, split) on the caller's core, stage B runs [split, N) on a worker thread
+// (pinned to the other core on the ESP32-S3). Each stage has its own
+// interpreter of the same model, so window k+1 can be in stage A while
+// window k is in stage B; throughput approaches the slower stage.
+//
+// The tensors live across the cut (written before split and read after it,
+// including model inputs read late and outputs written early) are handed
+// from A to B through two slots in a caller-supplied buffer. The same slot
+// returns B's outputs to the caller, so Pop() always gets results in Push()
+// order. The result is identical to a sequential Invoke().
+//
+//   pipeline.Begin(model, &front, &back, split, slots, sizeof(slots));
+//   for each window:
+//       fill front.input(0); pipeline.Push();
+//       if (pipeline.Pending() == 2) pipeline.Pop(outputs);
+//   drain with Pop() while Pending() > 0
+//
+// Models with variable (state) tensors are rejected: their state would be
+// split between the interpreters. Stateful custom ops are fine, each op only
+// ever runs in one of them.
+
+constexpr int LAYER_PIPELINE_SLOTS = 2;
+constexpr int LAYER_PIPELINE_MAX_CUT = 8;      // Tensors crossing the cut
+constexpr int LAYER_PIPELINE_MAX_OUTPUTS = 4;
+
+class LayerPipeline {
+public:
+    LayerPipeline();
+    ~LayerPipeline();
+
+    // front and back are allocated interpreters of model. The slot buffer
+    // must hold SlotBufferBytes(model, split) bytes (16-byte aligned) and
+    // outlive the pipeline. Starts the stage B worker.
+    bool Begin(const tflite::Model* model, tflite::MicroInterpreter* front,
+               tflite::MicroInterpreter* back, size_t split, uint8_t* slot_buffer,
+               size_t slot_buffer_size);
+
+    // Stop the worker (after the windows in flight) and release the interpreters
+    void End();
+
+    // Run stage A on the window in front->input(). Blocks while both slots
+    // hold windows that were not popped yet.
+    bool Push();
+
+    // Wait for the oldest pushed window and copy the model outputs to
+    // outputs[i] (output(i)->bytes each, nullptr to skip one)
+    bool Pop(uint8_t* const* outputs);
+
+    int Pending();
+    size_t Split() const { return split_; }
+    int CutTensorCount() const { return cut_count_; }
+    size_t SlotBytes() const { return slot_bytes_; }
+
+    // Slot buffer bytes needed to cut the model before operator split, 0 if
+    // the cut is not supported (see above)
+    static size_t SlotBufferBytes(const tflite::Model* model, size_t split);
+
+    // Operator index that balances the two stages, from per-operator times
+    // measured with InvokeRange() over repeat invokes. This runs the model,
+    // so call it before streaming (stateful ops see the extra invokes).
+    // stage_us, if given, receives the measured time of both stages.
+    static size_t BalancedSplit(tflite::MicroInterpreter* interpreter, int repeat = 3,
+                                uint32_t* stage_us = nullptr);
+
+private:
+    enum SlotState { SLOT_FREE, SLOT_FILLED, SLOT_DONE, SLOT_FAILED };
+
+    struct CutTensor {
+        int index;      // Tensor index in the subgraph
+        size_t offset;  // Offset in a slot
+        size_t bytes;
+    };
+
+    // Tensors crossing the cut, output sizes and the slot bytes they need.
+    // False if the cut or the model is not supported.
+    static bool PlanSlot(const tflite::Model* model, size_t split, CutTensor* cut,
+                         int* cut_count, size_t* output_bytes, int* output_count,
+                         size_t* slot_bytes);
+
+    void WorkerLoop();
+    uint8_t* Slot(int slot) { return slot_buffer_ + slot * slot_bytes_; }
+
+    tflite::MicroInterpreter* front_;
+    tflite::MicroInterpreter* back_;
+    size_t split_;
+    CutTensor cut_[LAYER_PIPELINE_MAX_CUT];
+    int cut_count_;
+    size_t output_bytes_[LAYER_PIPELINE_MAX_OUTPUTS];
+    int output_count_;
+    uint8_t* slot_buffer_;
+    size_t slot_bytes_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    SlotState state_[LAYER_PIPELINE_SLOTS];
+    int next_push_;
+    int next_run_;
+    int next_pop_;
+    bool stop_;
+    std::thread worker_;
+};
+
+#endif  // LAYER_PIPELINE_H_
@@ -0,0 +1,81 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Runtime metrics registry
+// Counters and log2-bucketed latency histograms (microseconds) for the main
+// loop, so stalls that break the 40 Hz sampling assumption show up as a
+// distribution instead of the occasional "[TIMING WARNING]". Recording is a
+// few integer ops and never allocates. The 'm' serial command dumps the
+// registry and resets it.
+
+// Bucket b counts values in [2^(b-1), 2^b) us (bucket 0: 0 us), so the last
+// bucket starts at ~8.4 s
+constexpr int METRICS_HISTOGRAM_BUCKETS = 25;
+
+enum MetricHistogram {
+    METRIC_LOOP_PERIOD,      // loop() start to next loop() start
+    METRIC_IMU_READ,         // ReadIMU() I2C burst read
+    METRIC_PREPROCESS,       // Preprocessor::ProcessSample()
+    METRIC_INVOKE,           // Model compute per window (sum of its slices)
+    METRIC_INVOKE_SLICE,     // One interpreter->InvokeStep() call
+    METRIC_OLED_FLUSH,       // oled_display_update()
+    METRIC_SAMPLE_INTERVAL,  // Between successful IMU reads
+    NUM_METRIC_HISTOGRAMS
+};
+
+enum MetricCounter {
+    METRIC_SAMPLES,            // Samples pushed into the window
+    METRIC_IMU_READ_ERRORS,    // ReadIMU() failures
+    METRIC_DEADLINE_MISSES,    // Sample intervals over 1.5 SAMPLE_PERIOD_MS (late or missed)
+    METRIC_INFERENCES,         // Windows classified (model or first stage)
+    METRIC_EARLY_EXITS,        // ... decided by the cascade first stage
+    METRIC_SLOW_LOOPS,         // loop() iterations over 100 ms
+    NUM_METRIC_COUNTERS
+};
+
+struct LatencyHistogram {
+    uint32_t buckets[METRICS_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+
+    void Record(uint32_t us);
+    void Reset();
+
+    // Upper bound of the bucket holding the given percentile (0-100), 0 if empty
+    uint32_t PercentileUpperBoundUs(float percentile) const;
+};
+
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    void Record(MetricHistogram histogram, uint32_t us) { histograms_[histogram].Record(us); }
+    void Increment(MetricCounter counter, uint32_t n = 1) { counters_[counter] += n; }
+
+    const LatencyHistogram& Histogram(MetricHistogram histogram) const {
+        return histograms_[histogram];
+    }
+    uint32_t Counter(MetricCounter counter) const { return counters_[counter]; }
+
+    // Clear everything and start a new measurement window
+    void Reset(unsigned long now_ms);
+
+    // Write the registry as short text lines (one for the counters, one per
+    // non-empty histogram with p50/p90/p99 bucket bounds, max, mean and the
+    // non-empty buckets as "bucket:count"). emit is called once per line.
+    void Dump(unsigned long now_ms, void (*emit)(const char* line)) const;
+
+private:
+    LatencyHistogram histograms_[NUM_METRIC_HISTOGRAMS];
+    uint32_t counters_[NUM_METRIC_COUNTERS];
+    unsigned long window_start_ms_;
+};
+
+const char* MetricHistogramName(MetricHistogram histogram);
+const char* MetricCounterName(MetricCounter counter);
+
+#endif  // METRICS_H_
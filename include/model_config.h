@@ -0,0 +1,41 @@
+#ifndef MODEL_CONFIG_H_
+#define MODEL_CONFIG_H_
+
+// Pushup model configuration shared by the firmware and the host tools
+// (host/replay). Update these based on your trained model metadata.
+
+constexpr int WINDOW_SIZE = 50;         // Number of IMU samples per window (50 @ 40Hz = 1.25s)
+constexpr int NUM_CHANNELS = 6;         // ax, ay, az, gx, gy, gz
+constexpr int NUM_POSTURE_CLASSES = 4;  // 4 posture types
+constexpr int SAMPLE_PERIOD_MS = 25;    // 40 Hz, the rate the training data was recorded at
+
+// Posture labels - MUST match model output order!
+// From pushup_model_metadata.json: ["good-form", "hips-high", "hips-sagging", "partial-rom"]
+constexpr const char* posture_labels[NUM_POSTURE_CLASSES] = {
+    "good-form",    // Class 0
+    "hips-high",    // Class 1
+    "hips-sagging", // Class 2
+    "partial-rom"   // Class 3
+};
+
+// ===== NORMALIZATION PARAMETERS =====
+// Replace with values from pushup_model_metadata.json generated during training
+// These are computed from your training data: mean and std per channel
+constexpr float imu_mean[NUM_CHANNELS] = {
+    0.00042208f,
+    -0.00188804f,
+    -0.00668184f,
+    -0.73875794f,
+    1.9212489f,
+    -0.94398156f
+};
+constexpr float imu_std[NUM_CHANNELS] = {
+    0.09626791f,
+    0.04948182f,
+    0.20323046f,
+    7.33304658f,
+    27.609867f,
+    5.87350077f
+};
+
+#endif  // MODEL_CONFIG_H_
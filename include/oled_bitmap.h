@@ -0,0 +1,169 @@
+#ifndef OLED_BITMAP_H_
+#define OLED_BITMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "font8x8_basic.h"
+#include "oled_display.h"
+
+// Compile-time OLED rendering
+// Static screens are lists of text lines rendered into a full SSD1306 frame
+// (8 pages x 128 columns, bit n of a byte = row n of the page) by the
+// compiler, exactly as oled_display_text() would draw them at runtime. As
+// constexpr globals the frames live in flash (.rodata); a screen change is a
+// 1 KB copy (oled_display_bitmap()) plus the dynamic fields drawn on top.
+// C++11 constexpr: single-return functions, recursion instead of loops.
+//
+//   constexpr OledText kIdleTexts[] = {{0, 10, "GAINS"}, {0, 30, "Press to start"}};
+//   static_assert(OledTextsFit(kIdleTexts), "idle screen text does not fit");
+//   constexpr OledFrame kIdleScreen = OledPrerender(kIdleTexts);
+
+struct OledText {
+    uint8_t x;  // Pixels, any alignment
+    uint8_t y;
+    const char* text;  // One line, no '\n'
+};
+
+struct OledFrame {
+    uint8_t bytes[OLED_FRAMEBUFFER_SIZE];
+};
+
+// Glyph columns: bit dy of column dx is pixel (dx, dy) of the character
+struct OledFontColumns {
+    uint8_t columns[128][8];
+};
+
+namespace oled_bitmap_internal {
+
+template <size_t... I>
+struct Indices {};
+
+template <class A, class B>
+struct Concat;
+
+template <size_t... A, size_t... B>
+struct Concat<Indices<A...>, Indices<B...>> {
+    typedef Indices<A..., (sizeof...(A) + B)...> type;
+};
+
+// 0..N-1, split in halves to stay far below the template depth limit
+template <size_t N>
+struct MakeIndices {
+    typedef typename Concat<typename MakeIndices<N / 2>::type,
+                            typename MakeIndices<N - N / 2>::type>::type type;
+};
+
+template <>
+struct MakeIndices<0> {
+    typedef Indices<> type;
+};
+
+template <>
+struct MakeIndices<1> {
+    typedef Indices<0> type;
+};
+
+// Same substitution as the runtime draw_char()
+constexpr uint8_t GlyphIndex(char c) {
+    return static_cast<unsigned char>(c) > 127 ? '?' : static_cast<unsigned char>(c);
+}
+
+constexpr uint8_t GlyphColumnFrom(uint8_t glyph, int dx, int dy) {
+    return dy == 8 ? 0
+                   : static_cast<uint8_t>((((font8x8_basic[glyph][dy] >> dx) & 1) << dy) |
+                                          GlyphColumnFrom(glyph, dx, dy + 1));
+}
+
+constexpr int TextLength(const char* text) {
+    return *text == '\0' ? 0 : 1 + TextLength(text + 1);
+}
+
+constexpr bool HasNewline(const char* text) {
+    return *text == '\0' ? false : *text == '\n' || HasNewline(text + 1);
+}
+
+constexpr bool Covers(const OledText& t, int page, int column) {
+    return column >= t.x && column < t.x + 8 * TextLength(t.text) && t.y < 8 * page + 8 &&
+           t.y + 8 > 8 * page;
+}
+
+// Rows of the page the text line covers, and its pixels in them
+constexpr uint8_t RowMask(int shift) {
+    return static_cast<uint8_t>(shift >= 0 ? 0xFF << shift : 0xFF >> -shift);
+}
+
+constexpr uint8_t RowBits(uint8_t column, int shift) {
+    return static_cast<uint8_t>(shift >= 0 ? column << shift : column >> -shift);
+}
+
+constexpr uint8_t GlyphColumnAt(const OledText& t, int column) {
+    return GlyphColumnFrom(GlyphIndex(t.text[(column - t.x) / 8]), (column - t.x) % 8, 0);
+}
+
+// draw_char() sets and clears every pixel of the glyph cell, so a later line
+// overwrites an earlier one where they overlap
+constexpr uint8_t ApplyText(const OledText& t, int page, int column, uint8_t byte) {
+    return !Covers(t, page, column)
+               ? byte
+               : static_cast<uint8_t>((byte & ~RowMask(t.y - 8 * page)) |
+                                      RowBits(GlyphColumnAt(t, column), t.y - 8 * page));
+}
+
+constexpr uint8_t FrameByte(const OledText* texts, size_t count, size_t k, int page, int column,
+                            uint8_t byte) {
+    return k == count ? byte
+                      : FrameByte(texts, count, k + 1, page, column,
+                                  ApplyText(texts[k], page, column, byte));
+}
+
+template <size_t N, size_t... I>
+constexpr OledFrame Render(const OledText (&texts)[N], Indices<I...>) {
+    return OledFrame{{FrameByte(texts, N, 0, static_cast<int>(I / OLED_WIDTH),
+                                static_cast<int>(I % OLED_WIDTH), 0)...}};
+}
+
+template <size_t... I>
+constexpr OledFontColumns FontColumns(Indices<I...>) {
+    return OledFontColumns{{GlyphColumnFrom(static_cast<uint8_t>(I / 8), I % 8, 0)...}};
+}
+
+}  // namespace oled_bitmap_internal
+
+// Column dx (0-7) of character c
+constexpr uint8_t OledGlyphColumn(char c, int dx) {
+    return oled_bitmap_internal::GlyphColumnFrom(oled_bitmap_internal::GlyphIndex(c), dx, 0);
+}
+
+// font8x8_basic transposed to columns, for drawing a glyph a byte at a time
+constexpr OledFontColumns OledRenderFontColumns() {
+    return oled_bitmap_internal::FontColumns(
+        oled_bitmap_internal::MakeIndices<128 * 8>::type());
+}
+
+// True if the line is drawn unwrapped and unclipped: draw_text() wraps
+// before a character that would start at x >= 120
+constexpr bool OledTextFits(const OledText& t) {
+    return !oled_bitmap_internal::HasNewline(t.text) &&
+           t.x + 8 * oled_bitmap_internal::TextLength(t.text) < OLED_WIDTH &&
+           t.y + 8 <= OLED_HEIGHT;
+}
+
+constexpr bool OledTextsFitFrom(const OledText* texts, size_t count) {
+    return count == 0 || (OledTextFits(texts[0]) && OledTextsFitFrom(texts + 1, count - 1));
+}
+
+template <size_t N>
+constexpr bool OledTextsFit(const OledText (&texts)[N]) {
+    return OledTextsFitFrom(texts, N);
+}
+
+// The frame oled_display_clear() + oled_display_text() for each line in
+// order would leave in the framebuffer
+template <size_t N>
+constexpr OledFrame OledPrerender(const OledText (&texts)[N]) {
+    return oled_bitmap_internal::Render(
+        texts, typename oled_bitmap_internal::MakeIndices<OLED_FRAMEBUFFER_SIZE>::type());
+}
+
+#endif  // OLED_BITMAP_H_
@@ -16,6 +16,7 @@ extern "C" {
 #define OLED_WIDTH 128
 #define OLED_HEIGHT 64
 #define OLED_I2C_ADDR 0x3C
+#define OLED_FRAMEBUFFER_SIZE (OLED_WIDTH * (OLED_HEIGHT / 8))
 
 // Initialize the OLED display
 esp_err_t oled_display_init(void);
@@ -26,12 +27,22 @@ void oled_display_clear(void);
 // Display text at specified position
 void oled_display_text(uint8_t x, uint8_t y, const char* text);
 
+// Replace the framebuffer with a full frame (OLED_FRAMEBUFFER_SIZE bytes,
+// e.g. a screen prerendered at compile time, oled_bitmap.h)
+void oled_display_bitmap(const uint8_t* frame);
+
+// The framebuffer as the next oled_display_update() sends it
+const uint8_t* oled_display_framebuffer(void);
+
 // Display the recognized command
 void oled_display_command(const char* command, uint8_t score);
 
 // Update the display buffer
 esp_err_t oled_display_update(void);
 
+// Panel on/off (sleep mode, ~10 uA); the display RAM is kept while off
+esp_err_t oled_display_set_power(bool on);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,37 @@
+#ifndef OLED_SCREENS_H_
+#define OLED_SCREENS_H_
+
+#include <cstdint>
+
+// GAINS OLED screens
+// The fixed text of every screen is prerendered at compile time into a 1 KB
+// frame in flash (oled_bitmap.h); rendering a screen copies that frame into
+// the framebuffer and draws only the dynamic fields (counts, confidence,
+// label) into their known places. The result is the same framebuffer as the
+// old oled_display_clear() + oled_display_text() sequence (checked by
+// host_bench). Rendering does not flush: call oled_display_update() after.
+
+enum OledScreen {
+    OLED_SCREEN_BOOT,         // "GAINS" while setup() runs
+    OLED_SCREEN_IDLE,         // "Press to start"
+    OLED_SCREEN_IMU_ERROR,    // Fatal setup errors
+    OLED_SCREEN_MODEL_ERROR,
+    OLED_SCREEN_ARENA_ERROR,
+    NUM_OLED_SCREENS
+};
+
+// A screen without dynamic fields
+void RenderStaticScreen(OledScreen screen);
+
+// "Recording..." with the number of windows classified and reps counted so far
+void RenderRecordingScreen(int sample_count, int rep_count);
+
+// Voted posture label, its confidence (0-1), the number of windows and the
+// set's reps with their time under tension
+void RenderResultScreen(const char* label, float confidence, int sample_count, int rep_count,
+                        uint32_t tension_ms);
+
+// Fewer than 2 windows when the recording stopped
+void RenderInsufficientSamplesScreen(int sample_count);
+
+#endif  // OLED_SCREENS_H_
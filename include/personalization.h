@@ -0,0 +1,126 @@
+#ifndef PERSONALIZATION_H_
+#define PERSONALIZATION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "model_config.h"
+#include "tensorflow/lite/c/common.h"
+
+// On-device personalization
+// The posture model is trained once for everybody; adapting it to one user
+// used to mean retraining and reflashing. Instead the activations that feed
+// the last FULLY_CONNECTED layer (the embedding) are kept after every invoke
+// and the user labels a few of their own recordings:
+//   - each class keeps the sum and count of the user's embeddings, its mean
+//     is updated in fixed point (Q4 int16) when a recording is labelled,
+//     a few microseconds per rep instead of a training cycle.
+//   - a window is classified by the int32 squared distance of its int8
+//     embedding to every class mean (nearest class mean). The distances
+//     become probabilities with a softmax at temperature_sq, which are
+//     blended with the model's (PERSONAL_BLEND) or replace them
+//     (PERSONAL_REPLACE).
+//   - the head only applies once every class has min_class_samples
+//     embeddings; until then the model output passes through.
+// The sums go to flash as a PersonalStore, tagged with the embedding's
+// quantization so a store from another model is not applied.
+// host/replay --check-personalization measures it on held-out recordings.
+
+// Largest embedding the head supports (the posture model has 32)
+constexpr int PERSONAL_MAX_EMBEDDING = 64;
+
+enum PersonalMode {
+    PERSONAL_OFF,       // Model output only (embeddings are still collected)
+    PERSONAL_BLEND,     // blend_weight of the head, the rest from the model
+    PERSONAL_REPLACE,   // Head only
+};
+
+const char* PersonalModeName(PersonalMode mode);
+
+struct PersonalHeadConfig {
+    PersonalMode mode = PERSONAL_BLEND;
+    float blend_weight = 0.5f;       // Share of the head in PERSONAL_BLEND
+    float temperature_sq = 8.0f;     // Softmax temperature on the squared distance (real units)
+    int min_class_samples = 1;       // Embeddings per class before the head applies
+};
+
+// Flash image of the class sums (about 1 KB)
+struct PersonalStore {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t embedding_size;
+    float embedding_scale;           // Quantization of the embedding it was built on
+    int32_t embedding_zero_point;
+    uint32_t counts[NUM_POSTURE_CLASSES];
+    int32_t sums[NUM_POSTURE_CLASSES][PERSONAL_MAX_EMBEDDING];
+};
+
+// Rewrite a model so the embedding (the input of the FULLY_CONNECTED that
+// feeds the final SOFTMAX) is a second subgraph output; output(1) then holds
+// it after Invoke() or the last InvokeStep(). Outputs live until the end of
+// the graph, so the arena only grows by the embedding. Apply it after
+// FuseModel(). False if the model does not end in FULLY_CONNECTED -> SOFTMAX
+// (exposed stays empty).
+bool ExposeEmbedding(const unsigned char* model_data, std::vector<uint8_t>* exposed);
+
+class PersonalHead {
+public:
+    explicit PersonalHead(const PersonalHeadConfig& config = PersonalHeadConfig());
+
+    // Bind to the model's embedding output; false if it is not an int8
+    // vector of at most PERSONAL_MAX_EMBEDDING. Clears the store.
+    bool Init(const TfLiteTensor* embedding);
+    bool Initialized() const { return embedding_size_ > 0; }
+
+    // Forget every labelled embedding
+    void Clear();
+
+    // Keep the embedding of the last invoke for LabelPending()
+    void Collect(const TfLiteTensor* embedding);
+    void ClearPending();
+    int PendingCount() const { return pending_count_; }
+
+    // Add the collected embeddings to a class. Returns how many were added.
+    int LabelPending(int label);
+
+    // Add one embedding (int8, as in the tensor) to a class
+    void Add(int label, const int8_t* embedding);
+
+    // Every class has min_class_samples embeddings
+    bool Ready() const;
+    uint32_t ClassCount(int label) const { return counts_[label]; }
+
+    // Squared distance to every class mean, in Q4 units (x16 per value)
+    void Distances(const int8_t* embedding, int32_t distances[NUM_POSTURE_CLASSES]) const;
+
+    // Apply the head to the model probabilities of the same invoke. Returns
+    // false (probs untouched) when the mode is off or the head is not ready.
+    bool Apply(const TfLiteTensor* embedding, float probs[NUM_POSTURE_CLASSES], int& best,
+               float& confidence) const;
+
+    void SetMode(PersonalMode mode) { config_.mode = mode; }
+    PersonalMode Mode() const { return config_.mode; }
+    const PersonalHeadConfig& config() const { return config_; }
+
+    void Save(PersonalStore* store) const;
+    // False if the store is for another embedding (the head stays empty)
+    bool Load(const PersonalStore& store);
+
+private:
+    // Recompute the Q4 mean of one class from its sum
+    void UpdateMean(int label);
+
+    PersonalHeadConfig config_;
+    int embedding_size_;
+    float embedding_scale_;
+    int32_t embedding_zero_point_;
+
+    uint32_t counts_[NUM_POSTURE_CLASSES];
+    int32_t sums_[NUM_POSTURE_CLASSES][PERSONAL_MAX_EMBEDDING];    // Of (q - zero point)
+    int16_t means_q4_[NUM_POSTURE_CLASSES][PERSONAL_MAX_EMBEDDING];
+
+    int pending_count_;
+    int32_t pending_sum_[PERSONAL_MAX_EMBEDDING];
+};
+
+#endif  // PERSONALIZATION_H_
@@ -37,12 +37,25 @@ public:
     // Reset filter states
     void Reset();
 
+    // The IMU's DLPF already band-limits the samples (imu_config.h): skip the
+    // median and the accel 10 Hz lowpass (steps 1-2 of ProcessSample). The
+    // gyro highpass and the gravity removal still run.
+    void SetHardwareLowpass(bool enabled) { hardware_lowpass = enabled; }
+    bool HardwareLowpass() const { return hardware_lowpass; }
+
+    // Set every filter to the state it would have after seeing this sample
+    // forever, e.g. when sampling resumes after the IMU slept (idle_mode.h).
+    // Without it the stale state rings through the gravity filter for seconds.
+    void Prime(const float* raw_accel, const float* raw_gyro);
+
     // Process single IMU sample
     // Input: raw_accel[3], raw_gyro[3] in physical units (g, deg/s)
     // Output: processed_sample[6] = [ax, ay, az, gx, gy, gz] with gravity removed
     void ProcessSample(const float* raw_accel, const float* raw_gyro, float* processed_sample);
 
 private:
+    bool hardware_lowpass;
+
     // Median filter buffers (rolling window of size 3)
     float accel_median_buffer[ACCEL_CHANNELS][MEDIAN_KERNEL_SIZE];
     float gyro_median_buffer[GYRO_CHANNELS][MEDIAN_KERNEL_SIZE];
@@ -61,6 +74,8 @@ private:
     float ApplyMedianFilter(float* buffer, float new_value);
     float ApplyBiquad(BiquadState* state, float input, float b0, float b1, float b2, float a1, float a2);
     float ApplyButterworthFilter(ButterworthFilter* filter, float input);
+    float PrimeBiquad(BiquadState* state, float input, float b0, float b1, float b2, float a1, float a2);
+    float PrimeButterworthFilter(ButterworthFilter* filter, float input);
 
     // Initialize filter coefficients
     void InitAccelLowpass();
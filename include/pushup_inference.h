@@ -0,0 +1,50 @@
+#ifndef PUSHUP_INFERENCE_H_
+#define PUSHUP_INFERENCE_H_
+
+#include "model_config.h"
+#include "tensorflow/lite/c/common.h"
+
+// Model input/output helpers shared by main.cpp and the host replay tools, so
+// the host runs exactly the same normalization and quantization as the device.
+
+// Copy the last WINDOW_SIZE samples of a circular buffer (oldest first) and
+// normalize them with imu_mean/imu_std.
+// head: index the next sample will be written to
+void NormalizeWindow(const float (*buffer)[NUM_CHANNELS], int buffer_size, int head,
+                     float normalized_window[WINDOW_SIZE][NUM_CHANNELS]);
+
+// Same for a contiguous window of WINDOW_SIZE samples, oldest first, e.g.
+// WindowRing::Window(WINDOW_SIZE)
+void NormalizeWindow(const float* window, float normalized_window[WINDOW_SIZE][NUM_CHANNELS]);
+
+// Quantize n values: q = round(v / scale) + zero_point, clamped to int8
+void QuantizeValues(const float* values, int n, float scale, int zero_point, int8_t* out);
+
+// Quantize a normalized window into the int8 input tensor [1, WINDOW_SIZE, NUM_CHANNELS]
+void QuantizeWindow(const float normalized_window[WINDOW_SIZE][NUM_CHANNELS],
+                    TfLiteTensor* model_input);
+
+// Quantize one raw sample (g, deg/s) for a model that starts with the
+// GAINS_IMU_FILTER op, using the raw input's per-channel scales
+void QuantizeRawSample(const float* raw_accel, const float* raw_gyro,
+                       const TfLiteTensor* raw_input, int16_t raw_sample[NUM_CHANNELS]);
+
+// One stored inference of a recording (main.cpp keeps them for the final vote)
+struct InferenceResult {
+    float probabilities[NUM_POSTURE_CLASSES];  // All 4 class probabilities
+    float max_confidence;                       // Best class confidence
+    int best_class;                             // Best class index
+    unsigned long timestamp;                    // When inference ran
+};
+
+// Sum of the class probabilities of count results, each weighted by its
+// max_confidence. Returns the total weight.
+float WeightedVoteScores(const InferenceResult* results, int count,
+                         float weighted_scores[NUM_POSTURE_CLASSES]);
+
+// Dequantize the posture output into probabilities and pick the best class
+void DequantizePosture(const TfLiteTensor* posture_output,
+                       float posture_probs[NUM_POSTURE_CLASSES],
+                       int& best_posture, float& max_posture_prob);
+
+#endif  // PUSHUP_INFERENCE_H_
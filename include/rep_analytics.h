@@ -0,0 +1,107 @@
+#ifndef REP_ANALYTICS_H_
+#define REP_ANALYTICS_H_
+
+#include <cstdint>
+
+// Streaming rep analytics
+// Splits a recording into reps and measures each one from the preprocessed
+// samples, in O(1) time and fixed memory per sample (no sample history):
+//   - a rep starts when the smoothed gyro magnitude leaves rest and ends when
+//     it is back at rest for rest_samples (or at Finish()), but only once the
+//     pitch rate has turned against its first direction: a pause at the
+//     bottom does not split the rep.
+//   - height: linear accel along gravity integrated twice from the start of
+//     the rep. Its lowest point is the bottom of the rep: eccentric before,
+//     concentric after. The velocity should be back at zero at the end; what
+//     is left is taken as a constant accel bias and removed from the depth
+//     (the ROM proxy) once the rep is complete.
+//   - pitch: the pitch-rate gyro channel integrated over the rep; the peak
+//     angular excursion is its range (the trunk pivots about the feet).
+//     Movements with a small excursion are not counted as reps.
+// Times come from the sample count at SAMPLE_PERIOD_MS: loop() pushes each
+// IMU sample once (DATA_RDY), so they are off only by dropped samples.
+
+struct RepAnalyticsConfig {
+    int pitch_axis = 4;                // Preprocessed channel of the pitch rate (gy)
+    float activity_smoothing = 0.3f;   // EMA weight on the gyro magnitude
+    float start_rate_dps = 15.0f;      // Gyro magnitude that starts a rep
+    float rest_rate_dps = 7.0f;        // Below this the trunk is at rest
+    int rest_samples = 4;              // Rest run that ends a rep (100 ms)
+    float min_excursion_deg = 5.0f;    // Smaller movements are not reps
+    int min_rep_samples = 12;          // 300 ms
+    int max_rep_samples = 240;         // 6 s without coming to rest: dropped
+    float gravity_smoothing = 0.05f;   // EMA weight for the gravity direction
+};
+
+struct RepMetrics {
+    uint32_t duration_ms;
+    uint32_t eccentric_ms;     // Start to the bottom (lowering)
+    uint32_t concentric_ms;    // Bottom to the end (pressing up)
+    float excursion_deg;       // Range of the pitch over the rep
+    float depth_cm;            // Chest travel from the start to the bottom
+};
+
+// Totals since Reset()
+struct RepSetSummary {
+    int reps;
+    uint32_t tension_ms;       // Time under tension: sum of rep durations
+    uint32_t eccentric_ms;
+    uint32_t concentric_ms;
+    float excursion_sum_deg;
+    float depth_sum_cm;
+    RepMetrics last;
+};
+
+class RepAnalytics {
+public:
+    explicit RepAnalytics(const RepAnalyticsConfig& config = RepAnalyticsConfig());
+
+    // Start of a recording
+    void Reset();
+
+    // Add one sample: raw accel (g) and the preprocessed sample [ax..gz].
+    // Returns true when it completed a rep (its metrics are in Last()).
+    bool OnSample(const float* raw_accel, const float* processed_sample);
+
+    // End of the recording: a rep still in motion ends here. Returns true if
+    // that completed a rep.
+    bool Finish();
+
+    const RepSetSummary& Summary() const { return summary_; }
+    const RepMetrics& Last() const { return summary_.last; }
+    bool InRep() const { return in_rep_; }
+
+private:
+    // Clear the integrals; the next movement starts at this sample
+    void StartMotion();
+    // Close the rep ending at end_sample; false if it is not one
+    bool CompleteRep(int end_sample);
+
+    RepAnalyticsConfig config_;
+    RepSetSummary summary_;
+
+    int sample_count_;
+    float activity_;           // Smoothed gyro magnitude (deg/s)
+    float rate_;               // Smoothed pitch rate (deg/s)
+    float gravity_[3];         // Smoothed raw accel (g)
+    bool in_rep_;
+    int rest_run_;
+
+    // Current rep, or the movement before it passes start_rate_dps
+    int start_sample_;
+    float pitch_deg_;          // Integrated pitch since start_sample_
+    float pitch_min_deg_;
+    float pitch_max_deg_;
+    float velocity_;           // Vertical velocity (m/s) since start_sample_
+    float height_;             // Vertical position (m) since start_sample_
+    float bottom_height_;
+    int bottom_sample_;
+    int direction_;            // Pitch rate sign while lowering, 0 until known
+    bool returned_;            // Saw a lobe against direction_ (coming back up)
+
+    // Current run of the pitch rate in one direction and its pitch change
+    int lobe_sign_;
+    float lobe_pitch_deg_;
+};
+
+#endif  // REP_ANALYTICS_H_
@@ -0,0 +1,80 @@
+#ifndef WINDOW_RING_H_
+#define WINDOW_RING_H_
+
+#include <cstring>
+
+#include "hot_path.h"
+
+// Double-mapped sliding window ring
+// Every sample is written twice, at slot i and at slot i + N, so the last n
+// samples (n <= N) are always one contiguous, oldest-first slice of the
+// backing store: no modulo per element, and a window can go straight to
+// memcpy or a vectorized loop. Costs 2x the memory and one extra store per
+// sample.
+//
+// Layout is fixed at compile time:
+//   RING_AOS: [slot][channel], Window(n) returns n * C interleaved values
+//   RING_SOA: [channel][slot], Channel(c, n) returns n values of channel c
+enum RingLayout {
+    RING_AOS,
+    RING_SOA,
+};
+
+template <typename T, int N, int C, RingLayout L = RING_AOS>
+class WindowRing {
+public:
+    static constexpr int kCapacity = N;
+    static constexpr int kChannels = C;
+    static constexpr RingLayout kLayout = L;
+
+    WindowRing() { Reset(); }
+
+    // Drop all samples and zero the backing store
+    void Reset() {
+        memset(data_, 0, sizeof(data_));
+        head_ = 0;
+        count_ = 0;
+    }
+
+    // Append one sample of C values; inlined into the per-sample path
+    GAINS_HOT_INLINE void Push(const T* sample) {
+        if (L == RING_AOS) {
+            memcpy(&data_[head_ * C], sample, C * sizeof(T));
+            memcpy(&data_[(head_ + N) * C], sample, C * sizeof(T));
+        } else {
+            for (int c = 0; c < C; c++) {
+                data_[c * 2 * N + head_] = sample[c];
+                data_[c * 2 * N + head_ + N] = sample[c];
+            }
+        }
+        head_ = head_ + 1 == N ? 0 : head_ + 1;
+        if (count_ < N) count_++;
+    }
+
+    // Samples held, saturates at N
+    int Count() const { return count_; }
+    bool Full() const { return count_ == N; }
+
+    // Slot the next sample goes to (same as the old modulo buffer_index)
+    int Head() const { return head_; }
+
+    // Last n samples (n <= N), oldest first, as n * C interleaved values.
+    // Slots never written read as zero.
+    const T* Window(int n) const {
+        static_assert(L == RING_AOS, "Window() needs RING_AOS, use Channel()");
+        return &data_[(head_ + N - n) * C];
+    }
+
+    // Last n values (n <= N) of one channel, oldest first
+    const T* Channel(int c, int n) const {
+        static_assert(L == RING_SOA, "Channel() needs RING_SOA, use Window()");
+        return &data_[c * 2 * N + head_ + N - n];
+    }
+
+private:
+    T data_[2 * N * C];
+    int head_;
+    int count_;
+};
+
+#endif  // WINDOW_RING_H_
@@ -110,11 +110,15 @@ TfLiteStatus Relu6Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace
 
 TfLiteRegistration Register_RELU() {
-  return tflite::micro::RegisterOp(ReluInit, ReluPrepare, ReluEval);
+  return tflite::micro::RegisterOp(ReluInit, ReluPrepare, ReluEval,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 TfLiteRegistration Register_RELU6() {
-  return tflite::micro::RegisterOp(Relu6Init, Relu6Prepare, Relu6Eval);
+  return tflite::micro::RegisterOp(Relu6Init, Relu6Prepare, Relu6Eval,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 }  // namespace tflite
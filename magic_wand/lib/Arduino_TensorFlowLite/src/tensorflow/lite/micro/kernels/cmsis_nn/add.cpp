@@ -357,15 +357,24 @@ TfLiteStatus EvalAddInt16(TfLiteContext* context, TfLiteNode* node) {
 }
 
 TfLiteRegistration Register_ADD() {
-  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAdd);
+  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAdd,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 TfLiteRegistration Register_ADD_INT8() {
-  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAddInt8);
+  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAddInt8,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 TfLiteRegistration Register_ADD_INT16() {
-  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAddInt16);
+  return tflite::micro::RegisterOp(InitAdd, PrepareAdd, EvalAddInt16,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 }  // namespace tflite
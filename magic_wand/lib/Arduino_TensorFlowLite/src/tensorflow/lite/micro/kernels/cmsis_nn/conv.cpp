@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
 #include "tensorflow/lite/micro/micro_log.h"
 
 namespace tflite {
@@ -37,8 +38,44 @@ struct OpData {
 
   // Index to buffer for optimizations if applicable.
   int buffer_idx;
+
+  // int8 kernel selected in Prepare (never kKernelVariantDefault).
+  KernelVariant variant;
 };
 
+// The kernel arm_convolve_wrapper_s8 dispatches to, or the requested variant
+// if this node's shape supports it.
+KernelVariant SelectConvVariant(KernelVariant requested,
+                                const cmsis_nn_conv_params& conv_params,
+                                const cmsis_nn_dims& input_dims,
+                                const cmsis_nn_dims& filter_dims,
+                                const cmsis_nn_dims& output_dims) {
+  const bool is_1x1 = conv_params.padding.w == 0 &&
+                      conv_params.padding.h == 0 &&
+                      conv_params.stride.w == 1 && conv_params.stride.h == 1 &&
+                      filter_dims.w == 1 && filter_dims.h == 1 &&
+                      conv_params.dilation.w == 1 &&
+                      conv_params.dilation.h == 1;
+  const bool is_1xn = input_dims.h == 1 && output_dims.w % 4 == 0 &&
+                      conv_params.dilation.w == 1 && filter_dims.h == 1;
+  switch (requested) {
+    case kKernelVariantReference:
+    case kKernelVariantCmsisGeneric:
+      return requested;
+    case kKernelVariantCmsisConv1x1Fast:
+      if (is_1x1) return requested;
+      break;
+    case kKernelVariantCmsisConv1xN:
+      if (is_1xn) return requested;
+      break;
+    default:
+      break;
+  }
+  if (is_1x1) return kKernelVariantCmsisConv1x1Fast;
+  if (is_1xn) return kKernelVariantCmsisConv1xN;
+  return kKernelVariantCmsisGeneric;
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context, sizeof(OpData));
@@ -128,8 +165,25 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     conv_params.activation.max = data->reference_op_data.output_activation_max;
 
     if (input->type == kTfLiteInt8) {
-      buf_size = arm_convolve_wrapper_s8_get_buffer_size(
-          &conv_params, &input_dims, &filter_dims, &output_dims);
+      data->variant = SelectConvVariant(
+          RequestedKernelVariant(context, node, kTfLiteBuiltinConv2d),
+          conv_params, input_dims, filter_dims, output_dims);
+      ReportKernelVariant(context, node, data->variant);
+      switch (data->variant) {
+        case kKernelVariantCmsisConv1x1Fast:
+          buf_size = arm_convolve_1x1_s8_fast_get_buffer_size(&input_dims);
+          break;
+        case kKernelVariantCmsisConv1xN:
+          buf_size =
+              arm_convolve_1_x_n_s8_get_buffer_size(&input_dims, &filter_dims);
+          break;
+        case kKernelVariantCmsisGeneric:
+          buf_size = arm_convolve_s8_get_buffer_size(&input_dims, &filter_dims);
+          break;
+        default:
+          buf_size = 0;
+          break;
+      }
     } else if (input->type == kTfLiteInt16) {
       TF_LITE_ENSURE_EQ(context, input->params.zero_point, 0);
       TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
@@ -238,16 +292,44 @@ TfLiteStatus EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
     // arm_convolve_wrapper_s8_get_buffer_size
   }
 
-  // arm_convolve_wrapper_s8 dispatches the optimized kernel accordingly with
-  // the parameters passed
-  TFLITE_DCHECK_EQ(
-      arm_convolve_wrapper_s8(
-          &ctx, &conv_params, &quant_params, &input_dims,
-          tflite::micro::GetTensorData<int8_t>(input), &filter_dims,
-          tflite::micro::GetTensorData<int8_t>(filter), &bias_dims,
-          tflite::micro::GetOptionalTensorData<int32_t>(bias), &output_dims,
-          tflite::micro::GetTensorData<int8_t>(output)),
-      ARM_CMSIS_NN_SUCCESS);
+  // Prepare picked the kernel arm_convolve_wrapper_s8 would dispatch to,
+  // unless a kernel variant table asked for another one
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data =
+      tflite::micro::GetOptionalTensorData<int32_t>(bias);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  arm_cmsis_nn_status status = ARM_CMSIS_NN_SUCCESS;
+  switch (data.variant) {
+    case kKernelVariantReference:
+      reference_integer_ops::ConvPerChannel(
+          ConvParamsQuantized(params, data.reference_op_data),
+          data.reference_op_data.per_channel_output_multiplier,
+          data.reference_op_data.per_channel_output_shift, input_shape,
+          input_data, filter_shape, filter_data, bias_shape, bias_data,
+          output_shape, output_data);
+      break;
+    case kKernelVariantCmsisConv1x1Fast:
+      status = arm_convolve_1x1_s8_fast(
+          &ctx, &conv_params, &quant_params, &input_dims, input_data,
+          &filter_dims, filter_data, &bias_dims, bias_data, &output_dims,
+          output_data);
+      break;
+    case kKernelVariantCmsisConv1xN:
+      status = arm_convolve_1_x_n_s8(&ctx, &conv_params, &quant_params,
+                                     &input_dims, input_data, &filter_dims,
+                                     filter_data, &bias_dims, bias_data,
+                                     &output_dims, output_data);
+      break;
+    default:
+      status = arm_convolve_s8(&ctx, &conv_params, &quant_params, &input_dims,
+                               input_data, &filter_dims, filter_data,
+                               &bias_dims, bias_data, &output_dims,
+                               output_data);
+      break;
+  }
+  TFLITE_DCHECK_EQ(status, ARM_CMSIS_NN_SUCCESS);
+  (void)status;
 
   return kTfLiteOk;
 }
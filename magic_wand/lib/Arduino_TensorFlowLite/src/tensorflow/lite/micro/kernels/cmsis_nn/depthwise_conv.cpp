@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/conv.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
 #include "tensorflow/lite/micro/micro_log.h"
 
 namespace tflite {
@@ -37,8 +38,44 @@ struct OpData {
 
   // Index to buffer for optimizations if applicable.
   int buffer_idx;
+
+  // int8 kernel selected in Prepare (never kKernelVariantDefault).
+  KernelVariant variant;
 };
 
+// The kernel arm_depthwise_conv_wrapper_s8 dispatches to, or the requested
+// variant if this node's shape supports it.
+KernelVariant SelectDepthwiseConvVariant(
+    KernelVariant requested, const cmsis_nn_dw_conv_params& dw_conv_params,
+    const cmsis_nn_dims& input_dims, const cmsis_nn_dims& filter_dims) {
+  const bool is_opt = dw_conv_params.ch_mult == 1 && input_dims.n == 1 &&
+                      dw_conv_params.dilation.w == 1 &&
+                      dw_conv_params.dilation.h == 1;
+#if !defined(ARM_MATH_MVEI)
+  const bool is_3x3 = is_opt && filter_dims.w == 3 && filter_dims.h == 3 &&
+                      dw_conv_params.padding.h <= 1 &&
+                      dw_conv_params.padding.w <= 1;
+#else
+  const bool is_3x3 = false;
+#endif
+  switch (requested) {
+    case kKernelVariantReference:
+    case kKernelVariantCmsisGeneric:
+      return requested;
+    case kKernelVariantCmsisDepthwiseOpt:
+      if (is_opt) return requested;
+      break;
+    case kKernelVariantCmsisDepthwise3x3:
+      if (is_3x3) return requested;
+      break;
+    default:
+      break;
+  }
+  if (is_3x3) return kKernelVariantCmsisDepthwise3x3;
+  if (is_opt) return kKernelVariantCmsisDepthwiseOpt;
+  return kKernelVariantCmsisGeneric;
+}
+
 // Always inline for optimal code size.
 void PopulateDwConvParams(
     cmsis_nn_dw_conv_params* const dw_conv_params,
@@ -140,12 +177,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
     TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
 
-    const int batch_size = MatchingDim(input_shape, 0, output_shape, 0);
+    // The opt and 3x3 variants only take batch 1, so Eval runs them once per
+    // batch; the kernel is picked for a single batch.
+    TFLITE_DCHECK_EQ(input_shape.Dims(0), output_shape.Dims(0));
     const int output_depth = MatchingDim(output_shape, 3, filter_shape, 3);
-    TFLITE_DCHECK_EQ(batch_size, 1); /* Only batch = 1 is supported */
 
     cmsis_nn_dims input_dims;
-    input_dims.n = batch_size;
+    input_dims.n = 1;
     input_dims.h = input_height;
     input_dims.w = input_width;
     input_dims.c = input_shape.Dims(3);
@@ -156,20 +194,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     filter_dims.w = filter_width;
     filter_dims.c = output_depth;
 
-    cmsis_nn_dims output_dims;
-    output_dims.n = batch_size;
-    output_dims.h = output_height;
-    output_dims.w = output_width;
-    output_dims.c = output_depth;
-
     cmsis_nn_dw_conv_params dw_conv_params;
     dw_conv_params.padding.h = data->reference_op_data.padding.height;
     dw_conv_params.padding.w = data->reference_op_data.padding.width;
     dw_conv_params.dilation.h = params.dilation_height_factor;
     dw_conv_params.dilation.w = params.dilation_width_factor;
-
-    const int32_t buf_size = arm_depthwise_conv_wrapper_s8_get_buffer_size(
-        &dw_conv_params, &input_dims, &filter_dims, &output_dims);
+    dw_conv_params.ch_mult = params.depth_multiplier;
+
+    data->variant = SelectDepthwiseConvVariant(
+        RequestedKernelVariant(context, node, kTfLiteBuiltinDepthwiseConv2d),
+        dw_conv_params, input_dims, filter_dims);
+    ReportKernelVariant(context, node, data->variant);
+    const int32_t buf_size =
+        data->variant == kKernelVariantCmsisDepthwiseOpt
+            ? arm_depthwise_conv_s8_opt_get_buffer_size(&input_dims,
+                                                        &filter_dims)
+            : 0;
 
     if (buf_size > 0) {
       TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
@@ -275,14 +315,67 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
     ctx.buf = context->GetScratchBuffer(context, data.buffer_idx);
   }
 
-  TFLITE_DCHECK_EQ(
-      arm_depthwise_conv_wrapper_s8(
-          &ctx, &dw_conv_params, &quant_params, &input_dims,
-          tflite::micro::GetTensorData<int8_t>(input), &filter_dims,
-          tflite::micro::GetTensorData<int8_t>(filter), &bias_dims,
-          tflite::micro::GetOptionalTensorData<int32_t>(bias), &output_dims,
-          tflite::micro::GetTensorData<int8_t>(output)),
-      ARM_CMSIS_NN_SUCCESS);
+  // Prepare picked the kernel arm_depthwise_conv_wrapper_s8 would dispatch
+  // to, unless a kernel variant table asked for another one
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data =
+      tflite::micro::GetOptionalTensorData<int32_t>(bias);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  arm_cmsis_nn_status status = ARM_CMSIS_NN_SUCCESS;
+
+  // Batch-1 kernels: one call per batch
+  if (data.variant == kKernelVariantCmsisDepthwiseOpt ||
+      data.variant == kKernelVariantCmsisDepthwise3x3) {
+    const int batches = input_dims.n;
+    const int input_batch_size = input_dims.h * input_dims.w * input_dims.c;
+    const int output_batch_size =
+        output_dims.h * output_dims.w * output_dims.c;
+    input_dims.n = 1;
+    output_dims.n = 1;
+    for (int b = 0; b < batches && status == ARM_CMSIS_NN_SUCCESS; b++) {
+      const int8_t* batch_input = input_data + b * input_batch_size;
+      int8_t* batch_output = output_data + b * output_batch_size;
+#if !defined(ARM_MATH_MVEI)
+      if (data.variant == kKernelVariantCmsisDepthwise3x3) {
+        status = arm_depthwise_conv_3x3_s8(
+            &ctx, &dw_conv_params, &quant_params, &input_dims, batch_input,
+            &filter_dims, filter_data, &bias_dims, bias_data, &output_dims,
+            batch_output);
+      } else
+#endif
+      {
+        status = arm_depthwise_conv_s8_opt(
+            &ctx, &dw_conv_params, &quant_params, &input_dims, batch_input,
+            &filter_dims, filter_data, &bias_dims, bias_data, &output_dims,
+            batch_output);
+      }
+    }
+    TFLITE_DCHECK_EQ(status, ARM_CMSIS_NN_SUCCESS);
+    (void)status;
+    return;
+  }
+
+  switch (data.variant) {
+    case kKernelVariantReference:
+      reference_integer_ops::DepthwiseConvPerChannel(
+          DepthwiseConvParamsQuantized(params, data.reference_op_data),
+          data.reference_op_data.per_channel_output_multiplier,
+          data.reference_op_data.per_channel_output_shift,
+          tflite::micro::GetTensorShape(input), input_data,
+          tflite::micro::GetTensorShape(filter), filter_data,
+          tflite::micro::GetTensorShape(bias), bias_data,
+          tflite::micro::GetTensorShape(output), output_data);
+      break;
+    default:
+      status = arm_depthwise_conv_s8(&ctx, &dw_conv_params, &quant_params,
+                                     &input_dims, input_data, &filter_dims,
+                                     filter_data, &bias_dims, bias_data,
+                                     &output_dims, output_data);
+      break;
+  }
+  TFLITE_DCHECK_EQ(status, ARM_CMSIS_NN_SUCCESS);
+  (void)status;
 }
 
 void EvalQuantizedPerChannel16x8(TfLiteContext* context, TfLiteNode* node,
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
 #include "tensorflow/lite/micro/micro_log.h"
 
 namespace tflite {
@@ -45,6 +46,9 @@ struct OpData {
   int32_t batches;
   int32_t accum_depth;
   int32_t output_depth;
+
+  // int8 kernel selected in Prepare (never kKernelVariantDefault).
+  KernelVariant variant;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -107,7 +111,21 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TFLITE_DCHECK_GE(output_dim_count, 2);
     TFLITE_DCHECK_LE(output_dim_count, 4);
 
-    if (output_dim_count > 2 && data->accum_depth % 4 == 0) {
+    // Batched inputs with a depth multiple of 4 run as a 1x1 convolution
+    // unless a kernel variant table asks for another kernel.
+    const bool is_1x1 = output_dim_count > 2 && data->accum_depth % 4 == 0;
+    const KernelVariant requested =
+        RequestedKernelVariant(context, node, kTfLiteBuiltinFullyConnected);
+    if (requested == kKernelVariantReference ||
+        requested == kKernelVariantCmsisGeneric) {
+      data->variant = requested;
+    } else {
+      data->variant =
+          is_1x1 ? kKernelVariantCmsisConv1x1Fast : kKernelVariantCmsisGeneric;
+    }
+    ReportKernelVariant(context, node, data->variant);
+
+    if (data->variant == kKernelVariantCmsisConv1x1Fast) {
       data->per_channel_output_multiplier =
           static_cast<int32_t*>(context->AllocatePersistentBuffer(
               context, data->output_depth * sizeof(int32_t)));
@@ -122,7 +140,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       input_dims.c = data->accum_depth;
 
       buf_size = arm_convolve_1x1_s8_fast_get_buffer_size(&input_dims);
-    } else {
+    } else if (data->variant == kKernelVariantCmsisGeneric) {
       buf_size = arm_fully_connected_s8_get_buffer_size(&filter_dims);
     }
   }
@@ -212,7 +230,16 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
   const int32_t* bias_data =
       tflite::micro::GetOptionalTensorData<int32_t>(bias);
 
-  if (output_dim_count > 2 && data.accum_depth % 4 == 0) {
+  if (data.variant == kKernelVariantReference) {
+    reference_integer_ops::FullyConnected(
+        FullyConnectedParamsQuantized(data.reference_op_data),
+        tflite::micro::GetTensorShape(input),
+        tflite::micro::GetTensorData<int8_t>(input),
+        tflite::micro::GetTensorShape(filter),
+        tflite::micro::GetTensorData<int8_t>(filter),
+        tflite::micro::GetTensorShape(bias), bias_data, output_shape,
+        tflite::micro::GetTensorData<int8_t>(output));
+  } else if (data.variant == kKernelVariantCmsisConv1x1Fast) {
     cmsis_nn_conv_params conv_params;
     conv_params.dilation.h = 1;
     conv_params.dilation.w = 1;
@@ -170,15 +170,24 @@ TfLiteStatus EvalInt16(TfLiteContext* context, TfLiteNode* node) {
 }
 
 TfLiteRegistration Register_MUL() {
-  return tflite::micro::RegisterOp(MulInit, MulPrepare, Eval);
+  return tflite::micro::RegisterOp(MulInit, MulPrepare, Eval,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 TfLiteRegistration Register_MUL_INT8() {
-  return tflite::micro::RegisterOp(MulInit, MulPrepare, EvalInt8);
+  return tflite::micro::RegisterOp(MulInit, MulPrepare, EvalInt8,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 TfLiteRegistration Register_MUL_INT16() {
-  return tflite::micro::RegisterOp(MulInit, MulPrepare, EvalInt16);
+  return tflite::micro::RegisterOp(MulInit, MulPrepare, EvalInt16,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared |
+                                       kTfLiteInplaceOpInput1Shared);
 }
 
 }  // namespace tflite
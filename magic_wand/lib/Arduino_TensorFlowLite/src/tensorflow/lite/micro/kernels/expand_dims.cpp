@@ -143,7 +143,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace
 
 TfLiteRegistration Register_EXPAND_DIMS() {
-  return tflite::micro::RegisterOp(nullptr, Prepare, Eval);
+  return tflite::micro::RegisterOp(nullptr, Prepare, Eval, /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 }  // namespace tflite
@@ -42,7 +42,8 @@ TfLiteRegistration RegisterOp(
     void* (*init)(TfLiteContext* context, const char* buffer, size_t length),
     TfLiteStatus (*prepare)(TfLiteContext* context, TfLiteNode* node),
     TfLiteStatus (*invoke)(TfLiteContext* context, TfLiteNode* node),
-    void (*free)(TfLiteContext* context, void* buffer)) {
+    void (*free)(TfLiteContext* context, void* buffer),
+    uint64_t inplace_operator) {
   return {/*init=*/init,
           /*free=*/free,
           /*prepare=*/prepare,
@@ -51,7 +52,8 @@ TfLiteRegistration RegisterOp(
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
           /*version=*/0,
-          /*registration_external=*/nullptr};
+          /*registration_external=*/nullptr,
+          /*inplace_operator=*/inplace_operator};
 }
 
 // Returns a mutable tensor for a given input index. is_variable must be checked
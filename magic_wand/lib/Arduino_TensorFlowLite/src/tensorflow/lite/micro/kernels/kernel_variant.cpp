@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/kernel_variant.h"
+
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/micro/micro_graph.h"
+
+namespace tflite {
+
+namespace {
+
+const KernelVariantTable* kernel_variant_table = nullptr;
+
+// Index of the node in subgraph 0, -1 for nodes of other subgraphs.
+int NodeIndex(TfLiteContext* context, const TfLiteNode* node) {
+  MicroGraph& graph = GetMicroContext(context)->graph();
+  if (graph.GetCurrentSubgraphIndex() != 0) {
+    return -1;
+  }
+  // The TfLiteNode is the first member of NodeAndRegistration.
+  const NodeAndRegistration* first =
+      graph.GetAllocations()[0].node_and_registrations;
+  const ptrdiff_t offset = reinterpret_cast<const char*>(node) -
+                           reinterpret_cast<const char*>(first);
+  if (offset < 0 || offset % sizeof(NodeAndRegistration) != 0) {
+    return -1;
+  }
+  return static_cast<int>(offset / sizeof(NodeAndRegistration));
+}
+
+}  // namespace
+
+const char* KernelVariantName(KernelVariant variant) {
+  switch (variant) {
+    case kKernelVariantDefault:
+      return "default";
+    case kKernelVariantReference:
+      return "reference";
+    case kKernelVariantCmsisGeneric:
+      return "cmsis_generic";
+    case kKernelVariantCmsisConv1x1Fast:
+      return "cmsis_1x1_fast";
+    case kKernelVariantCmsisConv1xN:
+      return "cmsis_1xn";
+    case kKernelVariantCmsisDepthwiseOpt:
+      return "cmsis_dw_opt";
+    case kKernelVariantCmsisDepthwise3x3:
+      return "cmsis_dw_3x3";
+    default:
+      return "unknown";
+  }
+}
+
+void SetKernelVariantTable(const KernelVariantTable* table) {
+  kernel_variant_table = table;
+}
+
+KernelVariant RequestedKernelVariant(TfLiteContext* context,
+                                     const TfLiteNode* node,
+                                     int32_t builtin_code) {
+  if (kernel_variant_table == nullptr) {
+    return kKernelVariantDefault;
+  }
+  const int node_index = NodeIndex(context, node);
+  for (size_t i = 0; i < kernel_variant_table->count; ++i) {
+    const KernelVariantEntry& entry = kernel_variant_table->entries[i];
+    if (entry.node_index == node_index && entry.builtin_code == builtin_code &&
+        entry.variant < kKernelVariantCount) {
+      return static_cast<KernelVariant>(entry.variant);
+    }
+  }
+  return kKernelVariantDefault;
+}
+
+void ReportKernelVariant(TfLiteContext* context, const TfLiteNode* node,
+                         KernelVariant variant) {
+  if (kernel_variant_table == nullptr ||
+      kernel_variant_table->selected == nullptr) {
+    return;
+  }
+  const int node_index = NodeIndex(context, node);
+  if (node_index >= 0 &&
+      static_cast<size_t>(node_index) < kernel_variant_table->selected_count) {
+    kernel_variant_table->selected[node_index] = variant;
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANT_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Implementations a kernel can run for one node. kKernelVariantDefault is the
+// kernel's own choice (for the CMSIS-NN kernels, the dispatch in the
+// arm_*_wrapper_s8 functions). A kernel that does not support a requested
+// variant for a node's shape falls back to the default.
+enum KernelVariant : uint8_t {
+  kKernelVariantDefault = 0,
+  // kernels/internal/reference(/integer_ops)
+  kKernelVariantReference = 1,
+  // arm_convolve_s8, arm_depthwise_conv_s8, arm_fully_connected_s8
+  kKernelVariantCmsisGeneric = 2,
+  // arm_convolve_1x1_s8_fast: 1x1 filter, stride 1, no padding
+  kKernelVariantCmsisConv1x1Fast = 3,
+  // arm_convolve_1_x_n_s8: input and filter height 1, output width % 4 == 0
+  kKernelVariantCmsisConv1xN = 4,
+  // arm_depthwise_conv_s8_opt: depth multiplier 1, no dilation
+  kKernelVariantCmsisDepthwiseOpt = 5,
+  // arm_depthwise_conv_3x3_s8: as Opt, 3x3 filter, padding <= 1
+  kKernelVariantCmsisDepthwise3x3 = 6,
+  kKernelVariantCount = 7,
+};
+
+const char* KernelVariantName(KernelVariant variant);
+
+// One node of subgraph 0 and the variant its kernel should run. builtin_code
+// is the node's BuiltinOperator; an entry whose code does not match the node
+// is ignored, so a table made for another model cannot pick a wrong kernel.
+struct KernelVariantEntry {
+  uint16_t node_index;
+  uint8_t builtin_code;
+  uint8_t variant;
+};
+
+struct KernelVariantTable {
+  const KernelVariantEntry* entries;
+  size_t count;
+  // Optional, one element per node: Prepare stores the variant each kernel
+  // actually selected (kKernelVariantDefault for kernels without variants).
+  uint8_t* selected;
+  size_t selected_count;
+};
+
+// Table consulted by the Prepare of every kernel with variants; nullptr (the
+// default) keeps each kernel's own choice. Prepare copies the selection into
+// the node's op data, so the table only has to live until AllocateTensors()
+// returns and interpreters created earlier are not affected.
+void SetKernelVariantTable(const KernelVariantTable* table);
+
+// For use in Prepare: the variant requested for this node (if the table
+// entry matches builtin_code), kKernelVariantDefault otherwise.
+KernelVariant RequestedKernelVariant(TfLiteContext* context,
+                                     const TfLiteNode* node,
+                                     int32_t builtin_code);
+
+// For use in Prepare: records the variant the node is going to run in the
+// table's selected array, if any. Pass a concrete variant, not Default.
+void ReportKernelVariant(TfLiteContext* context, const TfLiteNode* node,
+                         KernelVariant variant);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANT_H_
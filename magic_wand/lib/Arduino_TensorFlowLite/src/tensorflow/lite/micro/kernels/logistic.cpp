@@ -106,6 +106,8 @@ TfLiteStatus LogisticEval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace
 
 TfLiteRegistration Register_LOGISTIC() {
-  return tflite::micro::RegisterOp(LogisticInit, LogisticPrepare, LogisticEval);
+  return tflite::micro::RegisterOp(LogisticInit, LogisticPrepare, LogisticEval,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 }  // namespace tflite
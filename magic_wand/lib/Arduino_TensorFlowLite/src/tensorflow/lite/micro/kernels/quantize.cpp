@@ -35,7 +35,8 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
 TfLiteRegistration Register_QUANTIZE() {
   return tflite::micro::RegisterOp(Init, PrepareQuantizeReference,
-                                   EvalQuantizeReference);
+                                   EvalQuantizeReference, /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 }  // namespace tflite
@@ -115,7 +115,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace reshape
 
 TfLiteRegistration Register_RESHAPE() {
-  return tflite::micro::RegisterOp(nullptr, reshape::Prepare, reshape::Eval);
+  return tflite::micro::RegisterOp(nullptr, reshape::Prepare, reshape::Eval,
+                                   /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 }  // namespace micro
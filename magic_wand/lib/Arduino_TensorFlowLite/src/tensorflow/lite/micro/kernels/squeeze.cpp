@@ -105,14 +105,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                     TfLiteEvalTensorByteLength(output, &output_byte_size));
 
   TF_LITE_ENSURE_EQ(context, input_byte_size, output_byte_size);
-  memcpy(output->data.raw, input->data.raw, input_byte_size);
+  // Do nothing for in-place squeeze.
+  if (input->data.raw != output->data.raw) {
+    memcpy(output->data.raw, input->data.raw, input_byte_size);
+  }
   return kTfLiteOk;
 }
 
 }  // namespace
 
 TfLiteRegistration Register_SQUEEZE() {
-  return tflite::micro::RegisterOp(nullptr, Prepare, Eval);
+  return tflite::micro::RegisterOp(nullptr, Prepare, Eval, /*free=*/nullptr,
+                                   kTfLiteInplaceOpInput0Shared);
 }
 
 }  // namespace tflite
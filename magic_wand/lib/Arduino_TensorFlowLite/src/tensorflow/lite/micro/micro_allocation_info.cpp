@@ -198,6 +198,7 @@ TfLiteStatus AllocationInfoBuilder::InitializeAllocationInfo(
 
       current->first_created = kUninitializedLifetime;
       current->last_used = kUninitializedLifetime;
+      current->alias_of = kNoAllocationAlias;
       current->needs_allocating =
           (eval_tensors[i].data.data == nullptr) &&
           (!subgraph->tensors()->Get(i)->is_variable()) &&
@@ -224,6 +225,7 @@ TfLiteStatus AllocationInfoBuilder::InitializeAllocationInfo(
     AllocationInfo* current = &scratch_allocation_info[i];
     current->first_created = kUninitializedLifetime;
     current->last_used = kUninitializedLifetime;
+    current->alias_of = kNoAllocationAlias;
     current->needs_allocating = true;
     current->offline_offset = kOnlinePlannedBuffer;
   }
@@ -333,6 +335,69 @@ TfLiteStatus AllocationInfoBuilder::MarkAllocationLifetimes(
   return kTfLiteOk;
 }
 
+TfLiteStatus AllocationInfoBuilder::MarkInPlaceAliases(
+    SubgraphAllocations* allocations, size_t* aliased_bytes) {
+  *aliased_bytes = 0;
+  // Control flow subgraphs interleave their scopes with the caller's, so the
+  // operator index -> scope mapping below only holds for a single subgraph.
+  if (model_->subgraphs()->size() != 1) {
+    return kTfLiteOk;
+  }
+  const SubGraph* subgraph = model_->subgraphs()->Get(0);
+  AllocationInfo* allocation_info = info_.allocation_info;
+  uint32_t operators_size = NumSubgraphOperators(subgraph);
+
+  for (uint32_t i = 0; i < operators_size; i++) {
+    // Subgraph inputs are created in scope 0, operator i runs in scope i + 1.
+    const int scope = static_cast<int>(i) + 1;
+    const TfLiteRegistration* registration =
+        allocations[0].node_and_registrations[i].registration;
+    if (registration == nullptr ||
+        registration->inplace_operator == kTfLiteInplaceOpNone) {
+      continue;
+    }
+    const auto* op = subgraph->operators()->Get(i);
+    if (op->outputs() == nullptr || op->outputs()->size() < 1 ||
+        op->inputs() == nullptr) {
+      continue;
+    }
+    AllocationInfo* output = &allocation_info[op->outputs()->Get(0)];
+    if (!output->needs_allocating ||
+        output->offline_offset != kOnlinePlannedBuffer ||
+        output->first_created != scope) {
+      continue;
+    }
+
+    constexpr uint64_t kSharedInputFlags[] = {kTfLiteInplaceOpInput0Shared,
+                                              kTfLiteInplaceOpInput1Shared,
+                                              kTfLiteInplaceOpInput2Shared};
+    for (size_t n = 0; n < op->inputs()->size() && n < 3; ++n) {
+      const int tensor_index = op->inputs()->Get(n);
+      if (tensor_index < 0 ||
+          (registration->inplace_operator & kSharedInputFlags[n]) == 0) {
+        continue;
+      }
+      // The input may itself be an alias; its buffer belongs to the root.
+      int root_index = tensor_index;
+      while (allocation_info[root_index].alias_of != kNoAllocationAlias) {
+        root_index = allocation_info[root_index].alias_of;
+      }
+      AllocationInfo* root = &allocation_info[root_index];
+      if (root == output || !root->needs_allocating ||
+          root->offline_offset != kOnlinePlannedBuffer ||
+          root->last_used != scope || root->bytes < output->bytes) {
+        continue;
+      }
+      root->last_used = std::max(root->last_used, output->last_used);
+      output->needs_allocating = false;
+      output->alias_of = root_index;
+      *aliased_bytes += output->bytes;
+      break;
+    }
+  }
+  return kTfLiteOk;
+}
+
 // Get offline tensors allocation plan. See
 // micro/docs/memory_management.md for more info.
 TfLiteStatus AllocationInfoBuilder::GetOfflinePlannedOffsets(
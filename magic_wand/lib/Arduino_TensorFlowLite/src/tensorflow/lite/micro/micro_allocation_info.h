@@ -31,8 +31,14 @@ struct AllocationInfo {
   int last_used;
   int32_t offline_offset;
   bool needs_allocating;
+  // Index of the allocation whose buffer this one shares because an in-place
+  // operator writes it over its input (see MarkInPlaceAliases), or
+  // kNoAllocationAlias. An aliased allocation is not planned itself.
+  int alias_of;
 };
 
+constexpr int kNoAllocationAlias = -1;
+
 // Used to hold the allocation info list and related metadata for the entire
 // graph (including subgraphs). Since all subgraphs are planned together, the
 // allocation info list contains allocations for all subgraphs. Track the offset
@@ -104,6 +110,16 @@ class AllocationInfoBuilder {
       ScratchBufferHandle* scratch_buffer_handles,
       SubgraphAllocations* allocations);
 
+  // Let the output of an operator that declares in-place support
+  // (TfLiteRegistration::inplace_operator) share the buffer of the input it
+  // may overwrite when that operator is the input's last reader and the
+  // output is no larger. The input's lifetime is extended to cover the output
+  // and the output is taken out of the plan. Must be called after
+  // MarkAllocationLifetimes(); only single-subgraph models are aliased.
+  // Returns the number of bytes taken out of the plan in aliased_bytes.
+  TfLiteStatus MarkInPlaceAliases(SubgraphAllocations* allocations,
+                                  size_t* aliased_bytes);
+
   // Returns the number of allocations.
   int AllocationCount() const { return info_.allocation_info_count; }
 
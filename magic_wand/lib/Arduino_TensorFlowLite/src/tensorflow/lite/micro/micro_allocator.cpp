@@ -109,6 +109,13 @@ TfLiteStatus CommitPlan(MicroMemoryPlanner* planner, uint8_t* starting_point,
       ++planner_index;
     }
   }
+  // Outputs of in-place operators point at the buffer of the input they share.
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->alias_of != kNoAllocationAlias) {
+      *current->output_ptr = *allocation_info[current->alias_of].output_ptr;
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -832,6 +839,11 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
       GetScratchBufferRequests();
   TF_LITE_ENSURE_STATUS(builder.MarkAllocationLifetimes(
       0, scratch_buffer_requests, scratch_buffer_handles, allocations));
+  in_place_aliased_bytes_ = 0;
+  if (in_place_aliasing_) {
+    TF_LITE_ENSURE_STATUS(
+        builder.MarkInPlaceAliases(allocations, &in_place_aliased_bytes_));
+  }
   int allocation_info_count = builder.AllocationCount();
   AllocationInfo* allocation_info = builder.Finish();
 
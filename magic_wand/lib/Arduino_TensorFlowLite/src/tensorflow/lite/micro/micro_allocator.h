@@ -228,6 +228,15 @@ class MicroAllocator {
 
   TfLiteBridgeBuiltinDataAllocator* GetBuiltinDataAllocator();
 
+  // Lets the outputs of operators that declare in-place support share the
+  // buffer of an input whose last use is that operator (enabled by default).
+  // Must be set before the model is allocated.
+  void SetInPlaceAliasing(bool enabled) { in_place_aliasing_ = enabled; }
+
+  // Returns the total bytes of tensors that were aliased onto an input
+  // instead of being planned, only available after `FinishModelAllocation`.
+  size_t in_place_aliased_bytes() const { return in_place_aliased_bytes_; }
+
  protected:
   MicroAllocator(SingleArenaBufferAllocator* memory_allocator,
                  MicroMemoryPlanner* memory_planner);
@@ -306,6 +315,7 @@ class MicroAllocator {
   MicroMemoryPlanner* memory_planner_;
 
   bool model_is_allocating_;
+  bool in_place_aliasing_ = true;
 
   // Holds the number of ScratchBufferRequest instances stored in the head
   // section when a model is allocating.
@@ -318,6 +328,9 @@ class MicroAllocator {
   // to ensure that multi-tenant allocations can share the head for buffers.
   size_t max_head_buffer_usage_ = 0;
 
+  // Bytes of the tensors aliased onto an in-place operator's input.
+  size_t in_place_aliased_bytes_ = 0;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
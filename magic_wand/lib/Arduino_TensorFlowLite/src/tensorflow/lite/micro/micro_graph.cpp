@@ -143,16 +143,32 @@ TfLiteStatus MicroGraph::FreeSubgraphs() {
 }
 
 TfLiteStatus MicroGraph::InvokeSubgraph(int subgraph_idx) {
-  int previous_subgraph_idx = current_subgraph_index_;
-  current_subgraph_index_ = subgraph_idx;
+  if (static_cast<size_t>(subgraph_idx) >= subgraphs_->size()) {
+    MicroPrintf("Accessing subgraph %d but only %d subgraphs found",
+                subgraph_idx, subgraphs_->size());
+    return kTfLiteError;
+  }
+  return InvokeSubgraphRange(subgraph_idx, 0,
+                             NumSubgraphOperators(model_, subgraph_idx));
+}
 
+TfLiteStatus MicroGraph::InvokeSubgraphRange(int subgraph_idx, size_t first_op,
+                                             size_t end_op) {
   if (static_cast<size_t>(subgraph_idx) >= subgraphs_->size()) {
     MicroPrintf("Accessing subgraph %d but only %d subgraphs found",
                 subgraph_idx, subgraphs_->size());
     return kTfLiteError;
   }
   uint32_t operators_size = NumSubgraphOperators(model_, subgraph_idx);
-  for (size_t i = 0; i < operators_size; ++i) {
+  if (first_op > end_op || end_op > operators_size) {
+    MicroPrintf("Operator range [%d, %d) outside subgraph %d (%d operators)",
+                first_op, end_op, subgraph_idx, operators_size);
+    return kTfLiteError;
+  }
+
+  int previous_subgraph_idx = current_subgraph_index_;
+  current_subgraph_index_ = subgraph_idx;
+  for (size_t i = first_op; i < end_op; ++i) {
     TfLiteNode* node =
         &(subgraph_allocations_[subgraph_idx].node_and_registrations[i].node);
     const TfLiteRegistration* registration = subgraph_allocations_[subgraph_idx]
@@ -54,6 +54,13 @@ class MicroGraph {
   // the model.
   virtual TfLiteStatus InvokeSubgraph(int subgraph_idx);
 
+  // Calls TfLiteRegistration->Invoke for operators [first_op, end_op) of a
+  // single subgraph. Running consecutive ranges in order is the same as one
+  // InvokeSubgraph() call; temp allocations are released after every
+  // operator, so nothing is held between two ranges.
+  virtual TfLiteStatus InvokeSubgraphRange(int subgraph_idx, size_t first_op,
+                                           size_t end_op);
+
   // Zeros out all variable tensors in all subgraphs in the model.
   virtual TfLiteStatus ResetVariableTensors();
 
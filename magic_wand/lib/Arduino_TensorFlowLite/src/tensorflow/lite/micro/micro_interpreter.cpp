@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler_interface.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/micro/tflite_bridge/flatbuffer_conversions_bridge.h"
 #include "tensorflow/lite/micro/tflite_bridge/op_resolver_bridge.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -281,9 +282,63 @@ TfLiteStatus MicroInterpreter::Invoke() {
   if (!tensors_allocated_) {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
+  invoke_step_next_op_ = 0;
   return graph_.InvokeSubgraph(0);
 }
 
+TfLiteStatus MicroInterpreter::InvokeStep(uint32_t budget_us, bool* done) {
+  *done = false;
+  if (initialization_status_ != kTfLiteOk) {
+    MicroPrintf("InvokeStep() called after initialization failed\n");
+    return kTfLiteError;
+  }
+  if (!tensors_allocated_) {
+    TF_LITE_ENSURE_OK(&context_, AllocateTensors());
+  }
+
+  const size_t operators_size = NumSubgraphOperators(model_, 0);
+  const uint64_t budget_ticks =
+      static_cast<uint64_t>(budget_us) * ticks_per_second() / 1000000;
+  const uint32_t start = GetCurrentTimeTicks();
+  do {
+    const size_t op = invoke_step_next_op_;
+    if (op < operators_size) {
+      TfLiteStatus status = graph_.InvokeSubgraphRange(0, op, op + 1);
+      if (status != kTfLiteOk) {
+        invoke_step_next_op_ = 0;
+        return status;
+      }
+    }
+    invoke_step_next_op_ = op + 1;
+    if (invoke_step_next_op_ >= operators_size) {
+      invoke_step_next_op_ = 0;
+      *done = true;
+      return kTfLiteOk;
+    }
+  } while (static_cast<uint32_t>(GetCurrentTimeTicks() - start) < budget_ticks);
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::InvokeRange(size_t first_op, size_t end_op) {
+  if (initialization_status_ != kTfLiteOk) {
+    MicroPrintf("InvokeRange() called after initialization failed\n");
+    return kTfLiteError;
+  }
+  if (!tensors_allocated_) {
+    TF_LITE_ENSURE_OK(&context_, AllocateTensors());
+  }
+  invoke_step_next_op_ = 0;
+  return graph_.InvokeSubgraphRange(0, first_op, end_op);
+}
+
+TfLiteEvalTensor* MicroInterpreter::GetEvalTensor(int tensor_index) {
+  const int length = model_->subgraphs()->Get(0)->tensors()->size();
+  if (!tensors_allocated_ || tensor_index < 0 || tensor_index >= length) {
+    return nullptr;
+  }
+  return &graph_.GetAllocations()[0].tensors[tensor_index];
+}
+
 TfLiteTensor* MicroInterpreter::input(size_t index) {
   const size_t length = inputs_size();
   if (index >= length) {
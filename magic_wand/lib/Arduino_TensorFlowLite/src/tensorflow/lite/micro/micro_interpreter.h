@@ -73,6 +73,36 @@ class MicroInterpreter {
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Resumable Invoke() that returns between operators once roughly budget_us
+  // microseconds (GetCurrentTimeTicks()) have passed, so other work can run
+  // on the same core while a model is in flight. At least one operator runs
+  // per call and the last one may overshoot the budget. *done is set once the
+  // final operator has run; the outputs are only valid then. Inputs must not
+  // be written while a step sequence is in progress. Invoke() and
+  // AbortInvokeStep() restart the sequence from the first operator.
+  TfLiteStatus InvokeStep(uint32_t budget_us, bool* done);
+  void AbortInvokeStep() { invoke_step_next_op_ = 0; }
+  bool invoke_step_in_progress() const { return invoke_step_next_op_ > 0; }
+
+  // Runs operators [first_op, end_op) of the main subgraph. Tensors read by
+  // the range but written before first_op must hold valid data, e.g. copied
+  // in from another interpreter of the same model through GetEvalTensor().
+  TfLiteStatus InvokeRange(size_t first_op, size_t end_op);
+  size_t operators_size() const {
+    return model_->subgraphs()->Get(0)->operators()->size();
+  }
+
+  // Replaces the profiler given to the constructor (nullptr: none), e.g. to
+  // observe operators of an interpreter created by code that did not pass
+  // one. Takes effect at the next operator.
+  void SetProfiler(MicroProfilerInterface* profiler) {
+    context_.profiler = profiler;
+  }
+
+  // Eval tensor of the main subgraph by tensor index, nullptr if out of range
+  // or before AllocateTensors().
+  TfLiteEvalTensor* GetEvalTensor(int tensor_index);
+
   // This is the recommended API for an application to pass an external payload
   // pointer as an external context to kernels. The life time of the payload
   // pointer should be at least as long as this interpreter. TFLM supports only
@@ -156,6 +186,9 @@ class MicroInterpreter {
 
   TfLiteStatus initialization_status_;
 
+  // Next operator of subgraph 0 for InvokeStep(), 0 when none is in flight.
+  size_t invoke_step_next_op_ = 0;
+
   ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
 
   // TODO(b/162311891): Clean these pointers up when this class supports buffers
@@ -128,6 +128,27 @@ std::pair<size_t, char*> SerialReadLine(int timeout) {
                         reinterpret_cast<char*>(_ring_buffer._aucBuffer));
 }
 
+// SerialReadBytes
+// Read up to <length> bytes of binary data from the default serial port into
+// <buffer>.  Waits up to <timeout> milliseconds for the first byte, then
+// returns whatever is already available without further waiting.  Any
+// negative <timeout> value means that the wait for data will be forever.
+// Returns the number of bytes stored in <buffer> (zero on timeout).
+size_t SerialReadBytes(uint8_t* buffer, size_t length, int timeout) {
+  ulong start_time = millis();
+  while (DEBUG_SERIAL_OBJECT.available() <= 0) {
+    if (timeout >= 0 && millis() - start_time >= static_cast<ulong>(timeout)) {
+      return 0;
+    }
+  }
+
+  size_t count = 0;
+  while (count < length && DEBUG_SERIAL_OBJECT.available() > 0) {
+    buffer[count++] = static_cast<uint8_t>(DEBUG_SERIAL_OBJECT.read());
+  }
+  return count;
+}
+
 // SerialWrite
 // Write the ASCII characters in <buffer> to the default serial port.
 // The <buffer> must be zero terminated.
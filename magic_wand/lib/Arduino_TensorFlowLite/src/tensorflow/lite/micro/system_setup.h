@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_MICRO_SYSTEM_SETUP_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 
 namespace tflite {
@@ -49,6 +50,14 @@ void SerialChangeBaudRate(const int baud);
 // Returns {0, NULL} if the timeout occurs.
 std::pair<size_t, char*> SerialReadLine(int timeout);
 
+// SerialReadBytes
+// Read up to <length> bytes of binary data from the default serial port into
+// <buffer>.  Waits up to <timeout> milliseconds for the first byte, then
+// returns whatever is already available without further waiting.  Any
+// negative <timeout> value means that the wait for data will be forever.
+// Returns the number of bytes stored in <buffer> (zero on timeout).
+size_t SerialReadBytes(uint8_t* buffer, size_t length, int timeout);
+
 // SerialWrite
 // Write the ASCII characters in <buffer> to the default serial port.
 // The <buffer> must be zero terminated.
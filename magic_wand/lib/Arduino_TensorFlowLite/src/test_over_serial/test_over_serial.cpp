@@ -32,9 +32,15 @@ namespace test_over_serial {
 // (base64 encoded and decoded data in multiples of 4 bytes)
 constexpr size_t kBase64MaxDecodeLength = (kSerialMaxInputLength * 3) / 4;
 
+// binary (!BULK) transfer chunk size and inactivity timeout
+// kBulkChunkLength is a multiple of every TestDataType unit size
+constexpr size_t kBulkChunkLength = 240;
+constexpr int kBulkTimeoutMs = 2000;
+
 constexpr size_t k64BitUIntLength = 20;  // string length of 64bit uint
 const char* const kCommandTest = "TEST";
 const char* const kCommandData = "DATA";
+const char* const kCommandBulk = "BULK";
 const char* const kCommandDataAck = "DATA_ACK";
 const char* const kCommandOk = "OK";
 const char* const kCommandFail = "FAIL";
@@ -43,7 +49,12 @@ const char* const kDelimiter = " ";
 class TestOverSerialImpl : public TestOverSerial {
  private:
   bool in_data_mode_;
+  bool in_bulk_mode_;
   InputBuffer data_info_;
+  alignas(4) uint8_t bulk_buffer_[kBulkChunkLength];
+  size_t bulk_fill_;       // bytes held in bulk_buffer_
+  size_t bulk_remaining_;  // bytes still to be read from the serial port
+  bool bulk_discard_;      // transfer failed: drop the rest of its bytes
 
   void TokenizeInput(char* input, const char*& arg1, const char*& arg2,
                      const char*& arg3) {
@@ -62,6 +73,8 @@ class TestOverSerialImpl : public TestOverSerial {
         return "raw-float";
       case kAUDIO_PCM_16KHZ_MONO_S16:
         return "audio-pcm-16khz-mono-s16";
+      case kIMU_ACCEL_GYRO_F32:
+        return "imu-accel-gyro-f32";
       default:
         break;
     }
@@ -80,6 +93,8 @@ class TestOverSerialImpl : public TestOverSerial {
         return sizeof(float);
       case kAUDIO_PCM_16KHZ_MONO_S16:
         return sizeof(int16_t);
+      case kIMU_ACCEL_GYRO_F32:
+        return 6 * sizeof(float);
     }
     // NOTREACHED
   }
@@ -130,6 +145,79 @@ class TestOverSerialImpl : public TestOverSerial {
     DataReply(result);
   }
 
+  // Binary transfer: raw bytes, no base64 and no per-line !DATA_ACK.
+  // Reads at most one chunk per call so the application loop keeps running;
+  // the handler only ever sees whole units.
+  void ProcessBulkData(const InputHandler* handler) {
+    if (bulk_discard_) {
+      DiscardBulkData();
+      return;
+    }
+
+    const size_t unit = DataTypeToUnitSize();
+    size_t want = kBulkChunkLength - bulk_fill_;
+    if (want > bulk_remaining_) {
+      want = bulk_remaining_;
+    }
+
+    if (want > 0) {
+      size_t received =
+          SerialReadBytes(bulk_buffer_ + bulk_fill_, want, kBulkTimeoutMs);
+      if (received == 0) {
+        // host stopped sending: bytes it sends late are not commands either
+        bulk_discard_ = true;
+        DiscardBulkData();
+        return;
+      }
+      bulk_fill_ += received;
+      bulk_remaining_ -= received;
+    }
+
+    size_t units = bulk_fill_ / unit;
+    if (units > 0) {
+      uint8_t** p = const_cast<uint8_t**>(&data_info_.data.uint8);
+      *p = bulk_buffer_;
+      data_info_.length = units;
+      if (nullptr != handler && !(*handler)(&data_info_)) {
+        // abort input processing once the host has sent the rest
+        bulk_discard_ = true;
+        DiscardBulkData();
+        return;
+      }
+      data_info_.offset += units;
+
+      size_t used = units * unit;
+      memmove(bulk_buffer_, bulk_buffer_ + used, bulk_fill_ - used);
+      bulk_fill_ -= used;
+    }
+
+    if (bulk_remaining_ == 0 && bulk_fill_ == 0) {
+      in_bulk_mode_ = false;
+      DataReply(kCommandOk, kCommandBulk);
+    }
+  }
+
+  // After a failure the rest of the transfer is read and dropped, one chunk
+  // per call, so raw bytes are not parsed as commands. !FAIL BULK is sent
+  // once all of it arrived or nothing did for kBulkTimeoutMs.
+  void DiscardBulkData() {
+    bulk_fill_ = 0;
+    size_t want = kBulkChunkLength;
+    if (want > bulk_remaining_) {
+      want = bulk_remaining_;
+    }
+    size_t received = 0;
+    if (want > 0) {
+      received = SerialReadBytes(bulk_buffer_, want, kBulkTimeoutMs);
+      bulk_remaining_ -= received;
+    }
+    if (received == 0 || bulk_remaining_ == 0) {
+      in_bulk_mode_ = false;
+      bulk_discard_ = false;
+      DataReply(kCommandFail, kCommandBulk);
+    }
+  }
+
   inline bool IsDataMode() { return in_test_mode_ && in_data_mode_; }
 
   void TestOkReply(size_t input_length) {
@@ -144,11 +232,11 @@ class TestOverSerialImpl : public TestOverSerial {
     Reply({kCommandDataAck, data_length});
   }
 
-  void DataReply(const char* result) {
+  void DataReply(const char* result, const char* command = kCommandData) {
     char data_length[k64BitUIntLength + 1];
     MicroSnprintf(data_length, sizeof(data_length), "%u",
                   data_info_.total * DataTypeToUnitSize());
-    Reply({result, kCommandData, DataTypeToString(), data_length});
+    Reply({result, command, DataTypeToString(), data_length});
   }
 
   void Reply(const std::initializer_list<const char* const>& list) {
@@ -176,6 +264,10 @@ class TestOverSerialImpl : public TestOverSerial {
         // unable to convert to unsigned long
         return false;
       }
+      if ((total % DataTypeToUnitSize()) != 0) {
+        // partial units are never valid
+        return false;
+      }
       data_info_.total = total / DataTypeToUnitSize();
     } else {
       // mismatched data type
@@ -187,12 +279,25 @@ class TestOverSerialImpl : public TestOverSerial {
 
  public:
   TestOverSerialImpl()
-      : TestOverSerial(), in_data_mode_(false), data_info_({}) {}
+      : TestOverSerial(),
+        in_data_mode_(false),
+        in_bulk_mode_(false),
+        data_info_({}),
+        bulk_fill_(0),
+        bulk_remaining_(0),
+        bulk_discard_(false) {}
+
+  bool IsBulkMode(void) override { return in_test_mode_ && in_bulk_mode_; }
 
   void ProcessInput(const InputHandler* handler) override {
     size_t received;
     char* input_buffer;
 
+    if (IsBulkMode()) {
+      ProcessBulkData(handler);
+      return;
+    }
+
     std::tie(received, input_buffer) = SerialReadLine(10);
     if (received == 0 || input_buffer == NULL) {
       return;
@@ -240,6 +345,24 @@ class TestOverSerialImpl : public TestOverSerial {
       in_data_mode_ = true;
       // reply when all data received
 
+    } else if (strcmp(command, kCommandBulk) == 0) {
+      // BULK command
+      if (nullptr == data_type || nullptr == data_length) {
+        Reply({kCommandFail, input_buffer});
+        return;
+      }
+      if (!IsTestMode() || !ProcessDataInfo(data_type, data_length)) {
+        Reply({kCommandFail, command, data_type, data_length});
+        return;
+      }
+
+      in_bulk_mode_ = true;
+      bulk_discard_ = false;
+      bulk_fill_ = 0;
+      bulk_remaining_ = data_info_.total * DataTypeToUnitSize();
+      // host waits for this reply before sending the binary data
+      Reply({kCommandOk, command, data_type, data_length});
+
     } else {
       // unknown command
       // output FAIL with input_buffer
@@ -26,6 +26,7 @@ enum TestDataType {
   kRAW_FLOAT,                 // float32
   kIMAGE_GRAYSCALE,           // uint8
   kAUDIO_PCM_16KHZ_MONO_S16,  // PCM@16KHz, mono, int16
+  kIMU_ACCEL_GYRO_F32,        // float32 x6: ax, ay, az (g), gx, gy, gz (deg/s)
 };
 
 union DataPtr {
@@ -36,6 +37,7 @@ union DataPtr {
 };
 
 // length, offset and total use the chosen TestDataType units
+// (one unit of kIMU_ACCEL_GYRO_F32 is a complete 6-channel IMU sample)
 struct InputBuffer {
   DataPtr data;   // input buffer pointer
   size_t length;  // input buffer length
@@ -58,6 +60,8 @@ class TestOverSerial {
  public:
   static TestOverSerial& Instance(const TestDataType data_type);
   inline bool IsTestMode(void) { return in_test_mode_; }
+  // true while a !BULK binary transfer is in progress
+  virtual bool IsBulkMode(void) = 0;
   virtual void ProcessInput(const InputHandler*) = 0;
 };
 
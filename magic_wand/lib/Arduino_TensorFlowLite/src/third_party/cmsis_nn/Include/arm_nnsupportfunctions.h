@@ -35,6 +35,18 @@
 
 #include <stdbool.h>
 
+/**
+ * Placement of the int8 inner loops. With GAINS_HOT_IRAM on the ESP32
+ * (env xiao_release) the functions marked ARM_NN_HOT are IRAM_ATTR, as
+ * GAINS_HOT in include/hot_path.h; elsewhere it expands to nothing.
+ */
+#if defined(GAINS_HOT_IRAM) && defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#define ARM_NN_HOT IRAM_ATTR
+#else
+#define ARM_NN_HOT
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
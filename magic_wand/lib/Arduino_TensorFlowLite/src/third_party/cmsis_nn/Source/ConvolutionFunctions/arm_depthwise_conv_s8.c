@@ -270,17 +270,17 @@ static void depthwise_conv_s8_generic(const q7_t *input,
  *  Optimization using DSP extension is not available for the generic case where channel multiplier is > 1.
  *
  */
-arm_cmsis_nn_status arm_depthwise_conv_s8(const cmsis_nn_context *ctx,
-                                          const cmsis_nn_dw_conv_params *dw_conv_params,
-                                          const cmsis_nn_per_channel_quant_params *quant_params,
-                                          const cmsis_nn_dims *input_dims,
-                                          const q7_t *input,
-                                          const cmsis_nn_dims *filter_dims,
-                                          const q7_t *kernel,
-                                          const cmsis_nn_dims *bias_dims,
-                                          const int32_t *bias,
-                                          const cmsis_nn_dims *output_dims,
-                                          q7_t *output)
+arm_cmsis_nn_status ARM_NN_HOT arm_depthwise_conv_s8(const cmsis_nn_context *ctx,
+                                                     const cmsis_nn_dw_conv_params *dw_conv_params,
+                                                     const cmsis_nn_per_channel_quant_params *quant_params,
+                                                     const cmsis_nn_dims *input_dims,
+                                                     const q7_t *input,
+                                                     const cmsis_nn_dims *filter_dims,
+                                                     const q7_t *kernel,
+                                                     const cmsis_nn_dims *bias_dims,
+                                                     const int32_t *bias,
+                                                     const cmsis_nn_dims *output_dims,
+                                                     q7_t *output)
 {
     const uint16_t dilation_x = dw_conv_params->dilation.w;
     const uint16_t dilation_y = dw_conv_params->dilation.h;
@@ -37,17 +37,17 @@
  *
  */
 
-q7_t *arm_nn_mat_mult_kernel_s8_s16(const q7_t *input_a,
-                                    const q15_t *input_b,
-                                    const uint16_t output_ch,
-                                    const int32_t *out_shift,
-                                    const int32_t *out_mult,
-                                    const int32_t out_offset,
-                                    const int16_t activation_min,
-                                    const int16_t activation_max,
-                                    const uint16_t num_col_a,
-                                    const int32_t *const output_bias,
-                                    q7_t *out_0)
+q7_t *ARM_NN_HOT arm_nn_mat_mult_kernel_s8_s16(const q7_t *input_a,
+                                               const q15_t *input_b,
+                                               const uint16_t output_ch,
+                                               const int32_t *out_shift,
+                                               const int32_t *out_mult,
+                                               const int32_t out_offset,
+                                               const int16_t activation_min,
+                                               const int16_t activation_max,
+                                               const uint16_t num_col_a,
+                                               const int32_t *const output_bias,
+                                               q7_t *out_0)
 {
 #if !defined(ARM_MATH_MVEI)
     /* set up the second output pointers */
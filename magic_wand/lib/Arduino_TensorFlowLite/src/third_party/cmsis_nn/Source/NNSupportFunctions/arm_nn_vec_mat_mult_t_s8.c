@@ -52,20 +52,20 @@
  * Refer header file for details.
  *
  */
-arm_cmsis_nn_status arm_nn_vec_mat_mult_t_s8(const q7_t *lhs,
-                                             const q7_t *rhs,
-                                             const q31_t *bias,
-                                             q7_t *dst,
-                                             const int32_t lhs_offset,
-                                             const int32_t rhs_offset,
-                                             const int32_t dst_offset,
-                                             const int32_t dst_multiplier,
-                                             const int32_t dst_shift,
-                                             const int32_t rhs_cols,
-                                             const int32_t rhs_rows,
-                                             const int32_t activation_min,
-                                             const int32_t activation_max,
-                                             const int32_t address_offset)
+arm_cmsis_nn_status ARM_NN_HOT arm_nn_vec_mat_mult_t_s8(const q7_t *lhs,
+                                                        const q7_t *rhs,
+                                                        const q31_t *bias,
+                                                        q7_t *dst,
+                                                        const int32_t lhs_offset,
+                                                        const int32_t rhs_offset,
+                                                        const int32_t dst_offset,
+                                                        const int32_t dst_multiplier,
+                                                        const int32_t dst_shift,
+                                                        const int32_t rhs_cols,
+                                                        const int32_t rhs_rows,
+                                                        const int32_t activation_min,
+                                                        const int32_t activation_max,
+                                                        const int32_t address_offset)
 {
     (void)rhs_offset;
 #if defined(ARM_MATH_MVEI)
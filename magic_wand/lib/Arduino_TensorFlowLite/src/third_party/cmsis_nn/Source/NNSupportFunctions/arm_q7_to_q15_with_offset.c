@@ -39,7 +39,7 @@
  * @{
  */
 
-void arm_q7_to_q15_with_offset(const q7_t *src, q15_t *dst, uint32_t block_size, q15_t offset)
+void ARM_NN_HOT arm_q7_to_q15_with_offset(const q7_t *src, q15_t *dst, uint32_t block_size, q15_t offset)
 {
     int block_cnt;
 
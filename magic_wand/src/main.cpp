@@ -19,6 +19,8 @@
 #include "imu_provider.h"
 #include "magic_wand_model_data.h"
 #include "rasterize_stroke.h"
+#include "stroke_stream.h"
+#include "window_ring.h"
 
 #define BLE_SENSE_UUID(val) ("4798e0f2-" val "-4d68-af64-8a8f5258404e")
 
@@ -31,6 +33,12 @@ constexpr int stroke_transmit_stride      = 2;
 constexpr int stroke_transmit_max_length  = 160;
 constexpr int stroke_points_byte_count    = 2 * sizeof(int8_t) * stroke_transmit_max_length;
 constexpr int stroke_struct_byte_count    = (2 * sizeof(int32_t)) + stroke_points_byte_count;
+static_assert(stroke_transmit_max_length == kStrokeStreamMaxPoints, "stroke stream point limit");
+
+// Live stroke notifications (stroke_stream.h): new points go out after this
+// many have piled up or this long after the last packet, whichever is first
+constexpr int      kStrokeStreamFlushPoints = 8;
+constexpr uint32_t kStrokeStreamFlushMs     = 100;
 
 constexpr int raster_width    = 32;
 constexpr int raster_height   = 32;
@@ -38,6 +46,11 @@ constexpr int raster_channels = 3;
 constexpr int raster_byte_count = raster_height * raster_width * raster_channels;
 int8_t raster_buffer[raster_byte_count];
 
+// Input encoding, from the model input at setup: 3 = RGB time gradient
+// (RasterizeStroke), 1 = compact time raster (RasterizeStrokeTime, models
+// from train_wand_model.py --encoding time)
+int model_raster_channels = raster_channels;
+
 // ===== Stroke points in float coords ([-0.6,0.6]) =====
 struct StrokePointF {
   float x;
@@ -58,18 +71,21 @@ bool manual_done     = false;   // User pressed 's' to finish gesture
 
 BLEService        service              (BLE_SENSE_UUID("0000"));
 BLECharacteristic strokeCharacteristic (BLE_SENSE_UUID("300a"), BLERead, stroke_struct_byte_count);
+// ArduinoBLE cuts notifications at the negotiated MTU and does not expose it,
+// so packets are sized for the default MTU every central supports
+BLECharacteristic strokeStreamCharacteristic (BLE_SENSE_UUID("300b"), BLENotify, kStrokeStreamPacketBytes);
+StrokeStreamEncoder stroke_stream;
+uint32_t            stroke_stream_flush_ms = 0;
 
 String name;
 
 // Raw IMU buffers (kept mostly for compatibility / debug)
-constexpr int acceleration_data_length = 300 * 3;
-float acceleration_data[acceleration_data_length] = {};
-int   acceleration_data_index = 0;
+// Double-mapped rings: the last n samples are one contiguous [n][3] slice
+constexpr int imu_data_length = 300;
+WindowRing<float, imu_data_length, 3> acceleration_data;
 float acceleration_sample_rate = kDefaultImuSampleRateHz;
 
-constexpr int gyroscope_data_length = 300 * 3;
-float gyroscope_data[gyroscope_data_length]   = {};
-int   gyroscope_data_index = 0;
+WindowRing<float, imu_data_length, 3> gyroscope_data;
 float gyroscope_sample_rate = kDefaultImuSampleRateHz;
 
 float current_velocity[3]        = {0.0f, 0.0f, 0.0f};
@@ -198,19 +214,11 @@ void ReadAccelerometerAndGyroscope(int* new_accelerometer_samples, int* new_gyro
   }
 
   // Store gyro in buffer (optional; kept for compatibility)
-  const int gyroscope_index = (gyroscope_data_index % gyroscope_data_length);
-  gyroscope_data[gyroscope_index]     = gyro_sample[0];
-  gyroscope_data[gyroscope_index + 1] = gyro_sample[1];
-  gyroscope_data[gyroscope_index + 2] = gyro_sample[2];
-  gyroscope_data_index += 3;
+  gyroscope_data.Push(gyro_sample);
   *new_gyroscope_samples = 1;
 
   // Store accel
-  const int acceleration_index = (acceleration_data_index % acceleration_data_length);
-  acceleration_data[acceleration_index]     = accel_sample[0];
-  acceleration_data[acceleration_index + 1] = accel_sample[1];
-  acceleration_data[acceleration_index + 2] = accel_sample[2];
-  acceleration_data_index += 3;
+  acceleration_data.Push(accel_sample);
   *new_accelerometer_samples = 1;
 
   // HTML-style stroke building from gyro only
@@ -219,20 +227,18 @@ void ReadAccelerometerAndGyroscope(int* new_accelerometer_samples, int* new_gyro
 
 void EstimateGravityDirection(float* gravity) {
   int samples_to_average = 50;
-  if (samples_to_average >= acceleration_data_index) {
-    samples_to_average = acceleration_data_index;
+  if (samples_to_average >= acceleration_data.Count()) {
+    samples_to_average = acceleration_data.Count();
+  }
+  if (samples_to_average == 0) {
+    return;
   }
 
-  const int start_index = ((acceleration_data_index +
-    (acceleration_data_length - (3 * (samples_to_average + 1)))) %
-    acceleration_data_length);
-
+  const float* entry = acceleration_data.Window(samples_to_average);
   float x_total = 0.0f;
   float y_total = 0.0f;
   float z_total = 0.0f;
-  for (int i = 0; i < samples_to_average; ++i) {
-    const int index = ((start_index + (i * 3)) % acceleration_data_length);
-    const float* entry = &acceleration_data[index];
+  for (int i = 0; i < samples_to_average; ++i, entry += 3) {
     x_total += entry[0];
     y_total += entry[1];
     z_total += entry[2];
@@ -244,14 +250,8 @@ void EstimateGravityDirection(float* gravity) {
 
 void UpdateVelocity(int new_samples, float* gravity) {
   const float friction_fudge = 0.98f;
-  const int start_index = ((acceleration_data_index +
-    (acceleration_data_length - (3 * (new_samples + 1)))) %
-    acceleration_data_length);
-
-  for (int i = 0; i < new_samples; ++i) {
-    const int index = ((start_index + (i * 3)) % acceleration_data_length);
-    const float* entry = &acceleration_data[index];
-    
+  const float* entry = acceleration_data.Window(new_samples);
+  for (int i = 0; i < new_samples; ++i, entry += 3) {
     current_velocity[0] += (entry[0] - gravity[0]);
     current_velocity[1] += (entry[1] - gravity[1]);
     current_velocity[2] += (entry[2] - gravity[2]);
@@ -278,13 +278,8 @@ void UpdateOrientation(int new_samples, float* /*gravity*/, float* drift) {
   const float deg_to_rad = 0.017453292519943295f;  // PI/180
   const float dt         = 1.0f / gyroscope_sample_rate;
 
-  const int start_index = ((gyroscope_data_index +
-    (gyroscope_data_length - (3 * (new_samples + 1)))) %
-    gyroscope_data_length);
-
-  for (int i = 0; i < new_samples; ++i) {
-    const int index = ((start_index + (i * 3)) % gyroscope_data_length);
-    const float* gyro_entry = &gyroscope_data[index];
+  const float* gyro_entry = gyroscope_data.Window(new_samples);
+  for (int i = 0; i < new_samples; ++i, gyro_entry += 3) {
 
     const float gx = (gyro_entry[0] - drift[0]) * deg_to_rad;
     const float gy = (gyro_entry[1] - drift[1]) * deg_to_rad;
@@ -296,6 +291,28 @@ void UpdateOrientation(int new_samples, float* /*gravity*/, float* drift) {
   }
 }
 
+// ===== Live stroke over BLE =====
+// Keeps the stroke characteristic current (clients read it to resync) and
+// notifies the points added since the last packet. Unforced, it waits for
+// kStrokeStreamFlushPoints new points or kStrokeStreamFlushMs.
+void StreamStroke(bool force) {
+  const uint32_t now = millis();
+  if (!force && stroke_stream.Pending(*stroke_transmit_length) < kStrokeStreamFlushPoints &&
+      now - stroke_stream_flush_ms < kStrokeStreamFlushMs) {
+    return;
+  }
+  stroke_stream_flush_ms = now;
+  strokeCharacteristic.writeValue(stroke_struct_buffer, stroke_struct_byte_count);
+  if (!strokeStreamCharacteristic.subscribed()) return;
+
+  uint8_t packet[kStrokeStreamPacketBytes];
+  int length;
+  while ((length = stroke_stream.Encode(stroke_points, *stroke_transmit_length, *stroke_state,
+                                        packet)) > 0) {
+    strokeStreamCharacteristic.writeValue(packet, length);
+  }
+}
+
 // ===== Print strokePoints as wanddata-like JSON =====
 void PrintStrokeAsJson(int index, const char* label) {
   Serial.println("{");
@@ -361,6 +378,7 @@ void setup() {
   BLE.setDeviceName(name.c_str());
   BLE.setAdvertisedService(service);
   service.addCharacteristic(strokeCharacteristic);
+  service.addCharacteristic(strokeStreamCharacteristic);
   BLE.addService(service);
   BLE.advertise();
   Serial.println("✓ BLE ready");
@@ -382,7 +400,17 @@ void setup() {
     return;
   }
 
-  Serial.println("Model ready");
+  const TfLiteIntArray* input_dims = interpreter->input(0)->dims;
+  const int input_channels = input_dims->data[input_dims->size - 1];
+  if (input_channels != 1 && input_channels != raster_channels) {
+    Serial.println("ERROR: Model input must have 1 or 3 channels!");
+    return;
+  }
+  model_raster_channels = input_channels;
+
+  Serial.print("Model ready (");
+  Serial.print(model_raster_channels == 1 ? "time" : "RGB");
+  Serial.println(" raster input)");
   Serial.println("========================================");
   Serial.println("Draw digits 0-9!");
   Serial.println("Press 'r' to start, 's' to stop & classify");
@@ -403,14 +431,14 @@ void loop() {
       capture_enabled = true;
       manual_done     = false;
 
-      *stroke_state = 0;
+      *stroke_state = 1;
       stroke_length = 0;
       ResetStrokeAndIntegrator();
+      stroke_stream.BeginStroke();
+      StreamStroke(true);
 
-      acceleration_data_index = 0;
-      gyroscope_data_index    = 0;
-      memset(acceleration_data, 0, sizeof(acceleration_data));
-      memset(gyroscope_data,    0, sizeof(gyroscope_data));
+      acceleration_data.Reset();
+      gyroscope_data.Reset();
 
       current_velocity[0] = current_velocity[1] = current_velocity[2] = 0.0f;
       current_position[0] = current_position[1] = current_position[2] = 0.0f;
@@ -450,13 +478,19 @@ void loop() {
 
     if (stroke_length_f > 4) {  // require a few points
       done = true;
+      *stroke_state = 2;
     } else if (stroke_length_f == 0) {
       Serial.println("No gesture recorded; nothing to process.");
+      *stroke_state = 0;
       ResetStrokeAndIntegrator();
     } else {
       Serial.println("Gesture too small / flat; discarded.");
+      *stroke_state = 0;
       ResetStrokeAndIntegrator();
     }
+    StreamStroke(true);
+  } else if (capture_enabled) {
+    StreamStroke(false);
   }
 
   // Single-shot classification per gesture
@@ -467,20 +501,34 @@ void loop() {
     PrintStrokeAsJson(/*index=*/0, /*label=*/"?");
 
     // Rasterize from int8 stroke_points
-    RasterizeStroke(
-      stroke_points,
-      *stroke_transmit_length,
-      1.0f, 1.0f,           // use full normalized range [-1, 1]
-      raster_width,
-      raster_height,
-      raster_buffer);
-    
+    if (model_raster_channels == 1) {
+      RasterizeStrokeTime(
+        stroke_points,
+        *stroke_transmit_length,
+        1.0f, 1.0f,         // use full normalized range [-1, 1]
+        raster_width,
+        raster_height,
+        raster_buffer);
+    } else {
+      RasterizeStroke(
+        stroke_points,
+        *stroke_transmit_length,
+        1.0f, 1.0f,         // use full normalized range [-1, 1]
+        raster_width,
+        raster_height,
+        raster_buffer);
+    }
+    const int input_byte_count = raster_height * raster_width * model_raster_channels;
+
     // ASCII visualization of 32x32
     for (int y = 0; y < raster_height; ++y) {
       for (int x = 0; x < raster_width; ++x) {
-        const int8_t* pixel =
-            &raster_buffer[(y * raster_width * raster_channels) + (x * raster_channels)];
-        Serial.print((pixel[0] > -128 || pixel[1] > -128 || pixel[2] > -128) ? '#' : '.');
+        const int8_t* pixel = &raster_buffer[((y * raster_width) + x) * model_raster_channels];
+        bool drawn = false;
+        for (int c = 0; c < model_raster_channels; ++c) {
+          drawn = drawn || pixel[c] > -128;
+        }
+        Serial.print(drawn ? '#' : '.');
       }
       Serial.println();
     }
@@ -496,7 +544,7 @@ void loop() {
     // Serial.print("input_scale = "); Serial.println(input_scale, 6);
     // Serial.print("input_zp    = "); Serial.println(input_zp);
 
-    for (int i = 0; i < raster_byte_count; ++i) {
+    for (int i = 0; i < input_byte_count; ++i) {
       // raster_buffer is int8: background ~ -128, stroke up to ~127
       int s = static_cast<int>(raster_buffer[i]);   // [-128,127]
       uint8_t u = static_cast<uint8_t>(s + 128);    // [0,255] like Colab PNGs
@@ -587,6 +635,7 @@ void loop() {
     *stroke_state           = 0;
     stroke_length           = 0;
     ResetStrokeAndIntegrator();
+    StreamStroke(true);
     Serial.println("[Ready - press 'r' to record another gesture]");
   }
   
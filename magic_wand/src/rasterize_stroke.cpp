@@ -57,17 +57,18 @@ int32_t Abs(int32_t a) {
   }
 }
 
-}  // namespace
-
-void RasterizeStroke(
-    int8_t* stroke_points,
+// Draws the stroke segments into an interleaved int8 raster. Every segment is
+// drawn with the channel values pixel_for_time() returns for its start time.
+template <int num_channels, typename PixelForTime>
+void DrawStroke(
+    const int8_t* stroke_points,
     int stroke_points_count,
-    float x_range, 
-    float y_range, 
-    int width, 
+    float x_range,
+    float y_range,
+    int width,
     int height,
+    PixelForTime pixel_for_time,
     int8_t* out_buffer) {
-  constexpr int num_channels = 3;
   const int buffer_byte_count = height * width * num_channels;
 
   for (int i = 0; i < buffer_byte_count; ++i) {
@@ -83,8 +84,6 @@ void RasterizeStroke(
 
   const int t_inc_fp = kFixedPoint / stroke_points_count;
 
-  const int one_half_fp = (kFixedPoint / 2);
-
   for (int point_index = 0; point_index < (stroke_points_count - 1); ++point_index) {
     const int8_t* start_point = &stroke_points[point_index * 2];
     const int32_t start_point_x_fp = (start_point[0] * kFixedPoint) / 128;
@@ -101,26 +100,8 @@ void RasterizeStroke(
     const int32_t delta_x_fp = end_x_fp - start_x_fp;
     const int32_t delta_y_fp = end_y_fp - start_y_fp;
 
-    const int32_t t_fp = point_index * t_inc_fp;
-    int32_t red_i32;
-    int32_t green_i32;
-    int32_t blue_i32;
-    if (t_fp < one_half_fp) {
-      const int32_t local_t_fp = DivFP(t_fp, one_half_fp);
-      const int32_t one_minus_t_fp = kFixedPoint - local_t_fp;
-      red_i32 = RoundFPToInt(one_minus_t_fp * 255) - 128;
-      green_i32 = RoundFPToInt(local_t_fp * 255) - 128;
-      blue_i32 = -128;
-    } else {
-      const int32_t local_t_fp = DivFP(t_fp - one_half_fp, one_half_fp);
-      const int32_t one_minus_t_fp = kFixedPoint - local_t_fp;
-      red_i32 = -128;
-      green_i32 = RoundFPToInt(one_minus_t_fp * 255) - 128;
-      blue_i32 = RoundFPToInt(local_t_fp * 255) - 128;
-    }
-    const int8_t red_i8 = Gate(red_i32, -128, 127);
-    const int8_t green_i8 = Gate(green_i32, -128, 127);
-    const int8_t blue_i8 = Gate(blue_i32, -128, 127);
+    int8_t pixel[num_channels];
+    pixel_for_time(point_index * t_inc_fp, pixel);
 
     int line_length;
     int32_t x_inc_fp;
@@ -152,10 +133,65 @@ void RasterizeStroke(
       if ((x < 0) or (x >= width) or (y < 0) or (y >= height)) {
         continue;
       }
-      const int buffer_index = (y * width * num_channels) + (x * num_channels);
-      out_buffer[buffer_index + 0] = red_i8;
-      out_buffer[buffer_index + 1] = green_i8;
-      out_buffer[buffer_index + 2] = blue_i8;
+      int8_t* out = &out_buffer[(y * width * num_channels) + (x * num_channels)];
+      for (int c = 0; c < num_channels; ++c) {
+        out[c] = pixel[c];
+      }
     }
   }
 }
+
+}  // namespace
+
+void RasterizeStroke(
+    int8_t* stroke_points,
+    int stroke_points_count,
+    float x_range, 
+    float y_range, 
+    int width, 
+    int height,
+    int8_t* out_buffer) {
+  // Time as a red -> green -> blue gradient
+  const auto rgb_for_time = [](int32_t t_fp, int8_t* pixel) {
+    const int one_half_fp = (kFixedPoint / 2);
+    int32_t red_i32;
+    int32_t green_i32;
+    int32_t blue_i32;
+    if (t_fp < one_half_fp) {
+      const int32_t local_t_fp = DivFP(t_fp, one_half_fp);
+      const int32_t one_minus_t_fp = kFixedPoint - local_t_fp;
+      red_i32 = RoundFPToInt(one_minus_t_fp * 255) - 128;
+      green_i32 = RoundFPToInt(local_t_fp * 255) - 128;
+      blue_i32 = -128;
+    } else {
+      const int32_t local_t_fp = DivFP(t_fp - one_half_fp, one_half_fp);
+      const int32_t one_minus_t_fp = kFixedPoint - local_t_fp;
+      red_i32 = -128;
+      green_i32 = RoundFPToInt(one_minus_t_fp * 255) - 128;
+      blue_i32 = RoundFPToInt(local_t_fp * 255) - 128;
+    }
+    pixel[0] = Gate(red_i32, -128, 127);
+    pixel[1] = Gate(green_i32, -128, 127);
+    pixel[2] = Gate(blue_i32, -128, 127);
+  };
+  DrawStroke<3>(stroke_points, stroke_points_count, x_range, y_range, width, height,
+                rgb_for_time, out_buffer);
+}
+
+void RasterizeStrokeTime(
+    const int8_t* stroke_points,
+    int stroke_points_count,
+    float x_range,
+    float y_range,
+    int width,
+    int height,
+    int8_t* out_buffer) {
+  // Time as one ramp from kTimeRasterStart to 127, the gap to the -128
+  // background keeps the stroke start visible
+  const auto time_for_time = [](int32_t t_fp, int8_t* pixel) {
+    const int32_t span = 127 - kTimeRasterStart;
+    pixel[0] = Gate(kTimeRasterStart + RoundFPToInt(t_fp * span), -128, 127);
+  };
+  DrawStroke<1>(stroke_points, stroke_points_count, x_range, y_range, width, height,
+                time_for_time, out_buffer);
+}
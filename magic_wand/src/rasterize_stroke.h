@@ -24,4 +24,18 @@ void RasterizeStroke(
     int height,
     int8_t* out_buffer);
 
+// Compact variant: one int8 channel per pixel (width * height bytes) holding
+// the normalized stroke time, kTimeRasterStart at the first segment up to 127
+// at the end, -128 where there is no stroke. Same geometry as RasterizeStroke.
+constexpr int kTimeRasterStart = -64;
+
+void RasterizeStrokeTime(
+    const int8_t* stroke_points,
+    int stroke_points_count,
+    float x_range,
+    float y_range,
+    int width,
+    int height,
+    int8_t* out_buffer);
+
 #endif   // TENSORFLOW_LITE_MICRO_EXAMPLES_MAGIC_WAND_RASTERIZE_STROKE_H
@@ -0,0 +1,191 @@
+#include "stroke_stream.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr int kWidthBits[4] = {3, 4, 6, 9};   // Per width class; 9 covers int8 - int8
+
+int WidthClass(int dx, int dy) {
+    for (int c = 0; c < 3; c++) {
+        const int limit = 1 << (kWidthBits[c] - 1);
+        if (dx >= -limit && dx < limit && dy >= -limit && dy < limit) return c;
+    }
+    return 3;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : out_(out), bits_(0) {}
+
+    void Put(uint32_t value, int width) {
+        for (int i = 0; i < width; i++, bits_++) {
+            if ((bits_ & 7) == 0) out_[bits_ >> 3] = 0;
+            out_[bits_ >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (bits_ & 7));
+        }
+    }
+    int bytes() const { return (bits_ + 7) >> 3; }
+
+private:
+    uint8_t* out_;
+    int bits_;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* in, int bytes) : in_(in), bits_(0), limit_(bytes * 8) {}
+
+    // False once the packet runs out
+    bool Get(int width, uint32_t* value) {
+        if (bits_ + width > limit_) return false;
+        *value = 0;
+        for (int i = 0; i < width; i++, bits_++) {
+            *value |= static_cast<uint32_t>((in_[bits_ >> 3] >> (bits_ & 7)) & 1u) << i;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* in_;
+    int bits_;
+    int limit_;
+};
+
+int SignExtend(uint32_t value, int width) {
+    const uint32_t sign = 1u << (width - 1);
+    return static_cast<int>((value ^ sign) - sign);
+}
+
+}  // namespace
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+
+StrokeStreamEncoder::StrokeStreamEncoder(int max_packet_bytes)
+    : max_packet_bytes_(max_packet_bytes), sequence_(0), stroke_(0), sent_points_(0),
+      sent_state_(-1) {}
+
+void StrokeStreamEncoder::BeginStroke() {
+    stroke_ = static_cast<uint8_t>((stroke_ + 1) & 0x3F);
+    sent_points_ = 0;
+    sent_state_ = -1;
+}
+
+int StrokeStreamEncoder::Pending(int point_count) const {
+    return point_count > sent_points_ ? point_count - sent_points_ : 0;
+}
+
+int StrokeStreamEncoder::Encode(const int8_t* points, int point_count, int state,
+                                uint8_t* packet) {
+    if (point_count > kStrokeStreamMaxPoints) point_count = kStrokeStreamMaxPoints;
+    // The buffer was cleared: continue from its new end
+    if (point_count < sent_points_) sent_points_ = point_count;
+    if (point_count == sent_points_ && state == sent_state_) return 0;
+
+    const int first = sent_points_;
+    int prev_x = first > 0 ? points[2 * (first - 1)] : 0;
+    int prev_y = first > 0 ? points[2 * (first - 1) + 1] : 0;
+    const int budget = (max_packet_bytes_ - kStrokeStreamHeaderBytes) * 8;
+    BitWriter writer(packet + kStrokeStreamHeaderBytes);
+    int used = 0;
+    int count = 0;
+    while (first + count < point_count && count < 255) {
+        const int x = points[2 * (first + count)];
+        const int y = points[2 * (first + count) + 1];
+        const int c = WidthClass(x - prev_x, y - prev_y);
+        const int bits = 2 + 2 * kWidthBits[c];
+        if (used + bits > budget) break;
+        writer.Put(static_cast<uint32_t>(c), 2);
+        writer.Put(static_cast<uint32_t>(x - prev_x), kWidthBits[c]);
+        writer.Put(static_cast<uint32_t>(y - prev_y), kWidthBits[c]);
+        used += bits;
+        prev_x = x;
+        prev_y = y;
+        count++;
+    }
+
+    packet[0] = sequence_++;
+    packet[1] = static_cast<uint8_t>((stroke_ << 2) | (state & 3));
+    packet[2] = static_cast<uint8_t>(first);
+    packet[3] = static_cast<uint8_t>(count);
+    sent_points_ = first + count;
+    sent_state_ = state;
+    return kStrokeStreamHeaderBytes + writer.bytes();
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+StrokeStreamDecoder::StrokeStreamDecoder() {
+    Reset();
+    next_sequence_ = -1;
+    lost_packets_ = 0;
+}
+
+void StrokeStreamDecoder::Reset() {
+    memset(points_, 0, sizeof(points_));
+    point_count_ = 0;
+    state_ = 0;
+    stroke_ = -1;
+    synced_ = false;
+}
+
+StrokeStreamDecoder::Result StrokeStreamDecoder::Decode(const uint8_t* packet, int length) {
+    if (length < kStrokeStreamHeaderBytes) return kStrokeMalformed;
+    const int sequence = packet[0];
+    const int lost = next_sequence_ >= 0 ? (sequence - next_sequence_) & 0xFF : 0;
+    lost_packets_ += lost;
+    next_sequence_ = (sequence + 1) & 0xFF;
+
+    const int stroke = packet[1] >> 2;
+    const int state = packet[1] & 3;
+    const int first = packet[2];
+    const int count = packet[3];
+    if (first + count > kStrokeStreamMaxPoints) return kStrokeMalformed;
+    // A lost packet may have carried points or a state change; the first
+    // packet of a stroke stands on its own
+    const bool continues = synced_ && lost == 0 && (stroke == stroke_ || stroke_ < 0) &&
+                           first <= point_count_;
+    if (first != 0 && !continues) {
+        synced_ = false;
+        return kStrokeGap;
+    }
+
+    BitReader reader(packet + kStrokeStreamHeaderBytes, length - kStrokeStreamHeaderBytes);
+    int x = first > 0 ? points_[2 * (first - 1)] : 0;
+    int y = first > 0 ? points_[2 * (first - 1) + 1] : 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t c, dx, dy;
+        if (!reader.Get(2, &c) || !reader.Get(kWidthBits[c], &dx) ||
+            !reader.Get(kWidthBits[c], &dy)) {
+            synced_ = false;
+            return kStrokeMalformed;
+        }
+        x += SignExtend(dx, kWidthBits[c]);
+        y += SignExtend(dy, kWidthBits[c]);
+        points_[2 * (first + i)] = static_cast<int8_t>(x);
+        points_[2 * (first + i) + 1] = static_cast<int8_t>(y);
+    }
+    point_count_ = first + count;
+    state_ = state;
+    stroke_ = stroke;
+    synced_ = true;
+    return kStrokeUpdated;
+}
+
+bool StrokeStreamDecoder::Resync(const uint8_t* stroke_struct, int length) {
+    constexpr int kStructBytes = 2 * sizeof(int32_t) + 2 * kStrokeStreamMaxPoints;
+    if (length < kStructBytes) return false;
+    int32_t state, count;
+    memcpy(&state, stroke_struct, sizeof(state));
+    memcpy(&count, stroke_struct + sizeof(int32_t), sizeof(count));
+    if (count < 0 || count > kStrokeStreamMaxPoints) return false;
+    memcpy(points_, stroke_struct + 2 * sizeof(int32_t), sizeof(points_));
+    point_count_ = count;
+    state_ = state & 3;
+    stroke_ = -1;
+    synced_ = true;
+    return true;
+}
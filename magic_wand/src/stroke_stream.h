@@ -0,0 +1,86 @@
+#ifndef STROKE_STREAM_H_
+#define STROKE_STREAM_H_
+
+#include <cstdint>
+
+// Live stroke notifications
+// While a gesture is drawn the firmware notifies only the points added since
+// the last packet instead of the whole 328-byte stroke struct. Every packet
+// fits one notification at the default ATT MTU (23 - 3 bytes):
+//
+//   byte 0   sequence number, +1 per packet (wraps)
+//   byte 1   stroke id (bits 7..2, +1 per gesture) | stroke state (bits 1..0,
+//            as the struct: 0 waiting, 1 drawing, 2 done)
+//   byte 2   index of the first point in this packet
+//   byte 3   number of points in this packet
+//   byte 4+  points, LSB-first bit stream: per point a 2-bit width class
+//            (3, 4, 6 or 9 bits), then dx and dy in two's complement of that
+//            width, relative to the previous point (point -1 is 0, 0)
+//
+// A packet that follows the previous sequence number and starts at or
+// before the points the client has continues the stroke. Otherwise packets
+// were lost, and the client reads the full stroke characteristic once and
+// carries on (Resync()).
+// Deltas of consecutive points are small, so a point costs ~11 bits instead
+// of 16 and a full packet carries about 11 points.
+
+constexpr int kStrokeStreamPacketBytes = 20;
+constexpr int kStrokeStreamHeaderBytes = 4;
+constexpr int kStrokeStreamMaxPoints = 160;   // stroke_transmit_max_length
+
+class StrokeStreamEncoder {
+public:
+    explicit StrokeStreamEncoder(int max_packet_bytes = kStrokeStreamPacketBytes);
+
+    // New gesture: the next packet restarts at point 0 with the next stroke id
+    void BeginStroke();
+
+    // Points of the stroke buffer not sent yet
+    int Pending(int point_count) const;
+
+    // Next packet for the stroke buffer (x/y int8 pairs, as stroke_points)
+    // and state: the unsent points that fit, or the state if it changed.
+    // Returns its length, 0 when there is nothing new. Call until 0 to flush.
+    int Encode(const int8_t* points, int point_count, int state, uint8_t* packet);
+
+private:
+    int max_packet_bytes_;
+    uint8_t sequence_;
+    uint8_t stroke_;
+    int sent_points_;
+    int sent_state_;   // -1 until the stroke's first packet
+};
+
+class StrokeStreamDecoder {
+public:
+    enum Result {
+        kStrokeUpdated,
+        kStrokeGap,         // Packets were lost: Resync() from the stroke struct
+        kStrokeMalformed,
+    };
+
+    StrokeStreamDecoder();
+
+    void Reset();
+    Result Decode(const uint8_t* packet, int length);
+
+    // Take over the stroke characteristic value (int32 state, int32 length,
+    // 160 x/y int8 pairs). Returns false if it is too short.
+    bool Resync(const uint8_t* stroke_struct, int length);
+
+    int state() const { return state_; }
+    int point_count() const { return point_count_; }
+    const int8_t* points() const { return points_; }
+    int lost_packets() const { return lost_packets_; }   // From sequence gaps
+
+private:
+    int8_t points_[2 * kStrokeStreamMaxPoints];
+    int point_count_;
+    int state_;
+    int stroke_;          // -1 unknown (after Resync)
+    int next_sequence_;   // -1 before the first packet
+    int lost_packets_;
+    bool synced_;
+};
+
+#endif  // STROKE_STREAM_H_
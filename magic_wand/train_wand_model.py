@@ -0,0 +1,265 @@
+"""
+Train a magic wand model for either raster encoding and export it for TFLM.
+
+    rgb   32x32x3 int8, stroke time as a red -> green -> blue gradient
+          (RasterizeStroke, the encoding of the Colab notebook model)
+    time  32x32x1 int8, stroke time as one ramp (RasterizeStrokeTime),
+          a third of the input bytes and of the first conv's work
+
+The strokes come from wanddata_*.json (what PrintStrokeAsJson() prints).
+Rasterization is a port of src/rasterize_stroke.cpp, bit-exact with the
+firmware, so the model sees the same pixels on the device. The network is
+the notebook architecture (3x conv + max pool, global average pool, dense
+sigmoid) with the input channel count changed. The int8
+model keeps the notebook's input quantization (scale 1, zero point -128,
+i.e. the raster byte) and is written as a .tflite plus a C array that can
+replace src/magic_wand_model_data.cpp; main.cpp picks the encoding from the
+model input at setup.
+
+    python train_wand_model.py wanddata_0.json wanddata_1.json \\
+        --encoding time -o wand_time.tflite --c-array src/magic_wand_model_data.cpp
+
+Compare against the current model with the host evaluator:
+
+    pio run -e host_wand
+    .pio/build/host_wand/program --model magic_wand/wand_time.tflite magic_wand/wanddata_*.json
+
+Requires tensorflow and numpy.
+"""
+
+import argparse
+import json
+import math
+
+import numpy as np
+
+RASTER_SIZE = 32
+MAX_STROKE_POINTS = 160   # stroke_transmit_max_length
+COORD_SCALE = 0.6         # kCoordScale
+TIME_RASTER_START = -64   # kTimeRasterStart in rasterize_stroke.h
+FIXED_POINT = 256
+
+
+# ----------------------------------------------------------------------------
+# Rasterization (port of rasterize_stroke.cpp, C integer semantics)
+# ----------------------------------------------------------------------------
+
+def _cdiv(a, b):
+    """Integer division truncating toward zero, like C."""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b >= 0) else -q
+
+
+def _mul_fp(a, b):
+    return _cdiv(a * b, FIXED_POINT)
+
+
+def _div_fp(a, b):
+    return _cdiv(a * FIXED_POINT, b if b != 0 else 1)
+
+
+def _norm_to_coord_fp(a_fp, range_fp, half_size_fp):
+    return _mul_fp(_div_fp(a_fp, range_fp), half_size_fp) + half_size_fp
+
+
+def _round_fp_to_int(a):
+    return _cdiv(a + FIXED_POINT // 2, FIXED_POINT)
+
+
+def _gate(a):
+    return max(-128, min(127, a))
+
+
+def _rgb_for_time(t_fp):
+    half = FIXED_POINT // 2
+    if t_fp < half:
+        local = _div_fp(t_fp, half)
+        return (_gate(_round_fp_to_int((FIXED_POINT - local) * 255) - 128),
+                _gate(_round_fp_to_int(local * 255) - 128), -128)
+    local = _div_fp(t_fp - half, half)
+    return (-128, _gate(_round_fp_to_int((FIXED_POINT - local) * 255) - 128),
+            _gate(_round_fp_to_int(local * 255) - 128))
+
+
+def _time_for_time(t_fp):
+    return (_gate(TIME_RASTER_START + _round_fp_to_int(t_fp * (127 - TIME_RASTER_START))),)
+
+
+def rasterize(points, encoding):
+    """int8 stroke points [[x, y], ...] -> int8 raster [32, 32, C]."""
+    channels = 3 if encoding == "rgb" else 1
+    pixel_for_time = _rgb_for_time if encoding == "rgb" else _time_for_time
+    out = np.full((RASTER_SIZE, RASTER_SIZE, channels), -128, dtype=np.int8)
+    count = len(points)
+    if count < 2:
+        return out
+    half_fp = RASTER_SIZE * FIXED_POINT // 2
+    range_fp = FIXED_POINT  # x_range = y_range = 1.0
+    t_inc_fp = FIXED_POINT // count
+    for index in range(count - 1):
+        sx, sy = (_cdiv(v * FIXED_POINT, 128) for v in points[index])
+        ex, ey = (_cdiv(v * FIXED_POINT, 128) for v in points[index + 1])
+        start_x = _norm_to_coord_fp(sx, range_fp, half_fp)
+        start_y = _norm_to_coord_fp(-sy, range_fp, half_fp)
+        end_x = _norm_to_coord_fp(ex, range_fp, half_fp)
+        end_y = _norm_to_coord_fp(-ey, range_fp, half_fp)
+        dx = end_x - start_x
+        dy = end_y - start_y
+        pixel = pixel_for_time(index * t_inc_fp)
+        if abs(dx) > abs(dy):
+            length = abs(_round_fp_to_int(dx))
+            x_inc = FIXED_POINT if dx > 0 else -FIXED_POINT
+            y_inc = _div_fp(dy, dx) if dx > 0 else -_div_fp(dy, dx)
+        else:
+            length = abs(_round_fp_to_int(dy))
+            y_inc = FIXED_POINT if dy > 0 else -FIXED_POINT
+            x_inc = _div_fp(dx, dy) if dy > 0 else -_div_fp(dx, dy)
+        for i in range(length + 1):
+            x = _round_fp_to_int(start_x + i * x_inc)
+            y = _round_fp_to_int(start_y + i * y_inc)
+            if 0 <= x < RASTER_SIZE and 0 <= y < RASTER_SIZE:
+                out[y, x, :] = pixel
+    return out
+
+
+# ----------------------------------------------------------------------------
+# Dataset
+# ----------------------------------------------------------------------------
+
+def encode_points(points_f):
+    """[-0.6, 0.6] float points -> int8 like UpdateStrokeFromGyroSample()."""
+    encoded = []
+    for point in points_f[:MAX_STROKE_POINTS]:
+        pair = []
+        for v in point:
+            # float32 math and roundf() (half away from zero) as on the device
+            r = min(max(np.float32(v) / np.float32(COORD_SCALE), -1.0), 1.0)
+            scaled = float(np.float32(r) * np.float32(128.0))
+            pair.append(max(-128, min(127, int(math.copysign(math.floor(abs(scaled) + 0.5), scaled)))))
+        encoded.append(pair)
+    return encoded
+
+
+def load_strokes(paths):
+    strokes = []
+    for path in paths:
+        with open(path) as f:
+            for stroke in json.load(f)["strokes"]:
+                points = [(p["x"], p["y"]) for p in stroke["strokePoints"]]
+                strokes.append((points, stroke["label"]))
+    return strokes
+
+
+def augment(points, rng):
+    """Small rotation, scale and jitter of a float stroke."""
+    angle = math.radians(rng.uniform(-12.0, 12.0))
+    scale = rng.uniform(0.85, 1.15)
+    c, s = math.cos(angle) * scale, math.sin(angle) * scale
+    return [(c * x - s * y + rng.normal(0.0, 0.004), s * x + c * y + rng.normal(0.0, 0.004))
+            for x, y in points]
+
+
+def build_arrays(strokes, labels, encoding, copies, rng):
+    images, targets = [], []
+    for points, label in strokes:
+        for copy in range(copies):
+            stroke = points if copy == 0 else augment(points, rng)
+            raster = rasterize(encode_points(stroke), encoding)
+            # The model sees raster + 128 in [0, 255], like the Colab PNGs
+            images.append(raster.astype(np.float32) + 128.0)
+            targets.append(labels.index(label))
+    return np.stack(images), np.array(targets)
+
+
+# ----------------------------------------------------------------------------
+# Model
+# ----------------------------------------------------------------------------
+
+def build_model(channels, num_classes):
+    import tensorflow as tf
+    return tf.keras.Sequential([
+        tf.keras.layers.Input(shape=(RASTER_SIZE, RASTER_SIZE, channels)),
+        tf.keras.layers.Conv2D(32, 3, activation="relu"),
+        tf.keras.layers.MaxPooling2D(2),
+        tf.keras.layers.Conv2D(64, 3, activation="relu"),
+        tf.keras.layers.MaxPooling2D(2),
+        tf.keras.layers.Conv2D(128, 3, activation="relu"),
+        tf.keras.layers.MaxPooling2D(2),
+        tf.keras.layers.GlobalAveragePooling2D(),
+        tf.keras.layers.Dense(num_classes, activation="sigmoid"),
+    ])
+
+
+def convert_int8(model, representative):
+    import tensorflow as tf
+
+    def dataset():
+        for image in representative:
+            yield [image[np.newaxis].astype(np.float32)]
+
+    converter = tf.lite.TFLiteConverter.from_keras_model(model)
+    converter.optimizations = [tf.lite.Optimize.DEFAULT]
+    converter.representative_dataset = dataset
+    converter.target_spec.supported_ops = [tf.lite.OpsSet.TFLITE_BUILTINS_INT8]
+    converter.inference_input_type = tf.int8
+    converter.inference_output_type = tf.int8
+    return converter.convert()
+
+
+def write_c_array(data, path):
+    with open(path, "w") as f:
+        f.write("// Generated by train_wand_model.py\n\n")
+        f.write("unsigned char g_magic_wand_model_data[] = {\n")
+        for i in range(0, len(data), 12):
+            f.write("  " + ", ".join(f"0x{b:02x}" for b in data[i:i + 12]))
+            f.write(",\n" if i + 12 < len(data) else "\n")
+        f.write("};\n")
+        f.write(f"unsigned int g_magic_wand_model_data_len = {len(data)};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("json", nargs="+", help="wanddata_*.json files")
+    parser.add_argument("--encoding", choices=["rgb", "time"], default="time")
+    parser.add_argument("--labels", default="0,1", help="class order of the model output")
+    parser.add_argument("--epochs", type=int, default=60)
+    parser.add_argument("--augment", type=int, default=8, help="augmented copies per stroke")
+    parser.add_argument("--val-fraction", type=float, default=0.2)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("-o", "--output", default="wand_model.tflite")
+    parser.add_argument("--c-array", help="also write the model as a C array (.cpp)")
+    args = parser.parse_args()
+
+    import tensorflow as tf
+    tf.random.set_seed(args.seed)
+    rng = np.random.default_rng(args.seed)
+    labels = args.labels.split(",")
+    strokes = [s for s in load_strokes(args.json) if s[1] in labels]
+    order = rng.permutation(len(strokes))
+    val_count = int(len(strokes) * args.val_fraction)
+    val = [strokes[i] for i in order[:val_count]]
+    train = [strokes[i] for i in order[val_count:]]
+
+    x_train, y_train = build_arrays(train, labels, args.encoding, 1 + args.augment, rng)
+    x_val, y_val = build_arrays(val, labels, args.encoding, 1, rng)
+    channels = x_train.shape[-1]
+    print(f"{len(train)} train strokes ({len(x_train)} rasters), {len(val)} validation, "
+          f"{args.encoding} encoding ({RASTER_SIZE}x{RASTER_SIZE}x{channels})")
+
+    model = build_model(channels, len(labels))
+    model.compile(optimizer="adam", loss="binary_crossentropy", metrics=["categorical_accuracy"])
+    model.fit(x_train, tf.one_hot(y_train, len(labels)), epochs=args.epochs, batch_size=32,
+              validation_data=(x_val, tf.one_hot(y_val, len(labels))) if val_count else None,
+              verbose=2)
+
+    tflite_model = convert_int8(model, x_train[rng.permutation(len(x_train))[:200]])
+    with open(args.output, "wb") as f:
+        f.write(tflite_model)
+    print(f"Wrote {args.output} ({len(tflite_model)} bytes)")
+    if args.c_array:
+        write_c_array(tflite_model, args.c_array)
+        print(f"Wrote {args.c_array}")
+
+
+if __name__ == "__main__":
+    main()
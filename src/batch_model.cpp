@@ -0,0 +1,186 @@
+#include "batch_model.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "fused_ops.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+tflite::BuiltinOperator OpCode(const tflite::ModelT& model, const tflite::OperatorT& op) {
+    const tflite::OperatorCodeT* code = model.operator_codes[op.opcode_index].get();
+    // Models from older converters only set the deprecated int8 field
+    return static_cast<tflite::BuiltinOperator>(
+        std::max<int32_t>(code->builtin_code, code->deprecated_builtin_code));
+}
+
+const char* OpName(const tflite::ModelT& model, const tflite::OperatorT& op) {
+    const tflite::OperatorCodeT* code = model.operator_codes[op.opcode_index].get();
+    if (OpCode(model, op) == tflite::BuiltinOperator_CUSTOM) return code->custom_code.c_str();
+    return tflite::EnumNameBuiltinOperator(OpCode(model, op));
+}
+
+bool IsConstant(const tflite::ModelT& model, const tflite::TensorT& tensor) {
+    return tensor.buffer < model.buffers.size() && !model.buffers[tensor.buffer]->data.empty();
+}
+
+// Operators that compute every index of dimension 0 on its own
+bool IsBatchwise(const tflite::ModelT& model, const tflite::OperatorT& op) {
+    switch (OpCode(model, op)) {
+        case tflite::BuiltinOperator_CONV_2D:
+        case tflite::BuiltinOperator_DEPTHWISE_CONV_2D:
+        case tflite::BuiltinOperator_FULLY_CONNECTED:
+        case tflite::BuiltinOperator_MAX_POOL_2D:
+        case tflite::BuiltinOperator_AVERAGE_POOL_2D:
+        case tflite::BuiltinOperator_ADD:
+        case tflite::BuiltinOperator_MUL:
+        case tflite::BuiltinOperator_SOFTMAX:
+        case tflite::BuiltinOperator_LOGISTIC:
+        case tflite::BuiltinOperator_TANH:
+        case tflite::BuiltinOperator_RELU:
+        case tflite::BuiltinOperator_RELU6:
+        case tflite::BuiltinOperator_QUANTIZE:
+        case tflite::BuiltinOperator_DEQUANTIZE:
+        case tflite::BuiltinOperator_RESHAPE:
+        case tflite::BuiltinOperator_EXPAND_DIMS:
+        case tflite::BuiltinOperator_SQUEEZE:
+        case tflite::BuiltinOperator_MEAN:
+            return true;
+        case tflite::BuiltinOperator_CUSTOM: {
+            const std::string& name = model.operator_codes[op.opcode_index]->custom_code;
+            return name == kChannelAffineOpName || name == kConvPoolOpName;
+        }
+        default:
+            return false;
+    }
+}
+
+// The int32 values of a constant input, or false if it is something else
+bool ReadInt32Constant(const tflite::ModelT& model, const tflite::SubGraphT& subgraph,
+                       int32_t t, std::vector<int32_t>* values) {
+    if (t < 0) return false;
+    const tflite::TensorT& tensor = *subgraph.tensors[t];
+    if (tensor.type != tflite::TensorType_INT32 || !IsConstant(model, tensor)) return false;
+    const std::vector<uint8_t>& data = model.buffers[tensor.buffer]->data;
+    values->resize(data.size() / sizeof(int32_t));
+    memcpy(values->data(), data.data(), values->size() * sizeof(int32_t));
+    return true;
+}
+
+// Constants can share a buffer, so a changed one gets its own
+void WriteInt32Constant(tflite::ModelT* model, tflite::TensorT* tensor,
+                        const std::vector<int32_t>& values) {
+    std::unique_ptr<tflite::BufferT> buffer(new tflite::BufferT());
+    buffer->data.resize(values.size() * sizeof(int32_t));
+    memcpy(buffer->data.data(), values.data(), buffer->data.size());
+    model->buffers.push_back(std::move(buffer));
+    tensor->buffer = static_cast<uint32_t>(model->buffers.size() - 1);
+}
+
+// Axis in [-rank, rank) that refers to dimension 0
+bool IsBatchAxis(int32_t axis, int rank) {
+    return axis == 0 || axis == -rank;
+}
+
+// Shape and axis inputs that mention dimension 0. Returns false if the
+// operator would mix or drop the batch.
+bool FixShapeInputs(tflite::ModelT* model, tflite::SubGraphT* subgraph, tflite::OperatorT* op,
+                    int batch, BatchModelReport* report) {
+    const tflite::BuiltinOperator code = OpCode(*model, *op);
+    const int rank = static_cast<int>(subgraph->tensors[op->inputs[0]]->shape.size());
+    std::vector<int32_t> values;
+    if (code == tflite::BuiltinOperator_RESHAPE) {
+        // The kernel takes the output tensor's shape, the shape input and
+        // the options are kept consistent with it
+        tflite::ReshapeOptionsT* options = op->builtin_options.AsReshapeOptions();
+        if (options != nullptr && !options->new_shape.empty()) {
+            if (options->new_shape[0] != 1) return false;
+            options->new_shape[0] = batch;
+        }
+        if (op->inputs.size() > 1 && op->inputs[1] >= 0) {
+            if (!ReadInt32Constant(*model, *subgraph, op->inputs[1], &values) || values.empty() ||
+                (values[0] != 1 && values[0] != -1)) {
+                return false;
+            }
+            if (values[0] == 1) {
+                values[0] = batch;
+                WriteInt32Constant(model, subgraph->tensors[op->inputs[1]].get(), values);
+                report->constants_changed++;
+            }
+        }
+    } else if (code == tflite::BuiltinOperator_EXPAND_DIMS) {
+        // At batch 1, a new axis before the batch is the same as one after it
+        if (!ReadInt32Constant(*model, *subgraph, op->inputs[1], &values) || values.size() != 1) {
+            return false;
+        }
+        if (IsBatchAxis(values[0], rank + 1)) {
+            values[0] = 1;
+            WriteInt32Constant(model, subgraph->tensors[op->inputs[1]].get(), values);
+            report->constants_changed++;
+        }
+    } else if (code == tflite::BuiltinOperator_SQUEEZE) {
+        // Without squeeze_dims every size-1 dimension goes, the batch too
+        const tflite::SqueezeOptionsT* options = op->builtin_options.AsSqueezeOptions();
+        if (options == nullptr || options->squeeze_dims.empty()) return false;
+        for (int32_t axis : options->squeeze_dims) {
+            if (IsBatchAxis(axis, rank)) return false;
+        }
+    } else if (code == tflite::BuiltinOperator_MEAN) {
+        if (!ReadInt32Constant(*model, *subgraph, op->inputs[1], &values)) return false;
+        for (int32_t axis : values) {
+            if (IsBatchAxis(axis, rank)) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool BatchModel(const unsigned char* model_data, int batch, std::vector<uint8_t>* batched,
+                BatchModelReport* report) {
+    memset(report, 0, sizeof(*report));
+    report->batch = batch;
+    batched->clear();
+    if (batch < 1) return false;
+    std::unique_ptr<tflite::ModelT> model(tflite::GetModel(model_data)->UnPack());
+    if (model->subgraphs.size() != 1) {
+        MicroPrintf("Batch model: %d subgraphs, only single-subgraph models are supported",
+                    static_cast<int>(model->subgraphs.size()));
+        return false;
+    }
+    tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+
+    for (auto& op : subgraph->operators) {
+        if (!IsBatchwise(*model, *op) || op->inputs.empty() || op->inputs[0] < 0) {
+            MicroPrintf("Batch model: %s is not supported", OpName(*model, *op));
+            return false;
+        }
+        if (!FixShapeInputs(model.get(), subgraph, op.get(), batch, report)) {
+            MicroPrintf("Batch model: %s would mix the batch", OpName(*model, *op));
+            return false;
+        }
+    }
+
+    for (auto& tensor : subgraph->tensors) {
+        if (IsConstant(*model, *tensor)) continue;
+        if (tensor->shape.empty() || tensor->shape[0] != 1) {
+            MicroPrintf("Batch model: tensor %s has no batch dimension", tensor->name.c_str());
+            return false;
+        }
+        tensor->shape[0] = batch;
+        if (!tensor->shape_signature.empty()) tensor->shape_signature[0] = batch;
+        report->tensors_resized++;
+    }
+
+    // The TFLM copy of flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(16 * 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    model.reset();
+    batched->assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    return true;
+}
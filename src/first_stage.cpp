@@ -0,0 +1,168 @@
+#include "first_stage.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "first_stage_params.h"
+
+namespace {
+constexpr float kRadToDeg = 57.2957795f;
+constexpr float kAccelSmoothing = 0.3f;     // EMA weight for the pitch estimate
+constexpr float kActivitySmoothing = 0.2f;  // EMA weight for |vertical accel|
+constexpr float kActiveEnter = 0.06f;       // g, start of a movement segment
+constexpr float kActiveExit = 0.03f;        // g, end of a movement segment
+constexpr int kMinRepSamples = 4;           // Ignore blips shorter than 100 ms
+}  // namespace
+
+// ============================================================================
+// CONSTRUCTOR / RESET
+// ============================================================================
+
+FirstStageClassifier::FirstStageClassifier() {
+    Reset();
+}
+
+void FirstStageClassifier::Reset() {
+    memset(pitch_, 0, sizeof(pitch_));
+    memset(vertical_sq_, 0, sizeof(vertical_sq_));
+    pitch_max_.head = pitch_max_.count = 0;
+    pitch_min_.head = pitch_min_.count = 0;
+    vertical_sum_sq_ = 0.0f;
+    smoothed_accel_[0] = smoothed_accel_[1] = smoothed_accel_[2] = 0.0f;
+    activity_ = 0.0f;
+    active_run_ = 0;
+    last_rep_samples_ = 0;
+    sample_count_ = 0;
+}
+
+// ============================================================================
+// STREAMING FEATURES
+// ============================================================================
+
+void FirstStageClassifier::PushExtreme(MonotonicQueue* queue, bool keep_max) {
+    // Drop samples that left the window
+    if (queue->count > 0 && queue->items[queue->head] <= sample_count_ - WINDOW_SIZE) {
+        queue->head = (queue->head + 1) % WINDOW_SIZE;
+        queue->count--;
+    }
+
+    // Drop samples that can never be the extreme again
+    const float value = pitch_[sample_count_ % WINDOW_SIZE];
+    while (queue->count > 0) {
+        int back = queue->items[(queue->head + queue->count - 1) % WINDOW_SIZE];
+        float back_value = pitch_[back % WINDOW_SIZE];
+        if (keep_max ? back_value > value : back_value < value) break;
+        queue->count--;
+    }
+    queue->items[(queue->head + queue->count) % WINDOW_SIZE] = sample_count_;
+    queue->count++;
+}
+
+void FirstStageClassifier::OnSample(const float* raw_accel, const float* processed_sample) {
+    const int slot = sample_count_ % WINDOW_SIZE;
+
+    // Pitch from the smoothed raw accel (gravity dominates at pushup speeds)
+    for (int i = 0; i < 3; i++) {
+        smoothed_accel_[i] += kAccelSmoothing * (raw_accel[i] - smoothed_accel_[i]);
+    }
+    const float sa0 = smoothed_accel_[0], sa1 = smoothed_accel_[1], sa2 = smoothed_accel_[2];
+    const float horizontal = sqrtf(sa1 * sa1 + sa2 * sa2);
+    pitch_[slot] = atan2f(-sa0, horizontal) * kRadToDeg;
+    PushExtreme(&pitch_max_, true);
+    PushExtreme(&pitch_min_, false);
+
+    // Linear accel along gravity
+    const float norm = sqrtf(sa0 * sa0 + horizontal * horizontal);
+    float vertical = 0.0f;
+    if (norm > 1e-3f) {
+        vertical = (processed_sample[0] * sa0 + processed_sample[1] * sa1 +
+                    processed_sample[2] * sa2) / norm;
+    }
+    const float vertical_sq = vertical * vertical;
+    vertical_sum_sq_ += vertical_sq - vertical_sq_[slot];  // slot holds the sample leaving the window
+    if (vertical_sum_sq_ < 0.0f) vertical_sum_sq_ = 0.0f;
+    vertical_sq_[slot] = vertical_sq;
+
+    // Movement segments with hysteresis; a finished one is the rep duration
+    activity_ += kActivitySmoothing * (fabsf(vertical) - activity_);
+    if (active_run_ > 0) {
+        if (activity_ < kActiveExit) {
+            if (active_run_ >= kMinRepSamples) last_rep_samples_ = active_run_;
+            active_run_ = 0;
+        } else {
+            active_run_++;
+        }
+    } else if (activity_ > kActiveEnter) {
+        active_run_ = 1;
+    }
+
+    sample_count_++;
+}
+
+FirstStageFeatures FirstStageClassifier::Features() const {
+    FirstStageFeatures features;
+    if (sample_count_ == 0) {
+        features.pitch_range_deg = 0.0f;
+    } else {
+        const float max_pitch = pitch_[pitch_max_.items[pitch_max_.head] % WINDOW_SIZE];
+        const float min_pitch = pitch_[pitch_min_.items[pitch_min_.head] % WINDOW_SIZE];
+        features.pitch_range_deg = max_pitch - min_pitch;
+    }
+
+    // A segment still in progress counts once it is longer than the last one.
+    // One sample per SAMPLE_PERIOD_MS: loop() pushes only DATA_RDY samples.
+    int rep_samples = active_run_ > last_rep_samples_ ? active_run_ : last_rep_samples_;
+    features.rep_duration_s = rep_samples * (SAMPLE_PERIOD_MS / 1000.0f);
+
+    const int n = sample_count_ < WINDOW_SIZE ? sample_count_ : WINDOW_SIZE;
+    features.vertical_energy = n > 0 ? vertical_sum_sq_ / n : 0.0f;
+    return features;
+}
+
+// ============================================================================
+// CLASSIFIER
+// ============================================================================
+
+void FirstStageFeatureVector(const FirstStageFeatures& features,
+                             float out[NUM_FIRST_STAGE_FEATURES]) {
+    out[0] = features.pitch_range_deg;
+    out[1] = features.rep_duration_s;
+    out[2] = log10f(features.vertical_energy + 1e-6f);
+}
+
+bool FirstStageClassifier::Classify(float probs[NUM_POSTURE_CLASSES], int& best_class,
+                                    float& confidence) const {
+    float raw[NUM_FIRST_STAGE_FEATURES];
+    FirstStageFeatureVector(Features(), raw);
+    float x[NUM_FIRST_STAGE_FEATURES];
+    for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) {
+        x[f] = (raw[f] - kFirstStageMean[f]) / kFirstStageStd[f];
+    }
+
+    // Softmax over linear scores
+    float max_score = -1e30f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        float score = kFirstStageBias[c];
+        for (int f = 0; f < NUM_FIRST_STAGE_FEATURES; f++) {
+            score += kFirstStageWeights[c][f] * x[f];
+        }
+        probs[c] = score;
+        if (score > max_score) max_score = score;
+    }
+    float total = 0.0f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        probs[c] = expf(probs[c] - max_score);
+        total += probs[c];
+    }
+
+    best_class = 0;
+    confidence = 0.0f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        probs[c] /= total;
+        if (probs[c] > confidence) {
+            confidence = probs[c];
+            best_class = c;
+        }
+    }
+    return confidence >= kFirstStageExitThreshold[best_class];
+}
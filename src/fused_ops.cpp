@@ -0,0 +1,519 @@
+#include "fused_ops.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "hot_path.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "third_party/cmsis_nn/Include/arm_nnfunctions.h"
+
+namespace {
+
+// ============================================================================
+// GAINS_CHANNEL_AFFINE
+// ============================================================================
+
+constexpr int kAffineInputTensor = 0;
+constexpr int kAffineMulTensor = 1;
+constexpr int kAffineAddTensor = 2;
+constexpr int kAffineOutputTensor = 0;
+
+// Flexbuffer map values are ordered alphabetically by key
+constexpr int kAddActivationOptionIndex = 0;  // "add_activation"
+constexpr int kConstFirstOptionIndex = 1;     // "const_first"
+constexpr int kMidScaleOptionIndex = 2;       // "mid_scale"
+constexpr int kMidTableOptionIndex = 3;       // "mid_table"
+constexpr int kMidZeroPointOptionIndex = 4;   // "mid_zero_point"
+constexpr int kMulActivationOptionIndex = 5;  // "mul_activation"
+
+// The ADD left shift for int8 (add.cpp)
+constexpr int kAddLeftShift = 20;
+
+struct OpDataChannelAffine {
+    // Options
+    TfLiteFusedActivation mul_activation;
+    TfLiteFusedActivation add_activation;
+    bool const_first;
+    bool mid_table;
+    float mid_scale;
+    int32_t mid_zero_point;
+
+    // MUL, as in mul_common.cpp
+    int channels;
+    int32_t input_offset;
+    int32_t mul_multiplier;
+    int mul_shift;
+    int32_t mul_min;
+    int32_t mul_max;
+    int32_t* mul_const;  // Per channel, constant + its offset
+
+    // ADD, as in cmsis_nn/add.cpp. Both ADD inputs are rescaled separately
+    // before the sum: the constant side once per channel, the MUL side per
+    // element or, with mid_table, once per possible int8 value (the rescale
+    // only depends on that value).
+    int32_t* add_const_scaled;  // Per channel
+    int32_t mid_multiplier;
+    int mid_shift;
+    int32_t* mid_scaled;        // [256], indexed by the MUL output - INT8_MIN; or nullptr
+    int32_t output_multiplier;
+    int output_shift;
+    int32_t output_offset;
+    int32_t add_min;
+    int32_t add_max;
+};
+
+void* ChannelAffineInit(TfLiteContext* context, const char* buffer, size_t length) {
+    TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+    void* raw = context->AllocatePersistentBuffer(context, sizeof(OpDataChannelAffine));
+    if (raw == nullptr) return nullptr;
+    OpDataChannelAffine* data = new (raw) OpDataChannelAffine();
+    if (buffer == nullptr || length == 0) {
+        MicroPrintf("%s: missing options", kChannelAffineOpName);
+        return nullptr;
+    }
+    tflite::FlexbufferWrapper wrapper(reinterpret_cast<const uint8_t*>(buffer), length);
+    data->add_activation =
+        static_cast<TfLiteFusedActivation>(wrapper.ElementAsInt32(kAddActivationOptionIndex));
+    data->const_first = wrapper.ElementAsBool(kConstFirstOptionIndex);
+    data->mid_scale = wrapper.ElementAsFloat(kMidScaleOptionIndex);
+    data->mid_table = wrapper.ElementAsBool(kMidTableOptionIndex);
+    data->mid_zero_point = wrapper.ElementAsInt32(kMidZeroPointOptionIndex);
+    data->mul_activation =
+        static_cast<TfLiteFusedActivation>(wrapper.ElementAsInt32(kMulActivationOptionIndex));
+    return data;
+}
+
+TfLiteStatus ChannelAffinePrepare(TfLiteContext* context, TfLiteNode* node) {
+    TF_LITE_ENSURE(context, node->user_data != nullptr);
+    OpDataChannelAffine* data = static_cast<OpDataChannelAffine*>(node->user_data);
+    tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+    TF_LITE_ENSURE_EQ(context, tflite::NumInputs(node), 3);
+    TF_LITE_ENSURE_EQ(context, tflite::NumOutputs(node), 1);
+    TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, kAffineInputTensor);
+    TfLiteTensor* mul_const = micro_context->AllocateTempInputTensor(node, kAffineMulTensor);
+    TfLiteTensor* add_const = micro_context->AllocateTempInputTensor(node, kAffineAddTensor);
+    TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, kAffineOutputTensor);
+    TF_LITE_ENSURE(context, input != nullptr && mul_const != nullptr && add_const != nullptr &&
+                                output != nullptr);
+
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, mul_const->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, add_const->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+    TF_LITE_ENSURE(context, tflite::IsConstantTensor(mul_const));
+    TF_LITE_ENSURE(context, tflite::IsConstantTensor(add_const));
+    const int channels = input->dims->data[input->dims->size - 1];
+    TF_LITE_ENSURE_EQ(context, tflite::NumElements(mul_const), channels);
+    TF_LITE_ENSURE_EQ(context, tflite::NumElements(add_const), channels);
+    TF_LITE_ENSURE_EQ(context, tflite::NumElements(input), tflite::NumElements(output));
+    data->channels = channels;
+
+    // The MUL output only exists as these parameters
+    TfLiteTensor mid;
+    memset(&mid, 0, sizeof(mid));
+    mid.type = kTfLiteInt8;
+    mid.params.scale = data->mid_scale;
+    mid.params.zero_point = data->mid_zero_point;
+    TF_LITE_ENSURE(context, mid.params.scale > 0.0f);
+
+    data->input_offset = -input->params.zero_point;
+    TF_LITE_ENSURE_STATUS(tflite::CalculateActivationRangeQuantized(
+        context, data->mul_activation, &mid, &data->mul_min, &data->mul_max));
+    const double mul_real_multiplier = static_cast<double>(input->params.scale) *
+                                       static_cast<double>(mul_const->params.scale) /
+                                       static_cast<double>(mid.params.scale);
+    tflite::QuantizeMultiplier(mul_real_multiplier, &data->mul_multiplier, &data->mul_shift);
+
+    // ADD input 1/2 follow the original operand order
+    const TfLiteTensor* add_input1 = data->const_first ? add_const : &mid;
+    const TfLiteTensor* add_input2 = data->const_first ? &mid : add_const;
+    const double twice_max_input_scale =
+        2 * static_cast<double>(std::max(add_input1->params.scale, add_input2->params.scale));
+    int32_t input1_multiplier, input2_multiplier;
+    int input1_shift, input2_shift;
+    tflite::QuantizeMultiplierSmallerThanOneExp(
+        static_cast<double>(add_input1->params.scale) / twice_max_input_scale, &input1_multiplier,
+        &input1_shift);
+    tflite::QuantizeMultiplierSmallerThanOneExp(
+        static_cast<double>(add_input2->params.scale) / twice_max_input_scale, &input2_multiplier,
+        &input2_shift);
+    tflite::QuantizeMultiplierSmallerThanOneExp(
+        twice_max_input_scale / ((1 << kAddLeftShift) * static_cast<double>(output->params.scale)),
+        &data->output_multiplier, &data->output_shift);
+    data->output_offset = output->params.zero_point;
+    TF_LITE_ENSURE_STATUS(tflite::CalculateActivationRangeQuantized(
+        context, data->add_activation, output, &data->add_min, &data->add_max));
+
+    const int32_t const_multiplier = data->const_first ? input1_multiplier : input2_multiplier;
+    const int const_shift = data->const_first ? input1_shift : input2_shift;
+    const int32_t mid_offset = -data->mid_zero_point;
+    data->mid_multiplier = data->const_first ? input2_multiplier : input1_multiplier;
+    data->mid_shift = data->const_first ? input2_shift : input1_shift;
+
+    data->mul_const = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, sizeof(int32_t) * channels));
+    data->add_const_scaled = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, sizeof(int32_t) * channels));
+    TF_LITE_ENSURE(context, data->mul_const != nullptr && data->add_const_scaled != nullptr);
+    data->mid_scaled = nullptr;
+    if (data->mid_table) {
+        data->mid_scaled = static_cast<int32_t*>(
+            context->AllocatePersistentBuffer(context, sizeof(int32_t) * 256));
+        TF_LITE_ENSURE(context, data->mid_scaled != nullptr);
+        for (int v = INT8_MIN; v <= INT8_MAX; v++) {
+            data->mid_scaled[v - INT8_MIN] = tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+                (mid_offset + v) * (1 << kAddLeftShift), data->mid_multiplier, data->mid_shift);
+        }
+    }
+    for (int c = 0; c < channels; c++) {
+        data->mul_const[c] = mul_const->data.int8[c] - mul_const->params.zero_point;
+        const int32_t shifted = (add_const->data.int8[c] - add_const->params.zero_point) *
+                                (1 << kAddLeftShift);
+        data->add_const_scaled[c] = tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+            shifted, const_multiplier, const_shift);
+    }
+
+    micro_context->DeallocateTempTfLiteTensor(input);
+    micro_context->DeallocateTempTfLiteTensor(mul_const);
+    micro_context->DeallocateTempTfLiteTensor(add_const);
+    micro_context->DeallocateTempTfLiteTensor(output);
+    return kTfLiteOk;
+}
+
+}  // namespace
+
+// The per-element loop of every fused batch norm. Outside the anonymous
+// namespace so the linker map names it and host_linkmap can check it.
+TfLiteStatus GAINS_HOT ChannelAffineEval(TfLiteContext* context, TfLiteNode* node) {
+    const OpDataChannelAffine* data = static_cast<const OpDataChannelAffine*>(node->user_data);
+    const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, kAffineInputTensor);
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, kAffineOutputTensor);
+
+    const int8_t* in = tflite::micro::GetTensorData<int8_t>(input);
+    int8_t* out = tflite::micro::GetTensorData<int8_t>(output);
+    const int channels = data->channels;
+    const int rows = tflite::micro::GetTensorShape(input).FlatSize() / channels;
+    // Parameters in locals: the int8 stores may alias *data, which would
+    // reload every field per element
+    const int32_t input_offset = data->input_offset;
+    const int32_t* mul_const = data->mul_const;
+    const int32_t mul_multiplier = data->mul_multiplier;
+    const int mul_shift = data->mul_shift;
+    const int32_t mid_zero_point = data->mid_zero_point;
+    const int32_t mul_min = data->mul_min;
+    const int32_t mul_max = data->mul_max;
+    const int32_t* add_const_scaled = data->add_const_scaled;
+    const int32_t mid_multiplier = data->mid_multiplier;
+    const int mid_shift = data->mid_shift;
+    const int32_t* mid_scaled = data->mid_scaled;
+    const int32_t output_multiplier = data->output_multiplier;
+    const int output_shift = data->output_shift;
+    const int32_t output_offset = data->output_offset;
+    const int32_t add_min = data->add_min;
+    const int32_t add_max = data->add_max;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < channels; c++) {
+            // MUL (BroadcastMul4DSlow)
+            const int32_t product = (input_offset + in[c]) * mul_const[c];
+            int32_t mid = mid_zero_point +
+                          tflite::MultiplyByQuantizedMultiplier(product, mul_multiplier, mul_shift);
+            mid = std::min(mul_max, std::max(mul_min, mid));
+
+            // ADD (AddFunc)
+            const int32_t mid_sum =
+                mid_scaled != nullptr
+                    ? mid_scaled[mid - INT8_MIN]
+                    : tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+                          (mid - mid_zero_point) * (1 << kAddLeftShift), mid_multiplier, mid_shift);
+            const int32_t raw_sum = mid_sum + add_const_scaled[c];
+            int32_t result = tflite::MultiplyByQuantizedMultiplierSmallerThanOneExp(
+                                 raw_sum, output_multiplier, output_shift) +
+                             output_offset;
+            result = std::min(add_max, std::max(add_min, result));
+            out[c] = static_cast<int8_t>(result);
+        }
+        in += channels;
+        out += channels;
+    }
+    return kTfLiteOk;
+}
+
+namespace {
+
+// ============================================================================
+// GAINS_CONV_POOL
+// ============================================================================
+
+constexpr int kConvPoolInputTensor = 0;
+constexpr int kConvPoolFilterTensor = 1;
+constexpr int kConvPoolBiasTensor = 2;
+constexpr int kConvPoolOutputTensor = 0;
+
+// Flexbuffer map values are ordered alphabetically by key
+constexpr int kConvActivationOptionIndex = 0;  // "conv_activation"
+constexpr int kConvScaleOptionIndex = 1;       // "conv_scale"
+constexpr int kConvStrideHOptionIndex = 2;     // "conv_stride_h"
+constexpr int kConvStrideWOptionIndex = 3;     // "conv_stride_w"
+constexpr int kConvZeroPointOptionIndex = 4;   // "conv_zero_point"
+constexpr int kPoolActivationOptionIndex = 5;  // "pool_activation"
+constexpr int kPoolFilterHOptionIndex = 6;     // "pool_filter_h"
+constexpr int kPoolFilterWOptionIndex = 7;     // "pool_filter_w"
+constexpr int kPoolStrideHOptionIndex = 8;     // "pool_stride_h"
+constexpr int kPoolStrideWOptionIndex = 9;     // "pool_stride_w"
+
+struct OpDataConvPool {
+    // Options
+    TfLiteFusedActivation conv_activation;
+    float conv_scale;
+    int32_t conv_zero_point;
+    int conv_stride_h;
+    int conv_stride_w;
+    TfLiteFusedActivation pool_activation;
+    int pool_filter_h;
+    int pool_filter_w;
+    int pool_stride_h;
+    int pool_stride_w;
+
+    // Conv, as in cmsis_nn/conv.cpp
+    int32_t* per_channel_multiplier;
+    int32_t* per_channel_shift;
+    int32_t conv_min;
+    int32_t conv_max;
+    int32_t input_offset;
+
+    // One tile = the pool_filter_h conv rows one row of pooling windows reads
+    int conv_width;
+    int tile_input_rows;
+    int tile_buffer_index;
+    int cmsis_buffer_index;  // -1 if the conv kernel needs none
+
+    int32_t pool_min;
+    int32_t pool_max;
+};
+
+void* ConvPoolInit(TfLiteContext* context, const char* buffer, size_t length) {
+    TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+    void* raw = context->AllocatePersistentBuffer(context, sizeof(OpDataConvPool));
+    if (raw == nullptr) return nullptr;
+    OpDataConvPool* data = new (raw) OpDataConvPool();
+    if (buffer == nullptr || length == 0) {
+        MicroPrintf("%s: missing options", kConvPoolOpName);
+        return nullptr;
+    }
+    tflite::FlexbufferWrapper wrapper(reinterpret_cast<const uint8_t*>(buffer), length);
+    data->conv_activation =
+        static_cast<TfLiteFusedActivation>(wrapper.ElementAsInt32(kConvActivationOptionIndex));
+    data->conv_scale = wrapper.ElementAsFloat(kConvScaleOptionIndex);
+    data->conv_stride_h = wrapper.ElementAsInt32(kConvStrideHOptionIndex);
+    data->conv_stride_w = wrapper.ElementAsInt32(kConvStrideWOptionIndex);
+    data->conv_zero_point = wrapper.ElementAsInt32(kConvZeroPointOptionIndex);
+    data->pool_activation =
+        static_cast<TfLiteFusedActivation>(wrapper.ElementAsInt32(kPoolActivationOptionIndex));
+    data->pool_filter_h = wrapper.ElementAsInt32(kPoolFilterHOptionIndex);
+    data->pool_filter_w = wrapper.ElementAsInt32(kPoolFilterWOptionIndex);
+    data->pool_stride_h = wrapper.ElementAsInt32(kPoolStrideHOptionIndex);
+    data->pool_stride_w = wrapper.ElementAsInt32(kPoolStrideWOptionIndex);
+    return data;
+}
+
+void FillConvParams(const OpDataConvPool* data, cmsis_nn_conv_params* conv_params) {
+    conv_params->input_offset = data->input_offset;
+    conv_params->output_offset = data->conv_zero_point;
+    conv_params->stride.h = data->conv_stride_h;
+    conv_params->stride.w = data->conv_stride_w;
+    conv_params->padding.h = 0;
+    conv_params->padding.w = 0;
+    conv_params->dilation.h = 1;
+    conv_params->dilation.w = 1;
+    conv_params->activation.min = data->conv_min;
+    conv_params->activation.max = data->conv_max;
+}
+
+TfLiteStatus ConvPoolPrepare(TfLiteContext* context, TfLiteNode* node) {
+    TF_LITE_ENSURE(context, node->user_data != nullptr);
+    OpDataConvPool* data = static_cast<OpDataConvPool*>(node->user_data);
+    tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+    TF_LITE_ENSURE_EQ(context, tflite::NumInputs(node), 3);
+    TF_LITE_ENSURE_EQ(context, tflite::NumOutputs(node), 1);
+    TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, kConvPoolInputTensor);
+    TfLiteTensor* filter = micro_context->AllocateTempInputTensor(node, kConvPoolFilterTensor);
+    TfLiteTensor* bias = micro_context->AllocateTempInputTensor(node, kConvPoolBiasTensor);
+    TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, kConvPoolOutputTensor);
+    TF_LITE_ENSURE(context, input != nullptr && filter != nullptr && bias != nullptr &&
+                                output != nullptr);
+
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, bias->type, kTfLiteInt32);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, input->dims->size, 4);
+    TF_LITE_ENSURE_EQ(context, filter->dims->size, 4);
+    TF_LITE_ENSURE_EQ(context, output->dims->size, 4);
+    TF_LITE_ENSURE_EQ(context, output->dims->data[0], input->dims->data[0]);
+    TF_LITE_ENSURE(context, data->conv_stride_h > 0 && data->conv_stride_w > 0 &&
+                                data->pool_filter_h > 0 && data->pool_filter_w > 0 &&
+                                data->pool_stride_h > 0 && data->pool_stride_w > 0);
+
+    const int input_h = input->dims->data[1];
+    const int input_w = input->dims->data[2];
+    const int input_c = input->dims->data[3];
+    const int output_c = filter->dims->data[0];
+    const int filter_h = filter->dims->data[1];
+    const int filter_w = filter->dims->data[2];
+    TF_LITE_ENSURE_EQ(context, filter->dims->data[3], input_c);
+    TF_LITE_ENSURE_EQ(context, output->dims->data[3], output_c);
+
+    // VALID conv, then VALID pool
+    const int conv_h = (input_h - filter_h) / data->conv_stride_h + 1;
+    data->conv_width = (input_w - filter_w) / data->conv_stride_w + 1;
+    TF_LITE_ENSURE(context, conv_h >= data->pool_filter_h && data->conv_width >= data->pool_filter_w);
+    TF_LITE_ENSURE_EQ(context, output->dims->data[1],
+                      (conv_h - data->pool_filter_h) / data->pool_stride_h + 1);
+    TF_LITE_ENSURE_EQ(context, output->dims->data[2],
+                      (data->conv_width - data->pool_filter_w) / data->pool_stride_w + 1);
+    data->tile_input_rows = (data->pool_filter_h - 1) * data->conv_stride_h + filter_h;
+
+    // The conv output only exists as these parameters
+    TfLiteTensor conv_output;
+    memset(&conv_output, 0, sizeof(conv_output));
+    conv_output.type = kTfLiteInt8;
+    conv_output.params.scale = data->conv_scale;
+    conv_output.params.zero_point = data->conv_zero_point;
+    TF_LITE_ENSURE(context, conv_output.params.scale > 0.0f);
+
+    data->per_channel_multiplier = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, sizeof(int32_t) * output_c));
+    data->per_channel_shift = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, sizeof(int32_t) * output_c));
+    TF_LITE_ENSURE(context, data->per_channel_multiplier != nullptr &&
+                                data->per_channel_shift != nullptr);
+    int32_t output_multiplier;
+    int output_shift;
+    TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+        context, input, filter, bias, &conv_output, data->conv_activation, &output_multiplier,
+        &output_shift, &data->conv_min, &data->conv_max, data->per_channel_multiplier,
+        data->per_channel_shift, output_c));
+    data->input_offset = -input->params.zero_point;
+    TF_LITE_ENSURE_STATUS(tflite::CalculateActivationRangeQuantized(
+        context, data->pool_activation, output, &data->pool_min, &data->pool_max));
+
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context, data->pool_filter_h * data->conv_width * output_c, &data->tile_buffer_index));
+
+    cmsis_nn_conv_params conv_params;
+    FillConvParams(data, &conv_params);
+    const cmsis_nn_dims input_dims = {1, data->tile_input_rows, input_w, input_c};
+    const cmsis_nn_dims filter_dims = {output_c, filter_h, filter_w, input_c};
+    const cmsis_nn_dims output_dims = {1, data->pool_filter_h, data->conv_width, output_c};
+    const int32_t buffer_size =
+        arm_convolve_wrapper_s8_get_buffer_size(&conv_params, &input_dims, &filter_dims, &output_dims);
+    if (buffer_size > 0) {
+        TF_LITE_ENSURE_STATUS(
+            context->RequestScratchBufferInArena(context, buffer_size, &data->cmsis_buffer_index));
+    } else {
+        data->cmsis_buffer_index = -1;
+    }
+
+    micro_context->DeallocateTempTfLiteTensor(input);
+    micro_context->DeallocateTempTfLiteTensor(filter);
+    micro_context->DeallocateTempTfLiteTensor(bias);
+    micro_context->DeallocateTempTfLiteTensor(output);
+    return kTfLiteOk;
+}
+
+TfLiteStatus ConvPoolEval(TfLiteContext* context, TfLiteNode* node) {
+    const OpDataConvPool* data = static_cast<const OpDataConvPool*>(node->user_data);
+    const TfLiteEvalTensor* input =
+        tflite::micro::GetEvalInput(context, node, kConvPoolInputTensor);
+    const TfLiteEvalTensor* filter =
+        tflite::micro::GetEvalInput(context, node, kConvPoolFilterTensor);
+    const TfLiteEvalTensor* bias = tflite::micro::GetEvalInput(context, node, kConvPoolBiasTensor);
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, kConvPoolOutputTensor);
+
+    const int batches = input->dims->data[0];
+    const int input_h = input->dims->data[1];
+    const int input_w = input->dims->data[2];
+    const int input_c = input->dims->data[3];
+    const int output_c = filter->dims->data[0];
+    const int pooled_h = output->dims->data[1];
+    const int pooled_w = output->dims->data[2];
+
+    cmsis_nn_conv_params conv_params;
+    FillConvParams(data, &conv_params);
+    cmsis_nn_per_channel_quant_params quant_params;
+    quant_params.multiplier = data->per_channel_multiplier;
+    quant_params.shift = data->per_channel_shift;
+    const cmsis_nn_dims input_dims = {1, data->tile_input_rows, input_w, input_c};
+    const cmsis_nn_dims filter_dims = {output_c, filter->dims->data[1], filter->dims->data[2],
+                                       input_c};
+    const cmsis_nn_dims bias_dims = {1, 1, 1, output_c};
+    const cmsis_nn_dims output_dims = {1, data->pool_filter_h, data->conv_width, output_c};
+    cmsis_nn_context ctx;
+    ctx.buf = data->cmsis_buffer_index >= 0
+                  ? context->GetScratchBuffer(context, data->cmsis_buffer_index)
+                  : nullptr;
+    ctx.size = 0;
+    int8_t* tile = static_cast<int8_t*>(context->GetScratchBuffer(context, data->tile_buffer_index));
+
+    const int8_t* in = tflite::micro::GetTensorData<int8_t>(input);
+    const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+    const int32_t* bias_data = tflite::micro::GetOptionalTensorData<int32_t>(bias);
+    int8_t* out = tflite::micro::GetTensorData<int8_t>(output);
+    const size_t input_row_bytes = static_cast<size_t>(input_w) * input_c;
+    // out advances through the batches, in is offset per batch
+    for (int b = 0; b < batches; b++, in += input_h * input_row_bytes) {
+        for (int py = 0; py < pooled_h; py++) {
+            // Conv rows [py * pool_stride_h, + pool_filter_h)
+            const int input_row = py * data->pool_stride_h * data->conv_stride_h;
+            if (arm_convolve_wrapper_s8(&ctx, &conv_params, &quant_params, &input_dims,
+                                        in + input_row * input_row_bytes, &filter_dims,
+                                        filter_data, &bias_dims, bias_data, &output_dims,
+                                        tile) != ARM_CMSIS_NN_SUCCESS) {
+                MicroPrintf("%s: conv failed", kConvPoolOpName);
+                return kTfLiteError;
+            }
+
+            // Max pool over the tile (reference MaxPool: max, then the activation clamp)
+            for (int px = 0; px < pooled_w; px++) {
+                const int8_t* window = tile + px * data->pool_stride_w * output_c;
+                for (int c = 0; c < output_c; c++) {
+                    int8_t max = std::numeric_limits<int8_t>::lowest();
+                    for (int ky = 0; ky < data->pool_filter_h; ky++) {
+                        const int8_t* row = window + ky * data->conv_width * output_c + c;
+                        for (int kx = 0; kx < data->pool_filter_w; kx++) {
+                            max = std::max(max, row[kx * output_c]);
+                        }
+                    }
+                    int32_t value = std::max<int32_t>(max, data->pool_min);
+                    value = std::min<int32_t>(value, data->pool_max);
+                    *out++ = static_cast<int8_t>(value);
+                }
+            }
+        }
+    }
+    return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteRegistration* Register_GAINS_CHANNEL_AFFINE() {
+    static TfLiteRegistration r =
+        tflite::micro::RegisterOp(ChannelAffineInit, ChannelAffinePrepare, ChannelAffineEval,
+                                  nullptr, kTfLiteInplaceOpInput0Shared);
+    return &r;
+}
+
+TfLiteRegistration* Register_GAINS_CONV_POOL() {
+    static TfLiteRegistration r =
+        tflite::micro::RegisterOp(ConvPoolInit, ConvPoolPrepare, ConvPoolEval);
+    return &r;
+}
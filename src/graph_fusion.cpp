@@ -0,0 +1,380 @@
+#include "graph_fusion.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "fused_ops.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "third_party/flatbuffers/include/flatbuffers/flexbuffers.h"
+
+namespace {
+
+// Reader counts of every tensor. Subgraph outputs are kept separately: a
+// tensor the caller reads is never fused away.
+struct TensorUse {
+    std::vector<int> readers;
+    std::vector<int> first_reader;  // Operator index, -1 if none
+    std::vector<bool> graph_output;
+};
+
+tflite::BuiltinOperator OpCode(const tflite::ModelT& model, const tflite::OperatorT& op) {
+    const tflite::OperatorCodeT* code = model.operator_codes[op.opcode_index].get();
+    // Models from older converters only set the deprecated int8 field
+    return static_cast<tflite::BuiltinOperator>(
+        std::max<int32_t>(code->builtin_code, code->deprecated_builtin_code));
+}
+
+TensorUse FindUses(const tflite::SubGraphT& subgraph) {
+    TensorUse use;
+    const size_t count = subgraph.tensors.size();
+    use.readers.assign(count, 0);
+    use.first_reader.assign(count, -1);
+    use.graph_output.assign(count, false);
+    for (size_t i = 0; i < subgraph.operators.size(); i++) {
+        for (int32_t t : subgraph.operators[i]->inputs) {
+            if (t < 0) continue;
+            if (use.readers[t]++ == 0) use.first_reader[t] = static_cast<int>(i);
+        }
+    }
+    for (int32_t t : subgraph.outputs) use.graph_output[t] = true;
+    return use;
+}
+
+// Tensor t is read by exactly one operator and not by the caller
+int SoleReader(const TensorUse& use, int32_t t) {
+    if (use.readers[t] != 1 || use.graph_output[t]) return -1;
+    return use.first_reader[t];
+}
+
+bool SameQuantization(const tflite::TensorT& a, const tflite::TensorT& b) {
+    const tflite::QuantizationParametersT* qa = a.quantization.get();
+    const tflite::QuantizationParametersT* qb = b.quantization.get();
+    const bool a_empty = qa == nullptr || qa->scale.empty();
+    const bool b_empty = qb == nullptr || qb->scale.empty();
+    if (a_empty || b_empty) return a_empty == b_empty;
+    return qa->scale == qb->scale && qa->zero_point == qb->zero_point &&
+           qa->quantized_dimension == qb->quantized_dimension;
+}
+
+bool IsConstant(const tflite::ModelT& model, const tflite::TensorT& tensor) {
+    return tensor.buffer < model.buffers.size() && !model.buffers[tensor.buffer]->data.empty();
+}
+
+int64_t ElementCount(const tflite::TensorT& tensor) {
+    int64_t count = 1;
+    for (int32_t d : tensor.shape) count *= d;
+    return count;
+}
+
+bool HasScale(const tflite::TensorT& tensor) {
+    return tensor.quantization != nullptr && !tensor.quantization->scale.empty() &&
+           !tensor.quantization->zero_point.empty();
+}
+
+// Point every reader of from at to
+void ReplaceInput(tflite::SubGraphT* subgraph, int32_t from, int32_t to) {
+    for (auto& op : subgraph->operators) {
+        for (int32_t& t : op->inputs) {
+            if (t == from) t = to;
+        }
+    }
+}
+
+uint32_t CustomOpcode(tflite::ModelT* model, const char* name) {
+    for (size_t i = 0; i < model->operator_codes.size(); i++) {
+        const tflite::OperatorCodeT* code = model->operator_codes[i].get();
+        if (code->builtin_code == tflite::BuiltinOperator_CUSTOM && code->custom_code == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    std::unique_ptr<tflite::OperatorCodeT> code(new tflite::OperatorCodeT());
+    code->builtin_code = tflite::BuiltinOperator_CUSTOM;
+    code->deprecated_builtin_code = static_cast<int8_t>(tflite::BuiltinOperator_CUSTOM);
+    code->custom_code = name;
+    code->version = 1;
+    model->operator_codes.push_back(std::move(code));
+    return static_cast<uint32_t>(model->operator_codes.size() - 1);
+}
+
+// ============================================================================
+// PATTERNS
+// Each one rewrites the first match it finds starting at operator i and
+// returns true; the caller recomputes tensor uses and starts over.
+// ============================================================================
+
+bool IsShapeOnly(tflite::BuiltinOperator code) {
+    return code == tflite::BuiltinOperator_RESHAPE ||
+           code == tflite::BuiltinOperator_EXPAND_DIMS ||
+           code == tflite::BuiltinOperator_SQUEEZE;
+}
+
+// Shape op pair back to the original shape, DEQUANTIZE -> QUANTIZE round
+// trip, or QUANTIZE to the same parameters
+bool FuseIdentity(tflite::ModelT* model, tflite::SubGraphT* subgraph, const TensorUse& use,
+                  size_t i, GraphFusionReport* report) {
+    tflite::OperatorT* first = subgraph->operators[i].get();
+    const tflite::BuiltinOperator first_code = OpCode(*model, *first);
+    if (first->inputs.empty() || first->outputs.size() != 1 || first->inputs[0] < 0) return false;
+    const int32_t in = first->inputs[0];
+    const int32_t mid = first->outputs[0];
+    const tflite::TensorT& in_tensor = *subgraph->tensors[in];
+    const tflite::TensorT& mid_tensor = *subgraph->tensors[mid];
+
+    if (first_code == tflite::BuiltinOperator_QUANTIZE && !use.graph_output[mid] &&
+        in_tensor.type == mid_tensor.type && SameQuantization(in_tensor, mid_tensor)) {
+        ReplaceInput(subgraph, mid, in);
+        subgraph->operators.erase(subgraph->operators.begin() + i);
+        report->identity_ops += 1;
+        return true;
+    }
+
+    const bool shape_pair = IsShapeOnly(first_code);
+    if (!shape_pair && first_code != tflite::BuiltinOperator_DEQUANTIZE) return false;
+    const int reader = SoleReader(use, mid);
+    if (reader < 0) return false;
+    tflite::OperatorT* second = subgraph->operators[reader].get();
+    const tflite::BuiltinOperator second_code = OpCode(*model, *second);
+    if (shape_pair ? !IsShapeOnly(second_code) : second_code != tflite::BuiltinOperator_QUANTIZE) {
+        return false;
+    }
+    if (second->inputs[0] != mid || second->outputs.size() != 1) return false;
+    const int32_t out = second->outputs[0];
+    const tflite::TensorT& out_tensor = *subgraph->tensors[out];
+    if (use.graph_output[out] || out_tensor.type != in_tensor.type ||
+        out_tensor.shape != in_tensor.shape || !SameQuantization(in_tensor, out_tensor)) {
+        return false;
+    }
+
+    ReplaceInput(subgraph, out, in);
+    subgraph->operators.erase(subgraph->operators.begin() + reader);
+    subgraph->operators.erase(subgraph->operators.begin() + i);
+    report->identity_ops += 2;
+    return true;
+}
+
+// Index (0 or 1) of the int8 constant with count elements among the two
+// inputs of op, -1 if none
+int ConstantInput(const tflite::ModelT& model, const tflite::SubGraphT& subgraph,
+                  const tflite::OperatorT& op, int64_t count) {
+    if (op.inputs.size() != 2) return -1;
+    for (int k = 0; k < 2; k++) {
+        if (op.inputs[k] < 0) return -1;
+        const tflite::TensorT& t = *subgraph.tensors[op.inputs[k]];
+        if (t.type == tflite::TensorType_INT8 && IsConstant(model, t) && ElementCount(t) == count &&
+            HasScale(t)) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// MUL by a per-channel constant, then ADD of a per-channel constant
+bool FuseChannelAffine(tflite::ModelT* model, tflite::SubGraphT* subgraph, const TensorUse& use,
+                       size_t i, GraphFusionReport* report) {
+    tflite::OperatorT* mul = subgraph->operators[i].get();
+    if (OpCode(*model, *mul) != tflite::BuiltinOperator_MUL || mul->outputs.size() != 1) {
+        return false;
+    }
+    const int32_t mid = mul->outputs[0];
+    const tflite::TensorT& mid_tensor = *subgraph->tensors[mid];
+    if (mid_tensor.type != tflite::TensorType_INT8 || mid_tensor.shape.empty() ||
+        !HasScale(mid_tensor)) {
+        return false;
+    }
+    const int64_t channels = mid_tensor.shape.back();
+    const int mul_const = ConstantInput(*model, *subgraph, *mul, channels);
+    if (mul_const < 0) return false;
+    const int32_t x = mul->inputs[1 - mul_const];
+    const tflite::TensorT& x_tensor = *subgraph->tensors[x];
+    // A broadcast MUL: same-shape operands take the CMSIS elementwise kernel,
+    // which the fused op does not reproduce
+    if (x_tensor.type != tflite::TensorType_INT8 || x_tensor.shape != mid_tensor.shape ||
+        ElementCount(x_tensor) <= channels || IsConstant(*model, x_tensor)) {
+        return false;
+    }
+
+    const int reader = SoleReader(use, mid);
+    if (reader < 0) return false;
+    tflite::OperatorT* add = subgraph->operators[reader].get();
+    if (OpCode(*model, *add) != tflite::BuiltinOperator_ADD || add->outputs.size() != 1) {
+        return false;
+    }
+    const int add_const = ConstantInput(*model, *subgraph, *add, channels);
+    if (add_const < 0 || add->inputs[1 - add_const] != mid) return false;
+    const tflite::TensorT& out_tensor = *subgraph->tensors[add->outputs[0]];
+    if (out_tensor.type != tflite::TensorType_INT8 || out_tensor.shape != mid_tensor.shape) {
+        return false;
+    }
+
+    // ActivationFunctionType and TfLiteFusedActivation share their values
+    const tflite::MulOptionsT* mul_options = mul->builtin_options.AsMulOptions();
+    const tflite::AddOptionsT* add_options = add->builtin_options.AsAddOptions();
+    flexbuffers::Builder fbb;
+    const size_t map = fbb.StartMap();
+    fbb.Int("add_activation", add_options ? add_options->fused_activation_function : 0);
+    fbb.Bool("const_first", add_const == 0);
+    fbb.Float("mid_scale", mid_tensor.quantization->scale[0]);
+    fbb.Bool("mid_table", ElementCount(mid_tensor) >= kChannelAffineTableMinElements);
+    fbb.Int("mid_zero_point", mid_tensor.quantization->zero_point[0]);
+    fbb.Int("mul_activation", mul_options ? mul_options->fused_activation_function : 0);
+    fbb.EndMap(map);
+    fbb.Finish();
+
+    std::unique_ptr<tflite::OperatorT> fused(new tflite::OperatorT());
+    fused->opcode_index = CustomOpcode(model, kChannelAffineOpName);
+    fused->inputs = {x, mul->inputs[mul_const], add->inputs[add_const]};
+    fused->outputs = add->outputs;
+    fused->custom_options = fbb.GetBuffer();
+    fused->custom_options_format = tflite::CustomOptionsFormat_FLEXBUFFERS;
+    subgraph->operators.erase(subgraph->operators.begin() + reader);
+    subgraph->operators[i] = std::move(fused);
+    report->channel_affine++;
+    return true;
+}
+
+// VALID CONV_2D, then a VALID MAX_POOL_2D as its only reader
+bool FuseConvPool(tflite::ModelT* model, tflite::SubGraphT* subgraph, const TensorUse& use,
+                  size_t i, GraphFusionReport* report) {
+    tflite::OperatorT* conv = subgraph->operators[i].get();
+    if (OpCode(*model, *conv) != tflite::BuiltinOperator_CONV_2D || conv->inputs.size() != 3 ||
+        conv->outputs.size() != 1 || conv->inputs[2] < 0) {
+        return false;
+    }
+    const tflite::Conv2DOptionsT* conv_options = conv->builtin_options.AsConv2DOptions();
+    if (conv_options == nullptr || conv_options->padding != tflite::Padding_VALID ||
+        conv_options->dilation_w_factor != 1 || conv_options->dilation_h_factor != 1) {
+        return false;
+    }
+    const tflite::TensorT& in_tensor = *subgraph->tensors[conv->inputs[0]];
+    const tflite::TensorT& filter_tensor = *subgraph->tensors[conv->inputs[1]];
+    const tflite::TensorT& conv_tensor = *subgraph->tensors[conv->outputs[0]];
+    if (in_tensor.type != tflite::TensorType_INT8 || in_tensor.shape.size() != 4 ||
+        in_tensor.shape[0] != 1 || filter_tensor.type != tflite::TensorType_INT8 ||
+        !IsConstant(*model, filter_tensor) || conv_tensor.type != tflite::TensorType_INT8 ||
+        !HasScale(conv_tensor)) {
+        return false;
+    }
+
+    const int reader = SoleReader(use, conv->outputs[0]);
+    if (reader < 0) return false;
+    tflite::OperatorT* pool = subgraph->operators[reader].get();
+    if (OpCode(*model, *pool) != tflite::BuiltinOperator_MAX_POOL_2D || pool->outputs.size() != 1) {
+        return false;
+    }
+    const tflite::Pool2DOptionsT* pool_options = pool->builtin_options.AsPool2DOptions();
+    if (pool_options == nullptr || pool_options->padding != tflite::Padding_VALID ||
+        subgraph->tensors[pool->outputs[0]]->type != tflite::TensorType_INT8) {
+        return false;
+    }
+
+    flexbuffers::Builder fbb;
+    const size_t map = fbb.StartMap();
+    fbb.Int("conv_activation", conv_options->fused_activation_function);
+    fbb.Float("conv_scale", conv_tensor.quantization->scale[0]);
+    fbb.Int("conv_stride_h", conv_options->stride_h);
+    fbb.Int("conv_stride_w", conv_options->stride_w);
+    fbb.Int("conv_zero_point", conv_tensor.quantization->zero_point[0]);
+    fbb.Int("pool_activation", pool_options->fused_activation_function);
+    fbb.Int("pool_filter_h", pool_options->filter_height);
+    fbb.Int("pool_filter_w", pool_options->filter_width);
+    fbb.Int("pool_stride_h", pool_options->stride_h);
+    fbb.Int("pool_stride_w", pool_options->stride_w);
+    fbb.EndMap(map);
+    fbb.Finish();
+
+    std::unique_ptr<tflite::OperatorT> fused(new tflite::OperatorT());
+    fused->opcode_index = CustomOpcode(model, kConvPoolOpName);
+    fused->inputs = conv->inputs;
+    fused->outputs = pool->outputs;
+    fused->custom_options = fbb.GetBuffer();
+    fused->custom_options_format = tflite::CustomOptionsFormat_FLEXBUFFERS;
+    subgraph->operators.erase(subgraph->operators.begin() + reader);
+    subgraph->operators[i] = std::move(fused);
+    report->conv_pool++;
+    return true;
+}
+
+// Drop tensors no operator or subgraph input/output refers to any more
+void CompactTensors(tflite::ModelT* model, tflite::SubGraphT* subgraph) {
+    const size_t count = subgraph->tensors.size();
+    std::vector<bool> used(count, false);
+    for (const auto& op : subgraph->operators) {
+        for (int32_t t : op->inputs) if (t >= 0) used[t] = true;
+        for (int32_t t : op->outputs) if (t >= 0) used[t] = true;
+        for (int32_t t : op->intermediates) if (t >= 0) used[t] = true;
+    }
+    for (int32_t t : subgraph->inputs) used[t] = true;
+    for (int32_t t : subgraph->outputs) used[t] = true;
+
+    std::vector<int32_t> remap(count, -1);
+    std::vector<std::unique_ptr<tflite::TensorT>> kept;
+    for (size_t t = 0; t < count; t++) {
+        if (!used[t]) continue;
+        remap[t] = static_cast<int32_t>(kept.size());
+        kept.push_back(std::move(subgraph->tensors[t]));
+    }
+    subgraph->tensors = std::move(kept);
+
+    auto apply = [&remap](std::vector<int32_t>& indices) {
+        for (int32_t& t : indices) {
+            if (t >= 0) t = remap[t];
+        }
+    };
+    for (auto& op : subgraph->operators) {
+        apply(op->inputs);
+        apply(op->outputs);
+        apply(op->intermediates);
+    }
+    apply(subgraph->inputs);
+    apply(subgraph->outputs);
+    for (auto& signature : model->signature_defs) {
+        for (auto& map : signature->inputs) map->tensor_index = remap[map->tensor_index];
+        for (auto& map : signature->outputs) map->tensor_index = remap[map->tensor_index];
+    }
+}
+
+}  // namespace
+
+bool FuseModel(const unsigned char* model_data, std::vector<uint8_t>* fused,
+               GraphFusionReport* report) {
+    memset(report, 0, sizeof(*report));
+    fused->clear();
+    std::unique_ptr<tflite::ModelT> model(tflite::GetModel(model_data)->UnPack());
+    if (model->subgraphs.size() != 1) {
+        MicroPrintf("Graph fusion: %d subgraphs, only single-subgraph models are supported",
+                    static_cast<int>(model->subgraphs.size()));
+        return false;
+    }
+    tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+    report->ops_before = static_cast<int>(subgraph->operators.size());
+    report->tensors_before = static_cast<int>(subgraph->tensors.size());
+
+    // Identities first, they can hide a fusable pair from each other
+    typedef bool (*Pattern)(tflite::ModelT*, tflite::SubGraphT*, const TensorUse&, size_t,
+                            GraphFusionReport*);
+    const Pattern patterns[] = {FuseIdentity, FuseChannelAffine, FuseConvPool};
+    for (Pattern pattern : patterns) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const TensorUse use = FindUses(*subgraph);
+            for (size_t i = 0; i < subgraph->operators.size() && !changed; i++) {
+                changed = pattern(model.get(), subgraph, use, i, report);
+            }
+        }
+    }
+    CompactTensors(model.get(), subgraph);
+    report->ops_after = static_cast<int>(subgraph->operators.size());
+    report->tensors_after = static_cast<int>(subgraph->tensors.size());
+
+    // The TFLM copy of flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(16 * 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    model.reset();  // Keep the heap peak at builder + one model
+    fused->assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    return true;
+}
@@ -0,0 +1,119 @@
+#include "idle_mode.h"
+
+#include <Arduino.h>
+
+#include "imu_provider.h"
+
+// ============================================================================
+// CONSTRUCTOR / RESET
+// ============================================================================
+
+IdleMode::IdleMode(const IdleModeConfig& config)
+    : config_(config),
+      wake_config_(ImuWakeConfigFor(config.wom_threshold_g, config.wom_period_ms)),
+      filter_(nullptr),
+      stats_() {
+    Reset(0, nullptr);
+}
+
+void IdleMode::Reset(uint32_t now_ms, const ImuFilterConfig* filter) {
+    filter_ = filter;
+    asleep_ = false;
+    last_activity_ms_ = now_ms;
+    sleep_start_ms_ = now_ms;
+    has_last_accel_ = false;
+    for (int axis = 0; axis < 3; axis++) {
+        rest_accel_[axis] = axis == 2 ? 1.0f : 0.0f;
+        rest_gyro_[axis] = 0.0f;
+    }
+}
+
+// ============================================================================
+// AWAKE
+// ============================================================================
+
+void IdleMode::OnActivity(uint32_t now_ms) {
+    last_activity_ms_ = now_ms;
+}
+
+void IdleMode::OnSample(uint32_t now_ms, const float* raw_accel, const float* raw_gyro) {
+    // The threshold on the IMU's 4 mg grid, so awake and asleep agree
+    if (has_last_accel_ &&
+        IsMovementDetected(raw_accel, last_accel_, wake_config_.threshold_g)) {
+        last_activity_ms_ = now_ms;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        last_accel_[axis] = raw_accel[axis];
+        rest_accel_[axis] = raw_accel[axis];
+        rest_gyro_[axis] = raw_gyro[axis];
+    }
+    has_last_accel_ = true;
+}
+
+bool IdleMode::ShouldSleep(uint32_t now_ms) const {
+    return !asleep_ && now_ms - last_activity_ms_ >= config_.sleep_after_ms;
+}
+
+bool IdleMode::Sleep(uint32_t now_ms) {
+    if (!EnterImuWakeOnMotion(wake_config_)) {
+        stats_.errors++;
+        last_activity_ms_ = now_ms;
+        return false;
+    }
+    asleep_ = true;
+    sleep_start_ms_ = now_ms;
+    stats_.sleeps++;
+    Serial.printf("[IDLE] Sleeping: wake-on-motion %.3f g at %.1f Hz\n", wake_config_.threshold_g,
+                  wake_config_.odr_hz);
+    return true;
+}
+
+// ============================================================================
+// ASLEEP
+// ============================================================================
+
+bool IdleMode::Poll(uint32_t now_ms, bool button) {
+    if (!asleep_) return true;
+    stats_.polls++;
+
+    bool motion = false;
+    float accel[3];
+    const bool status_ok = ReadImuWakeStatus(&motion, accel);
+    if (status_ok && !motion) {
+        // Still at rest: the orientation to prime with
+        for (int axis = 0; axis < 3; axis++) {
+            rest_accel_[axis] = accel[axis];
+        }
+    }
+    if (!status_ok) {
+        // Better awake than stuck asleep
+        stats_.errors++;
+    } else if (motion) {
+        stats_.motion_wakes++;
+    } else if (button) {
+        stats_.button_wakes++;
+    } else {
+        return false;
+    }
+
+    Wake(now_ms);
+    Serial.printf("[IDLE] Awake after %lu ms (%s)\n",
+                  static_cast<unsigned long>(now_ms - sleep_start_ms_),
+                  !status_ok ? "IMU error" : motion ? "motion" : "button");
+    return true;
+}
+
+void IdleMode::RestSample(float* accel, float* gyro) const {
+    for (int axis = 0; axis < 3; axis++) {
+        accel[axis] = rest_accel_[axis];
+        gyro[axis] = rest_gyro_[axis];
+    }
+}
+
+void IdleMode::Wake(uint32_t now_ms) {
+    if (!ExitImuWakeOnMotion(filter_)) stats_.errors++;
+    asleep_ = false;
+    stats_.asleep_ms += now_ms - sleep_start_ms_;
+    last_activity_ms_ = now_ms;
+    has_last_accel_ = false;
+}
@@ -0,0 +1,67 @@
+#include "imu_config.h"
+
+#include <cmath>
+
+#include "model_config.h"
+
+namespace {
+
+// 3 dB bandwidth per DLPF_CFG / A_DLPF_CFG value 0-6 (ICM-20600 datasheet,
+// FCHOICE_B = 0). 7 is a wide-band setting and never selected.
+constexpr int kDlpfSettings = 7;
+const float kGyroBandwidthHz[kDlpfSettings] = {250.0f, 176.0f, 92.0f, 41.0f, 20.0f, 10.0f, 5.0f};
+const float kAccelBandwidthHz[kDlpfSettings] = {218.1f, 218.1f, 99.0f, 44.8f,
+                                                21.2f,  10.2f,  5.1f};
+
+// Closest on a log scale, so 10 Hz picks 10.2 Hz rather than 5.1 Hz
+uint8_t ClosestSetting(const float* bandwidths, float requested_hz) {
+    if (requested_hz <= 0.0f) requested_hz = bandwidths[kDlpfSettings - 1];
+    uint8_t best = 0;
+    float best_distance = fabsf(logf(bandwidths[0] / requested_hz));
+    for (uint8_t cfg = 1; cfg < kDlpfSettings; cfg++) {
+        const float distance = fabsf(logf(bandwidths[cfg] / requested_hz));
+        if (distance < best_distance) {
+            best = cfg;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+ImuFilterConfig ImuFilterConfigFor(uint32_t sample_period_ms, float accel_bandwidth_hz,
+                                   float gyro_bandwidth_hz) {
+    if (sample_period_ms < 1) sample_period_ms = 1;
+    if (sample_period_ms > 256) sample_period_ms = 256;
+
+    ImuFilterConfig config;
+    config.smplrt_div = static_cast<uint8_t>(sample_period_ms - 1);
+    config.odr_hz = 1000.0f / (1 + config.smplrt_div);
+    const uint8_t accel_cfg = ClosestSetting(kAccelBandwidthHz, accel_bandwidth_hz);
+    const uint8_t gyro_cfg = ClosestSetting(kGyroBandwidthHz, gyro_bandwidth_hz);
+    config.config = gyro_cfg;          // EXT_SYNC_SET = 0, FIFO_MODE = 0
+    config.accel_config2 = accel_cfg;  // DEC2_CFG = 0, ACCEL_FCHOICE_B = 0
+    config.accel_bandwidth_hz = kAccelBandwidthHz[accel_cfg];
+    config.gyro_bandwidth_hz = kGyroBandwidthHz[gyro_cfg];
+    return config;
+}
+
+ImuFilterConfig ModelImuFilterConfig() {
+    return ImuFilterConfigFor(SAMPLE_PERIOD_MS, IMU_ACCEL_DLPF_HZ, IMU_GYRO_DLPF_HZ);
+}
+
+ImuWakeConfig ImuWakeConfigFor(float threshold_g, uint32_t sample_period_ms) {
+    if (sample_period_ms < 1) sample_period_ms = 1;
+    if (sample_period_ms > 256) sample_period_ms = 256;
+    float lsb = roundf(threshold_g / IMU_WOM_LSB_G);
+    if (lsb < 1.0f) lsb = 1.0f;
+    if (lsb > 255.0f) lsb = 255.0f;
+
+    ImuWakeConfig config;
+    config.threshold_lsb = static_cast<uint8_t>(lsb);
+    config.smplrt_div = static_cast<uint8_t>(sample_period_ms - 1);
+    config.threshold_g = config.threshold_lsb * IMU_WOM_LSB_G;
+    config.odr_hz = 1000.0f / (1 + config.smplrt_div);
+    return config;
+}
@@ -0,0 +1,169 @@
+#include "imu_filter_op.h"
+
+#include <cstring>
+#include <new>
+
+#include "model_config.h"
+#include "preprocessing.h"
+#include "pushup_inference.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace {
+
+constexpr int kRawInputTensor = 0;
+constexpr int kNewSamplesTensor = 1;
+constexpr int kOutputTensor = 0;
+
+// Flexbuffer map values are ordered alphabetically by key
+constexpr int kMeanOptionIndex = 0;  // "mean"
+constexpr int kStdOptionIndex = 1;   // "std"
+
+struct OpDataImuFilter {
+    Preprocessor preprocessor;
+    float input_scale[NUM_CHANNELS];  // Per-channel dequantization of the raw input
+    float mean[NUM_CHANNELS];
+    float std[NUM_CHANNELS];
+    float output_scale;
+    int output_zero_point;
+    int window_size;
+    float (*filtered)[NUM_CHANNELS];  // Ring of filtered samples, window_size long
+    int head;                         // Next ring slot to write
+};
+
+bool ReadFloatVector(const flexbuffers::Reference& ref, float* out, int count) {
+    if (ref.IsTypedVector() || ref.IsFixedTypedVector()) {
+        const flexbuffers::TypedVector v = ref.AsTypedVector();
+        if (static_cast<int>(v.size()) != count) return false;
+        for (int i = 0; i < count; i++) out[i] = v[i].AsFloat();
+        return true;
+    }
+    const flexbuffers::Vector v = ref.AsVector();
+    if (static_cast<int>(v.size()) != count) return false;
+    for (int i = 0; i < count; i++) out[i] = v[i].AsFloat();
+    return true;
+}
+
+void* ImuFilterInit(TfLiteContext* context, const char* buffer, size_t length) {
+    TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+    void* raw = context->AllocatePersistentBuffer(context, sizeof(OpDataImuFilter));
+    if (raw == nullptr) return nullptr;
+    OpDataImuFilter* data = new (raw) OpDataImuFilter();
+
+    // Defaults: the normalization the firmware uses
+    memcpy(data->mean, imu_mean, sizeof(data->mean));
+    memcpy(data->std, imu_std, sizeof(data->std));
+    if (buffer != nullptr && length > 0) {
+        tflite::FlexbufferWrapper wrapper(reinterpret_cast<const uint8_t*>(buffer), length);
+        if (!ReadFloatVector(wrapper[kMeanOptionIndex], data->mean, NUM_CHANNELS) ||
+            !ReadFloatVector(wrapper[kStdOptionIndex], data->std, NUM_CHANNELS)) {
+            MicroPrintf("%s: mean/std options must have %d values", kImuFilterOpName,
+                        NUM_CHANNELS);
+            return nullptr;
+        }
+    }
+    return data;
+}
+
+TfLiteStatus ImuFilterPrepare(TfLiteContext* context, TfLiteNode* node) {
+    TF_LITE_ENSURE(context, node->user_data != nullptr);
+    OpDataImuFilter* data = static_cast<OpDataImuFilter*>(node->user_data);
+    tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+    TF_LITE_ENSURE_EQ(context, tflite::NumInputs(node), 2);
+    TF_LITE_ENSURE_EQ(context, tflite::NumOutputs(node), 1);
+    TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, kRawInputTensor);
+    TfLiteTensor* new_samples = micro_context->AllocateTempInputTensor(node, kNewSamplesTensor);
+    TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+    TF_LITE_ENSURE(context, input != nullptr && new_samples != nullptr && output != nullptr);
+
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt16);
+    TF_LITE_ENSURE_TYPES_EQ(context, new_samples->type, kTfLiteInt32);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, input->dims->size, 3);
+    TF_LITE_ENSURE_EQ(context, input->dims->data[0], 1);
+    TF_LITE_ENSURE_EQ(context, input->dims->data[2], NUM_CHANNELS);
+    TF_LITE_ENSURE_EQ(context, tflite::NumElements(input), tflite::NumElements(output));
+    TF_LITE_ENSURE_EQ(context, tflite::NumElements(new_samples), 1);
+
+    // Raw input: one scale per channel (or one for all), zero point 0
+    TF_LITE_ENSURE_EQ(context, input->quantization.type, kTfLiteAffineQuantization);
+    const auto* input_params =
+        static_cast<const TfLiteAffineQuantization*>(input->quantization.params);
+    TF_LITE_ENSURE(context, input_params != nullptr && input_params->scale != nullptr);
+    const int num_scales = input_params->scale->size;
+    TF_LITE_ENSURE(context, num_scales == 1 || num_scales == NUM_CHANNELS);
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        data->input_scale[ch] = input_params->scale->data[num_scales == 1 ? 0 : ch];
+    }
+
+    data->output_scale = output->params.scale;
+    data->output_zero_point = output->params.zero_point;
+    data->window_size = input->dims->data[1];
+    data->filtered = static_cast<float(*)[NUM_CHANNELS]>(context->AllocatePersistentBuffer(
+        context, sizeof(float) * NUM_CHANNELS * data->window_size));
+    TF_LITE_ENSURE(context, data->filtered != nullptr);
+    memset(data->filtered, 0, sizeof(float) * NUM_CHANNELS * data->window_size);
+    data->head = 0;
+    data->preprocessor.Init();
+
+    micro_context->DeallocateTempTfLiteTensor(input);
+    micro_context->DeallocateTempTfLiteTensor(new_samples);
+    micro_context->DeallocateTempTfLiteTensor(output);
+    return kTfLiteOk;
+}
+
+TfLiteStatus ImuFilterEval(TfLiteContext* context, TfLiteNode* node) {
+    OpDataImuFilter* data = static_cast<OpDataImuFilter*>(node->user_data);
+    const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, kRawInputTensor);
+    const TfLiteEvalTensor* new_samples =
+        tflite::micro::GetEvalInput(context, node, kNewSamplesTensor);
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+    const int window = data->window_size;
+    const int16_t* raw = tflite::micro::GetTensorData<int16_t>(input);
+    int count = tflite::micro::GetTensorData<int32_t>(new_samples)[0];
+    if (count < 0 || count > window) {
+        // Start of a recording: same as Preprocessor::Reset() + empty window.
+        // Samples older than the window are gone, so the filters cannot
+        // continue over a longer gap either.
+        data->preprocessor.Reset();
+        memset(data->filtered, 0, sizeof(float) * NUM_CHANNELS * window);
+        data->head = 0;
+        count = window;
+    }
+
+    // Filter only the new samples, continuing the filter state
+    for (int t = window - count; t < window; t++) {
+        const int16_t* q = raw + t * NUM_CHANNELS;
+        float sample[NUM_CHANNELS];
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            sample[ch] = q[ch] * data->input_scale[ch];
+        }
+        data->preprocessor.ProcessSample(&sample[0], &sample[3], data->filtered[data->head]);
+        data->head = (data->head + 1) % window;
+    }
+
+    // Normalize oldest first and quantize, exactly like NormalizeWindow/QuantizeWindow
+    int8_t* out = tflite::micro::GetTensorData<int8_t>(output);
+    for (int t = 0; t < window; t++) {
+        const float* sample = data->filtered[(data->head + t) % window];
+        float normalized[NUM_CHANNELS];
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            normalized[ch] = (sample[ch] - data->mean[ch]) / (data->std[ch] + 1e-8f);
+        }
+        QuantizeValues(normalized, NUM_CHANNELS, data->output_scale, data->output_zero_point,
+                       out + t * NUM_CHANNELS);
+    }
+    return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteRegistration* Register_GAINS_IMU_FILTER() {
+    static TfLiteRegistration r =
+        tflite::micro::RegisterOp(ImuFilterInit, ImuFilterPrepare, ImuFilterEval);
+    return &r;
+}
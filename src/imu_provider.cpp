@@ -135,6 +135,13 @@ bool SetupIMU() {
         ESP_LOGE(TAG, "Failed to enable sensors");
         return false;
     }
+
+    // DATA_RDY in INT_STATUS, for ReadIMU()'s fresh flag (INT is not wired)
+    ret = i2c_write_byte(kIMU_Address, ICM20600_Regs::INT_ENABLE, 0x01);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable data ready status");
+        return false;
+    }
     
     vTaskDelay(pdMS_TO_TICKS(100));
     
@@ -142,15 +149,120 @@ bool SetupIMU() {
     return true;
 }
 
-bool ReadIMU(float* accel_data, float* gyro_data) {
-    uint8_t raw_data[14];
+// Filter registers only, for ConfigureImuFilter() and ExitImuWakeOnMotion()
+static bool WriteFilterRegisters(const ImuFilterConfig& config) {
+    // Gyro FCHOICE_B (GYRO_CONFIG bits 1:0) is already 0 from SetupIMU()
+    esp_err_t ret = i2c_write_byte(kIMU_Address, ICM20600_Regs::CONFIG, config.config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure gyro DLPF");
+        return false;
+    }
+    ret = i2c_write_byte(kIMU_Address, ICM20600_Regs::ACCEL_CONFIG2, config.accel_config2);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure accel DLPF");
+        return false;
+    }
+    ret = i2c_write_byte(kIMU_Address, ICM20600_Regs::SMPLRT_DIV, config.smplrt_div);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set sample rate divider");
+        return false;
+    }
+    return true;
+}
+
+bool ConfigureImuFilter(const ImuFilterConfig& config) {
+    if (!WriteFilterRegisters(config)) return false;
+
+    // Let the filters settle on the new rate
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    Serial.printf("[IMU] ODR %.1f Hz, DLPF accel %.1f Hz, gyro %.1f Hz\n", config.odr_hz,
+                  config.accel_bandwidth_hz, config.gyro_bandwidth_hz);
+    return true;
+}
+
+bool EnterImuWakeOnMotion(const ImuWakeConfig& config) {
+    // Register and value, in the order of the datasheet's WOM sequence
+    const uint8_t sequence[][2] = {
+        {ICM20600_Regs::PWR_MGMT_1, 0x00},        // Awake, cycle off while configuring
+        {ICM20600_Regs::PWR_MGMT_2, 0x07},        // Accel on, gyro standby
+        {ICM20600_Regs::ACCEL_CONFIG2, 0x01},     // Low-power filter, no averaging
+        {ICM20600_Regs::INT_PIN_CFG, 0x20},       // Active high, latched, cleared by INT_STATUS read
+        {ICM20600_Regs::INT_ENABLE, 0xE0},        // WOM on X, Y and Z
+        {ICM20600_Regs::ACCEL_WOM_X_THR, config.threshold_lsb},
+        {ICM20600_Regs::ACCEL_WOM_Y_THR, config.threshold_lsb},
+        {ICM20600_Regs::ACCEL_WOM_Z_THR, config.threshold_lsb},
+        {ICM20600_Regs::ACCEL_INTEL_CTRL, 0xC0},  // WOM on, compare with previous sample
+        {ICM20600_Regs::SMPLRT_DIV, config.smplrt_div},
+        {ICM20600_Regs::PWR_MGMT_1, 0x20},        // CYCLE: accel low-power mode
+    };
+    for (const auto& write : sequence) {
+        if (i2c_write_byte(kIMU_Address, write[0], write[1]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to enter wake-on-motion (register 0x%02X)", write[0]);
+            return false;
+        }
+    }
+
+    // Drop anything latched while configuring
+    bool motion;
+    return ReadImuWakeStatus(&motion);
+}
+
+bool ReadImuWakeStatus(bool* motion, float* accel_data) {
+    uint8_t raw_data[7];
+    const size_t len = accel_data != nullptr ? 7 : 1;
+    if (i2c_read_bytes(kIMU_Address, ICM20600_Regs::INT_STATUS, raw_data, len) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read interrupt status");
+        return false;
+    }
+    *motion = (raw_data[0] & 0xE0) != 0;
+    if (accel_data != nullptr) {
+        // ±2g as in ReadIMU()
+        constexpr float accel_scale = 2.0f / 32768.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            accel_data[axis] =
+                (int16_t)((raw_data[1 + 2 * axis] << 8) | raw_data[2 + 2 * axis]) * accel_scale;
+        }
+    }
+    return true;
+}
+
+bool ExitImuWakeOnMotion(const ImuFilterConfig* filter) {
+    const uint8_t sequence[][2] = {
+        {ICM20600_Regs::INT_ENABLE, 0x01},  // DATA_RDY only, as SetupIMU()
+        {ICM20600_Regs::ACCEL_INTEL_CTRL, 0x00},
+        {ICM20600_Regs::PWR_MGMT_1, 0x00},  // Cycle off
+        {ICM20600_Regs::PWR_MGMT_2, 0x00},  // Gyro on
+    };
+    for (const auto& write : sequence) {
+        if (i2c_write_byte(kIMU_Address, write[0], write[1]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to leave wake-on-motion (register 0x%02X)", write[0]);
+            return false;
+        }
+    }
+    const ImuFilterConfig reset_defaults = {0, 0, 0, 1000.0f, 218.1f, 250.0f};
+    if (!WriteFilterRegisters(filter != nullptr ? *filter : reset_defaults)) return false;
+
+    // Gyro start-up
+    vTaskDelay(pdMS_TO_TICKS(IMU_GYRO_STARTUP_MS));
+    return true;
+}
+
+bool ReadIMU(float* accel_data, float* gyro_data, bool* fresh) {
+    uint8_t status_and_data[15];
     
-    // Read all sensor data at once (burst read)
-    esp_err_t ret = i2c_read_bytes(kIMU_Address, ICM20600_Regs::ACCEL_XOUT_H, raw_data, 14);
+    // Read all sensor data at once (burst read), from INT_STATUS if asked
+    // for the DATA_RDY bit (ACCEL_XOUT_H follows INT_STATUS)
+    const uint8_t first_reg = fresh != nullptr ? ICM20600_Regs::INT_STATUS : ICM20600_Regs::ACCEL_XOUT_H;
+    uint8_t* raw_data = fresh != nullptr ? status_and_data + 1 : status_and_data;
+    esp_err_t ret = i2c_read_bytes(kIMU_Address, first_reg, status_and_data, fresh != nullptr ? 15 : 14);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read IMU data");
         return false;
     }
+    if (fresh != nullptr) {
+        *fresh = (status_and_data[0] & 0x01) != 0;
+    }
     
     // Parse accelerometer data (±4g range)
     int16_t accel_x = (int16_t)((raw_data[0] << 8) | raw_data[1]);
@@ -180,7 +292,15 @@ bool ReadIMU(float* accel_data, float* gyro_data) {
     return true;
 }
 
-bool IsMovementDetected(const float* accel_data) {
+bool IsMovementDetected(const float* accel_data, const float* reference, float threshold_g) {
+    if (reference != nullptr) {
+        // Per-axis change, like the wake-on-motion comparison
+        for (int axis = 0; axis < 3; axis++) {
+            if (fabsf(accel_data[axis] - reference[axis]) > threshold_g) return true;
+        }
+        return false;
+    }
+
     // Calculate magnitude of acceleration vector
     float magnitude = sqrtf(accel_data[0] * accel_data[0] + 
                            accel_data[1] * accel_data[1] + 
@@ -189,5 +309,5 @@ bool IsMovementDetected(const float* accel_data) {
     // Detect if magnitude deviates significantly from 1g (gravity)
     float deviation = fabsf(magnitude - 1.0f);
     
-    return deviation > kAccelThreshold;
+    return deviation > threshold_g;
 }
@@ -0,0 +1,132 @@
+#include "imu_spectral_frontend.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/window_util.h"
+
+namespace {
+constexpr int kSampleRateHz = 1000 / SAMPLE_PERIOD_MS;
+constexpr float kAccelToInt16 = 8192.0f;  // 1/8192 g per LSB, gravity-free accel fits +-4 g
+constexpr float kGyroToInt16 = 128.0f;    // 1/128 deg/s per LSB, +-256 deg/s
+constexpr int kLogScaleShift = 6;         // LogScaleApply output is ln(x) * 2^6
+constexpr float kLogScale = 1.0f / (1 << kLogScaleShift);
+
+int16_t ToInt16(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled > 32767.0f) scaled = 32767.0f;
+    if (scaled < -32768.0f) scaled = -32768.0f;
+    return static_cast<int16_t>(scaled);
+}
+}  // namespace
+
+// ============================================================================
+// CONSTRUCTOR / INIT / RESET
+// ============================================================================
+
+ImuSpectralFrontend::ImuSpectralFrontend() : frame_head_(0), frame_count_(0), initialized_(false) {
+    memset(channels_, 0, sizeof(channels_));
+    memset(frames_, 0, sizeof(frames_));
+    log_scale_.enable_log = 1;
+    log_scale_.scale_shift = kLogScaleShift;
+}
+
+ImuSpectralFrontend::~ImuSpectralFrontend() {
+    if (!initialized_) return;
+    for (ChannelState& channel : channels_) {
+        WindowFreeStateContents(&channel.window);
+        FftFreeStateContents(&channel.fft);
+        FilterbankFreeStateContents(&channel.filterbank);
+    }
+}
+
+bool ImuSpectralFrontend::Init() {
+    if (initialized_) return true;
+
+    WindowConfig window_config;
+    window_config.size_ms = SPECTRAL_WINDOW_MS;
+    window_config.step_size_ms = SPECTRAL_STEP_MS;
+
+    FilterbankConfig filterbank_config;
+    FilterbankFillConfigWithDefaults(&filterbank_config);
+    filterbank_config.num_channels = SPECTRAL_NUM_BANDS;
+    filterbank_config.lower_band_limit = SPECTRAL_LOWER_HZ;
+    filterbank_config.upper_band_limit = SPECTRAL_UPPER_HZ;
+
+    for (ChannelState& channel : channels_) {
+        if (!WindowPopulateState(&window_config, &channel.window, kSampleRateHz) ||
+            !FftPopulateState(&channel.fft, channel.window.size) ||
+            !FilterbankPopulateState(&filterbank_config, &channel.filterbank, kSampleRateHz,
+                                     channel.fft.fft_size / 2 + 1)) {
+            return false;
+        }
+    }
+    initialized_ = true;
+    Reset();
+    return true;
+}
+
+void ImuSpectralFrontend::Reset() {
+    if (initialized_) {
+        for (ChannelState& channel : channels_) {
+            WindowReset(&channel.window);
+            FftReset(&channel.fft);
+            FilterbankReset(&channel.filterbank);
+        }
+    }
+    memset(frames_, 0, sizeof(frames_));
+    frame_head_ = 0;
+    frame_count_ = 0;
+}
+
+// ============================================================================
+// STREAMING
+// ============================================================================
+
+bool ImuSpectralFrontend::ProcessSample(const float* processed_sample) {
+    bool frame_ready = false;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        ChannelState& channel = channels_[ch];
+        const int16_t sample =
+            ToInt16(processed_sample[ch], ch < 3 ? kAccelToInt16 : kGyroToInt16);
+        size_t samples_read = 0;
+        // All channels step together, so they complete a window on the same sample
+        if (!WindowProcessSamples(&channel.window, &sample, 1, &samples_read)) continue;
+        frame_ready = true;
+
+        // Same chain as FrontendProcessSamples() without noise reduction / PCAN:
+        // scale the windowed input to use the full int16 range of the FFT
+        const int input_shift = 15 - MostSignificantBit32(channel.window.max_abs_output_value);
+        FftCompute(&channel.fft, channel.window.output, input_shift);
+
+        // The FFT output buffer is reused for the energies
+        int32_t* energy = reinterpret_cast<int32_t*>(channel.fft.output);
+        FilterbankConvertFftComplexToEnergy(&channel.filterbank, channel.fft.output, energy);
+        FilterbankAccumulateChannels(&channel.filterbank, energy);
+        uint32_t* amplitudes = FilterbankSqrt(&channel.filterbank, input_shift);
+
+        const int correction_bits =
+            MostSignificantBit32(channel.fft.fft_size) - 1 - (kFilterbankBits / 2);
+        const uint16_t* logged =
+            LogScaleApply(&log_scale_, amplitudes, SPECTRAL_NUM_BANDS, correction_bits);
+        memcpy(frames_[frame_head_] + ch * SPECTRAL_NUM_BANDS, logged,
+               SPECTRAL_NUM_BANDS * sizeof(uint16_t));
+    }
+
+    if (frame_ready) {
+        frame_head_ = (frame_head_ + 1) % SPECTRAL_NUM_FRAMES;
+        frame_count_++;
+    }
+    return frame_ready;
+}
+
+void ImuSpectralFrontend::GetFeatures(float features[SPECTRAL_FEATURE_SIZE]) const {
+    for (int f = 0; f < SPECTRAL_NUM_FRAMES; f++) {
+        const uint16_t* frame = frames_[(frame_head_ + f) % SPECTRAL_NUM_FRAMES];
+        for (int i = 0; i < SPECTRAL_FRAME_SIZE; i++) {
+            features[f * SPECTRAL_FRAME_SIZE + i] = frame[i] * kLogScale;
+        }
+    }
+}
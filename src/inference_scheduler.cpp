@@ -0,0 +1,111 @@
+#include "inference_scheduler.h"
+
+// ============================================================================
+// CONSTRUCTOR / RESET
+// ============================================================================
+
+InferenceScheduler::InferenceScheduler(const InferenceSchedulerConfig& config)
+    : config_(config) {
+    Reset(0);
+}
+
+void InferenceScheduler::Reset(uint32_t now_ms) {
+    motion_energy_ = 1.0f;  // Training data average, i.e. "normal" motion
+    last_class_ = -1;
+    agree_count_ = 0;
+    interval_ms_ = config_.base_interval_ms;
+    // First inference is due immediately
+    last_invoke_ms_ = now_ms - config_.max_interval_ms;
+    last_base_slot_ms_ = now_ms - config_.base_interval_ms;
+    invoke_count_ = 0;
+    skipped_count_ = 0;
+}
+
+// ============================================================================
+// SIGNALS
+// ============================================================================
+
+void InferenceScheduler::OnSample(const float* processed_sample) {
+    // Mean squared z-score across channels: ~1 for average training data
+    float energy = 0.0f;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        float z = (processed_sample[ch] - imu_mean[ch]) / imu_std[ch];
+        energy += z * z;
+    }
+    energy /= NUM_CHANNELS;
+
+    motion_energy_ += config_.energy_alpha * (energy - motion_energy_);
+    UpdateInterval();
+}
+
+void InferenceScheduler::OnPrediction(int best_class, float confidence) {
+    if (confidence >= config_.stable_confidence && best_class == last_class_) {
+        agree_count_++;
+    } else {
+        agree_count_ = (confidence >= config_.stable_confidence) ? 1 : 0;
+    }
+    last_class_ = best_class;
+    UpdateInterval();
+}
+
+bool InferenceScheduler::IsStable() const {
+    return agree_count_ >= config_.stable_count;
+}
+
+// ============================================================================
+// SCHEDULING
+// ============================================================================
+
+void InferenceScheduler::UpdateInterval() {
+    uint32_t interval = config_.base_interval_ms;
+    if (motion_energy_ >= config_.high_motion_energy) {
+        interval = config_.min_interval_ms;
+    } else if (motion_energy_ <= config_.low_motion_energy) {
+        interval = config_.max_interval_ms;
+    }
+
+    // Settled predictions: halve the rate for every agreeing prediction, but
+    // keep sampling fast motion at least at the base rate so a change of form
+    // is still caught
+    if (IsStable()) {
+        if (interval < config_.base_interval_ms) interval = config_.base_interval_ms;
+        for (int n = config_.stable_count; n <= agree_count_ && interval < config_.max_interval_ms; n++) {
+            interval *= 2;
+        }
+    }
+
+    if (interval > config_.max_interval_ms) interval = config_.max_interval_ms;
+    interval_ms_ = interval;
+}
+
+bool InferenceScheduler::ShouldInfer(uint32_t now_ms) {
+    // A fixed-rate scheduler would run once per base interval
+    bool base_slot = (now_ms - last_base_slot_ms_) >= config_.base_interval_ms;
+    if (base_slot) {
+        last_base_slot_ms_ = now_ms;
+    }
+
+    if ((now_ms - last_invoke_ms_) >= interval_ms_) {
+        last_invoke_ms_ = now_ms;
+        invoke_count_++;
+        return true;
+    }
+
+    if (base_slot) {
+        skipped_count_++;
+    }
+    return false;
+}
+
+bool InferenceScheduler::ShouldInferFinal(uint32_t now_ms) {
+    // Settled predictions: the last result stands however old it is
+    if (invoke_count_ > 0 && IsStable()) {
+        return false;
+    }
+    if (invoke_count_ > 0 && (now_ms - last_invoke_ms_) < config_.base_interval_ms) {
+        return false;
+    }
+    last_invoke_ms_ = now_ms;
+    invoke_count_++;
+    return true;
+}
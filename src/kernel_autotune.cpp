@@ -0,0 +1,247 @@
+#include "kernel_autotune.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace {
+
+bool IsTunable(int32_t builtin_code) {
+    return builtin_code == tflite::BuiltinOperator_CONV_2D ||
+           builtin_code == tflite::BuiltinOperator_DEPTHWISE_CONV_2D ||
+           builtin_code == tflite::BuiltinOperator_FULLY_CONNECTED;
+}
+
+// Same pseudo-random input for repeat r in every run; floats stay in [-1, 1)
+void FillInputs(tflite::MicroInterpreter* interpreter, int r) {
+    uint32_t state = 0x9E3779B9u * static_cast<uint32_t>(r + 1);
+    for (size_t i = 0; i < interpreter->inputs_size(); i++) {
+        TfLiteTensor* input = interpreter->input(i);
+        if (input->type == kTfLiteFloat32) {
+            for (size_t k = 0; k < input->bytes / sizeof(float); k++) {
+                state = state * 1664525u + 1013904223u;
+                input->data.f[k] = (state >> 8) / 8388608.0f - 1.0f;
+            }
+        } else {
+            for (size_t k = 0; k < input->bytes; k++) {
+                state = state * 1664525u + 1013904223u;
+                input->data.uint8[k] = static_cast<uint8_t>(state >> 24);
+            }
+        }
+    }
+}
+
+// FNV-1a over every output of the operator, folded into digest
+uint32_t HashOutputs(tflite::MicroInterpreter* interpreter, const tflite::Operator* op,
+                     uint32_t digest) {
+    for (size_t n = 0; op->outputs() != nullptr && n < op->outputs()->size(); n++) {
+        const TfLiteEvalTensor* tensor = interpreter->GetEvalTensor(op->outputs()->Get(n));
+        size_t bytes = 0;
+        if (tensor == nullptr || tensor->data.data == nullptr ||
+            tflite::TfLiteEvalTensorByteLength(tensor, &bytes) != kTfLiteOk) {
+            continue;
+        }
+        const uint8_t* data = static_cast<const uint8_t*>(tensor->data.data);
+        for (size_t i = 0; i < bytes; i++) {
+            digest = (digest ^ data[i]) * 16777619u;
+        }
+    }
+    return digest;
+}
+
+// One allocation of the model with every tuned node asking for variant
+// (kKernelVariantDefault: no table entries). Records the variant each node
+// selected, its ticks and the per-operator output digests over all repeats.
+// The default run only tells which variant each kernel picks by itself.
+bool RunVariant(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+                uint8_t* arena, size_t arena_size, int repeat, tflite::KernelVariant variant,
+                KernelTuneReport* report, uint8_t* selected, uint32_t* ticks,
+                uint32_t* digests) {
+    tflite::KernelVariantEntry entries[KERNEL_AUTOTUNE_MAX_NODES];
+    size_t entry_count = 0;
+    if (variant != tflite::kKernelVariantDefault) {
+        for (int i = 0; i < report->node_count; i++) {
+            entries[entry_count].node_index = report->nodes[i].node_index;
+            entries[entry_count].builtin_code = report->nodes[i].builtin_code;
+            entries[entry_count].variant = variant;
+            entry_count++;
+        }
+    }
+    const size_t operators_size = model->subgraphs()->Get(0)->operators()->size();
+    memset(selected, tflite::kKernelVariantDefault, operators_size);
+    tflite::KernelVariantTable table = {entries, entry_count, selected, operators_size};
+
+    tflite::SetKernelVariantTable(&table);
+    tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size);
+    const TfLiteStatus status = interpreter.AllocateTensors();
+    tflite::SetKernelVariantTable(nullptr);
+    if (status != kTfLiteOk) {
+        MicroPrintf("[TUNE] ERROR: tensor allocation failed");
+        return false;
+    }
+
+    const auto* operators = model->subgraphs()->Get(0)->operators();
+    memset(ticks, 0, operators_size * sizeof(uint32_t));
+    for (size_t op = 0; op < operators_size; op++) digests[op] = 2166136261u;
+    for (int r = 0; r < repeat; r++) {
+        FillInputs(&interpreter, r);
+        for (size_t op = 0; op < operators_size; op++) {
+            const uint32_t start = tflite::GetCurrentTimeTicks();
+            if (interpreter.InvokeRange(op, op + 1) != kTfLiteOk) {
+                MicroPrintf("[TUNE] ERROR: operator %d failed", static_cast<int>(op));
+                return false;
+            }
+            ticks[op] += tflite::GetCurrentTimeTicks() - start;
+            digests[op] = HashOutputs(&interpreter, operators->Get(op), digests[op]);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool TuneKernelVariants(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+                        uint8_t* arena, size_t arena_size, int repeat,
+                        KernelTuneReport* report) {
+    memset(report, 0, sizeof(*report));
+    if (model->subgraphs()->size() != 1) {
+        MicroPrintf("[TUNE] ERROR: only single-subgraph models are tuned");
+        return false;
+    }
+    const auto* operators = model->subgraphs()->Get(0)->operators();
+    const size_t operators_size = operators->size();
+    if (operators_size > KERNEL_AUTOTUNE_MAX_OPS) {
+        MicroPrintf("[TUNE] ERROR: %d operators, at most %d", static_cast<int>(operators_size),
+                    KERNEL_AUTOTUNE_MAX_OPS);
+        return false;
+    }
+    if (repeat < 1) repeat = 1;
+    if (repeat > KERNEL_AUTOTUNE_MAX_REPEAT) repeat = KERNEL_AUTOTUNE_MAX_REPEAT;
+    report->repeat = repeat;
+
+    for (size_t op = 0; op < operators_size; op++) {
+        const int32_t code =
+            tflite::GetBuiltinCode(model->operator_codes()->Get(operators->Get(op)->opcode_index()));
+        if (!IsTunable(code) || report->node_count == KERNEL_AUTOTUNE_MAX_NODES) continue;
+        KernelTuneNode& node = report->nodes[report->node_count++];
+        node.node_index = static_cast<uint16_t>(op);
+        node.builtin_code = static_cast<uint8_t>(code);
+    }
+    if (report->node_count == 0) return true;
+
+    static uint8_t selected[KERNEL_AUTOTUNE_MAX_OPS];
+    static uint32_t ticks[KERNEL_AUTOTUNE_MAX_OPS];
+    static uint32_t digests[KERNEL_AUTOTUNE_MAX_OPS];
+    static uint32_t reference_digests[KERNEL_AUTOTUNE_MAX_OPS];
+
+    // The reference kernels define the expected outputs
+    if (!RunVariant(model, resolver, arena, arena_size, repeat, tflite::kKernelVariantReference,
+                    report, selected, ticks, reference_digests)) {
+        return false;
+    }
+    for (int v = tflite::kKernelVariantDefault; v < tflite::kKernelVariantCount; v++) {
+        const tflite::KernelVariant variant = static_cast<tflite::KernelVariant>(v);
+        if (!RunVariant(model, resolver, arena, arena_size, repeat, variant, report, selected,
+                        ticks, digests)) {
+            return false;
+        }
+        // Everything from the first operator whose outputs changed is suspect
+        size_t first_mismatch = operators_size;
+        for (size_t op = 0; op < operators_size; op++) {
+            if (digests[op] != reference_digests[op]) {
+                first_mismatch = op;
+                break;
+            }
+        }
+        for (int i = 0; i < report->node_count; i++) {
+            KernelTuneNode& node = report->nodes[i];
+            if (variant == tflite::kKernelVariantDefault) {
+                node.default_variant = selected[node.node_index];
+                continue;
+            }
+            if (selected[node.node_index] != variant) continue;
+            node.ticks[v] = ticks[node.node_index] > 0 ? ticks[node.node_index] : 1;
+            node.exact[v] = node.node_index < first_mismatch;
+        }
+    }
+
+    for (int i = 0; i < report->node_count; i++) {
+        KernelTuneNode& node = report->nodes[i];
+        // A node leaves its default only for a clear gain (1/16 of its time
+        // and a tick per input), not for timer noise
+        int best = node.default_variant;
+        const bool default_usable = node.ticks[best] != 0 && node.exact[best];
+        for (int v = 1; v < tflite::kKernelVariantCount; v++) {
+            if (node.ticks[v] == 0 || !node.exact[v] || v == node.default_variant) continue;
+            const uint32_t reference = default_usable ? node.ticks[node.default_variant] : 0;
+            const uint32_t margin = reference / 16 > static_cast<uint32_t>(repeat)
+                                        ? reference / 16
+                                        : static_cast<uint32_t>(repeat);
+            const bool beats_default = !default_usable || node.ticks[v] + margin <= reference;
+            const bool beats_best = best == node.default_variant || node.ticks[v] < node.ticks[best];
+            if (beats_default && beats_best) best = v;
+        }
+        node.best_variant = static_cast<uint8_t>(best);
+        // Both sums from the per-variant runs, so timer noise between the
+        // default run and the variant runs cannot make the table look slower
+        report->default_ticks += node.ticks[node.default_variant];
+        report->best_ticks += node.ticks[best];
+    }
+    return true;
+}
+
+size_t KernelVariantTableFromReport(const KernelTuneReport& report,
+                                    tflite::KernelVariantEntry* entries, size_t max_entries) {
+    size_t count = 0;
+    for (int i = 0; i < report.node_count && count < max_entries; i++) {
+        entries[count].node_index = report.nodes[i].node_index;
+        entries[count].builtin_code = report.nodes[i].builtin_code;
+        entries[count].variant = report.nodes[i].best_variant;
+        count++;
+    }
+    return count;
+}
+
+size_t FormatKernelVariantHeader(const KernelTuneReport& report, int operator_count,
+                                 const char* name, const char* tuned_on, char* out,
+                                 size_t out_size) {
+    size_t length = 0;
+    auto append = [&](int written) {
+        if (written > 0) length += static_cast<size_t>(written);
+    };
+    auto tail = [&]() { return length < out_size ? out + length : nullptr; };
+    auto room = [&]() { return length < out_size ? out_size - length : 0; };
+
+    append(snprintf(tail(), room(),
+                    "// Generated by the kernel autotuner (kernel_autotune.h), tuned on %s.\n"
+                    "// Tuned nodes: %d ticks with the default kernels, %d with this table\n"
+                    "// (%d inputs).\n"
+                    "constexpr int %sOperators = %d;\n"
+                    "constexpr tflite::KernelVariantEntry %s[] = {\n",
+                    tuned_on, static_cast<int>(report.default_ticks),
+                    static_cast<int>(report.best_ticks), report.repeat, name, operator_count,
+                    name));
+    for (int i = 0; i < report.node_count; i++) {
+        const KernelTuneNode& node = report.nodes[i];
+        append(snprintf(tail(), room(), "    {%d, %d, %d},  // %s, default %s:",
+                        node.node_index, node.builtin_code, node.best_variant,
+                        tflite::EnumNameBuiltinOperator(
+                            static_cast<tflite::BuiltinOperator>(node.builtin_code)),
+                        tflite::KernelVariantName(
+                            static_cast<tflite::KernelVariant>(node.default_variant))));
+        for (int v = 1; v < tflite::kKernelVariantCount; v++) {
+            if (node.ticks[v] == 0) continue;
+            append(snprintf(tail(), room(), " %s %d%s",
+                            tflite::KernelVariantName(static_cast<tflite::KernelVariant>(v)),
+                            static_cast<int>(node.ticks[v]), node.exact[v] ? "" : " (inexact)"));
+        }
+        append(snprintf(tail(), room(), "\n"));
+    }
+    append(snprintf(tail(), room(), "};\n"));
+    return length;
+}
@@ -0,0 +1,314 @@
+#include "layer_pipeline.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+
+namespace {
+
+constexpr size_t kSlotAlignment = 16;
+constexpr int kStageBCore = 0;  // loop() runs on core 1
+constexpr int kStageBStackSize = 8192;
+
+size_t AlignUp(size_t bytes) {
+    return (bytes + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+}
+
+bool Contains(const flatbuffers::Vector<int32_t>* list, int tensor) {
+    if (list == nullptr) return false;
+    for (flatbuffers::uoffset_t i = 0; i < list->size(); i++) {
+        if (list->Get(i) == tensor) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+LayerPipeline::LayerPipeline()
+    : front_(nullptr), back_(nullptr), split_(0), cut_count_(0), output_count_(0),
+      slot_buffer_(nullptr), slot_bytes_(0), next_push_(0), next_run_(0), next_pop_(0),
+      stop_(false) {
+    for (int i = 0; i < LAYER_PIPELINE_SLOTS; i++) state_[i] = SLOT_FREE;
+}
+
+LayerPipeline::~LayerPipeline() {
+    End();
+}
+
+// ============================================================================
+// PLANNING
+// ============================================================================
+
+bool LayerPipeline::PlanSlot(const tflite::Model* model, size_t split, CutTensor* cut,
+                             int* cut_count, size_t* output_bytes, int* output_count,
+                             size_t* slot_bytes) {
+    const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+    const auto* operators = subgraph->operators();
+    const auto* tensors = subgraph->tensors();
+    const auto* buffers = model->buffers();
+    if (split == 0 || split >= operators->size()) {
+        MicroPrintf("LayerPipeline: split %d outside 1..%d", static_cast<int>(split),
+                    static_cast<int>(operators->size()) - 1);
+        return false;
+    }
+
+    *cut_count = 0;
+    size_t cut_bytes = 0;
+    for (flatbuffers::uoffset_t t = 0; t < tensors->size(); t++) {
+        const tflite::Tensor* tensor = tensors->Get(t);
+        if (tensor->is_variable()) {
+            MicroPrintf("LayerPipeline: variable tensor %d, state cannot be split", t);
+            return false;
+        }
+        const tflite::Buffer* buffer = buffers->Get(tensor->buffer());
+        if (buffer != nullptr && buffer->data() != nullptr && buffer->data()->size() > 0) {
+            continue;  // Constant, in the flatbuffer for both interpreters
+        }
+
+        // Live across the cut: written by stage A (or a model input) and read
+        // by stage B (or a model output)
+        bool written_before = Contains(subgraph->inputs(), t);
+        bool read_after = Contains(subgraph->outputs(), t);
+        for (flatbuffers::uoffset_t op = 0; op < operators->size(); op++) {
+            if (op < split) {
+                written_before = written_before || Contains(operators->Get(op)->outputs(), t);
+            } else {
+                read_after = read_after || Contains(operators->Get(op)->inputs(), t);
+            }
+        }
+        if (!written_before || !read_after) continue;
+
+        if (*cut_count == LAYER_PIPELINE_MAX_CUT) {
+            MicroPrintf("LayerPipeline: more than %d tensors cross operator %d",
+                        LAYER_PIPELINE_MAX_CUT, static_cast<int>(split));
+            return false;
+        }
+        size_t bytes = 0;
+        size_t type_size = 0;
+        if (tflite::BytesRequiredForTensor(*tensor, &bytes, &type_size) != kTfLiteOk) {
+            return false;
+        }
+        cut[*cut_count] = {static_cast<int>(t), cut_bytes, bytes};
+        (*cut_count)++;
+        cut_bytes += AlignUp(bytes);
+    }
+
+    // B's outputs come back in the same slot once the cut tensors are copied out
+    const flatbuffers::Vector<int32_t>* outputs = subgraph->outputs();
+    if (outputs->size() > static_cast<flatbuffers::uoffset_t>(LAYER_PIPELINE_MAX_OUTPUTS)) {
+        MicroPrintf("LayerPipeline: more than %d outputs", LAYER_PIPELINE_MAX_OUTPUTS);
+        return false;
+    }
+    *output_count = static_cast<int>(outputs->size());
+    size_t all_output_bytes = 0;
+    for (int i = 0; i < *output_count; i++) {
+        size_t type_size = 0;
+        if (tflite::BytesRequiredForTensor(*tensors->Get(outputs->Get(i)), &output_bytes[i],
+                                           &type_size) != kTfLiteOk) {
+            return false;
+        }
+        all_output_bytes += AlignUp(output_bytes[i]);
+    }
+    *slot_bytes = cut_bytes > all_output_bytes ? cut_bytes : all_output_bytes;
+    return true;
+}
+
+size_t LayerPipeline::SlotBufferBytes(const tflite::Model* model, size_t split) {
+    CutTensor cut[LAYER_PIPELINE_MAX_CUT];
+    int cut_count = 0;
+    size_t output_bytes[LAYER_PIPELINE_MAX_OUTPUTS];
+    int output_count = 0;
+    size_t slot_bytes = 0;
+    if (!PlanSlot(model, split, cut, &cut_count, output_bytes, &output_count, &slot_bytes)) {
+        return 0;
+    }
+    return LAYER_PIPELINE_SLOTS * slot_bytes;
+}
+
+size_t LayerPipeline::BalancedSplit(tflite::MicroInterpreter* interpreter, int repeat,
+                                    uint32_t* stage_us) {
+    const size_t operators_size = interpreter->operators_size();
+    if (operators_size < 2) return 1;
+    uint32_t op_ticks[256];
+    if (operators_size > sizeof(op_ticks) / sizeof(op_ticks[0])) return operators_size / 2;
+
+    memset(op_ticks, 0, sizeof(op_ticks));
+    for (int r = 0; r < repeat; r++) {
+        for (size_t op = 0; op < operators_size; op++) {
+            const uint32_t start = tflite::GetCurrentTimeTicks();
+            if (interpreter->InvokeRange(op, op + 1) != kTfLiteOk) return operators_size / 2;
+            op_ticks[op] += tflite::GetCurrentTimeTicks() - start;
+        }
+    }
+
+    uint64_t total = 0;
+    for (size_t op = 0; op < operators_size; op++) total += op_ticks[op];
+    // Minimize the slower stage
+    size_t best_split = 1;
+    uint64_t best_cost = UINT64_MAX;
+    uint64_t best_front = 0;
+    uint64_t front = 0;
+    for (size_t split = 1; split < operators_size; split++) {
+        front += op_ticks[split - 1];
+        const uint64_t cost = front > total - front ? front : total - front;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_split = split;
+            best_front = front;
+        }
+    }
+    if (stage_us != nullptr) {
+        // Mean per invoke
+        const uint64_t ticks = static_cast<uint64_t>(repeat) * tflite::ticks_per_second();
+        stage_us[0] = static_cast<uint32_t>(best_front * 1000000 / ticks);
+        stage_us[1] = static_cast<uint32_t>((total - best_front) * 1000000 / ticks);
+    }
+    return best_split;
+}
+
+// ============================================================================
+// STREAMING
+// ============================================================================
+
+bool LayerPipeline::Begin(const tflite::Model* model, tflite::MicroInterpreter* front,
+                          tflite::MicroInterpreter* back, size_t split, uint8_t* slot_buffer,
+                          size_t slot_buffer_size) {
+    End();
+    if (!PlanSlot(model, split, cut_, &cut_count_, output_bytes_, &output_count_,
+                  &slot_bytes_)) {
+        return false;
+    }
+    if (slot_buffer_size < LAYER_PIPELINE_SLOTS * slot_bytes_) {
+        MicroPrintf("LayerPipeline: slot buffer of %d bytes, %d needed",
+                    static_cast<int>(slot_buffer_size),
+                    static_cast<int>(LAYER_PIPELINE_SLOTS * slot_bytes_));
+        return false;
+    }
+    front_ = front;
+    back_ = back;
+    split_ = split;
+    slot_buffer_ = slot_buffer;
+    for (int i = 0; i < LAYER_PIPELINE_SLOTS; i++) state_[i] = SLOT_FREE;
+    next_push_ = 0;
+    next_run_ = 0;
+    next_pop_ = 0;
+    stop_ = false;
+
+#ifdef ESP_PLATFORM
+    // Stage B on the core that does not run loop()
+    esp_pthread_cfg_t config = esp_pthread_get_default_config();
+    config.pin_to_core = kStageBCore;
+    config.stack_size = kStageBStackSize;
+    config.thread_name = "pipeline_b";
+    esp_pthread_set_cfg(&config);
+#endif
+    worker_ = std::thread(&LayerPipeline::WorkerLoop, this);
+    return true;
+}
+
+void LayerPipeline::End() {
+    if (!worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all();
+    worker_.join();
+    front_ = nullptr;
+    back_ = nullptr;
+    for (int i = 0; i < LAYER_PIPELINE_SLOTS; i++) state_[i] = SLOT_FREE;
+}
+
+bool LayerPipeline::Push() {
+    if (front_ == nullptr) return false;
+    // Stage A runs while stage B may still be busy with the previous window
+    if (front_->InvokeRange(0, split_) != kTfLiteOk) return false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return state_[next_push_] == SLOT_FREE; });
+    const int slot = next_push_;
+    lock.unlock();
+
+    // A free slot belongs to the pusher until it is marked filled
+    for (int i = 0; i < cut_count_; i++) {
+        const TfLiteEvalTensor* tensor = front_->GetEvalTensor(cut_[i].index);
+        memcpy(Slot(slot) + cut_[i].offset, tensor->data.raw, cut_[i].bytes);
+    }
+
+    lock.lock();
+    state_[slot] = SLOT_FILLED;
+    next_push_ = (next_push_ + 1) % LAYER_PIPELINE_SLOTS;
+    lock.unlock();
+    changed_.notify_all();
+    return true;
+}
+
+bool LayerPipeline::Pop(uint8_t* const* outputs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (state_[next_pop_] == SLOT_FREE) {
+        MicroPrintf("LayerPipeline: Pop() without a pushed window");
+        return false;
+    }
+    changed_.wait(lock, [this] {
+        return state_[next_pop_] == SLOT_DONE || state_[next_pop_] == SLOT_FAILED;
+    });
+    const int slot = next_pop_;
+    const bool ok = state_[slot] == SLOT_DONE;
+    lock.unlock();
+
+    size_t offset = 0;
+    for (int i = 0; ok && i < output_count_; i++) {
+        if (outputs[i] != nullptr) memcpy(outputs[i], Slot(slot) + offset, output_bytes_[i]);
+        offset += AlignUp(output_bytes_[i]);
+    }
+
+    lock.lock();
+    state_[slot] = SLOT_FREE;
+    next_pop_ = (next_pop_ + 1) % LAYER_PIPELINE_SLOTS;
+    lock.unlock();
+    changed_.notify_all();
+    return ok;
+}
+
+int LayerPipeline::Pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int pending = 0;
+    for (int i = 0; i < LAYER_PIPELINE_SLOTS; i++) {
+        if (state_[i] != SLOT_FREE) pending++;
+    }
+    return pending;
+}
+
+void LayerPipeline::WorkerLoop() {
+    const size_t operators_size = back_->operators_size();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Windows still in flight are finished before stopping
+        changed_.wait(lock, [this] { return stop_ || state_[next_run_] == SLOT_FILLED; });
+        if (state_[next_run_] != SLOT_FILLED) return;
+        const int slot = next_run_;
+        lock.unlock();
+
+        for (int i = 0; i < cut_count_; i++) {
+            TfLiteEvalTensor* tensor = back_->GetEvalTensor(cut_[i].index);
+            memcpy(tensor->data.raw, Slot(slot) + cut_[i].offset, cut_[i].bytes);
+        }
+        const bool ok = back_->InvokeRange(split_, operators_size) == kTfLiteOk;
+        size_t offset = 0;
+        for (int i = 0; ok && i < output_count_; i++) {
+            memcpy(Slot(slot) + offset, back_->output(i)->data.raw, output_bytes_[i]);
+            offset += AlignUp(output_bytes_[i]);
+        }
+
+        lock.lock();
+        state_[slot] = ok ? SLOT_DONE : SLOT_FAILED;
+        next_run_ = (next_run_ + 1) % LAYER_PIPELINE_SLOTS;
+        changed_.notify_all();
+    }
+}
@@ -5,9 +5,12 @@
  * Hardware: Seeed Studio XIAO ESP32S3 + ICM-20600 IMU
  */
 #include <Arduino.h>
+#include <Preferences.h>
+#include <vector>
 #include "oled_display.h" 
 #include "esp_task_wdt.h"
 #include "esp_system.h"
+#include "esp_sleep.h"
 
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/micro/micro_log.h"
@@ -17,9 +20,26 @@
 #include "tensorflow/lite/version.h"
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 
+#include "test_over_serial/test_over_serial.h"
+
+#include "first_stage.h"
+#include "fused_ops.h"
+#include "graph_fusion.h"
+#include "idle_mode.h"
+#include "imu_filter_op.h"
 #include "imu_provider.h"
+#include "inference_scheduler.h"
+#include "kernel_autotune.h"
+#include "kernel_variants.h"
+#include "metrics.h"
+#include "model_config.h"
+#include "oled_screens.h"
+#include "personalization.h"
+#include "pushup_inference.h"
 #include "pushup_model_data.h"
 #include "preprocessing.h"
+#include "rep_analytics.h"
+#include "window_ring.h"
 
 // Note definitions for the speaker
 #define NOTE_C4 262
@@ -50,30 +70,8 @@ void IRAM_ATTR handleButtonInterrupt() {
     buttonState = digitalRead(BUTTON_PIN);
 }
 
-// ===== MODEL CONFIGURATION =====
-// Update these based on your trained model metadata
-constexpr int WINDOW_SIZE = 50;         // Number of IMU samples per window (50 @ 40Hz = 1.25s)
-constexpr int NUM_CHANNELS = 6;         // ax, ay, az, gx, gy, gz
-constexpr int NUM_POSTURE_CLASSES = 4;  // 4 posture types
-
-// Posture labels - MUST match model output order!
-// From pushup_model_metadata.json: ["good-form", "hips-high", "hips-sagging", "partial-rom"]
-const char* posture_labels[NUM_POSTURE_CLASSES] = {
-    "good-form",    // Class 0
-    "hips-high",    // Class 1
-    "hips-sagging", // Class 2
-    "partial-rom"   // Class 3
-};
-
 // ===== INFERENCE RESULT STORAGE =====
-// Structure to store individual inference results for voting
-struct InferenceResult {
-    float probabilities[NUM_POSTURE_CLASSES];  // All 4 class probabilities
-    float max_confidence;                       // Best class confidence
-    int best_class;                             // Best class index
-    unsigned long timestamp;                    // When inference ran
-};
-
+// Individual inference results for voting (InferenceResult in pushup_inference.h)
 constexpr int MAX_INFERENCE_RESULTS = 15;  // Support pushups up to 15s
 InferenceResult inference_buffer[MAX_INFERENCE_RESULTS];
 int inference_count = 0;
@@ -92,32 +90,10 @@ int final_voted_class = 0;
 float final_voted_confidence = 0.0f;
 int final_sample_count = 0;
 
-// ===== NORMALIZATION PARAMETERS =====
-// Replace with values from pushup_model_metadata.json generated during training
-// These are computed from your training data: mean and std per channel
-float imu_mean[NUM_CHANNELS] = {
-    0.00042208,
-    -0.00188804,
-    -0.00668184,
-    -0.73875794,
-    1.9212489,
-    -0.94398156
-};
-float imu_std[NUM_CHANNELS] = {
-    0.09626791,
-    0.04948182,
-    0.20323046,
-    7.33304658,
-    27.609867,
-    5.87350077
-};
-
 // ===== IMU BUFFER =====
-// Circular buffer for sliding window
+// Sliding window, double-mapped so the window is one contiguous slice
 constexpr int BUFFER_SIZE = WINDOW_SIZE;
-float imu_buffer[BUFFER_SIZE][NUM_CHANNELS];  // [50][6]
-int buffer_index = 0;
-int samples_collected = 0;
+WindowRing<float, BUFFER_SIZE, NUM_CHANNELS> imu_window;  // [2 * 50][6]
 
 // ===== TENSORFLOW LITE MICRO =====
 constexpr int kTensorArenaSize = 120 * 1024;  // 120 KB for CNN model (58 KB model + working memory)
@@ -126,15 +102,127 @@ alignas(16) uint8_t tensor_arena[kTensorArenaSize];
 const tflite::Model* model = nullptr;
 tflite::MicroInterpreter* interpreter = nullptr;
 
+// ===== IN-MODEL PREPROCESSING =====
+// Models exported with add_imu_filter_op.py start with the GAINS_IMU_FILTER
+// op: they take raw int16 samples plus a new-sample count and do the
+// filtering/normalization themselves (see imu_filter_op.h). Detected at setup.
+bool model_filters_input = false;
+WindowRing<int16_t, BUFFER_SIZE, NUM_CHANNELS> imu_raw_window;  // Raw samples, in step with imu_window
+int raw_new_samples = 0;         // Since the op last ran
+bool raw_reset_pending = true;   // Next run resets the op (start of a recording)
+
 // ===== INFERENCE CONTROL =====
-constexpr int INFERENCE_INTERVAL_MS = 200;  // Run inference every  second when enabled
-unsigned long lastInferenceTime = 0;
+// Inference rate adapts to motion energy and prediction stability
+// (175-400 ms, 200 ms nominal), see inference_scheduler.h
+InferenceScheduler inference_scheduler;
+
+// ===== TIME-SLICED INVOKE =====
+// The CNN runs a few operators per loop() iteration (InvokeStep) instead of
+// blocking for the whole invoke, so IMU reads, buttons and serial keep their
+// ~10 ms cadence while a window is classified. The window is copied into the
+// model input when the invoke starts, so new samples do not disturb it.
+constexpr uint32_t INVOKE_SLICE_US = 5000;
+bool invoke_pending = false;            // Model invoke in flight
+unsigned long invoke_pending_us = 0;    // Compute time of its slices so far
+int invoke_pending_slices = 0;
+
+// ===== CASCADED EARLY EXIT =====
+// Cheap feature classifier decides obvious windows, the CNN runs only when it
+// is not confident (see first_stage.h). Off: on held-out recordings the
+// committed fit costs accuracy (host/README.md, "Cascaded early exit").
+constexpr bool ENABLE_CASCADE = false;
+FirstStageClassifier first_stage;
+unsigned long cascade_windows = 0;  // Windows classified since recording start
+unsigned long cascade_exits = 0;    // ... of which the first stage decided
+
+// ===== REP ANALYTICS =====
+// Reps of the recording with tempo, pitch excursion and depth, counted from
+// the preprocessed samples in O(1) per sample (rep_analytics.h). One "[REPS]"
+// line per rep; the set totals are shown with the voted result.
+RepAnalytics rep_analytics;
+
+// ===== PERSONALIZATION =====
+// Nearest-class-mean head on the model's penultimate activations, adapted to
+// the user without retraining (personalization.h). The embeddings of every
+// invoke in a recording are kept; after it, send '0'-'3' to label them as
+// that class. The class sums live in flash (NVS) and the head is blended
+// with the model once every class has a labelled recording. 'p' cycles
+// off/blend/replace, 'x' forgets the labels. The model gets the embedding as
+// a second output, a rewritten copy on the heap like the fused one.
+constexpr bool ENABLE_PERSONALIZATION = true;
+constexpr const char* PERSONAL_PREFS_NAMESPACE = "gains";
+constexpr const char* PERSONAL_PREFS_KEY = "personal";
+PersonalHead personal_head;
+std::vector<uint8_t> personal_model_data;
+
+// ===== GRAPH FUSION =====
+// The model is rewritten at load time so operator chains run as fused
+// kernels with fewer arena round trips (graph_fusion.h). The rewritten copy
+// lives on the heap (~40 KB); malloc alignment is enough, model data is read
+// with at most 4-byte loads. Falls back to the flash model if it fails.
+// Trade: the batch norm rescale tables cost 4 KB of arena for a ~9% faster
+// invoke (kChannelAffineTableMinElements in fused_ops.h turns them off).
+constexpr bool ENABLE_GRAPH_FUSION = true;
+std::vector<uint8_t> fused_model_data;
+
+// ===== KERNEL AUTOTUNING =====
+// Conv/depthwise/FC nodes run the kernel variant chosen per node by the
+// autotuner (kernel_autotune.h), from the generated include/kernel_variants.h.
+// With ENABLE_KERNEL_AUTOTUNE the model is tuned at boot instead (about seven
+// runs of KERNEL_AUTOTUNE_REPEAT invokes) and the header for these timings is
+// printed; paste it into include/kernel_variants.h to keep it.
+constexpr bool ENABLE_KERNEL_AUTOTUNE = false;
+constexpr int KERNEL_AUTOTUNE_REPEAT = 8;
 
 // ===== PREPROCESSING =====
 Preprocessor preprocessor;  // Global preprocessor instance for filtering pipeline
 
+// The IMU's DLPF and sample-rate divider band-limit the samples at the model's
+// rate (imu_config.h), so the Preprocessor skips its median and accel
+// lowpass. Models with GAINS_IMU_FILTER run the whole software chain
+// themselves and keep the IMU's default configuration.
+constexpr bool ENABLE_IMU_DLPF = true;
+ImuFilterConfig imu_filter_config;  // Programmed with ENABLE_IMU_DLPF, restored after idle sleep
+
+// ===== IDLE MODE =====
+// Outside a recording, after 30 s without button, serial or motion the IMU
+// drops to wake-on-motion, the OLED turns off and the CPU light-sleeps
+// between polls (idle_mode.h). On wake the filters are primed with the
+// orientation the device woke from.
+constexpr bool ENABLE_IDLE_SLEEP = true;
+IdleMode idle_mode;
+
+// ===== METRICS =====
+// Loop/IMU/preprocess/invoke/OLED timing histograms and counters (metrics.h).
+// Send 'm' over serial to dump and reset them.
+MetricsRegistry metrics;
+unsigned long last_sample_us = 0;  // micros() of the last successful IMU read
+
+// ===== HARDWARE-IN-THE-LOOP TEST MODE =====
+// A host script (hil_replay.py) sends "!TEST" and then streams recorded raw
+// IMU samples with test_over_serial ("imu-accel-gyro-f32"). They replace
+// ReadIMU() and go through the normal preprocessing and inference path.
+// Every transfer is one recording; one "!RESULT" line is printed per window.
+constexpr int HIL_INFERENCE_STRIDE = 10;  // samples between windows (training stride)
+int hil_sample_count = 0;
+
 // ===== HELPER FUNCTIONS =====
 
+// Defined with the inference code below, used by the recording state machine
+void RunInference();
+void StepInference(uint32_t budget_us);
+
+// Flush the framebuffer to the OLED and record how long the I2C transfer took
+void UpdateDisplay() {
+    unsigned long start_us = micros();
+    oled_display_update();
+    metrics.Record(METRIC_OLED_FLUSH, micros() - start_us);
+}
+
+void PrintMetricsLine(const char* line) {
+    Serial.println(line);
+}
+
 // Clear inference buffer when starting new recording
 void ClearInferenceBuffer() {
     inference_count = 0;
@@ -170,20 +258,11 @@ bool ComputeWeightedVote(int& voted_class, float& voted_confidence) {
         return false;
     }
 
-    float weighted_scores[NUM_POSTURE_CLASSES] = {0};
-    float total_weight = 0;
-
     // Compute weighted scores
-    for (int i = 0; i < inference_count; i++) {
-        float weight = inference_buffer[i].max_confidence;
-        total_weight += weight;
+    float weighted_scores[NUM_POSTURE_CLASSES];
+    WeightedVoteScores(inference_buffer, inference_count, weighted_scores);
 
-        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
-            weighted_scores[c] += inference_buffer[i].probabilities[c] * weight;
-        }
-    }
-
-    // Normalize and find winner
+    // Normalize (by the total weight WeightedVoteScores returns) and find winner
     // voted_class = 0;
     // voted_confidence = 0;
     // for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
@@ -201,7 +280,8 @@ bool ComputeWeightedVote(int& voted_class, float& voted_confidence) {
 
     // Debug output
     Serial.println("\n========== WEIGHTED VOTE ==========");
-    Serial.printf("Samples: %d\n", inference_count);
+    Serial.printf("Samples: %d (%lu fixed-rate inferences skipped)\n", inference_count,
+                  (unsigned long)inference_scheduler.SkippedCount());
     for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
         Serial.printf("  %s: %.1f%%\n", posture_labels[c],
                       weighted_scores[c] * 100);
@@ -213,74 +293,128 @@ bool ComputeWeightedVote(int& voted_class, float& voted_confidence) {
     return true;
 }
 
-// Display recording status with sample count
-void DisplayRecordingStatus() {
-    oled_display_clear();
-    oled_display_text(0, 0, "GAINS");
-    oled_display_text(0, 16, "Recording...");
-
-    char sample_line[32];
-    snprintf(sample_line, sizeof(sample_line), "%d samples", inference_count);
-    oled_display_text(0, 32, sample_line);
+// Show a prerendered screen without dynamic fields (oled_screens.h)
+void DisplayScreen(OledScreen screen) {
+    RenderStaticScreen(screen);
+    UpdateDisplay();
+}
 
-    oled_display_update();
+// Display recording status with sample and rep count
+void DisplayRecordingStatus() {
+    RenderRecordingScreen(inference_count, rep_analytics.Summary().reps);
+    UpdateDisplay();
 }
 
-// Display voted result with confidence
+// Display voted result with confidence and the set's reps
 void DisplayVotedResult(int voted_class, float voted_conf, int sample_count) {
-    oled_display_clear();
-    oled_display_text(0, 0, "GAINS");
-    oled_display_text(0, 12, "Result:");
+    const RepSetSummary& reps = rep_analytics.Summary();
+    RenderResultScreen(posture_labels[voted_class], voted_conf, sample_count, reps.reps,
+                       reps.tension_ms);
+    UpdateDisplay();
+}
 
-    // Posture label (may wrap to two lines)
-    oled_display_text(0, 24, posture_labels[voted_class]);
+// One line per completed rep
+void PrintRep() {
+    const RepMetrics& rep = rep_analytics.Last();
+    Serial.printf("[REPS] #%d: %.2f s (down %.2f s, up %.2f s), pitch %.1f deg, depth %.0f cm\n",
+                  rep_analytics.Summary().reps, rep.duration_ms / 1000.0f,
+                  rep.eccentric_ms / 1000.0f, rep.concentric_ms / 1000.0f, rep.excursion_deg,
+                  rep.depth_cm);
+}
 
-    // Confidence
-    char conf_line[32];
-    snprintf(conf_line, sizeof(conf_line), "%.0f%% confident", voted_conf * 100);
-    oled_display_text(0, 36, conf_line);
+// Set totals at the end of a recording
+void PrintRepSummary() {
+    const RepSetSummary& reps = rep_analytics.Summary();
+    if (reps.reps == 0) {
+        Serial.println("[REPS] No reps counted");
+        return;
+    }
+    const float n = static_cast<float>(reps.reps);
+    Serial.printf("[REPS] Set: %d reps, %.1f s under tension, tempo %.2f s down / %.2f s up, "
+                  "pitch %.1f deg, depth %.0f cm (means)\n",
+                  reps.reps, reps.tension_ms / 1000.0f, reps.eccentric_ms / 1000.0f / n,
+                  reps.concentric_ms / 1000.0f / n, reps.excursion_sum_deg / n,
+                  reps.depth_sum_cm / n);
+}
 
-    // Sample count
-    char sample_line[32];
-    snprintf(sample_line, sizeof(sample_line), "(%d samples)", sample_count);
-    oled_display_text(0, 48, sample_line);
+// Restore the labelled embeddings from flash
+void LoadPersonalStore() {
+    static PersonalStore store;  // ~1 KB, off the loop stack
+    Preferences prefs;
+    prefs.begin(PERSONAL_PREFS_NAMESPACE, true);
+    const size_t bytes = prefs.getBytes(PERSONAL_PREFS_KEY, &store, sizeof(store));
+    prefs.end();
+    if (bytes == sizeof(store) && personal_head.Load(store)) {
+        Serial.printf("[PERSONAL] Restored %lu/%lu/%lu/%lu labelled windows, mode %s\n",
+                      (unsigned long)personal_head.ClassCount(0),
+                      (unsigned long)personal_head.ClassCount(1),
+                      (unsigned long)personal_head.ClassCount(2),
+                      (unsigned long)personal_head.ClassCount(3),
+                      PersonalModeName(personal_head.Mode()));
+    } else if (bytes > 0) {
+        Serial.println("[PERSONAL] Stored labels are for another model, starting empty");
+    }
+}
 
-    oled_display_update();
+// Write the labelled embeddings to flash
+void SavePersonalStore() {
+    static PersonalStore store;
+    personal_head.Save(&store);
+    Preferences prefs;
+    prefs.begin(PERSONAL_PREFS_NAMESPACE, false);
+    if (prefs.putBytes(PERSONAL_PREFS_KEY, &store, sizeof(store)) != sizeof(store)) {
+        Serial.println("[PERSONAL] WARNING: saving the labels failed");
+    }
+    prefs.end();
+}
+
+// Label the windows of the last recording as one class (serial '0'-'3')
+void LabelLastRecording(int label) {
+    if (!personal_head.Initialized()) {
+        Serial.println("[PERSONAL] The model has no embedding output");
+        return;
+    }
+    if (recording_state == RECORDING || personal_head.PendingCount() == 0) {
+        Serial.println("[PERSONAL] Nothing to label: record a set first");
+        return;
+    }
+    const unsigned long start_us = micros();
+    const int added = personal_head.LabelPending(label);
+    const unsigned long label_us = micros() - start_us;
+    SavePersonalStore();
+    Serial.printf("[PERSONAL] %d windows labelled %s in %lu us (%lu in the class)%s\n", added,
+                  posture_labels[label], label_us,
+                  (unsigned long)personal_head.ClassCount(label),
+                  personal_head.Ready() ? "" : ", label every class to use the head");
 }
 
 // Display error when insufficient samples collected
 void DisplayInsufficientSamplesError(int sample_count) {
-    oled_display_clear();
-    oled_display_text(0, 0, "GAINS");
-    oled_display_text(0, 16, "ERROR");
-    oled_display_text(0, 32, "Need 2+ samples");
-
-    char got_line[32];
-    snprintf(got_line, sizeof(got_line), "Got: %d", sample_count);
-    oled_display_text(0, 48, got_line);
-
-    oled_display_update();
+    RenderInsufficientSamplesScreen(sample_count);
+    UpdateDisplay();
 }
 
 // Handle recording state transitions (unified button/serial handler)
 void HandleRecordingToggle(bool is_button) {
     const char* source = is_button ? "button" : "serial";
+    idle_mode.OnActivity(millis());
 
     switch (recording_state) {
         case IDLE:
             // Start recording
             recording_state = RECORDING;
             ClearInferenceBuffer();
+            rep_analytics.Reset();
+            personal_head.ClearPending();
+            inference_scheduler.Reset(millis());
+            cascade_windows = 0;
+            cascade_exits = 0;
 
             Serial.printf("[STATE] IDLE -> RECORDING (via %s)\n", source);
 
             // Visual feedback
             digitalWrite(RECORDING_LED_PIN, HIGH);
-            oled_display_clear();
-            oled_display_text(0, 0, "GAINS");
-            oled_display_text(0, 20, "Recording...");
-            oled_display_text(0, 40, "0 samples");
-            oled_display_update();
+            DisplayRecordingStatus();
 
             // Audio feedback
             tone(BUZZER_PIN, NOTE_D4, 100);
@@ -293,10 +427,21 @@ void HandleRecordingToggle(bool is_button) {
             break;
 
         case RECORDING:
+            // Finish an invoke in flight, then refresh the last result if the
+            // scheduler backed off
+            if (invoke_pending) {
+                StepInference(UINT32_MAX);
+            }
+            if (imu_window.Full() && inference_scheduler.ShouldInferFinal(millis())) {
+                RunInference();
+            }
+            if (rep_analytics.Finish()) PrintRep();
+
             // Stop recording and compute vote
             recording_state = DISPLAYING_RESULT;
 
             Serial.printf("[STATE] RECORDING -> DISPLAYING_RESULT (via %s)\n", source);
+            PrintRepSummary();
 
             // Compute vote
             if (ComputeWeightedVote(final_voted_class, final_voted_confidence)) {
@@ -324,101 +469,221 @@ void HandleRecordingToggle(bool is_button) {
 
             Serial.printf("[STATE] DISPLAYING_RESULT -> IDLE (via %s)\n", source);
 
-            oled_display_clear();
-            oled_display_text(0, 10, "GAINS");
-            oled_display_text(0, 30, "Press to start");
-            oled_display_update();
+            DisplayScreen(OLED_SCREEN_IDLE);
             break;
     }
 
     lastOLEDUpdate = millis();
 }
 
-void NormalizeWindow(float normalized_window[WINDOW_SIZE][NUM_CHANNELS]) {
-    // Normalize the sliding window using saved mean/std
-    for (int i = 0; i < WINDOW_SIZE; i++) {
-        int buf_idx = (buffer_index - WINDOW_SIZE + i + BUFFER_SIZE) % BUFFER_SIZE;
-        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-            normalized_window[i][ch] = (imu_buffer[buf_idx][ch] - imu_mean[ch]) / (imu_std[ch] + 1e-8f);
-        }
-    }
+// Raw window oldest first for the GAINS_IMU_FILTER op, which filters only
+// the samples that are new since it last ran
+void FillRawInput() {
+    memcpy(interpreter->input(0)->data.i16, imu_raw_window.Window(WINDOW_SIZE),
+           WINDOW_SIZE * NUM_CHANNELS * sizeof(int16_t));
+    interpreter->input(1)->data.i32[0] = raw_reset_pending ? -1 : raw_new_samples;
+    raw_new_samples = 0;
+    raw_reset_pending = false;
 }
 
-void RunInference() {
-    if (samples_collected < WINDOW_SIZE) {
-        // Not enough samples yet
-        return;
+// Preprocess one raw IMU sample and append it to the sliding window
+void PushSample(const float* raw_accel, const float* raw_gyro) {
+    // Apply preprocessing pipeline:
+    // 1. Median filter (denoise)
+    // 2. Lowpass filter on accel (10 Hz)
+    // 3. Highpass filter on gyro (0.2 Hz)
+    // 4. Gravity removal from accel (0.5 Hz lowpass estimate)
+    // With ENABLE_IMU_DLPF, 1-2 happen in the IMU. A model with the filter op
+    // filters its own raw window; this chain still feeds the first stage,
+    // rep analytics and the scheduler.
+    float processed_sample[NUM_CHANNELS];
+    unsigned long preprocess_start_us = micros();
+    preprocessor.ProcessSample(raw_accel, raw_gyro, processed_sample);
+    metrics.Record(METRIC_PREPROCESS, micros() - preprocess_start_us);
+    metrics.Increment(METRIC_SAMPLES);
+    first_stage.OnSample(raw_accel, processed_sample);
+    if (recording_state == RECORDING && rep_analytics.OnSample(raw_accel, processed_sample)) {
+        PrintRep();
     }
 
-    // Feed watchdog to prevent reset during inference
-    esp_task_wdt_reset();
-
-    // Create normalized window
-    float normalized_window[WINDOW_SIZE][NUM_CHANNELS];
-    NormalizeWindow(normalized_window);
-
-    // Get input tensor
-    TfLiteTensor* model_input = interpreter->input(0);
+    // Store preprocessed data in the window: [ax, ay, az, gx, gy, gz]
+    // This data is now: linear accel (no gravity) + drift-free gyro
+    imu_window.Push(processed_sample);
+    if (model_filters_input) {
+        int16_t raw_sample[NUM_CHANNELS];
+        QuantizeRawSample(raw_accel, raw_gyro, interpreter->input(0), raw_sample);
+        imu_raw_window.Push(raw_sample);
+        raw_new_samples++;
+        // Between inferences (idle, backed-off schedule) run the filter op
+        // alone before samples drop out of the window, so its filters see
+        // every sample
+        if (raw_new_samples >= WINDOW_SIZE && !invoke_pending) {
+            FillRawInput();
+            if (interpreter->InvokeRange(0, 1) != kTfLiteOk) {
+                Serial.println("ERROR: Filter op failed!");
+            }
+        }
+    }
 
-    // Get quantization parameters
-    const float input_scale = model_input->params.scale;
-    const int input_zp = model_input->params.zero_point;
+    inference_scheduler.OnSample(processed_sample);
+}
 
-    // Quantize and copy data to model input
-    // Model expects shape: [1, WINDOW_SIZE, NUM_CHANNELS]
-    for (int t = 0; t < WINDOW_SIZE; t++) {
-        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-            int idx = t * NUM_CHANNELS + ch;
-            float val = normalized_window[t][ch];
+// Clear filter state and the sliding window (start of a new recording)
+void ResetSampleWindow() {
+    preprocessor.Reset();
+    first_stage.Reset();
+    imu_window.Reset();
+    imu_raw_window.Reset();
+    raw_new_samples = 0;
+    raw_reset_pending = true;
+}
 
-            // Quantize: q = round(val / scale) + zero_point
-            int32_t q = static_cast<int32_t>(roundf(val / input_scale)) + input_zp;
+// Back from idle sleep: the IMU samples at full rate again
+void WakeFromIdle() {
+    oled_display_set_power(true);
+    // The window would span the sleep, the filters start from the rest sample
+    ResetSampleWindow();
+    float rest_accel[3], rest_gyro[3];
+    idle_mode.RestSample(rest_accel, rest_gyro);
+    preprocessor.Prime(rest_accel, rest_gyro);
+    last_sample_us = 0;
+
+    // The press that woke the device only wakes it
+    buttonState = digitalRead(BUTTON_PIN);
+    lastButtonState = buttonState;
+    lastOLEDUpdate = millis();
+}
 
-            // Clamp to int8 range
-            if (q < -128) q = -128;
-            if (q > 127) q = 127;
+// One light sleep until a button change and the IMU's INT pin if it is
+// wired, else the next INT_STATUS poll; then the poll
+void IdleSleepStep() {
+    // Level wakeup replaces the button's edge interrupt while asleep
+    detachInterrupt(digitalPinToInterrupt(BUTTON_PIN));
+    gpio_wakeup_enable(static_cast<gpio_num_t>(BUTTON_PIN),
+                       lastButtonState ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    if (kIMU_IntPin >= 0) {
+        gpio_wakeup_enable(static_cast<gpio_num_t>(kIMU_IntPin), GPIO_INTR_HIGH_LEVEL);
+    } else {
+        esp_sleep_enable_timer_wakeup(idle_mode.config().poll_interval_ms * 1000ULL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+    Serial.flush();
+    esp_light_sleep_start();
 
-            model_input->data.int8[idx] = static_cast<int8_t>(q);
-        }
+    const bool gpio_wake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+    gpio_wakeup_disable(static_cast<gpio_num_t>(BUTTON_PIN));
+    if (kIMU_IntPin >= 0) {
+        gpio_wakeup_disable(static_cast<gpio_num_t>(kIMU_IntPin));
     }
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), handleButtonInterrupt, CHANGE);
 
-    // Run inference
-    Serial.println("[INFERENCE] Starting model invoke...");
-    unsigned long start_time = millis();
+    // A GPIO wake is the button unless INT_STATUS shows motion
+    if (idle_mode.Poll(millis(), gpio_wake || Serial.available() > 0)) {
+        WakeFromIdle();
+    }
+}
 
-    TfLiteStatus invoke_status = interpreter->Invoke();
+// First stage, then (if it is unsure) fill the model input for the current
+// window. Returns true if the first stage decided the window (results are
+// filled in), false if the model has to run.
+bool PrepareClassify(float posture_probs[NUM_POSTURE_CLASSES], int& best_posture,
+                     float& max_posture_prob) {
+    cascade_windows++;
+    metrics.Increment(METRIC_INFERENCES);
+    if (ENABLE_CASCADE && first_stage.Classify(posture_probs, best_posture, max_posture_prob)) {
+        cascade_exits++;
+        metrics.Increment(METRIC_EARLY_EXITS);
+        return true;
+    }
 
-    unsigned long inference_time = millis() - start_time;
-    Serial.printf("[INFERENCE] Completed in %lu ms\n", inference_time);
+    if (model_filters_input) {
+        FillRawInput();
+    } else {
+        // Create normalized, quantized window
+        float normalized_window[WINDOW_SIZE][NUM_CHANNELS];
+        NormalizeWindow(imu_window.Window(WINDOW_SIZE), normalized_window);
+        QuantizeWindow(normalized_window, interpreter->input(0));
+    }
+    return false;
+}
 
+// Dequantize the model output once the invoke has finished
+bool FinishClassify(TfLiteStatus invoke_status, float posture_probs[NUM_POSTURE_CLASSES],
+                    int& best_posture, float& max_posture_prob) {
     if (invoke_status != kTfLiteOk) {
         Serial.println("ERROR: Inference failed!");
-        return;
+        return false;
     }
 
-    // Feed watchdog again after inference
+    // Get output tensor (single-task model with 1 output: posture)
+    DequantizePosture(interpreter->output(0), posture_probs, best_posture, max_posture_prob);
+
+    // output(1) is the embedding when personalization is on
+    if (personal_head.Initialized()) {
+        const TfLiteTensor* embedding = interpreter->output(1);
+        if (recording_state == RECORDING) personal_head.Collect(embedding);
+        personal_head.Apply(embedding, posture_probs, best_posture, max_posture_prob);
+    }
+    return true;
+}
+
+// Drop a sliced invoke that is still in flight (its input is about to change)
+void AbortPendingInvoke() {
+    if (invoke_pending) {
+        interpreter->AbortInvokeStep();
+        invoke_pending = false;
+    }
+}
+
+// Classify the current window in one go: first stage, then (if it is unsure)
+// quantize, invoke the model and dequantize the output. invoke_us is 0 on
+// early exit. Returns false if the window is not full yet or the invoke failed.
+bool ClassifyWindow(float posture_probs[NUM_POSTURE_CLASSES], int& best_posture,
+                    float& max_posture_prob, unsigned long& invoke_us) {
+    if (!imu_window.Full()) {
+        // Not enough samples yet
+        return false;
+    }
+
+    AbortPendingInvoke();
+    if (PrepareClassify(posture_probs, best_posture, max_posture_prob)) {
+        invoke_us = 0;
+        return true;
+    }
+
+    // Feed watchdog to prevent reset during inference
     esp_task_wdt_reset();
 
-    // Get output tensor (single-task model with 1 output: posture)
-    TfLiteTensor* posture_output = interpreter->output(0);
+    // Run inference
+    unsigned long start_time = micros();
+    TfLiteStatus invoke_status = interpreter->Invoke();
+    invoke_us = micros() - start_time;
+    metrics.Record(METRIC_INVOKE, invoke_us);
 
-    // Dequantize posture predictions
-    const float posture_scale = posture_output->params.scale;
-    const int posture_zp = posture_output->params.zero_point;
+    // Feed watchdog again after inference
+    esp_task_wdt_reset();
 
-    float posture_probs[NUM_POSTURE_CLASSES];
-    int best_posture = 0;
-    float max_posture_prob = -1.0f;
+    return FinishClassify(invoke_status, posture_probs, best_posture, max_posture_prob);
+}
 
-    for (int i = 0; i < NUM_POSTURE_CLASSES; i++) {
-        float p = posture_scale * (static_cast<int>(posture_output->data.int8[i]) - posture_zp);
-        posture_probs[i] = p;
-        if (p > max_posture_prob) {
-            max_posture_prob = p;
-            best_posture = i;
-        }
+// Print a classified window, feed it to the scheduler and store it for the vote
+void ReportInference(const float posture_probs[NUM_POSTURE_CLASSES], int best_posture,
+                     float max_posture_prob, unsigned long invoke_us, int slices) {
+    if (invoke_us == 0) {
+        Serial.printf("[CASCADE] Early exit (%lu/%lu windows, %.0f%%)\n", cascade_exits,
+                      cascade_windows, 100.0f * cascade_exits / cascade_windows);
+    } else {
+        Serial.printf("[INFERENCE] Completed in %lu ms (%d slice%s)\n", invoke_us / 1000, slices,
+                      slices == 1 ? "" : "s");
     }
 
+    inference_scheduler.OnPrediction(best_posture, max_posture_prob);
+    Serial.printf("[SCHEDULER] rate=%.1f Hz energy=%.2f%s invoked=%lu skipped=%lu\n",
+                  inference_scheduler.CurrentRateHz(), inference_scheduler.MotionEnergy(),
+                  inference_scheduler.IsStable() ? " stable" : "",
+                  (unsigned long)inference_scheduler.InvokeCount(),
+                  (unsigned long)inference_scheduler.SkippedCount());
+
     // Print results to serial
     Serial.println("\n========== PREDICTION ==========");
     Serial.print("Posture: ");
@@ -452,6 +717,99 @@ void RunInference() {
     }
 }
 
+// Classify the current window synchronously (final refresh at recording stop)
+void RunInference() {
+    if (!imu_window.Full()) {
+        // Not enough samples yet
+        return;
+    }
+
+    float posture_probs[NUM_POSTURE_CLASSES];
+    int best_posture = 0;
+    float max_posture_prob = -1.0f;
+    unsigned long invoke_us = 0;
+
+    Serial.println("[INFERENCE] Starting model invoke...");
+    if (!ClassifyWindow(posture_probs, best_posture, max_posture_prob, invoke_us)) {
+        return;
+    }
+    ReportInference(posture_probs, best_posture, max_posture_prob, invoke_us, 1);
+}
+
+// Start classifying the current window. A first stage exit is reported right
+// away, otherwise the model input is filled and StepInference() runs it.
+void StartInference() {
+    float posture_probs[NUM_POSTURE_CLASSES];
+    int best_posture = 0;
+    float max_posture_prob = -1.0f;
+
+    Serial.println("[INFERENCE] Starting model invoke...");
+    if (PrepareClassify(posture_probs, best_posture, max_posture_prob)) {
+        ReportInference(posture_probs, best_posture, max_posture_prob, 0, 0);
+        return;
+    }
+    invoke_pending = true;
+    invoke_pending_us = 0;
+    invoke_pending_slices = 0;
+}
+
+// Run the pending model invoke for about budget_us and report it when done
+void StepInference(uint32_t budget_us) {
+    bool done = false;
+    unsigned long start_time = micros();
+    TfLiteStatus invoke_status = interpreter->InvokeStep(budget_us, &done);
+    unsigned long slice_us = micros() - start_time;
+    metrics.Record(METRIC_INVOKE_SLICE, slice_us);
+    invoke_pending_us += slice_us;
+    invoke_pending_slices++;
+    if (invoke_status == kTfLiteOk && !done) {
+        return;
+    }
+
+    invoke_pending = false;
+    metrics.Record(METRIC_INVOKE, invoke_pending_us);
+    float posture_probs[NUM_POSTURE_CLASSES];
+    int best_posture = 0;
+    float max_posture_prob = -1.0f;
+    if (FinishClassify(invoke_status, posture_probs, best_posture, max_posture_prob)) {
+        ReportInference(posture_probs, best_posture, max_posture_prob, invoke_pending_us,
+                        invoke_pending_slices);
+    }
+}
+
+// test_over_serial input handler: feed streamed samples in place of ReadIMU()
+bool HandleTestSamples(const test_over_serial::InputBuffer* const input) {
+    if (input->offset == 0) {
+        // First chunk of a new recording
+        ResetSampleWindow();
+        hil_sample_count = 0;
+    }
+
+    for (size_t i = 0; i < input->length; i++) {
+        const float* sample = input->data.float32 + i * NUM_CHANNELS;
+        PushSample(&sample[0], &sample[3]);
+        hil_sample_count++;
+
+        if (!imu_window.Full() || (hil_sample_count % HIL_INFERENCE_STRIDE) != 0) {
+            continue;
+        }
+
+        float probs[NUM_POSTURE_CLASSES];
+        int best = 0;
+        float confidence = 0.0f;
+        unsigned long invoke_us = 0;
+        if (!ClassifyWindow(probs, best, confidence, invoke_us)) {
+            return false;  // aborts the transfer with !FAIL
+        }
+        // !RESULT <sample index> <class> <invoke us> <p0> <p1> <p2> <p3>
+        Serial.printf("!RESULT %d %d %lu %.4f %.4f %.4f %.4f\n", hil_sample_count, best,
+                      invoke_us, probs[0], probs[1], probs[2], probs[3]);
+    }
+
+    esp_task_wdt_reset();
+    return true;
+}
+
 // ====================================================================
 // setup()
 // ====================================================================
@@ -495,8 +853,7 @@ void setup() {
 
     // Initialize OLED
     oled_display_init();
-    oled_display_text(0, 10, "GAINS");
-    oled_display_update();
+    DisplayScreen(OLED_SCREEN_BOOT);
 
     // Initialize button and LED
     pinMode(BUTTON_PIN, INPUT_PULLUP);  // Enable pull-up to prevent floating pin
@@ -512,10 +869,7 @@ void setup() {
     // Initialize IMU
     if (!SetupIMU()) {
         Serial.println("ERROR: IMU failed!");
-        oled_display_clear();
-        oled_display_text(0, 10, "ERROR");
-        oled_display_text(0, 30, "IMU Failed!");
-        oled_display_update();
+        DisplayScreen(OLED_SCREEN_IMU_ERROR);
         while (1) delay(1000);
     }
     Serial.println("✓ IMU ready");
@@ -530,30 +884,89 @@ void setup() {
         Serial.println("ERROR: Model version mismatch!");
         Serial.printf("Model version: %d, Expected: %d\n",
                       model->version(), TFLITE_SCHEMA_VERSION);
-        oled_display_clear();
-        oled_display_text(0, 10, "ERROR");
-        oled_display_text(0, 30, "Model Version!");
-        oled_display_update();
+        DisplayScreen(OLED_SCREEN_MODEL_ERROR);
         while (1) delay(1000);
     }
     Serial.println("✓ Model loaded");
 
+    if (ENABLE_GRAPH_FUSION) {
+        GraphFusionReport fusion;
+        if (FuseModel(g_pushup_model_data, &fused_model_data, &fusion)) {
+            model = tflite::GetModel(fused_model_data.data());
+            Serial.printf("[FUSION] %d -> %d ops (%d identity ops removed, %d channel affine, "
+                          "%d conv+pool), %u bytes in RAM\n", fusion.ops_before, fusion.ops_after,
+                          fusion.identity_ops, fusion.channel_affine, fusion.conv_pool,
+                          static_cast<unsigned>(fused_model_data.size()));
+        } else {
+            Serial.println("[FUSION] Not supported, using the unfused model");
+        }
+    }
+
+    if (ENABLE_PERSONALIZATION) {
+        const unsigned char* model_data =
+            fused_model_data.empty() ? g_pushup_model_data : fused_model_data.data();
+        if (ExposeEmbedding(model_data, &personal_model_data)) {
+            model = tflite::GetModel(personal_model_data.data());
+            std::vector<uint8_t>().swap(fused_model_data);  // Replaced by the copy
+        } else {
+            Serial.println("[PERSONAL] No embedding in this model, personalization is off");
+        }
+    }
+
     // Setup TFLite interpreter
     static tflite::AllOpsResolver micro_op_resolver;
+    micro_op_resolver.AddCustom(kImuFilterOpName, Register_GAINS_IMU_FILTER());
+    AddFusedOps(micro_op_resolver);
+
+    const int model_ops = static_cast<int>(model->subgraphs()->Get(0)->operators()->size());
+    static tflite::KernelVariantEntry tuned_variants[KERNEL_AUTOTUNE_MAX_NODES];
+    tflite::KernelVariantTable variant_table = {nullptr, 0, nullptr, 0};
+    if (ENABLE_KERNEL_AUTOTUNE) {
+        static KernelTuneReport tune_report;
+        if (TuneKernelVariants(model, micro_op_resolver, tensor_arena, kTensorArenaSize,
+                               KERNEL_AUTOTUNE_REPEAT, &tune_report)) {
+            variant_table.entries = tuned_variants;
+            variant_table.count = KernelVariantTableFromReport(tune_report, tuned_variants,
+                                                               KERNEL_AUTOTUNE_MAX_NODES);
+            static char header[2048];
+            FormatKernelVariantHeader(tune_report, model_ops, "kPushupKernelVariants", "the ESP32",
+                                      header, sizeof(header));
+            Serial.printf("[TUNE] %u -> %u us on the tuned nodes, table:\n%s",
+                          static_cast<unsigned>(tune_report.default_ticks),
+                          static_cast<unsigned>(tune_report.best_ticks), header);
+        } else {
+            Serial.println("[TUNE] Tuning failed, using the default kernels");
+        }
+    } else if (kPushupKernelVariantsOperators == model_ops) {
+        variant_table.entries = kPushupKernelVariants;
+        variant_table.count = sizeof(kPushupKernelVariants) / sizeof(kPushupKernelVariants[0]);
+        Serial.printf("[TUNE] Kernel variant table: %u nodes\n",
+                      static_cast<unsigned>(variant_table.count));
+    } else {
+        Serial.println("[TUNE] Kernel variant table is for another model, using the defaults");
+    }
 
     static tflite::MicroInterpreter static_interpreter(
         model, micro_op_resolver, tensor_arena, kTensorArenaSize);
     interpreter = &static_interpreter;
 
-    if (interpreter->AllocateTensors() != kTfLiteOk) {
+    // The kernels copy their variant in Prepare, the table is not needed after
+    tflite::SetKernelVariantTable(&variant_table);
+    const TfLiteStatus allocate_status = interpreter->AllocateTensors();
+    tflite::SetKernelVariantTable(nullptr);
+    if (allocate_status != kTfLiteOk) {
         Serial.println("ERROR: Tensor allocation failed!");
-        oled_display_clear();
-        oled_display_text(0, 10, "ERROR");
-        oled_display_text(0, 30, "Tensor Alloc!");
-        oled_display_update();
+        DisplayScreen(OLED_SCREEN_ARENA_ERROR);
         while (1) delay(1000);
     }
     Serial.println("✓ Model ready");
+    Serial.printf("Arena used: %u of %d bytes\n",
+                  static_cast<unsigned>(interpreter->arena_used_bytes()), kTensorArenaSize);
+    if (interpreter->outputs_size() > 1 && personal_head.Init(interpreter->output(1))) {
+        Serial.printf("✓ Personalization: %u-value embedding\n",
+                      static_cast<unsigned>(interpreter->output(1)->bytes));
+        LoadPersonalStore();
+    }
 
     // Print model info
     TfLiteTensor* input = interpreter->input(0);
@@ -562,21 +975,36 @@ void setup() {
                   input->dims->data[1],
                   input->dims->data[2]);
     Serial.printf("Input type: %s\n",
-                  input->type == kTfLiteInt8 ? "INT8" : "FLOAT32");
+                  input->type == kTfLiteInt8 ? "INT8" :
+                  input->type == kTfLiteInt16 ? "INT16" : "FLOAT32");
+    model_filters_input = interpreter->inputs_size() == 2 && input->type == kTfLiteInt16;
+    if (model_filters_input) {
+        Serial.println("✓ Model preprocesses raw IMU input (GAINS_IMU_FILTER)");
+    } else if (ENABLE_IMU_DLPF) {
+        imu_filter_config = ModelImuFilterConfig();
+        if (ConfigureImuFilter(imu_filter_config)) {
+            preprocessor.SetHardwareLowpass(true);
+            Serial.println("✓ IMU DLPF replaces the software median/lowpass");
+        } else {
+            Serial.println("WARNING: IMU DLPF setup failed, filtering in software");
+        }
+    }
 
     Serial.println("========================================");
     Serial.println("System ready!");
     Serial.println("Press button or 'r' key to START recording");
     Serial.println("Press again to STOP and get result");
     Serial.println("Press third time to return to IDLE");
+    Serial.println("Send 'm' to dump and reset loop timing metrics");
+    if (personal_head.Initialized()) {
+        Serial.println("After a set send '0'-'3' to label it (good-form, hips-high, hips-sagging,");
+        Serial.println("partial-rom), 'p' for the personalization mode, 'x' to forget the labels");
+    }
     Serial.println("========================================\n");
 
     // Initialize state machine
     recording_state = IDLE;
-    oled_display_clear();
-    oled_display_text(0, 10, "GAINS");
-    oled_display_text(0, 30, "Press to start");
-    oled_display_update();
+    DisplayScreen(OLED_SCREEN_IDLE);
 
     // Clear any serial data sent during connection (shell prompts, etc)
     delay(500);
@@ -584,20 +1012,66 @@ void setup() {
         Serial.read();
     }
     Serial.println("Serial buffer cleared - ready for input!");
+    metrics.Reset(millis());
+    idle_mode.Reset(millis(), preprocessor.HardwareLowpass() ? &imu_filter_config : nullptr);
 }
 
 // ====================================================================
 // loop()
 // ====================================================================
 void loop() {
+    // Hardware-in-the-loop test mode: all serial input belongs to
+    // test_over_serial and samples come from the host instead of the IMU
+    static test_over_serial::TestOverSerial& test_serial =
+        test_over_serial::TestOverSerial::Instance(test_over_serial::kIMU_ACCEL_GYRO_F32);
+    static const test_over_serial::InputHandler test_handler = HandleTestSamples;
+    // Streamed recordings were not taken through the IMU DLPF, so the
+    // software median/lowpass runs on them while test mode lasts
+    static bool hil_active = false;
+    static bool hil_saved_lowpass = false;
+    if (test_serial.IsTestMode() || (Serial.available() > 0 && Serial.peek() == '!')) {
+        if (!hil_active) {
+            hil_active = true;
+            hil_saved_lowpass = preprocessor.HardwareLowpass();
+            preprocessor.SetHardwareLowpass(false);
+            ResetSampleWindow();
+        }
+        test_serial.ProcessInput(&test_handler);
+        esp_task_wdt_reset();
+        return;
+    }
+    if (hil_active) {
+        hil_active = false;
+        preprocessor.SetHardwareLowpass(hil_saved_lowpass);
+        ResetSampleWindow();
+    }
+
     // Timing diagnostics: Track loop duration
     static unsigned long last_loop_time = 0;
+    static unsigned long last_loop_start_us = 0;
+
+    // Idle sleep: light sleep and wake-on-motion polls only. The sleep is
+    // not a slow loop or a missed sample.
+    if (idle_mode.Asleep()) {
+        IdleSleepStep();
+        last_loop_time = 0;
+        last_loop_start_us = 0;
+        esp_task_wdt_reset();
+        return;
+    }
+
     unsigned long loop_start = millis();
     unsigned long loop_duration = loop_start - last_loop_time;
+    unsigned long loop_start_us = micros();
+    if (last_loop_start_us > 0) {
+        metrics.Record(METRIC_LOOP_PERIOD, loop_start_us - last_loop_start_us);
+    }
+    last_loop_start_us = loop_start_us;
 
     // Warn if loop is taking too long (> 100ms indicates blocking)
     if (last_loop_time > 0 && loop_duration > 100) {
         Serial.printf("[TIMING WARNING] Loop took %lu ms (expected ~10ms)\n", loop_duration);
+        metrics.Increment(METRIC_SLOW_LOOPS);
     }
 
     // Handle button state changes
@@ -617,49 +1091,65 @@ void loop() {
 
     // Handle serial input - only respond to 'r' or 'R' key
     if (Serial.available() > 0) {
+        idle_mode.OnActivity(millis());
         char key = Serial.read();
         // Clear any remaining characters
         while (Serial.available() > 0) {
             Serial.read();
         }
 
-        // Only toggle recording on 'r' or 'R' key
+        // Toggle recording on 'r' or 'R' key, dump and reset metrics on 'm' or 'M'
         if (key == 'r' || key == 'R') {
             Serial.printf("Key pressed: '%c' (0x%02X) - toggling recording\n", key, key);
             HandleRecordingToggle(false);  // false = serial source
+        } else if (key == 'm' || key == 'M') {
+            metrics.Dump(millis(), PrintMetricsLine);
+            metrics.Reset(millis());
+        } else if (key >= '0' && key < '0' + NUM_POSTURE_CLASSES) {
+            LabelLastRecording(key - '0');
+        } else if (key == 'p' || key == 'P') {
+            const int next = (personal_head.Mode() + 1) % (PERSONAL_REPLACE + 1);
+            personal_head.SetMode(static_cast<PersonalMode>(next));
+            Serial.printf("[PERSONAL] Mode: %s%s\n", PersonalModeName(personal_head.Mode()),
+                          personal_head.Ready() ? "" : " (not every class is labelled yet)");
+        } else if ((key == 'x' || key == 'X') && personal_head.Initialized()) {
+            personal_head.Clear();
+            SavePersonalStore();
+            Serial.println("[PERSONAL] Labels cleared");
         } else {
-            Serial.printf("Key pressed: '%c' (0x%02X) - ignored (press 'r' to toggle)\n", key, key);
+            Serial.printf("Key pressed: '%c' (0x%02X) - ignored (press 'r' to toggle, 'm' for metrics)\n",
+                          key, key);
         }
     }
 
-    // Always read IMU data (keep buffer updated)
+    // Always read IMU data (keep buffer updated). The loop runs faster than
+    // the 40 Hz ODR, so only samples flagged by DATA_RDY are pushed: a repeat
+    // would put the same sample in the window twice and stretch its timing.
     float raw_accel[3], raw_gyro[3];
-    if (ReadIMU(raw_accel, raw_gyro)) {
-        // Apply preprocessing pipeline:
-        // 1. Median filter (denoise)
-        // 2. Lowpass filter on accel (10 Hz)
-        // 3. Highpass filter on gyro (0.2 Hz)
-        // 4. Gravity removal from accel (0.5 Hz lowpass estimate)
-        float processed_sample[NUM_CHANNELS];
-        preprocessor.ProcessSample(raw_accel, raw_gyro, processed_sample);
-
-        // Store preprocessed data in circular buffer: [ax, ay, az, gx, gy, gz]
-        // This data is now: linear accel (no gravity) + drift-free gyro
-        imu_buffer[buffer_index][0] = processed_sample[0];
-        imu_buffer[buffer_index][1] = processed_sample[1];
-        imu_buffer[buffer_index][2] = processed_sample[2];
-        imu_buffer[buffer_index][3] = processed_sample[3];
-        imu_buffer[buffer_index][4] = processed_sample[4];
-        imu_buffer[buffer_index][5] = processed_sample[5];
-
-        buffer_index = (buffer_index + 1) % BUFFER_SIZE;
-        if (samples_collected < WINDOW_SIZE) {
-            samples_collected++;
+    bool imu_fresh = false;
+    unsigned long imu_start_us = micros();
+    bool imu_ok = ReadIMU(raw_accel, raw_gyro, &imu_fresh);
+    unsigned long imu_end_us = micros();
+    metrics.Record(METRIC_IMU_READ, imu_end_us - imu_start_us);
+    if (!imu_ok) {
+        metrics.Increment(METRIC_IMU_READ_ERRORS);
+    } else if (imu_fresh) {
+        if (last_sample_us > 0) {
+            unsigned long interval_us = imu_end_us - last_sample_us;
+            metrics.Record(METRIC_SAMPLE_INTERVAL, interval_us);
+            // Polling jitters each interval by up to a loop iteration; only
+            // a missed sample makes one reach two periods
+            if (interval_us > SAMPLE_PERIOD_MS * 1500UL) {
+                metrics.Increment(METRIC_DEADLINE_MISSES);
+            }
         }
+        last_sample_us = imu_end_us;
+        PushSample(raw_accel, raw_gyro);
+        idle_mode.OnSample(millis(), raw_accel, raw_gyro);
 
         // Debug: Print raw vs processed data every 20 samples (every 0.5 seconds @ 40Hz)
         static int debug_count = 0;
-        // if (samples_collected >= WINDOW_SIZE && (++debug_count % 20 == 0)) {
+        // if (imu_window.Full() && (++debug_count % 20 == 0)) {
         //     Serial.printf("[RAW] ax=%.3f, ay=%.3f, az=%.3f | gx=%.3f, gy=%.3f, gz=%.3f\n",
         //                   raw_accel[0], raw_accel[1], raw_accel[2],
         //                   raw_gyro[0], raw_gyro[1], raw_gyro[2]);
@@ -670,12 +1160,21 @@ void loop() {
         // }
     }
 
-    // Run inference periodically ONLY when recording
-    if (recording_state == RECORDING) {
-        unsigned long currentTime = millis();
-        if (currentTime - lastInferenceTime >= INFERENCE_INTERVAL_MS) {
-            lastInferenceTime = currentTime;
-            RunInference();
+    // Run inference ONLY when recording, at the rate picked by the scheduler,
+    // one slice of the model per iteration
+    if (recording_state == RECORDING && imu_window.Full()) {
+        if (!invoke_pending && inference_scheduler.ShouldInfer(millis())) {
+            StartInference();
+        }
+        if (invoke_pending) {
+            StepInference(INVOKE_SLICE_US);
+        }
+    }
+
+    // Nothing to record: wake-on-motion until motion or the button
+    if (ENABLE_IDLE_SLEEP && recording_state != RECORDING && idle_mode.ShouldSleep(millis())) {
+        if (idle_mode.Sleep(millis())) {
+            oled_display_set_power(false);
         }
     }
 
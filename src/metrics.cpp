@@ -0,0 +1,106 @@
+#include "metrics.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+const char* const kHistogramNames[NUM_METRIC_HISTOGRAMS] = {
+    "loop", "imu_read", "preprocess", "invoke", "invoke_slice", "oled_flush", "sample_interval",
+};
+const char* const kCounterNames[NUM_METRIC_COUNTERS] = {
+    "samples", "imu_errors", "deadline_miss", "inferences", "early_exits", "slow_loops",
+};
+
+int BucketIndex(uint32_t us) {
+    if (us == 0) return 0;
+    int bucket = 32 - __builtin_clz(us);
+    return bucket < METRICS_HISTOGRAM_BUCKETS ? bucket : METRICS_HISTOGRAM_BUCKETS - 1;
+}
+}  // namespace
+
+const char* MetricHistogramName(MetricHistogram histogram) {
+    return kHistogramNames[histogram];
+}
+
+const char* MetricCounterName(MetricCounter counter) {
+    return kCounterNames[counter];
+}
+
+// ============================================================================
+// HISTOGRAM
+// ============================================================================
+
+void LatencyHistogram::Record(uint32_t us) {
+    buckets[BucketIndex(us)]++;
+    count++;
+    sum_us += us;
+    if (us > max_us) max_us = us;
+}
+
+void LatencyHistogram::Reset() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    max_us = 0;
+    sum_us = 0;
+}
+
+uint32_t LatencyHistogram::PercentileUpperBoundUs(float percentile) const {
+    if (count == 0) return 0;
+    // Rank of the sample at this percentile (1-based, rounded up)
+    uint32_t rank = static_cast<uint32_t>(percentile / 100.0f * count + 0.999f);
+    if (rank < 1) rank = 1;
+    uint32_t seen = 0;
+    for (int b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            const uint32_t upper = b == 0 ? 0 : (1u << b) - 1;
+            return upper < max_us ? upper : max_us;
+        }
+    }
+    return max_us;
+}
+
+// ============================================================================
+// REGISTRY
+// ============================================================================
+
+MetricsRegistry::MetricsRegistry() {
+    Reset(0);
+}
+
+void MetricsRegistry::Reset(unsigned long now_ms) {
+    for (LatencyHistogram& histogram : histograms_) histogram.Reset();
+    memset(counters_, 0, sizeof(counters_));
+    window_start_ms_ = now_ms;
+}
+
+void MetricsRegistry::Dump(unsigned long now_ms, void (*emit)(const char* line)) const {
+    char line[256];
+    int n = snprintf(line, sizeof(line), "[METRICS] window=%lums",
+                     now_ms - window_start_ms_);
+    for (int c = 0; c < NUM_METRIC_COUNTERS && n < static_cast<int>(sizeof(line)); c++) {
+        n += snprintf(line + n, sizeof(line) - n, " %s=%lu", kCounterNames[c],
+                      static_cast<unsigned long>(counters_[c]));
+    }
+    emit(line);
+
+    for (int h = 0; h < NUM_METRIC_HISTOGRAMS; h++) {
+        const LatencyHistogram& histogram = histograms_[h];
+        if (histogram.count == 0) continue;
+        n = snprintf(line, sizeof(line),
+                     "[METRICS] %s_us n=%lu p50<=%lu p90<=%lu p99<=%lu max=%lu mean=%lu |",
+                     kHistogramNames[h], static_cast<unsigned long>(histogram.count),
+                     static_cast<unsigned long>(histogram.PercentileUpperBoundUs(50.0f)),
+                     static_cast<unsigned long>(histogram.PercentileUpperBoundUs(90.0f)),
+                     static_cast<unsigned long>(histogram.PercentileUpperBoundUs(99.0f)),
+                     static_cast<unsigned long>(histogram.max_us),
+                     static_cast<unsigned long>(histogram.sum_us / histogram.count));
+        // Non-empty buckets, b:count where bucket b holds [2^(b-1), 2^b) us
+        for (int b = 0; b < METRICS_HISTOGRAM_BUCKETS && n < static_cast<int>(sizeof(line)); b++) {
+            if (histogram.buckets[b] == 0) continue;
+            n += snprintf(line + n, sizeof(line) - n, " %d:%lu", b,
+                          static_cast<unsigned long>(histogram.buckets[b]));
+        }
+        emit(line);
+    }
+}
@@ -8,7 +8,7 @@
 #include "driver/i2c.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
-#include "font8x8_basic.h"
+#include "oled_bitmap.h"
 
 #define I2C_PORT I2C_NUM_0
 #define TAG "OLED"
@@ -18,7 +18,10 @@
 #define OLED_CONTROL_DATA 0x40
 
 // 1KB framebuffer for 128x64 display (8 pages x 128 columns)
-static uint8_t s_framebuffer[OLED_WIDTH * (OLED_HEIGHT / 8)] = {0};
+static uint8_t s_framebuffer[OLED_FRAMEBUFFER_SIZE] = {0};
+
+// font8x8_basic as columns, transposed at compile time (in flash)
+static constexpr OledFontColumns kFontColumns = OledRenderFontColumns();
 static bool s_oled_ready = false;
 
 // Builds and sends I2C command
@@ -131,15 +134,26 @@ static inline void set_pixel(int x, int y, bool on) {
     }
 }
 
-// Displays character using font8x8_basic
+// Displays character using font8x8_basic, a framebuffer byte per column:
+// rows y..y+7 are one page, or the bottom and top of two if y % 8 != 0
 static void draw_char(int x, int y, char c) {
     if ((unsigned char)c > 127) c = '?';
-    const uint8_t* glyph = (const uint8_t*)font8x8_basic[(int)(unsigned char)c];
-    for (int dy = 0; dy < 8; ++dy) {
-        uint8_t row = glyph[dy];
-        for (int dx = 0; dx < 8; ++dx) {
-            bool on = (row >> dx) & 0x01;
-            set_pixel(x + dx, y + dy, on);
+    const uint8_t* columns = kFontColumns.columns[(int)(unsigned char)c];
+    const int page = y / 8;
+    const int shift = y % 8;
+    const uint8_t upper_mask = (uint8_t)(0xFF << shift);
+    const uint8_t lower_mask = (uint8_t)(0xFF >> (8 - shift));
+    for (int dx = 0; dx < 8; ++dx) {
+        int cx = x + dx;
+        if (cx < 0 || cx >= OLED_WIDTH) continue;
+        uint8_t bits = columns[dx];
+        if (page < OLED_HEIGHT / 8) {
+            uint8_t* cell = &s_framebuffer[page * OLED_WIDTH + cx];
+            *cell = (uint8_t)((*cell & ~upper_mask) | (bits << shift));
+        }
+        if (shift != 0 && page + 1 < OLED_HEIGHT / 8) {
+            uint8_t* cell = &s_framebuffer[(page + 1) * OLED_WIDTH + cx];
+            *cell = (uint8_t)((*cell & ~lower_mask) | (bits >> (8 - shift)));
         }
     }
 }
@@ -181,6 +195,15 @@ void oled_display_text(uint8_t x, uint8_t y, const char* text) {
     draw_text(x, y, text);
 }
 
+void oled_display_bitmap(const uint8_t* frame) {
+    if (!frame) return;
+    memcpy(s_framebuffer, frame, sizeof(s_framebuffer));
+}
+
+const uint8_t* oled_display_framebuffer(void) {
+    return s_framebuffer;
+}
+
 void oled_display_command(const char* command, uint8_t score) {
     // Title and a progress bar 
     oled_display_clear();
@@ -207,3 +230,9 @@ esp_err_t oled_display_update(void) {
     if (err != ESP_OK) return err;
     return oled_data(s_framebuffer, sizeof(s_framebuffer));
 }
+
+esp_err_t oled_display_set_power(bool on) {
+    if (!s_oled_ready) return ESP_ERR_INVALID_STATE;
+    // Display OFF keeps the GDDRAM, so ON shows the last frame again
+    return oled_cmd(on ? 0xAF : 0xAE);
+}
@@ -0,0 +1,103 @@
+#include "oled_screens.h"
+
+#include <stdio.h>
+
+#include "oled_bitmap.h"
+#include "oled_display.h"
+
+namespace {
+
+// ============================================================================
+// STATIC TEXT
+// ============================================================================
+// Layouts as main.cpp drew them; dynamic fields are left blank here
+
+constexpr OledText kBootTexts[] = {{0, 10, "GAINS"}};
+constexpr OledText kIdleTexts[] = {{0, 10, "GAINS"}, {0, 30, "Press to start"}};
+constexpr OledText kImuErrorTexts[] = {{0, 10, "ERROR"}, {0, 30, "IMU Failed!"}};
+constexpr OledText kModelErrorTexts[] = {{0, 10, "ERROR"}, {0, 30, "Model Version!"}};
+constexpr OledText kArenaErrorTexts[] = {{0, 10, "ERROR"}, {0, 30, "Tensor Alloc!"}};
+
+// Fields: "%d samples" at (0, 32), "%d reps" at (0, 48)
+constexpr OledText kRecordingTexts[] = {{0, 0, "GAINS"}, {0, 16, "Recording..."}};
+
+// Fields: label at (0, 24), "%.0f%% confident" at (0, 36), "(%d samples)" at (0, 48),
+// "%d reps %lus TUT" at (0, 56)
+constexpr OledText kResultTexts[] = {{0, 0, "GAINS"}, {0, 12, "Result:"}};
+
+// Field: the count after "Got: "
+constexpr OledText kInsufficientTexts[] = {
+    {0, 0, "GAINS"}, {0, 16, "ERROR"}, {0, 32, "Need 2+ samples"}, {0, 48, "Got: "}};
+constexpr uint8_t kInsufficientCountX = 5 * 8;
+
+static_assert(OledTextsFit(kBootTexts) && OledTextsFit(kIdleTexts) &&
+                  OledTextsFit(kImuErrorTexts) && OledTextsFit(kModelErrorTexts) &&
+                  OledTextsFit(kArenaErrorTexts) && OledTextsFit(kRecordingTexts) &&
+                  OledTextsFit(kResultTexts) && OledTextsFit(kInsufficientTexts),
+              "screen text would wrap or run off the display");
+
+// ============================================================================
+// PRERENDERED FRAMES
+// ============================================================================
+
+constexpr OledFrame kStaticScreens[NUM_OLED_SCREENS] = {
+    OledPrerender(kBootTexts),       OledPrerender(kIdleTexts),
+    OledPrerender(kImuErrorTexts),   OledPrerender(kModelErrorTexts),
+    OledPrerender(kArenaErrorTexts),
+};
+
+constexpr OledFrame kRecordingScreen = OledPrerender(kRecordingTexts);
+constexpr OledFrame kResultScreen = OledPrerender(kResultTexts);
+constexpr OledFrame kInsufficientScreen = OledPrerender(kInsufficientTexts);
+
+}  // namespace
+
+// ============================================================================
+// RENDERING
+// ============================================================================
+
+void RenderStaticScreen(OledScreen screen) {
+    if (screen < 0 || screen >= NUM_OLED_SCREENS) return;
+    oled_display_bitmap(kStaticScreens[screen].bytes);
+}
+
+void RenderRecordingScreen(int sample_count, int rep_count) {
+    oled_display_bitmap(kRecordingScreen.bytes);
+
+    char sample_line[32];
+    snprintf(sample_line, sizeof(sample_line), "%d samples", sample_count);
+    oled_display_text(0, 32, sample_line);
+
+    char rep_line[32];
+    snprintf(rep_line, sizeof(rep_line), "%d reps", rep_count);
+    oled_display_text(0, 48, rep_line);
+}
+
+void RenderResultScreen(const char* label, float confidence, int sample_count, int rep_count,
+                        uint32_t tension_ms) {
+    oled_display_bitmap(kResultScreen.bytes);
+
+    // Posture label (may wrap to two lines)
+    oled_display_text(0, 24, label);
+
+    char conf_line[32];
+    snprintf(conf_line, sizeof(conf_line), "%.0f%% confident", confidence * 100);
+    oled_display_text(0, 36, conf_line);
+
+    char sample_line[32];
+    snprintf(sample_line, sizeof(sample_line), "(%d samples)", sample_count);
+    oled_display_text(0, 48, sample_line);
+
+    char rep_line[32];
+    snprintf(rep_line, sizeof(rep_line), "%d reps %lus TUT", rep_count,
+             static_cast<unsigned long>((tension_ms + 500) / 1000));
+    oled_display_text(0, 56, rep_line);
+}
+
+void RenderInsufficientSamplesScreen(int sample_count) {
+    oled_display_bitmap(kInsufficientScreen.bytes);
+
+    char count[16];
+    snprintf(count, sizeof(count), "%d", sample_count);
+    oled_display_text(kInsufficientCountX, 48, count);
+}
@@ -0,0 +1,242 @@
+#include "personalization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr uint32_t kStoreMagic = 0x4C535047;  // "GPSL"
+constexpr uint16_t kStoreVersion = 1;
+constexpr int kMeanShift = 4;                 // Means and distances in Q4
+
+tflite::BuiltinOperator OpCode(const tflite::ModelT& model, const tflite::OperatorT& op) {
+    const tflite::OperatorCodeT* code = model.operator_codes[op.opcode_index].get();
+    // Models from older converters only set the deprecated int8 field
+    return static_cast<tflite::BuiltinOperator>(
+        std::max<int32_t>(code->builtin_code, code->deprecated_builtin_code));
+}
+
+// Operator that writes tensor, -1 for graph inputs and constants
+int Producer(const tflite::SubGraphT& subgraph, int32_t tensor) {
+    for (size_t i = 0; i < subgraph.operators.size(); i++) {
+        for (int32_t output : subgraph.operators[i]->outputs) {
+            if (output == tensor) return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+const char* PersonalModeName(PersonalMode mode) {
+    switch (mode) {
+        case PERSONAL_OFF:
+            return "off";
+        case PERSONAL_BLEND:
+            return "blend";
+        case PERSONAL_REPLACE:
+            return "replace";
+    }
+    return "?";
+}
+
+// ============================================================================
+// MODEL REWRITE
+// ============================================================================
+
+bool ExposeEmbedding(const unsigned char* model_data, std::vector<uint8_t>* exposed) {
+    exposed->clear();
+    std::unique_ptr<tflite::ModelT> model(tflite::GetModel(model_data)->UnPack());
+    if (model->subgraphs.size() != 1 || model->subgraphs[0]->outputs.size() != 1) {
+        MicroPrintf("Personalization: only single-subgraph, single-output models are supported");
+        return false;
+    }
+    tflite::SubGraphT* subgraph = model->subgraphs[0].get();
+
+    // output <- SOFTMAX <- FULLY_CONNECTED(embedding, weights, bias)
+    const int softmax = Producer(*subgraph, subgraph->outputs[0]);
+    if (softmax < 0 || OpCode(*model, *subgraph->operators[softmax]) !=
+                           tflite::BuiltinOperator_SOFTMAX) {
+        MicroPrintf("Personalization: the model output is not a SOFTMAX");
+        return false;
+    }
+    const int logits = Producer(*subgraph, subgraph->operators[softmax]->inputs[0]);
+    if (logits < 0 || OpCode(*model, *subgraph->operators[logits]) !=
+                          tflite::BuiltinOperator_FULLY_CONNECTED) {
+        MicroPrintf("Personalization: the SOFTMAX input is not a FULLY_CONNECTED");
+        return false;
+    }
+    const int32_t embedding = subgraph->operators[logits]->inputs[0];
+    if (Producer(*subgraph, embedding) < 0 ||
+        subgraph->tensors[embedding]->type != tflite::TensorType_INT8) {
+        MicroPrintf("Personalization: the embedding is not an int8 activation");
+        return false;
+    }
+    subgraph->outputs.push_back(embedding);
+
+    // The TFLM copy of flatbuffers has no implicit default allocator
+    flatbuffers::DefaultAllocator allocator;
+    flatbuffers::FlatBufferBuilder builder(16 * 1024, &allocator);
+    tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, model.get()));
+    model.reset();  // Keep the heap peak at builder + one model
+    exposed->assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    return true;
+}
+
+// ============================================================================
+// HEAD
+// ============================================================================
+
+PersonalHead::PersonalHead(const PersonalHeadConfig& config)
+    : config_(config), embedding_size_(0), embedding_scale_(0.0f), embedding_zero_point_(0) {
+    Clear();
+}
+
+bool PersonalHead::Init(const TfLiteTensor* embedding) {
+    embedding_size_ = 0;
+    Clear();
+    if (embedding == nullptr || embedding->type != kTfLiteInt8) return false;
+    const int size = static_cast<int>(embedding->bytes);
+    if (size <= 0 || size > PERSONAL_MAX_EMBEDDING) return false;
+    embedding_size_ = size;
+    embedding_scale_ = embedding->params.scale;
+    embedding_zero_point_ = embedding->params.zero_point;
+    return true;
+}
+
+void PersonalHead::Clear() {
+    memset(counts_, 0, sizeof(counts_));
+    memset(sums_, 0, sizeof(sums_));
+    memset(means_q4_, 0, sizeof(means_q4_));
+    ClearPending();
+}
+
+void PersonalHead::Collect(const TfLiteTensor* embedding) {
+    if (!Initialized()) return;
+    const int8_t* q = embedding->data.int8;
+    for (int i = 0; i < embedding_size_; i++) pending_sum_[i] += q[i] - embedding_zero_point_;
+    pending_count_++;
+}
+
+void PersonalHead::ClearPending() {
+    pending_count_ = 0;
+    memset(pending_sum_, 0, sizeof(pending_sum_));
+}
+
+int PersonalHead::LabelPending(int label) {
+    if (label < 0 || label >= NUM_POSTURE_CLASSES) return 0;
+    const int added = pending_count_;
+    for (int i = 0; i < embedding_size_; i++) sums_[label][i] += pending_sum_[i];
+    counts_[label] += added;
+    UpdateMean(label);
+    ClearPending();
+    return added;
+}
+
+void PersonalHead::Add(int label, const int8_t* embedding) {
+    if (label < 0 || label >= NUM_POSTURE_CLASSES) return;
+    for (int i = 0; i < embedding_size_; i++) {
+        sums_[label][i] += embedding[i] - embedding_zero_point_;
+    }
+    counts_[label]++;
+    UpdateMean(label);
+}
+
+void PersonalHead::UpdateMean(int label) {
+    const int32_t count = static_cast<int32_t>(counts_[label]);
+    if (count == 0) return;
+    for (int i = 0; i < embedding_size_; i++) {
+        // Round to nearest; sums of ReLU outputs are not negative
+        const int32_t scaled = sums_[label][i] * (1 << kMeanShift);
+        const int32_t mean = (scaled + (scaled >= 0 ? count / 2 : -count / 2)) / count;
+        means_q4_[label][i] = static_cast<int16_t>(mean);
+    }
+}
+
+bool PersonalHead::Ready() const {
+    if (!Initialized()) return false;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        if (counts_[c] < static_cast<uint32_t>(config_.min_class_samples) || counts_[c] == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PersonalHead::Distances(const int8_t* embedding,
+                             int32_t distances[NUM_POSTURE_CLASSES]) const {
+    // |x| <= 255 after the zero point, so |diff| < 2^13 and 64 squares fit in int32
+    int16_t x[PERSONAL_MAX_EMBEDDING];
+    for (int i = 0; i < embedding_size_; i++) {
+        x[i] = static_cast<int16_t>((embedding[i] - embedding_zero_point_) * (1 << kMeanShift));
+    }
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        int32_t sum = 0;
+        for (int i = 0; i < embedding_size_; i++) {
+            const int32_t diff = x[i] - means_q4_[c][i];
+            sum += diff * diff;
+        }
+        distances[c] = sum;
+    }
+}
+
+bool PersonalHead::Apply(const TfLiteTensor* embedding, float probs[NUM_POSTURE_CLASSES],
+                         int& best, float& confidence) const {
+    if (config_.mode == PERSONAL_OFF || !Ready()) return false;
+
+    int32_t distances[NUM_POSTURE_CLASSES];
+    Distances(embedding->data.int8, distances);
+    int32_t nearest = distances[0];
+    for (int c = 1; c < NUM_POSTURE_CLASSES; c++) nearest = std::min(nearest, distances[c]);
+
+    // Q4 squared distance back to embedding units
+    const float to_real = embedding_scale_ * embedding_scale_ / (1 << (2 * kMeanShift));
+    float head[NUM_POSTURE_CLASSES];
+    float total = 0.0f;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        head[c] = expf(-(distances[c] - nearest) * to_real / config_.temperature_sq);
+        total += head[c];
+    }
+
+    const float weight = config_.mode == PERSONAL_REPLACE ? 1.0f : config_.blend_weight;
+    best = 0;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+        probs[c] = (1.0f - weight) * probs[c] + weight * head[c] / total;
+        if (probs[c] > probs[best]) best = c;
+    }
+    confidence = probs[best];
+    return true;
+}
+
+// ============================================================================
+// FLASH STORE
+// ============================================================================
+
+void PersonalHead::Save(PersonalStore* store) const {
+    memset(store, 0, sizeof(*store));
+    store->magic = kStoreMagic;
+    store->version = kStoreVersion;
+    store->embedding_size = static_cast<uint16_t>(embedding_size_);
+    store->embedding_scale = embedding_scale_;
+    store->embedding_zero_point = embedding_zero_point_;
+    memcpy(store->counts, counts_, sizeof(counts_));
+    memcpy(store->sums, sums_, sizeof(sums_));
+}
+
+bool PersonalHead::Load(const PersonalStore& store) {
+    Clear();
+    if (!Initialized() || store.magic != kStoreMagic || store.version != kStoreVersion ||
+        store.embedding_size != embedding_size_ || store.embedding_scale != embedding_scale_ ||
+        store.embedding_zero_point != embedding_zero_point_) {
+        return false;
+    }
+    memcpy(counts_, store.counts, sizeof(counts_));
+    memcpy(sums_, store.sums, sizeof(sums_));
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) UpdateMean(c);
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "preprocessing.h"
+#include "hot_path.h"
 #include <Arduino.h>
 #include <cmath>
 #include <algorithm>
@@ -7,7 +8,7 @@
 // CONSTRUCTOR
 // ============================================================================
 
-Preprocessor::Preprocessor() {
+Preprocessor::Preprocessor() : hardware_lowpass(false) {
     Init();
 }
 
@@ -166,7 +167,7 @@ void Preprocessor::InitGravityFilter() {
 // FILTER APPLICATION
 // ============================================================================
 
-float Preprocessor::ApplyMedianFilter(float* buffer, float new_value) {
+float GAINS_HOT Preprocessor::ApplyMedianFilter(float* buffer, float new_value) {
     // Store new value in circular buffer
     buffer[median_index] = new_value;
 
@@ -191,9 +192,9 @@ float Preprocessor::ApplyMedianFilter(float* buffer, float new_value) {
     return sorted[MEDIAN_KERNEL_SIZE / 2];
 }
 
-float Preprocessor::ApplyBiquad(BiquadState* state, float input,
-                                 float b0, float b1, float b2,
-                                 float a1, float a2) {
+float GAINS_HOT Preprocessor::ApplyBiquad(BiquadState* state, float input,
+                                           float b0, float b1, float b2,
+                                           float a1, float a2) {
     // Direct Form II transposed structure
     // More numerically stable than Direct Form I
 
@@ -204,7 +205,7 @@ float Preprocessor::ApplyBiquad(BiquadState* state, float input,
     return output;
 }
 
-float Preprocessor::ApplyButterworthFilter(ButterworthFilter* filter, float input) {
+float GAINS_HOT Preprocessor::ApplyButterworthFilter(ButterworthFilter* filter, float input) {
     // Apply cascade of two biquad sections for 4th-order filter
     // Section 1 uses coefficients b0_1, b1_1, b2_1, a1_1, a2_1
     float intermediate = ApplyBiquad(&filter->section1, input,
@@ -219,30 +220,93 @@ float Preprocessor::ApplyButterworthFilter(ButterworthFilter* filter, float inpu
     return output;
 }
 
+float Preprocessor::PrimeBiquad(BiquadState* state, float input,
+                                float b0, float b1, float b2,
+                                float a1, float a2) {
+    // Steady state for a constant input: the output is the DC gain times
+    // the input, and both state equations of ApplyBiquad hold unchanged
+    float output = input * (b0 + b1 + b2) / (1.0f + a1 + a2);
+    state->w1 = output - b0 * input;
+    state->w2 = b2 * input - a2 * output;
+
+    return output;
+}
+
+float Preprocessor::PrimeButterworthFilter(ButterworthFilter* filter, float input) {
+    float intermediate = PrimeBiquad(&filter->section1, input,
+                                     filter->b0_1, filter->b1_1, filter->b2_1,
+                                     filter->a1_1, filter->a2_1);
+    return PrimeBiquad(&filter->section2, intermediate,
+                       filter->b0_2, filter->b1_2, filter->b2_2,
+                       filter->a1_2, filter->a2_2);
+}
+
 // ============================================================================
-// MAIN PROCESSING FUNCTION
+// PRIMING
 // ============================================================================
 
-void Preprocessor::ProcessSample(const float* raw_accel, const float* raw_gyro,
-                                   float* processed_sample) {
-    // Step 1: Median filter (denoise)
-    float accel_median[ACCEL_CHANNELS];
-    float gyro_median[GYRO_CHANNELS];
+void Preprocessor::Prime(const float* raw_accel, const float* raw_gyro) {
+    // Median buffers hold the sample in every slot
+    median_index = 0;
+    for (int i = 0; i < ACCEL_CHANNELS; i++) {
+        for (int j = 0; j < MEDIAN_KERNEL_SIZE; j++) {
+            accel_median_buffer[i][j] = raw_accel[i];
+        }
+    }
+    for (int i = 0; i < GYRO_CHANNELS; i++) {
+        for (int j = 0; j < MEDIAN_KERNEL_SIZE; j++) {
+            gyro_median_buffer[i][j] = raw_gyro[i];
+        }
+    }
 
+    // Each filter feeds its steady-state output to the next, as in ProcessSample
     for (int i = 0; i < ACCEL_CHANNELS; i++) {
-        accel_median[i] = ApplyMedianFilter(accel_median_buffer[i], raw_accel[i]);
+        float accel = raw_accel[i];
+        if (!hardware_lowpass) {
+            accel = PrimeButterworthFilter(&accel_lowpass[i], accel);
+        }
+        PrimeButterworthFilter(&gravity_filter[i], accel);
     }
     for (int i = 0; i < GYRO_CHANNELS; i++) {
-        gyro_median[i] = ApplyMedianFilter(gyro_median_buffer[i], raw_gyro[i]);
+        PrimeButterworthFilter(&gyro_highpass[i], raw_gyro[i]);
     }
+}
 
-    // Update median buffer index
-    median_index = (median_index + 1) % MEDIAN_KERNEL_SIZE;
+// ============================================================================
+// MAIN PROCESSING FUNCTION
+// ============================================================================
 
-    // Step 2: Apply lowpass filter to accelerometer (10 Hz)
+void GAINS_HOT Preprocessor::ProcessSample(const float* raw_accel, const float* raw_gyro,
+                                             float* processed_sample) {
     float accel_lowpass_out[ACCEL_CHANNELS];
-    for (int i = 0; i < ACCEL_CHANNELS; i++) {
-        accel_lowpass_out[i] = ApplyButterworthFilter(&accel_lowpass[i], accel_median[i]);
+    float gyro_median[GYRO_CHANNELS];
+
+    if (hardware_lowpass) {
+        // Steps 1-2 happened in the IMU's DLPF
+        for (int i = 0; i < ACCEL_CHANNELS; i++) {
+            accel_lowpass_out[i] = raw_accel[i];
+        }
+        for (int i = 0; i < GYRO_CHANNELS; i++) {
+            gyro_median[i] = raw_gyro[i];
+        }
+    } else {
+        // Step 1: Median filter (denoise)
+        float accel_median[ACCEL_CHANNELS];
+
+        for (int i = 0; i < ACCEL_CHANNELS; i++) {
+            accel_median[i] = ApplyMedianFilter(accel_median_buffer[i], raw_accel[i]);
+        }
+        for (int i = 0; i < GYRO_CHANNELS; i++) {
+            gyro_median[i] = ApplyMedianFilter(gyro_median_buffer[i], raw_gyro[i]);
+        }
+
+        // Update median buffer index
+        median_index = (median_index + 1) % MEDIAN_KERNEL_SIZE;
+
+        // Step 2: Apply lowpass filter to accelerometer (10 Hz)
+        for (int i = 0; i < ACCEL_CHANNELS; i++) {
+            accel_lowpass_out[i] = ApplyButterworthFilter(&accel_lowpass[i], accel_median[i]);
+        }
     }
 
     // Step 3: Apply highpass filter to gyroscope (0.2 Hz drift removal)
@@ -0,0 +1,94 @@
+#include "pushup_inference.h"
+
+#include <cmath>
+
+void NormalizeWindow(const float (*buffer)[NUM_CHANNELS], int buffer_size, int head,
+                     float normalized_window[WINDOW_SIZE][NUM_CHANNELS]) {
+    // Normalize the sliding window using saved mean/std
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        int buf_idx = (head - WINDOW_SIZE + i + buffer_size) % buffer_size;
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            normalized_window[i][ch] = (buffer[buf_idx][ch] - imu_mean[ch]) / (imu_std[ch] + 1e-8f);
+        }
+    }
+}
+
+void NormalizeWindow(const float* window, float normalized_window[WINDOW_SIZE][NUM_CHANNELS]) {
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            normalized_window[i][ch] =
+                (window[i * NUM_CHANNELS + ch] - imu_mean[ch]) / (imu_std[ch] + 1e-8f);
+        }
+    }
+}
+
+void QuantizeValues(const float* values, int n, float scale, int zero_point, int8_t* out) {
+    for (int i = 0; i < n; i++) {
+        // Quantize: q = round(val / scale) + zero_point
+        int32_t q = static_cast<int32_t>(roundf(values[i] / scale)) + zero_point;
+
+        // Clamp to int8 range
+        if (q < -128) q = -128;
+        if (q > 127) q = 127;
+
+        out[i] = static_cast<int8_t>(q);
+    }
+}
+
+void QuantizeWindow(const float normalized_window[WINDOW_SIZE][NUM_CHANNELS],
+                    TfLiteTensor* model_input) {
+    // Model expects shape: [1, WINDOW_SIZE, NUM_CHANNELS]
+    QuantizeValues(&normalized_window[0][0], WINDOW_SIZE * NUM_CHANNELS,
+                   model_input->params.scale, model_input->params.zero_point,
+                   model_input->data.int8);
+}
+
+void QuantizeRawSample(const float* raw_accel, const float* raw_gyro,
+                       const TfLiteTensor* raw_input, int16_t raw_sample[NUM_CHANNELS]) {
+    const auto* params = static_cast<const TfLiteAffineQuantization*>(raw_input->quantization.params);
+    const int num_scales = params->scale->size;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        const float value = ch < 3 ? raw_accel[ch] : raw_gyro[ch - 3];
+        const float scale = params->scale->data[num_scales == 1 ? 0 : ch];
+        int32_t q = static_cast<int32_t>(roundf(value / scale));
+        if (q < -32768) q = -32768;
+        if (q > 32767) q = 32767;
+        raw_sample[ch] = static_cast<int16_t>(q);
+    }
+}
+
+void DequantizePosture(const TfLiteTensor* posture_output,
+                       float posture_probs[NUM_POSTURE_CLASSES],
+                       int& best_posture, float& max_posture_prob) {
+    // Dequantize posture predictions
+    const float posture_scale = posture_output->params.scale;
+    const int posture_zp = posture_output->params.zero_point;
+
+    best_posture = 0;
+    max_posture_prob = -1.0f;
+
+    for (int i = 0; i < NUM_POSTURE_CLASSES; i++) {
+        float p = posture_scale * (static_cast<int>(posture_output->data.int8[i]) - posture_zp);
+        posture_probs[i] = p;
+        if (p > max_posture_prob) {
+            max_posture_prob = p;
+            best_posture = i;
+        }
+    }
+}
+
+float WeightedVoteScores(const InferenceResult* results, int count,
+                         float weighted_scores[NUM_POSTURE_CLASSES]) {
+    float total_weight = 0;
+    for (int c = 0; c < NUM_POSTURE_CLASSES; c++) weighted_scores[c] = 0;
+
+    for (int i = 0; i < count; i++) {
+        float weight = results[i].max_confidence;
+        total_weight += weight;
+
+        for (int c = 0; c < NUM_POSTURE_CLASSES; c++) {
+            weighted_scores[c] += results[i].probabilities[c] * weight;
+        }
+    }
+    return total_weight;
+}
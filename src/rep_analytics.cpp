@@ -0,0 +1,168 @@
+#include "rep_analytics.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "model_config.h"
+
+namespace {
+constexpr float kSampleSeconds = SAMPLE_PERIOD_MS / 1000.0f;
+constexpr float kStandardGravity = 9.80665f;  // m/s^2 per g
+}  // namespace
+
+// ============================================================================
+// CONSTRUCTOR / RESET
+// ============================================================================
+
+RepAnalytics::RepAnalytics(const RepAnalyticsConfig& config) : config_(config) {
+    Reset();
+}
+
+void RepAnalytics::Reset() {
+    memset(&summary_, 0, sizeof(summary_));
+    sample_count_ = 0;
+    activity_ = 0.0f;
+    rate_ = 0.0f;
+    gravity_[0] = gravity_[1] = gravity_[2] = 0.0f;
+    in_rep_ = false;
+    rest_run_ = 0;
+    StartMotion();
+}
+
+void RepAnalytics::StartMotion() {
+    start_sample_ = sample_count_;
+    pitch_deg_ = pitch_min_deg_ = pitch_max_deg_ = 0.0f;
+    velocity_ = 0.0f;
+    height_ = 0.0f;
+    bottom_height_ = 0.0f;
+    bottom_sample_ = sample_count_;
+    direction_ = 0;
+    returned_ = false;
+    lobe_sign_ = 0;
+    lobe_pitch_deg_ = 0.0f;
+}
+
+// ============================================================================
+// STREAMING
+// ============================================================================
+
+bool RepAnalytics::OnSample(const float* raw_accel, const float* processed_sample) {
+    // Gravity direction from the slowly smoothed raw accel
+    if (sample_count_ == 0) {
+        for (int i = 0; i < 3; i++) gravity_[i] = raw_accel[i];
+    } else {
+        for (int i = 0; i < 3; i++) {
+            gravity_[i] += config_.gravity_smoothing * (raw_accel[i] - gravity_[i]);
+        }
+    }
+    const float norm = sqrtf(gravity_[0] * gravity_[0] + gravity_[1] * gravity_[1] +
+                             gravity_[2] * gravity_[2]);
+    float vertical = 0.0f;  // Up is positive: at rest the accel points away from the floor
+    if (norm > 1e-3f) {
+        vertical = (processed_sample[0] * gravity_[0] + processed_sample[1] * gravity_[1] +
+                    processed_sample[2] * gravity_[2]) / norm;
+    }
+
+    const float* gyro = &processed_sample[3];
+    const float speed = sqrtf(gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2]);
+    const float pitch_rate = processed_sample[config_.pitch_axis];
+    activity_ += config_.activity_smoothing * (speed - activity_);
+    rate_ += config_.activity_smoothing * (pitch_rate - rate_);
+    sample_count_++;
+
+    // Integrate from the first sample above rest, so the rep keeps its onset
+    if (!in_rep_ && activity_ < config_.rest_rate_dps) {
+        StartMotion();
+        return false;
+    }
+
+    // A lobe is a run of the pitch rate in one direction
+    const int sign = rate_ > config_.rest_rate_dps ? 1 : (rate_ < -config_.rest_rate_dps ? -1 : 0);
+    if (sign != 0 && sign != lobe_sign_) {
+        lobe_sign_ = sign;
+        lobe_pitch_deg_ = 0.0f;
+    }
+    pitch_deg_ += pitch_rate * kSampleSeconds;
+    pitch_min_deg_ = fminf(pitch_min_deg_, pitch_deg_);
+    pitch_max_deg_ = fmaxf(pitch_max_deg_, pitch_deg_);
+    velocity_ += vertical * kStandardGravity * kSampleSeconds;
+    height_ += velocity_ * kSampleSeconds;
+    if (height_ < bottom_height_) {
+        bottom_height_ = height_;
+        bottom_sample_ = sample_count_;
+    }
+    lobe_pitch_deg_ += pitch_rate * kSampleSeconds;
+
+    if (!in_rep_) {
+        if (activity_ >= config_.start_rate_dps) {
+            in_rep_ = true;
+            rest_run_ = 0;
+        }
+        return false;
+    }
+
+    // Half the minimum excursion makes a lobe count: the first one is the
+    // lowering, one against it is the way back up
+    if (fabsf(lobe_pitch_deg_) >= 0.5f * config_.min_excursion_deg) {
+        if (direction_ == 0) {
+            direction_ = lobe_sign_;
+        } else if (lobe_sign_ != direction_) {
+            returned_ = true;
+        }
+    }
+
+    // Rest ends a rep once it came back up; a pause at the bottom does not
+    rest_run_ = activity_ < config_.rest_rate_dps ? rest_run_ + 1 : 0;
+    if (rest_run_ >= config_.rest_samples && (returned_ || direction_ == 0)) {
+        const bool completed = CompleteRep(sample_count_ - rest_run_);
+        in_rep_ = false;
+        StartMotion();
+        return completed;
+    }
+
+    // Never came back (or a slow drift that never started a rep)
+    if (sample_count_ - start_sample_ > config_.max_rep_samples) {
+        in_rep_ = false;
+        StartMotion();
+    }
+    return false;
+}
+
+bool RepAnalytics::Finish() {
+    const bool completed = in_rep_ && CompleteRep(sample_count_);
+    in_rep_ = false;
+    rest_run_ = 0;
+    StartMotion();
+    return completed;
+}
+
+bool RepAnalytics::CompleteRep(int end_sample) {
+    const int rep_samples = end_sample - start_sample_;
+    if (bottom_sample_ > end_sample) bottom_sample_ = end_sample;  // Found in the rest run
+    const float excursion = pitch_max_deg_ - pitch_min_deg_;
+    if (rep_samples < config_.min_rep_samples || excursion < config_.min_excursion_deg) {
+        return false;
+    }
+
+    // Velocity should be back at zero: remove the constant accel bias that
+    // explains what is left, at the time of the bottom
+    const float elapsed_s = (sample_count_ - start_sample_) * kSampleSeconds;
+    const float bottom_s = (bottom_sample_ - start_sample_) * kSampleSeconds;
+    const float bias = elapsed_s > 0.0f ? velocity_ / elapsed_s : 0.0f;
+    const float depth_m = -(bottom_height_ - 0.5f * bias * bottom_s * bottom_s);
+
+    RepMetrics& rep = summary_.last;
+    rep.duration_ms = static_cast<uint32_t>(rep_samples) * SAMPLE_PERIOD_MS;
+    rep.eccentric_ms = static_cast<uint32_t>(bottom_sample_ - start_sample_) * SAMPLE_PERIOD_MS;
+    rep.concentric_ms = rep.duration_ms - rep.eccentric_ms;
+    rep.excursion_deg = excursion;
+    rep.depth_cm = depth_m > 0.0f ? depth_m * 100.0f : 0.0f;
+
+    summary_.reps++;
+    summary_.tension_ms += rep.duration_ms;
+    summary_.eccentric_ms += rep.eccentric_ms;
+    summary_.concentric_ms += rep.concentric_ms;
+    summary_.excursion_sum_deg += rep.excursion_deg;
+    summary_.depth_sum_cm += rep.depth_cm;
+    return true;
+}
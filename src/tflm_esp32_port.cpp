@@ -29,3 +29,64 @@ void InitializeTarget() {
 }
 
 }  // namespace tflite
+
+// The library's system_setup.cpp only provides the test_over_serial serial
+// API for the Nano 33 BLE, so the ESP32 port supplies it here.
+namespace test_over_serial {
+
+namespace {
+char line_buffer[kSerialMaxInputLength + 1];
+size_t line_length = 0;
+bool line_complete = false;
+}  // namespace
+
+void SerialChangeBaudRate(const int baud) {
+  Serial.begin(baud);
+  unsigned long start = millis();
+  while (!Serial && (millis() - start < kSerialInitTimeoutMs)) {
+    delay(10);
+  }
+}
+
+std::pair<size_t, char*> SerialReadLine(int timeout) {
+  if (line_complete) {
+    line_complete = false;
+    line_length = 0;
+  }
+
+  unsigned long start = millis();
+  while (true) {
+    int value = Serial.read();
+    if (value >= 0) {
+      if (value != '\n') {
+        line_buffer[line_length++] = static_cast<char>(value);
+      }
+      // a newline or a full buffer ends the line
+      if (value == '\n' || line_length == kSerialMaxInputLength) {
+        line_buffer[line_length] = '\0';
+        line_complete = true;
+        return std::make_pair(line_length, line_buffer);
+      }
+    }
+    if (timeout >= 0 && millis() - start >= static_cast<unsigned long>(timeout)) {
+      return std::make_pair(0UL, static_cast<char*>(nullptr));
+    }
+  }
+}
+
+size_t SerialReadBytes(uint8_t* buffer, size_t length, int timeout) {
+  unsigned long start = millis();
+  while (Serial.available() <= 0) {
+    if (timeout >= 0 && millis() - start >= static_cast<unsigned long>(timeout)) {
+      return 0;
+    }
+    delay(1);
+  }
+  return Serial.readBytes(buffer, min(length, static_cast<size_t>(Serial.available())));
+}
+
+void SerialWrite(const char* buffer) {
+  Serial.print(buffer);
+}
+
+}  // namespace test_over_serial